@@ -59,6 +59,12 @@
 #define UALDS_CONF_MAX_URI_LENGTH 256
 /* maximum length of a settings key */
 #define UALDS_CONF_MAX_KEY_LENGTH 50
+/* interval of the expiration check of registered servers in milliseconds */
+#define UALDS_CONF_EXPIRATION_CHECK_INTERVAL 1000
+/* interval of the host name refresh in milliseconds */
+#define UALDS_CONF_HOSTNAME_REFRESH_INTERVAL 60000
+/* maximum time the network thread waits for a free request queue entry in milliseconds */
+#define UALDS_CONF_THREADPOOL_TIMEOUT 1000
 
 /* Windows specific section */
 #ifdef _WIN32
@@ -80,6 +86,14 @@
 #define UALDS_CONF_LOG_LEVEL         UALDS_LOG_DEBUG
 #define UALDS_CONF_SYSLOG_IDENT      "ualds"
 #define UALDS_CONF_SYSLOG_FACILITY   LOG_LOCAL0
+/* default number of queued messages in async log mode (rounded up to a power of two) */
+#define UALDS_CONF_LOG_ASYNC_QUEUE_SIZE  4096
+/* maximum length of a queued log line in async log mode; longer lines are truncated */
+#define UALDS_CONF_LOG_ASYNC_LINE_LENGTH 512
+/* maximum time in milliseconds a queued log line waits for the writer in async log mode */
+#define UALDS_CONF_LOG_ASYNC_FLUSH_INTERVAL 100
+/* default number of trace ring records per thread (rounded up to a power of two) */
+#define UALDS_CONF_TRACERING_SIZE    1024
 
 // Bonjour Service Names
 # define APPLE_BONJOUR_SERVICE_NAME       TEXT("Bonjour Service")
@@ -39,10 +39,178 @@
 #include "config.h"
 #include "ualds.h"
 #include "settings.h"
+#include "registry.h"
 /* local platform includes */
 #include <platform.h>
 #include <log.h>
 
+/** Prebuilt result of a FindServers request without ServerUris filter.
+ * The cache is rebuilt when the registry generation or the host name changes.
+ * Requests use shallow copies of \c pServers, so the cache is reference counted
+ * and freed when the last request which uses it has sent its response.
+ */
+struct _ualds_findservers_cache
+{
+    int                           refCount;
+    unsigned int                  generation;
+    char                          szHostname[50];
+    OpcUa_Int32                   numServers;
+    OpcUa_ApplicationDescription *pServers;
+};
+typedef struct _ualds_findservers_cache ualds_findservers_cache;
+
+static ualds_findservers_cache *g_pFindServersCache = OpcUa_Null;
+static OpcUa_Mutex              g_hFindServersCacheMutex = OpcUa_Null;
+
+/** Fills \c pDescription with the information of the registered server \c pServer.
+ * [gethostname] is replaced by \c szHostname in the DiscoveryUrls and in the ServerUri.
+ */
+static void ualds_findservers_describe(OpcUa_ApplicationDescription *pDescription,
+                                       const ualds_registeredserver *pServer,
+                                       const char *szHostname)
+{
+    char szTmpUrl[UALDS_CONF_MAX_URI_LENGTH];
+    int j;
+
+    OpcUa_ApplicationDescription_Initialize(pDescription);
+    OpcUa_String_AttachCopy(&pDescription->ProductUri, pServer->szProductUri);
+    if (pServer->nNoOfServerNames > 0)
+    {
+        OpcUa_String_AttachCopy(&pDescription->ApplicationName.Locale, pServer->pServerNames[0].szLocale);
+        OpcUa_String_AttachCopy(&pDescription->ApplicationName.Text, pServer->pServerNames[0].szText);
+    }
+    pDescription->ApplicationType = (OpcUa_ApplicationType)pServer->ServerType;
+    OpcUa_String_AttachCopy(&pDescription->GatewayServerUri, pServer->szGatewayServerUri);
+    if (pServer->nNoOfDiscoveryUrls > 0)
+    {
+        pDescription->DiscoveryUrls = OpcUa_Alloc(sizeof(OpcUa_String)* pServer->nNoOfDiscoveryUrls);
+        if (pDescription->DiscoveryUrls)
+        {
+            pDescription->NoOfDiscoveryUrls = pServer->nNoOfDiscoveryUrls;
+            for (j = 0; j<pServer->nNoOfDiscoveryUrls; j++)
+            {
+                strlcpy(szTmpUrl, pServer->pszDiscoveryUrls[j], UALDS_CONF_MAX_URI_LENGTH);
+                replace_string(szTmpUrl, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
+                OpcUa_String_Initialize(&pDescription->DiscoveryUrls[j]);
+                OpcUa_String_AttachCopy(&pDescription->DiscoveryUrls[j], szTmpUrl);
+            }
+        }
+    }
+
+    /* finally replace [gethostname] in ServerUri and copy to ApplicationUri */
+    strlcpy(szTmpUrl, pServer->szServerUri, UALDS_CONF_MAX_URI_LENGTH);
+    replace_string(szTmpUrl, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
+    OpcUa_String_AttachCopy(&pDescription->ApplicationUri, szTmpUrl);
+}
+
+static void ualds_findservers_freecache(ualds_findservers_cache *pCache)
+{
+    OpcUa_Int32 i;
+
+    for (i = 0; i < pCache->numServers; i++)
+    {
+        OpcUa_ApplicationDescription_Clear(&pCache->pServers[i]);
+    }
+    OpcUa_Free(pCache->pServers);
+    OpcUa_Free(pCache);
+}
+
+/** Releases a cache reference returned by ualds_findservers_getcache. */
+static void ualds_findservers_releasecache(ualds_findservers_cache *pCache)
+{
+    int refCount;
+
+    OpcUa_Mutex_Lock(g_hFindServersCacheMutex);
+    refCount = --pCache->refCount;
+    OpcUa_Mutex_Unlock(g_hFindServersCacheMutex);
+
+    if (refCount == 0) ualds_findservers_freecache(pCache);
+}
+
+/** Returns a reference to the prebuilt list of all registered servers.
+ * The cache is rebuilt if the registry has changed since it was built.
+ * The caller must release the reference using ualds_findservers_releasecache.
+ * @return The cache or NULL if out of memory.
+ */
+static ualds_findservers_cache* ualds_findservers_getcache(const char *szHostname)
+{
+    ualds_findservers_cache *pCache;
+    ualds_findservers_cache *pOld;
+    ualds_registeredserver  *pServer;
+    OpcUa_Int32              i = 0;
+
+    ualds_registry_lockread();
+
+    OpcUa_Mutex_Lock(g_hFindServersCacheMutex);
+    pCache = g_pFindServersCache;
+    if (pCache && pCache->generation == ualds_registry_generation() && strcmp(pCache->szHostname, szHostname) == 0)
+    {
+        pCache->refCount++;
+        OpcUa_Mutex_Unlock(g_hFindServersCacheMutex);
+        ualds_registry_unlockread();
+        return pCache;
+    }
+    OpcUa_Mutex_Unlock(g_hFindServersCacheMutex);
+
+    /* rebuild, the registry can't change while the read lock is held */
+    pCache = OpcUa_Alloc(sizeof(ualds_findservers_cache));
+    if (pCache == OpcUa_Null)
+    {
+        ualds_registry_unlockread();
+        return OpcUa_Null;
+    }
+    OpcUa_MemSet(pCache, 0, sizeof(ualds_findservers_cache));
+    pCache->generation = ualds_registry_generation();
+    strlcpy(pCache->szHostname, szHostname, sizeof(pCache->szHostname));
+    if (ualds_registry_count() > 0)
+    {
+        pCache->pServers = OpcUa_Alloc(sizeof(OpcUa_ApplicationDescription) * ualds_registry_count());
+        if (pCache->pServers == OpcUa_Null)
+        {
+            ualds_registry_unlockread();
+            OpcUa_Free(pCache);
+            return OpcUa_Null;
+        }
+        for (pServer = ualds_registry_first(); pServer; pServer = pServer->pNext)
+        {
+            ualds_findservers_describe(&pCache->pServers[i++], pServer, szHostname);
+        }
+        pCache->numServers = i;
+    }
+
+    ualds_registry_unlockread();
+
+    /* one reference for the global pointer and one for the caller */
+    pCache->refCount = 2;
+    OpcUa_Mutex_Lock(g_hFindServersCacheMutex);
+    pOld = g_pFindServersCache;
+    g_pFindServersCache = pCache;
+    OpcUa_Mutex_Unlock(g_hFindServersCacheMutex);
+
+    if (pOld) ualds_findservers_releasecache(pOld);
+
+    return pCache;
+}
+
+/** Creates the lock of the FindServers cache. */
+OpcUa_StatusCode ualds_findservers_initialize(void)
+{
+    return OpcUa_Mutex_Create(&g_hFindServersCacheMutex);
+}
+
+/** Frees the FindServers cache. */
+void ualds_findservers_cleanup(void)
+{
+    if (g_hFindServersCacheMutex == OpcUa_Null) return;
+
+    if (g_pFindServersCache)
+    {
+        ualds_findservers_releasecache(g_pFindServersCache);
+        g_pFindServersCache = OpcUa_Null;
+    }
+    OpcUa_Mutex_Delete(&g_hFindServersCacheMutex);
+}
+
 /** FindServer Service implementation.
 * @param hEndpoint OPC UA Endpoint handle.
 * @param hContext  Service context.
@@ -61,21 +229,19 @@ OpcUa_StatusCode ualds_findservers(
     OpcUa_FindServersResponse *pResponse;
     OpcUa_EncodeableType      *pResponseType = 0;
     OpcUa_StatusCode           uStatus = OpcUa_Good;
-    char                     **szUriArray = 0;
-    char                       szTmpUrl[UALDS_CONF_MAX_URI_LENGTH];
+    ualds_registeredserver    *pServer;
+    ualds_registeredserver   **ppServers = 0;
+    ualds_findservers_cache   *pCache = 0;
     int i, j;
     char                       szHostname[50];
     int numServers = 0;
-    int numServerNames = 0;
-    int numDiscoveryUrls = 0;
-    int tmpInt;
 
     UALDS_UNUSED(pRequestType);
 
     OpcUa_ReturnErrorIfArgumentNull(ppRequest);
     pRequest = *ppRequest;
 
-    ualds_platform_getfqhostname(szHostname, 50);
+    ualds_hostname(szHostname, sizeof(szHostname));
     
     uStatus = OpcUa_Endpoint_BeginSendResponse(
         hEndpoint,
@@ -86,137 +252,93 @@ OpcUa_StatusCode ualds_findservers(
 
     if ( pResponse )
     {
-		OpcUa_Mutex_Lock(g_mutex);
-
-        ualds_expirationcheck();
-
-        ualds_settings_begingroup("RegisteredServers");
-        ualds_settings_beginreadarray("Servers", &numServers);
-        if (numServers > 0)
+        if (pRequest->NoOfServerUris <= 0)
         {
-            szUriArray = OpcUa_Alloc(numServers * sizeof(char*));
-            if (szUriArray)
+            /* without filter the response contains all servers, use the prebuilt list */
+            pCache = ualds_findservers_getcache(szHostname);
+            if (pCache == 0)
+            {
+                uStatus = OpcUa_BadOutOfMemory;
+            }
+            else if (pCache->numServers > 0)
             {
-                OpcUa_MemSet(szUriArray, 0, numServers * sizeof(char*));
+                pResponse->Servers = OpcUa_Alloc(sizeof(OpcUa_ApplicationDescription) * pCache->numServers);
+                if (pResponse->Servers)
+                {
+                    OpcUa_MemCpy(pResponse->Servers, sizeof(OpcUa_ApplicationDescription) * pCache->numServers,
+                                 pCache->pServers, sizeof(OpcUa_ApplicationDescription) * pCache->numServers);
+                    pResponse->NoOfServers = pCache->numServers;
+                }
+                else
+                {
+                    uStatus = OpcUa_BadOutOfMemory;
+                }
+            }
+        }
+        else
+        {
+            /* FindServers only reads the registry, so it does not need g_mutex */
+            ualds_registry_lockread();
 
-                tmpInt = 0;
-                for (i=0; i<numServers; i++)
+            /* collect all servers which pass the ServerUri filter */
+            if (ualds_registry_count() > 0)
+            {
+                ppServers = OpcUa_Alloc(ualds_registry_count() * sizeof(ualds_registeredserver*));
+                if (ppServers == 0)
                 {
-                    OpcUa_Boolean bFilteredOut = OpcUa_False;
+                    ualds_registry_unlockread();
 
-                    ualds_settings_setarrayindex(i);
-                    ualds_settings_readstring("ServerUri", szTmpUrl, UALDS_CONF_MAX_URI_LENGTH);
+                    UALDS_BUILDRESPONSEHEADER;
 
-                    /* filter by ServerUri */
-                    if (pRequest->NoOfServerUris > 0)
-                    {
-                        bFilteredOut = OpcUa_True;
+                    pResponse->ResponseHeader.ServiceResult = OpcUa_BadOutOfMemory;
 
-                        for (j = 0; j < pRequest->NoOfServerUris; j++)
-                        {
-                            if (OpcUa_String_StrnCmp(&pRequest->ServerUris[j], OpcUa_String_FromCString(szTmpUrl), OPCUA_STRING_LENDONTCARE, OpcUa_False) == 0)
-                            {
-                                bFilteredOut = OpcUa_False;
-                                break;
-                            }
-                        }
-                    }
-                    if (bFilteredOut == OpcUa_False)
+                    /* Send response */
+                    OpcUa_Endpoint_EndSendResponse(
+                        hEndpoint,
+                        &hContext,
+                        OpcUa_Good,
+                        pResponse,
+                        pResponseType);
+
+                    return OpcUa_Good;
+                }
+
+                for (pServer = ualds_registry_first(); pServer; pServer = pServer->pNext)
+                {
+                    for (j = 0; j < pRequest->NoOfServerUris; j++)
                     {
-                        szUriArray[tmpInt] = OpcUa_Alloc(UALDS_CONF_MAX_URI_LENGTH);
-                        if (szUriArray[tmpInt])
+                        if (OpcUa_String_StrnCmp(&pRequest->ServerUris[j], OpcUa_String_FromCString(pServer->szServerUri), OPCUA_STRING_LENDONTCARE, OpcUa_False) == 0)
                         {
-                            strlcpy(szUriArray[tmpInt], szTmpUrl, UALDS_CONF_MAX_URI_LENGTH);
+                            ppServers[numServers++] = pServer;
+                            break;
                         }
-                        tmpInt++;
                     }
                 }
-                numServers = tmpInt;
             }
-            else
-            {
-                UALDS_BUILDRESPONSEHEADER;
-
-                pResponse->ResponseHeader.ServiceResult = OpcUa_BadOutOfMemory;
 
-                /* Send response */
-                OpcUa_Endpoint_EndSendResponse(
-                    hEndpoint,
-                    &hContext,
-                    OpcUa_Good,
-                    pResponse,
-                    pResponseType);
-
-                ualds_settings_endarray();
-                ualds_settings_endgroup();
-
-				OpcUa_Mutex_Unlock(g_mutex);
-
-                return OpcUa_Good;
-            }
-        }
-        ualds_settings_endarray();
-        ualds_settings_endgroup();
-
-        pResponse->NoOfServers = numServers;
-        if (pResponse->NoOfServers > 0)
-        {
-            pResponse->Servers = OpcUa_Alloc(sizeof(OpcUa_ApplicationDescription)* pResponse->NoOfServers);
-            if (pResponse->Servers)
+            pResponse->NoOfServers = numServers;
+            if (pResponse->NoOfServers > 0)
             {
-                for (i = 0; i<pResponse->NoOfServers; i++)
+                pResponse->Servers = OpcUa_Alloc(sizeof(OpcUa_ApplicationDescription)* pResponse->NoOfServers);
+                if (pResponse->Servers)
                 {
-                    OpcUa_ApplicationDescription_Initialize(&pResponse->Servers[i]);
-                    if (szUriArray[i] == 0) continue;
-                    ualds_settings_begingroup(szUriArray[i]);
-                    ualds_settings_readuastring("ProductUri", &pResponse->Servers[i].ProductUri);
-                    ualds_settings_beginreadarray("ServerNames", &numServerNames);
-                    if (numServerNames > 0)
+                    for (i = 0; i<pResponse->NoOfServers; i++)
                     {
-                        ualds_settings_setarrayindex(0);
-                        ualds_settings_readuastring("Locale", &pResponse->Servers[i].ApplicationName.Locale);
-                        ualds_settings_readuastring("Text", &pResponse->Servers[i].ApplicationName.Text);
+                        ualds_findservers_describe(&pResponse->Servers[i], ppServers[i], szHostname);
                     }
-                    ualds_settings_endarray();
-                    ualds_settings_readint("ServerType", &tmpInt);
-                    pResponse->Servers[i].ApplicationType = (OpcUa_ApplicationType)tmpInt;
-                    ualds_settings_readuastring("GatewayServerUri", &pResponse->Servers[i].GatewayServerUri);
-                    ualds_settings_beginreadarray("DiscoveryUrls", &numDiscoveryUrls);
-                    if (numDiscoveryUrls > 0)
-                    {
-                        pResponse->Servers[i].NoOfDiscoveryUrls = numDiscoveryUrls;
-                        pResponse->Servers[i].DiscoveryUrls = OpcUa_Alloc(sizeof(OpcUa_String)* numDiscoveryUrls);
-                        if (pResponse->Servers[i].DiscoveryUrls)
-                        {
-                            for (j = 0; j<numDiscoveryUrls; j++)
-                            {
-                                ualds_settings_setarrayindex(j);
-                                ualds_settings_readstring("Url", szTmpUrl, UALDS_CONF_MAX_URI_LENGTH);
-                                replace_string(szTmpUrl, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
-                                OpcUa_String_Initialize(&pResponse->Servers[i].DiscoveryUrls[j]);
-                                OpcUa_String_AttachCopy(&pResponse->Servers[i].DiscoveryUrls[j], szTmpUrl);
-                            }
-                        }
-                    }
-                    ualds_settings_endarray();
-                    ualds_settings_endgroup();
-
-                    /* finally replace [gethostname] in ServerUri and copy to ApplicationUri */
-                    replace_string(szUriArray[i], UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
-                    OpcUa_String_AttachCopy(&pResponse->Servers[i].ApplicationUri, szUriArray[i]);
+                }
+                else
+                {
+                    uStatus = OpcUa_BadOutOfMemory;
                 }
             }
             else
             {
-                uStatus = OpcUa_BadOutOfMemory;
+                uStatus = OpcUa_Good;
             }
-        }
-        else
-        {
-            uStatus = OpcUa_Good;
-        }
 
-		OpcUa_Mutex_Unlock(g_mutex);
+            ualds_registry_unlockread();
+        }
 
         UALDS_BUILDRESPONSEHEADER;
 
@@ -228,19 +350,19 @@ OpcUa_StatusCode ualds_findservers(
             pResponse,
             pResponseType);
 
-        /* free response */
+        /* free response, the descriptions of the prebuilt list are owned by the cache */
+        if (pCache)
+        {
+            OpcUa_Free(pResponse->Servers);
+            pResponse->Servers = OpcUa_Null;
+            pResponse->NoOfServers = 0;
+            ualds_findservers_releasecache(pCache);
+        }
         OpcUa_FindServersResponse_Clear(pResponse);
         OpcUa_Free(pResponse);
 
         /* cleanup */
-        if (szUriArray)
-        {
-            for (i=0; i<numServers; i++)
-            {
-                if (szUriArray[i]) OpcUa_Free(szUriArray[i]);
-            }
-            OpcUa_Free(szUriArray);
-        }
+        if (ppServers) OpcUa_Free(ppServers);
 
         /* we have send a response, either with good or bad status, this does not matter.
          * we must return Good now, otherwise the stack will send an error message.
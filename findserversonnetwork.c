@@ -151,25 +151,17 @@ static void ualds_findserversonnetwork_removeServiceEntries(ualds_browseContext
     }
 }
 
-void ualds_findserversonnetwork_socketEventCallback(int* shutdown)
+/** Collects the sockets of all pending mDNS browse and resolve operations for ualds_platform_poll.
+ * Entries of failed or stopped operations are removed.
+ * @param pFds Receives up to \c maxFds sockets.
+ * @return The number of sockets, which can be larger than \c maxFds.
+ */
+int ualds_findserversonnetwork_getSockets(UALDS_POLLFD *pFds, int maxFds)
 {
-    fd_set readFDs;
-    struct timeval tv;
-    int fd, status;
+    int numFds = 0;
     ualds_genericContext* context;
     MulticastSocketCallbackStruct* socketCallbackStruct;
 
-    if (*shutdown)
-    {
-        return;
-    }
-
-    /*
-    TODO:
-    This should be combined with zerconf socket callback into one "poll" loop that builds 
-    pollfd or select bitmask from the socket cb list. This would then be driven from main.
-    */
-
     /* Lock access to shared sdref/fd from server processing thread */
     OpcUa_Mutex_Lock(g_mutex);
     OpcUa_List_Enter(&g_findServersSocketList);
@@ -179,7 +171,7 @@ void ualds_findserversonnetwork_socketEventCallback(int* shutdown)
     while (socketCallbackStruct)
     {
         context = (ualds_genericContext*)socketCallbackStruct->context;
-        if (*shutdown || context == OpcUa_Null || context->sdRef == OpcUa_Null)
+        if (context == OpcUa_Null || context->sdRef == OpcUa_Null || context->sdRef != socketCallbackStruct->sdRef)
         {
             /* browse or resolve failed or was stopped - remove socket from poll list */
             OpcUa_Free(socketCallbackStruct);
@@ -188,23 +180,55 @@ void ualds_findserversonnetwork_socketEventCallback(int* shutdown)
             continue;
         }
 
-        fd = DNSServiceRefSockFD(socketCallbackStruct->sdRef);
-        FD_ZERO(&readFDs);
-        FD_SET(fd, &readFDs);
+        if (numFds < maxFds)
+        {
+            pFds[numFds].fd = DNSServiceRefSockFD(socketCallbackStruct->sdRef);
+            pFds[numFds].events = POLLIN;
+            pFds[numFds].revents = 0;
+        }
+        numFds++;
+        socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetNextElement(&g_findServersSocketList);
+    }
+
+    OpcUa_List_Leave(&g_findServersSocketList);
+    OpcUa_Mutex_Unlock(g_mutex);
+
+    return numFds;
+}
+
+/** Processes the mDNS browse or resolve result which is pending on the socket \c pFd.
+ * The operation may have been stopped since the socket was collected,
+ * so the socket is looked up again and checked for pending data before
+ * DNSServiceProcessResult is called, which would block otherwise.
+ */
+void ualds_findserversonnetwork_processSocket(const UALDS_POLLFD *pFd)
+{
+    UALDS_POLLFD pollFd = *pFd;
+    ualds_genericContext* context;
+    MulticastSocketCallbackStruct* socketCallbackStruct;
 
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000;
-        status = select(fd + 1, &readFDs, NULL, NULL, &tv);
-        if (status > 0)
+    OpcUa_Mutex_Lock(g_mutex);
+    OpcUa_List_Enter(&g_findServersSocketList);
+    OpcUa_List_ResetCurrent(&g_findServersSocketList);
+
+    socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetCurrentElement(&g_findServersSocketList);
+    while (socketCallbackStruct)
+    {
+        context = (ualds_genericContext*)socketCallbackStruct->context;
+        if (context != OpcUa_Null && context->sdRef != OpcUa_Null && context->sdRef == socketCallbackStruct->sdRef &&
+            DNSServiceRefSockFD(socketCallbackStruct->sdRef) == pollFd.fd)
         {
-            if (FD_ISSET(fd, &readFDs))
+            pollFd.revents = 0;
+            if (ualds_platform_poll(&pollFd, 1, 0) > 0)
             {
+                /* the reply callbacks append new resolve operations to g_findServersSocketList */
                 int error = DNSServiceProcessResult(socketCallbackStruct->sdRef);
                 if (error != kDNSServiceErr_NoError)
                 {
-                    ualds_log(UALDS_LOG_ERR, "ualds_findserversonnetwork_socketEventCallback: DNSServiceProcessResult returned error %i", error);
+                    ualds_log(UALDS_LOG_ERR, "ualds_findserversonnetwork_processSocket: DNSServiceProcessResult returned error %i", error);
                 }
             }
+            break;
         }
         socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetNextElement(&g_findServersSocketList);
     }
@@ -978,7 +1002,7 @@ void ualds_zeroconf_register_offline(const char *szServerUri)
 
     // replace [gethostname] if necessary
     char szHostname[UALDS_CONF_MAX_URI_LENGTH];
-    ualds_platform_getfqhostname(szHostname, UALDS_CONF_MAX_URI_LENGTH);
+    ualds_hostname(szHostname, UALDS_CONF_MAX_URI_LENGTH);
     replace_string(szMDNSServerName, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
 
     // get number of Capabilities
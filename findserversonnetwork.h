@@ -31,11 +31,13 @@
 #define __FINDSERVERSONNETWORK_H__
 
 #include <opcua_proxystub.h>
+#include <platform.h>
 
 OpcUa_StatusCode ualds_findserversonnetwork_start_listening(void);
 void ualds_findserversonnetwork_stop_listening(void);
 
-void ualds_findserversonnetwork_socketEventCallback(int *shutdown);
+int ualds_findserversonnetwork_getSockets(UALDS_POLLFD *pFds, int maxFds);
+void ualds_findserversonnetwork_processSocket(const UALDS_POLLFD *pFd);
 
 void ualds_zeroconf_register_offline(const char *szServerUri);
 void ualds_zeroconf_unregister_offline(const char *szServerUri);
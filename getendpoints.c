@@ -46,6 +46,289 @@
 /** TODO: remove this hack */
 extern OpcUa_ByteString g_server_certificate;
 
+/** Prebuilt GetEndpoints result.
+ * The endpoint descriptions only depend on the configuration, the server certificate
+ * and the host name, so they are built once and rebuilt when the host name changes.
+ * All descriptions share one copy of the certificate in \c Certificate.
+ * Requests use shallow copies of \c pEndpoints, so the cache is reference counted
+ * and freed when the last request which uses it has sent its response.
+ */
+struct _ualds_getendpoints_cache
+{
+    int                        refCount;
+    char                       szHostname[50];
+    OpcUa_ByteString           Certificate;
+    OpcUa_Int32                numEndpoints;
+    OpcUa_EndpointDescription *pEndpoints;
+};
+typedef struct _ualds_getendpoints_cache ualds_getendpoints_cache;
+
+static ualds_getendpoints_cache *g_pGetEndpointsCache = OpcUa_Null;
+static OpcUa_Mutex               g_hGetEndpointsCacheMutex = OpcUa_Null;
+static OpcUa_UserTokenPolicy     g_AnonymousTokenPolicy;
+
+/** Returns the SecurityLevel of the given security policy, higher is more secure. */
+static OpcUa_Byte ualds_getendpoints_securitylevel(const OpcUa_String *pSecurityPolicy)
+{
+    const char *szSecurityPolicy = OpcUa_String_GetRawString(pSecurityPolicy);
+
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_Aes256Sha256RsaPss) == 0) return 6;
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_Basic256Sha256) == 0) return 5;
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_Aes128Sha256RsaOaep) == 0) return 4;
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_Basic256) == 0) return 3;
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_Basic128Rsa15) == 0) return 2;
+    if (strcmp(szSecurityPolicy, OpcUa_SecurityPolicy_None) == 0) return 1;
+
+    ualds_log(UALDS_LOG_ERR, "Configured unsupported security policy: %s", szSecurityPolicy);
+    return 0; /* don't use this */
+}
+
+static void ualds_getendpoints_freecache(ualds_getendpoints_cache *pCache)
+{
+    OpcUa_Int32 i;
+
+    for (i = 0; i < pCache->numEndpoints; i++)
+    {
+        /* the certificate and the user token policy are shared */
+        OpcUa_ByteString_Initialize(&pCache->pEndpoints[i].ServerCertificate);
+        pCache->pEndpoints[i].UserIdentityTokens = OpcUa_Null;
+        pCache->pEndpoints[i].NoOfUserIdentityTokens = 0;
+        OpcUa_EndpointDescription_Clear(&pCache->pEndpoints[i]);
+    }
+    OpcUa_Free(pCache->pEndpoints);
+    OpcUa_ByteString_Clear(&pCache->Certificate);
+    OpcUa_Free(pCache);
+}
+
+/** Releases a cache reference returned by ualds_getendpoints_getcache. */
+static void ualds_getendpoints_releasecache(ualds_getendpoints_cache *pCache)
+{
+    int refCount;
+
+    OpcUa_Mutex_Lock(g_hGetEndpointsCacheMutex);
+    refCount = --pCache->refCount;
+    OpcUa_Mutex_Unlock(g_hGetEndpointsCacheMutex);
+
+    if (refCount == 0) ualds_getendpoints_freecache(pCache);
+}
+
+/** Builds the endpoint descriptions for the given host name.
+ * We need one endpoint description for each message mode in each security policy in each real endpoint.
+ * Sounds stupid, but that's how it is defined in the spec.
+ * @return The new cache with a reference count of zero or NULL if out of memory.
+ */
+static ualds_getendpoints_cache* ualds_getendpoints_buildcache(const char *szHostname)
+{
+    ualds_getendpoints_cache  *pCache;
+    OpcUa_EndpointDescription *pDescription;
+    OpcUa_UInt32               numEndpoints;
+    const ualds_endpoint      *pEP = ualds_endpoints(&numEndpoints);
+    const OpcUa_Endpoint_SecurityPolicyConfiguration *pPolicy;
+    char                       szApplicationUri[UALDS_CONF_MAX_URI_LENGTH];
+    char                       szTmpUrl[UALDS_CONF_MAX_URI_LENGTH];
+    int                        numDiscoveryUrls = 0;
+    const char* const         *pszDiscoveryUrls = ualds_discoveryurls(&numDiscoveryUrls);
+    OpcUa_Int32                count = 0;
+    OpcUa_UInt32               i, j, k;
+    OpcUa_UInt16               mode;
+    int                        iDiscoveryUrl;
+
+    pCache = OpcUa_Alloc(sizeof(ualds_getendpoints_cache));
+    if (pCache == OpcUa_Null) return OpcUa_Null;
+    OpcUa_MemSet(pCache, 0, sizeof(ualds_getendpoints_cache));
+    strlcpy(pCache->szHostname, szHostname, sizeof(pCache->szHostname));
+
+    /* counting */
+    for (i = 0; i < numEndpoints; i++)
+    {
+        for (j = 0; j < pEP[i].nNoOfSecurityPolicies; j++)
+        {
+            for (k = 0, mode = 1; k < 3; k++, mode <<= 1)
+            {
+                if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & mode) != 0) count++;
+            }
+        }
+    }
+    if (count == 0) return pCache;
+
+    pCache->pEndpoints = OpcUa_Alloc(sizeof(OpcUa_EndpointDescription) * count);
+    if (pCache->pEndpoints == OpcUa_Null)
+    {
+        OpcUa_Free(pCache);
+        return OpcUa_Null;
+    }
+
+    /* one copy of the certificate for all descriptions */
+    pCache->Certificate.Length = g_server_certificate.Length;
+    if (g_server_certificate.Length > 0)
+    {
+        pCache->Certificate.Data = OpcUa_Alloc(g_server_certificate.Length);
+        if (pCache->Certificate.Data == OpcUa_Null)
+        {
+            OpcUa_Free(pCache->pEndpoints);
+            OpcUa_Free(pCache);
+            return OpcUa_Null;
+        }
+        memcpy(pCache->Certificate.Data, g_server_certificate.Data, g_server_certificate.Length);
+    }
+
+    strlcpy(szApplicationUri, ualds_serveruri(), UALDS_CONF_MAX_URI_LENGTH);
+    replace_string(szApplicationUri, sizeof(szApplicationUri), "[gethostname]", szHostname);
+
+    for (i = 0; i < numEndpoints; i++)
+    {
+        for (j = 0; j < pEP[i].nNoOfSecurityPolicies; j++)
+        {
+            pPolicy = &pEP[i].pSecurityPolicies[j];
+
+            for (k = 0, mode = 1; k < 3; k++, mode <<= 1)
+            {
+                if ((pPolicy->uMessageSecurityModes & mode) == 0) continue;
+
+                pDescription = &pCache->pEndpoints[pCache->numEndpoints++];
+                OpcUa_EndpointDescription_Initialize(pDescription);
+                /* fill endpoint url */
+                OpcUa_String_AttachReadOnly(&pDescription->EndpointUrl, (const OpcUa_StringA)pEP[i].szUrl);
+                /* fill application description */
+                OpcUa_String_AttachReadOnly(&pDescription->Server.ApplicationName.Locale, "en-US");
+                OpcUa_String_AttachReadOnly(&pDescription->Server.ApplicationName.Text, (const OpcUa_StringA)ualds_applicationname("en-US"));
+                OpcUa_String_AttachCopy(&pDescription->Server.ApplicationUri, szApplicationUri);
+                OpcUa_String_AttachReadOnly(&pDescription->Server.ProductUri, (const OpcUa_StringA)ualds_producturi());
+                pDescription->Server.ApplicationType = OpcUa_ApplicationType_DiscoveryServer;
+
+                /* the own DiscoveryUrls are cached on startup, so g_mutex is not needed */
+                if (numDiscoveryUrls > 0)
+                {
+                    pDescription->Server.DiscoveryUrls = OpcUa_Alloc(sizeof(OpcUa_String) * numDiscoveryUrls);
+                    if (pDescription->Server.DiscoveryUrls)
+                    {
+                        pDescription->Server.NoOfDiscoveryUrls = numDiscoveryUrls;
+                        for (iDiscoveryUrl=0; iDiscoveryUrl<numDiscoveryUrls; iDiscoveryUrl++)
+                        {
+                            strlcpy(szTmpUrl, pszDiscoveryUrls[iDiscoveryUrl], UALDS_CONF_MAX_URI_LENGTH);
+                            replace_string(szTmpUrl, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
+                            OpcUa_String_Initialize(&pDescription->Server.DiscoveryUrls[iDiscoveryUrl]);
+                            OpcUa_String_AttachCopy(&pDescription->Server.DiscoveryUrls[iDiscoveryUrl], szTmpUrl);
+                        }
+                    }
+                }
+
+                /* set security policy */
+                OpcUa_String_AttachReadOnly(&pDescription->SecurityPolicyUri, (const OpcUa_StringA)OpcUa_String_GetRawString(&pPolicy->sSecurityPolicy));
+                /* tranport profile uri */
+                OpcUa_String_AttachReadOnly(&pDescription->TransportProfileUri, "http://opcfoundation.org/UA-Profile/Transport/uatcp-uasc-uabinary");
+                /* server certificate, shared by all descriptions */
+                pDescription->ServerCertificate = pCache->Certificate;
+                /* set security level */
+                pDescription->SecurityLevel = ualds_getendpoints_securitylevel(&pPolicy->sSecurityPolicy);
+                /* set security mode */
+                switch (mode)
+                {
+                case OPCUA_ENDPOINT_MESSAGESECURITYMODE_NONE:
+                    pDescription->SecurityMode = OpcUa_MessageSecurityMode_None;
+                    break;
+                case OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGN:
+                    pDescription->SecurityMode = OpcUa_MessageSecurityMode_Sign;
+                    break;
+                case OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGNANDENCRYPT:
+                    pDescription->SecurityMode = OpcUa_MessageSecurityMode_SignAndEncrypt;
+                    break;
+                default:
+                    break;
+                }
+                /* set user tokens, anonymous only */
+                pDescription->NoOfUserIdentityTokens = 1;
+                pDescription->UserIdentityTokens = &g_AnonymousTokenPolicy;
+            }
+        }
+    }
+
+    return pCache;
+}
+
+/** Returns a reference to the prebuilt endpoint descriptions.
+ * The cache is rebuilt if the host name has changed since it was built.
+ * The caller must release the reference using ualds_getendpoints_releasecache.
+ * @return The cache or NULL if out of memory.
+ */
+static ualds_getendpoints_cache* ualds_getendpoints_getcache(const char *szHostname)
+{
+    ualds_getendpoints_cache *pCache;
+    ualds_getendpoints_cache *pOld;
+
+    OpcUa_Mutex_Lock(g_hGetEndpointsCacheMutex);
+    pCache = g_pGetEndpointsCache;
+    if (pCache && strcmp(pCache->szHostname, szHostname) == 0)
+    {
+        pCache->refCount++;
+        OpcUa_Mutex_Unlock(g_hGetEndpointsCacheMutex);
+        return pCache;
+    }
+    OpcUa_Mutex_Unlock(g_hGetEndpointsCacheMutex);
+
+    pCache = ualds_getendpoints_buildcache(szHostname);
+    if (pCache == OpcUa_Null) return OpcUa_Null;
+
+    /* one reference for the global pointer and one for the caller */
+    pCache->refCount = 2;
+    OpcUa_Mutex_Lock(g_hGetEndpointsCacheMutex);
+    pOld = g_pGetEndpointsCache;
+    g_pGetEndpointsCache = pCache;
+    OpcUa_Mutex_Unlock(g_hGetEndpointsCacheMutex);
+
+    if (pOld) ualds_getendpoints_releasecache(pOld);
+
+    return pCache;
+}
+
+/** Creates the lock of the GetEndpoints cache and builds the endpoint descriptions.
+ * This must be called after the endpoints and the server certificate are loaded,
+ * and again after the server certificate has been replaced.
+ */
+OpcUa_StatusCode ualds_getendpoints_initialize(void)
+{
+    ualds_getendpoints_cache *pCache;
+    char szHostname[50];
+    OpcUa_StatusCode uStatus = OpcUa_Good;
+
+    if (g_hGetEndpointsCacheMutex == OpcUa_Null)
+    {
+        uStatus = OpcUa_Mutex_Create(&g_hGetEndpointsCacheMutex);
+        OpcUa_ReturnErrorIfBad(uStatus);
+
+        OpcUa_UserTokenPolicy_Initialize(&g_AnonymousTokenPolicy);
+        g_AnonymousTokenPolicy.TokenType = OpcUa_UserTokenType_Anonymous;
+        OpcUa_String_AttachReadOnly(&g_AnonymousTokenPolicy.PolicyId, "0");
+    }
+
+    /* drop a cache with an old certificate, then build the new one */
+    OpcUa_Mutex_Lock(g_hGetEndpointsCacheMutex);
+    pCache = g_pGetEndpointsCache;
+    g_pGetEndpointsCache = OpcUa_Null;
+    OpcUa_Mutex_Unlock(g_hGetEndpointsCacheMutex);
+    if (pCache) ualds_getendpoints_releasecache(pCache);
+
+    ualds_hostname(szHostname, sizeof(szHostname));
+    pCache = ualds_getendpoints_getcache(szHostname);
+    if (pCache == OpcUa_Null) return OpcUa_BadOutOfMemory;
+    ualds_getendpoints_releasecache(pCache);
+
+    return uStatus;
+}
+
+/** Frees the GetEndpoints cache. */
+void ualds_getendpoints_cleanup(void)
+{
+    if (g_hGetEndpointsCacheMutex == OpcUa_Null) return;
+
+    if (g_pGetEndpointsCache)
+    {
+        ualds_getendpoints_releasecache(g_pGetEndpointsCache);
+        g_pGetEndpointsCache = OpcUa_Null;
+    }
+    OpcUa_Mutex_Delete(&g_hGetEndpointsCacheMutex);
+}
+
 /** GetEndpoints Service implementation.
 * @param hEndpoint OPC UA Endpoint handle.
 * @param hContext  Service context.
@@ -63,22 +346,16 @@ OpcUa_StatusCode ualds_getendpoints(
     OpcUa_GetEndpointsRequest  *pRequest;
     OpcUa_GetEndpointsResponse *pResponse;
     OpcUa_EncodeableType       *pResponseType = 0;
-    OpcUa_UInt32                numEndpoints, numMessageModes;
-    const ualds_endpoint       *pEP = ualds_endpoints(&numEndpoints);
     OpcUa_StatusCode            uStatus = OpcUa_Good;
+    ualds_getendpoints_cache   *pCache;
     char                        szHostname[50];
-    char                        szTmpUrl[UALDS_CONF_MAX_URI_LENGTH];
-    int                         numDiscoveryUrls = 0;
-    int                         iDiscoveryUrl;
-    OpcUa_UInt32 i, j, k, index;
-    OpcUa_UInt16 mode;
 
     UALDS_UNUSED(pRequestType);
 
     OpcUa_ReturnErrorIfArgumentNull(ppRequest);
     pRequest = *ppRequest;
 
-    ualds_platform_getfqhostname(szHostname, 50);
+    ualds_hostname(szHostname, sizeof(szHostname));
 
     uStatus = OpcUa_Endpoint_BeginSendResponse(
         hEndpoint,
@@ -89,166 +366,25 @@ OpcUa_StatusCode ualds_getendpoints(
 
     if ( pResponse )
     {
-        pResponse->NoOfEndpoints = 0;
-        /* counting: we need one endpoint description for each mesage mode in each security policy in each real endpoint.
-         * sounds stupid, but that's how it is defiend in the spec.
-         */
-        for (i=0; i<numEndpoints; i++)
+        /* the EndpointUrl filter is not applied, all endpoints are returned */
+        pCache = ualds_getendpoints_getcache(szHostname);
+        if (pCache == 0)
         {
-            /* filter URL */
-            /*if (strcmp(pEP[i].szUrl, OpcUa_String_GetRawString(&pRequest->EndpointUrl)) != 0)
-            {
-                ualds_log(UALDS_LOG_DEBUG, "Filtering endpoint url '%s', client requestet '%s'",
-                          pEP[i].szUrl,
-                          OpcUa_String_GetRawString(&pRequest->EndpointUrl));
-                continue;
-            }*/
-
-            /* iterate of all security policies */
-            for (j=0; j<pEP[i].nNoOfSecurityPolicies; j++)
-            {
-                /* count number of message modes */
-                numMessageModes = 0;
-                if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_NONE) != 0) numMessageModes++;
-                if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGN) != 0) numMessageModes++;
-                if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGNANDENCRYPT) != 0) numMessageModes++;
-                pResponse->NoOfEndpoints += numMessageModes;
-            }
+            uStatus = OpcUa_BadOutOfMemory;
         }
-        /* now allocate the array and fill it */
-        pResponse->Endpoints = OpcUa_Alloc(sizeof(OpcUa_EndpointDescription) * pResponse->NoOfEndpoints);
-        if (pResponse->Endpoints)
+        else if (pCache->numEndpoints > 0)
         {
-            index = 0;
-            for (i=0; i<numEndpoints; i++)
+            pResponse->Endpoints = OpcUa_Alloc(sizeof(OpcUa_EndpointDescription) * pCache->numEndpoints);
+            if (pResponse->Endpoints)
             {
-                /* filter URL */
-                /*if (strcmp(pEP[i].szUrl, OpcUa_String_GetRawString(&pRequest->EndpointUrl)) != 0) continue;*/
-
-                for (j=0; j<pEP[i].nNoOfSecurityPolicies; j++)
-                {
-                    /* count number of message modes */
-                    numMessageModes = 0;
-                    if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_NONE) != 0) numMessageModes++;
-                    if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGN) != 0) numMessageModes++;
-                    if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGNANDENCRYPT) != 0) numMessageModes++;
-
-                    for (k=0, mode=1; k<3; k++, mode<<=1)
-                    {
-                        char szApplicationUri[UALDS_CONF_MAX_URI_LENGTH];
-
-                        if ((pEP[i].pSecurityPolicies[j].uMessageSecurityModes & mode) == 0) continue;
-
-                        OpcUa_EndpointDescription_Initialize(&pResponse->Endpoints[index]);
-                        /* fill endpoint url */
-                        OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].EndpointUrl, (const OpcUa_StringA)pEP[i].szUrl);
-                        /* fill application description */
-                        OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].Server.ApplicationName.Locale, "en-US");
-                        OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].Server.ApplicationName.Text, (const OpcUa_StringA)ualds_applicationname("en-US"));
-                        strlcpy(szApplicationUri, ualds_serveruri(), UALDS_CONF_MAX_URI_LENGTH);
-                        replace_string(szApplicationUri, sizeof(szApplicationUri), "[gethostname]", szHostname);
-                        OpcUa_String_AttachCopy(&pResponse->Endpoints[index].Server.ApplicationUri, szApplicationUri);
-                        OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].Server.ProductUri, (const OpcUa_StringA)ualds_producturi());
-                        pResponse->Endpoints[index].Server.ApplicationType = OpcUa_ApplicationType_DiscoveryServer;
-
-						OpcUa_Mutex_Lock(g_mutex);
-
-                        ualds_settings_begingroup(ualds_serveruri());
-                        ualds_settings_beginreadarray("DiscoveryUrls", &numDiscoveryUrls);
-                        if (numDiscoveryUrls > 0)
-                        {
-                            pResponse->Endpoints[index].Server.NoOfDiscoveryUrls = numDiscoveryUrls;
-                            pResponse->Endpoints[index].Server.DiscoveryUrls = OpcUa_Alloc(sizeof(OpcUa_String) * numDiscoveryUrls);
-                            if (pResponse->Endpoints[index].Server.DiscoveryUrls)
-                            {
-                                for (iDiscoveryUrl=0; iDiscoveryUrl<numDiscoveryUrls; iDiscoveryUrl++)
-                                {
-                                    ualds_settings_setarrayindex(iDiscoveryUrl);
-                                    ualds_settings_readstring("Url", szTmpUrl, UALDS_CONF_MAX_URI_LENGTH);
-                                    replace_string(szTmpUrl, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", szHostname);
-                                    OpcUa_String_Initialize(&pResponse->Endpoints[index].Server.DiscoveryUrls[iDiscoveryUrl]);
-                                    OpcUa_String_AttachCopy(&pResponse->Endpoints[index].Server.DiscoveryUrls[iDiscoveryUrl], szTmpUrl);
-                                }
-                            }
-                        }
-                        ualds_settings_endarray();
-                        ualds_settings_endgroup();
-
-						OpcUa_Mutex_Unlock(g_mutex);
-
-                        /* set security policy */
-                        OpcUa_String_StrnCpy(&pResponse->Endpoints[index].SecurityPolicyUri, &pEP[i].pSecurityPolicies[j].sSecurityPolicy, OPCUA_STRING_LENDONTCARE);
-                        /* tranport profile uri */
-                        OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].TransportProfileUri, "http://opcfoundation.org/UA-Profile/Transport/uatcp-uasc-uabinary");
-                        /* fill server certificate */
-                        pResponse->Endpoints[index].ServerCertificate.Length = g_server_certificate.Length;
-                        if (g_server_certificate.Length >= 0)
-                        {
-                            pResponse->Endpoints[index].ServerCertificate.Data = OpcUa_Memory_Alloc(g_server_certificate.Length);
-                            memcpy(pResponse->Endpoints[index].ServerCertificate.Data, g_server_certificate.Data, g_server_certificate.Length);
-                        }
-                        /* set security level */
-						if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_Aes256Sha256RsaPss) == 0)
-						{
-							pResponse->Endpoints[index].SecurityLevel = 6;
-						}
-						else if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_Basic256Sha256) == 0)
-						{
-							pResponse->Endpoints[index].SecurityLevel = 5;
-						}
-						else if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_Aes128Sha256RsaOaep) == 0)
-						{
-							pResponse->Endpoints[index].SecurityLevel = 4;
-						}
-                        else if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_Basic256) == 0)
-                        {
-                            pResponse->Endpoints[index].SecurityLevel = 3;
-                        }
-                        else if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_Basic128Rsa15) == 0)
-                        {
-                            pResponse->Endpoints[index].SecurityLevel = 2;
-                        }
-                        else if (strcmp(OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy), OpcUa_SecurityPolicy_None) == 0)
-                        {
-                            pResponse->Endpoints[index].SecurityLevel = 1;
-                        }
-                        else
-                        {
-                            pResponse->Endpoints[index].SecurityLevel = 0; /* don't use this */
-                            ualds_log(UALDS_LOG_ERR, "Configured unsupported security policy: %s", OpcUa_String_GetRawString(&pEP[i].pSecurityPolicies[j].sSecurityPolicy));
-                        }
-                        /* set security mode */
-                        switch (pEP[i].pSecurityPolicies[j].uMessageSecurityModes & mode)
-                        {
-                        case OPCUA_ENDPOINT_MESSAGESECURITYMODE_NONE:
-                            pResponse->Endpoints[index].SecurityMode = OpcUa_MessageSecurityMode_None;
-                            break;
-                        case OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGN:
-                            pResponse->Endpoints[index].SecurityMode = OpcUa_MessageSecurityMode_Sign;
-                            break;
-                        case OPCUA_ENDPOINT_MESSAGESECURITYMODE_SIGNANDENCRYPT:
-                            pResponse->Endpoints[index].SecurityMode = OpcUa_MessageSecurityMode_SignAndEncrypt;
-                            break;
-                        default:
-                            break;
-                        }
-                        /* set user tokens */
-                        pResponse->Endpoints[index].NoOfUserIdentityTokens = 1;
-                        pResponse->Endpoints[index].UserIdentityTokens = OpcUa_Alloc(sizeof(OpcUa_UserTokenPolicy));
-                        if (pResponse->Endpoints[index].UserIdentityTokens)
-                        {
-                            OpcUa_UserTokenPolicy_Initialize(&pResponse->Endpoints[index].UserIdentityTokens[0]);
-                            pResponse->Endpoints[index].UserIdentityTokens[0].TokenType = OpcUa_UserTokenType_Anonymous;
-                            OpcUa_String_AttachReadOnly(&pResponse->Endpoints[index].UserIdentityTokens[0].PolicyId, "0");
-                        }
-                        index++;
-                    }
-                }
+                OpcUa_MemCpy(pResponse->Endpoints, sizeof(OpcUa_EndpointDescription) * pCache->numEndpoints,
+                             pCache->pEndpoints, sizeof(OpcUa_EndpointDescription) * pCache->numEndpoints);
+                pResponse->NoOfEndpoints = pCache->numEndpoints;
+            }
+            else
+            {
+                uStatus = OpcUa_BadOutOfMemory;
             }
-        }
-        else
-        {
-            uStatus = OpcUa_BadOutOfMemory;
         }
 
         UALDS_BUILDRESPONSEHEADER;
@@ -261,7 +397,11 @@ OpcUa_StatusCode ualds_getendpoints(
             pResponse,
             pResponseType);
 
-        /* free response */
+        /* free response, the descriptions are owned by the cache */
+        OpcUa_Free(pResponse->Endpoints);
+        pResponse->Endpoints = OpcUa_Null;
+        pResponse->NoOfEndpoints = 0;
+        if (pCache) ualds_getendpoints_releasecache(pCache);
         OpcUa_GetEndpointsResponse_Clear(pResponse);
         OpcUa_Free(pResponse);
 
@@ -0,0 +1,619 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/**
+ * \addtogroup journal Registration Journal
+ * @{
+ *
+ *  The registration journal is an optional append-only log of all changes of the
+ *  registered servers. Each registration, unregistration and expiration appends one
+ *  line to \<configfile\>.journal, so the settings file does not need to be rewritten
+ *  on each RegisterServer call.
+ *
+ *  At startup the journal is replayed on top of the settings file. When the journal
+ *  exceeds its maximum size, the settings are written as a new snapshot and the journal
+ *  is moved to \<configfile\>.journal.bak. So the journal backup always contains the
+ *  changes between the settings backup file and the settings file. If the settings
+ *  had to be restored from the backup file, the journal backup is replayed first.
+ *
+ *  Each record is one line, the fields are separated by tab characters. Tab, newline,
+ *  carriage return and backslash characters in values are escaped using a backslash.
+ *  \code
+ *  R <UpdateTime> <bMdns> <ServerUri> <ProductUri> <ServerType> <GatewayServerUri>
+ *    <SemaphoreFilePath> <MdnsServerName> <n> {<Locale> <Text>} <n> {<DiscoveryUrl>}
+ *    <n> {<Capability>}
+ *  D <Time> <ServerUri>
+ *  \endcode
+ *  Records which cannot be parsed, like an incomplete last line after a crash, are skipped.
+ *
+ *  \b Note that this module is not thread-safe. The caller must hold g_mutex.
+ */
+
+/* system includes */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+/* local includes */
+#include "config.h"
+#include "settings.h"
+#include "registry.h"
+#include "journal.h"
+/* local platform includes */
+#include <platform.h>
+#include <log.h>
+
+/** Upper limit for array sizes in a record, protects against corrupt files. */
+#define JOURNAL_MAX_ARRAY_SIZE 10000
+
+struct _ualds_journal
+{
+    char       *szPath;
+    char       *szPathBackup;
+    UALDS_FILE *fp;
+    long        size;
+    long        maxSize;
+    int         bFailed; /**< an append failed, the journal must be compacted */
+};
+typedef struct _ualds_journal ualds_journal;
+
+/** Growable buffer for one record. */
+struct _ualds_journal_line
+{
+    char   *pData;
+    size_t  len;
+    size_t  capacity;
+    int     bFailed;
+};
+typedef struct _ualds_journal_line ualds_journal_line;
+
+static ualds_journal g_journal;
+
+static void ualds_journal_reserve(ualds_journal_line *pLine, size_t len)
+{
+    size_t capacity;
+    char *pData;
+
+    if (pLine->bFailed || pLine->len + len <= pLine->capacity) return;
+
+    capacity = pLine->capacity ? pLine->capacity : 256;
+    while (capacity < pLine->len + len) capacity *= 2;
+
+    pData = realloc(pLine->pData, capacity);
+    if (pData == 0)
+    {
+        pLine->bFailed = 1;
+        return;
+    }
+    pLine->pData = pData;
+    pLine->capacity = capacity;
+}
+
+/** Appends the escaped value \c szValue as new field to the record. */
+static void ualds_journal_addfield(ualds_journal_line *pLine, const char *szValue)
+{
+    const char *pSrc;
+    char *pDst;
+
+    if (szValue == 0) szValue = "";
+
+    /* worst case: separator and each character escaped */
+    ualds_journal_reserve(pLine, 2 * strlen(szValue) + 1);
+    if (pLine->bFailed) return;
+
+    pDst = pLine->pData + pLine->len;
+    if (pLine->len > 0) *pDst++ = '\t';
+    for (pSrc = szValue; *pSrc; pSrc++)
+    {
+        switch (*pSrc)
+        {
+        case '\\': *pDst++ = '\\'; *pDst++ = '\\'; break;
+        case '\t': *pDst++ = '\\'; *pDst++ = 't'; break;
+        case '\n': *pDst++ = '\\'; *pDst++ = 'n'; break;
+        case '\r': *pDst++ = '\\'; *pDst++ = 'r'; break;
+        default: *pDst++ = *pSrc; break;
+        }
+    }
+    pLine->len = pDst - pLine->pData;
+}
+
+static void ualds_journal_addint(ualds_journal_line *pLine, int value)
+{
+    char szValue[20];
+
+    snprintf(szValue, sizeof(szValue), "%i", value);
+    ualds_journal_addfield(pLine, szValue);
+}
+
+static void ualds_journal_addtime(ualds_journal_line *pLine, time_t value)
+{
+    char szValue[24];
+
+    snprintf(szValue, sizeof(szValue), "%"PRITT, (TTINTTYPE)value);
+    ualds_journal_addfield(pLine, szValue);
+}
+
+/** Terminates the record, appends it to the journal file and frees the record buffer. */
+static void ualds_journal_append(ualds_journal_line *pLine)
+{
+    size_t written;
+
+    ualds_journal_reserve(pLine, 1);
+    if (pLine->bFailed)
+    {
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        g_journal.bFailed = 1;
+    }
+    else
+    {
+        pLine->pData[pLine->len++] = '\n';
+        written = ualds_platform_fwrite(pLine->pData, 1, pLine->len, g_journal.fp);
+        if (written == pLine->len && ualds_platform_fsync(g_journal.fp) == 0)
+        {
+            g_journal.size += (long)written;
+        }
+        else
+        {
+            ualds_log(UALDS_LOG_ERR, "Failed to write registration journal '%s'.", g_journal.szPath);
+            g_journal.bFailed = 1;
+        }
+    }
+
+    free(pLine->pData);
+}
+
+/** Returns the next field of a record and unescapes it in place.
+ * @return The field or NULL if the record has no more fields.
+ */
+static char* ualds_journal_nextfield(char **ppCursor)
+{
+    char *szField = *ppCursor;
+    char *pSrc;
+    char *pDst;
+
+    if (szField == 0) return 0;
+
+    for (pSrc = pDst = szField; *pSrc != 0 && *pSrc != '\t'; pSrc++)
+    {
+        if (*pSrc == '\\' && pSrc[1] != 0)
+        {
+            pSrc++;
+            switch (*pSrc)
+            {
+            case 't': *pDst++ = '\t'; break;
+            case 'n': *pDst++ = '\n'; break;
+            case 'r': *pDst++ = '\r'; break;
+            default: *pDst++ = *pSrc; break;
+            }
+        }
+        else
+        {
+            *pDst++ = *pSrc;
+        }
+    }
+    *ppCursor = (*pSrc == '\t') ? pSrc + 1 : 0;
+    *pDst = 0;
+
+    return szField;
+}
+
+static int ualds_journal_nextstring(char **ppCursor, char **pszValue)
+{
+    char *szField = ualds_journal_nextfield(ppCursor);
+
+    if (szField == 0) return EINVAL;
+    *pszValue = strdup(szField);
+
+    return *pszValue ? 0 : ENOMEM;
+}
+
+static int ualds_journal_nextint(char **ppCursor, int *pValue, int minValue, int maxValue)
+{
+    char *szField = ualds_journal_nextfield(ppCursor);
+    char *pEnd;
+    long value;
+
+    if (szField == 0 || *szField == 0) return EINVAL;
+    value = strtol(szField, &pEnd, 10);
+    if (*pEnd != 0 || value < minValue || value > maxValue) return EINVAL;
+    *pValue = (int)value;
+
+    return 0;
+}
+
+/** Parses and applies a register record. */
+static int ualds_journal_replayregister(char *pCursor)
+{
+    ualds_registeredserver *pRecord;
+    char *szField;
+    int bMdns = 0;
+    int num = 0;
+    int i;
+    int ret;
+
+    pRecord = calloc(1, sizeof(ualds_registeredserver));
+    if (pRecord == 0) return ENOMEM;
+
+    szField = ualds_journal_nextfield(&pCursor);
+    if (szField == 0 || *szField == 0)
+    {
+        ualds_registry_freeserver(pRecord);
+        return EINVAL;
+    }
+    pRecord->UpdateTime = (time_t)strtol(szField, 0, 10);
+
+    ret = ualds_journal_nextint(&pCursor, &bMdns, 0, 1);
+    if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->szServerUri);
+    if (ret == 0 && pRecord->szServerUri[0] == 0) ret = EINVAL;
+    if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->szProductUri);
+    if (ret == 0) ret = ualds_journal_nextint(&pCursor, &pRecord->ServerType, 0, 3);
+    if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->szGatewayServerUri);
+    if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->szSemaphoreFilePath);
+    if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->szMdnsServerName);
+
+    /* ServerNames */
+    if (ret == 0) ret = ualds_journal_nextint(&pCursor, &num, 0, JOURNAL_MAX_ARRAY_SIZE);
+    if (ret == 0 && num > 0)
+    {
+        pRecord->pServerNames = calloc(num, sizeof(ualds_localizedtext));
+        if (pRecord->pServerNames == 0) ret = ENOMEM;
+        else pRecord->nNoOfServerNames = num;
+    }
+    for (i = 0; ret == 0 && i < pRecord->nNoOfServerNames; i++)
+    {
+        ret = ualds_journal_nextstring(&pCursor, &pRecord->pServerNames[i].szLocale);
+        if (ret == 0) ret = ualds_journal_nextstring(&pCursor, &pRecord->pServerNames[i].szText);
+    }
+
+    /* DiscoveryUrls */
+    if (ret == 0) ret = ualds_journal_nextint(&pCursor, &num, 0, JOURNAL_MAX_ARRAY_SIZE);
+    if (ret == 0 && num > 0)
+    {
+        pRecord->pszDiscoveryUrls = calloc(num, sizeof(char*));
+        if (pRecord->pszDiscoveryUrls == 0) ret = ENOMEM;
+        else pRecord->nNoOfDiscoveryUrls = num;
+    }
+    for (i = 0; ret == 0 && i < pRecord->nNoOfDiscoveryUrls; i++)
+    {
+        ret = ualds_journal_nextstring(&pCursor, &pRecord->pszDiscoveryUrls[i]);
+    }
+
+    /* ServerCapabilities */
+    if (ret == 0) ret = ualds_journal_nextint(&pCursor, &num, 0, JOURNAL_MAX_ARRAY_SIZE);
+    if (ret == 0 && num > 0)
+    {
+        pRecord->pszServerCapabilities = calloc(num, sizeof(char*));
+        if (pRecord->pszServerCapabilities == 0) ret = ENOMEM;
+        else pRecord->nNoOfServerCapabilities = num;
+    }
+    for (i = 0; ret == 0 && i < pRecord->nNoOfServerCapabilities; i++)
+    {
+        ret = ualds_journal_nextstring(&pCursor, &pRecord->pszServerCapabilities[i]);
+    }
+
+    if (ret == 0 && pCursor != 0) ret = EINVAL; /* unexpected trailing fields */
+    if (ret != 0)
+    {
+        ualds_registry_freeserver(pRecord);
+        return ret;
+    }
+
+    /* the registry takes ownership of the record */
+    return ualds_registry_restore(pRecord, bMdns);
+}
+
+/** Parses and applies a remove record. */
+static int ualds_journal_replayremove(char *pCursor)
+{
+    char *szServerUri;
+
+    /* the time is only informational */
+    if (ualds_journal_nextfield(&pCursor) == 0) return EINVAL;
+    szServerUri = ualds_journal_nextfield(&pCursor);
+    if (szServerUri == 0 || *szServerUri == 0 || pCursor != 0) return EINVAL;
+
+    ualds_registry_remove(szServerUri);
+
+    return 0;
+}
+
+/** Applies all records of the journal file \c szPath.
+ * @return The number of applied records.
+ */
+static int ualds_journal_replayfile(const char *szPath)
+{
+    UALDS_FILE *f;
+    char *pData;
+    char *pLine;
+    char *pEnd;
+    char *szType;
+    long len;
+    int numRecords = 0;
+    int numInvalid = 0;
+    int ret;
+
+    f = ualds_platform_fopen(szPath, "rb");
+    if (f == 0) return 0;
+
+    if (fseek(f, 0, SEEK_END) != 0 || (len = ftell(f)) < 0 || fseek(f, 0, SEEK_SET) != 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Failed to read registration journal '%s'.", szPath);
+        ualds_platform_fclose(f);
+        return 0;
+    }
+
+    pData = malloc(len + 1);
+    if (pData == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        ualds_platform_fclose(f);
+        return 0;
+    }
+    len = (long)ualds_platform_fread(pData, 1, len, f);
+    ualds_platform_fclose(f);
+    pData[len] = 0;
+
+    for (pLine = pData; pLine < pData + len; pLine = pEnd + 1)
+    {
+        pEnd = strchr(pLine, '\n');
+        if (pEnd == 0)
+        {
+            /* incomplete last record */
+            numInvalid++;
+            break;
+        }
+        *pEnd = 0;
+        if (pEnd > pLine && pEnd[-1] == '\r') pEnd[-1] = 0;
+
+        szType = ualds_journal_nextfield(&pLine);
+        if (strcmp(szType, "R") == 0)
+        {
+            ret = ualds_journal_replayregister(pLine);
+        }
+        else if (strcmp(szType, "D") == 0)
+        {
+            ret = ualds_journal_replayremove(pLine);
+        }
+        else
+        {
+            ret = EINVAL;
+        }
+
+        if (ret == 0)
+        {
+            numRecords++;
+        }
+        else if (ret == ENOMEM)
+        {
+            ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+            break;
+        }
+        else
+        {
+            numInvalid++;
+        }
+    }
+
+    free(pData);
+
+    if (numInvalid > 0)
+    {
+        ualds_log(UALDS_LOG_WARNING, "Skipped %i invalid records of registration journal '%s'.", numInvalid, szPath);
+    }
+    ualds_log(UALDS_LOG_INFO, "Replayed %i records of registration journal '%s'.", numRecords, szPath);
+
+    return numRecords;
+}
+
+static char* ualds_journal_makepath(const char *szConfigFile, const char *szSuffix)
+{
+    size_t len = strlen(szConfigFile) + strlen(szSuffix) + 1;
+    char *szPath = malloc(len);
+
+    if (szPath)
+    {
+        strlcpy(szPath, szConfigFile, len);
+        strlcat(szPath, szSuffix, len);
+    }
+
+    return szPath;
+}
+
+/** Opens the registration journal of \c szConfigFile and replays its content.
+ * The registry must be loaded before.
+ * @param szConfigFile Path of the settings file.
+ * @param maxSize Journal size in bytes which triggers a compaction.
+ * @param bReplayBackup Set if the settings were restored from the backup file,
+ *   then the journal backup is replayed first.
+ * @return Zero on success.
+ */
+int ualds_journal_open(const char *szConfigFile, long maxSize, int bReplayBackup)
+{
+    int numRecords = 0;
+
+    if (g_journal.fp) return EEXIST;
+
+    g_journal.szPath = ualds_journal_makepath(szConfigFile, ".journal");
+    g_journal.szPathBackup = ualds_journal_makepath(szConfigFile, ".journal.bak");
+    if (g_journal.szPath == 0 || g_journal.szPathBackup == 0)
+    {
+        ualds_journal_close();
+        return ENOMEM;
+    }
+    g_journal.maxSize = maxSize;
+    g_journal.bFailed = 0;
+
+    /* the journal is not open while replaying, so nothing is journaled again */
+    if (bReplayBackup)
+    {
+        numRecords += ualds_journal_replayfile(g_journal.szPathBackup);
+    }
+    numRecords += ualds_journal_replayfile(g_journal.szPath);
+    if (numRecords > 0)
+    {
+        /* removed entries are not yet removed from the persisted server list */
+        ualds_registry_writeserverlist();
+    }
+
+    g_journal.fp = ualds_platform_fopen(g_journal.szPath, "a+b");
+    if (g_journal.fp == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Failed to open registration journal '%s'.", g_journal.szPath);
+        ualds_journal_close();
+        return EIO;
+    }
+    fseek(g_journal.fp, 0, SEEK_END);
+    g_journal.size = ftell(g_journal.fp);
+
+    /* terminate an incomplete last record, so it does not corrupt the next one */
+    if (g_journal.size > 0 && fseek(g_journal.fp, -1, SEEK_END) == 0 && fgetc(g_journal.fp) != '\n')
+    {
+        fseek(g_journal.fp, 0, SEEK_END);
+        fputc('\n', g_journal.fp);
+        g_journal.size++;
+    }
+
+    return 0;
+}
+
+/** Closes the registration journal. This does not write a snapshot. */
+void ualds_journal_close(void)
+{
+    if (g_journal.fp)
+    {
+        ualds_platform_fclose(g_journal.fp);
+    }
+    free(g_journal.szPath);
+    free(g_journal.szPathBackup);
+    memset(&g_journal, 0, sizeof(g_journal));
+}
+
+/** Returns 1 if the registration journal is open. */
+int ualds_journal_isopen(void)
+{
+    return g_journal.fp != 0;
+}
+
+/** Appends a register record for \c pServer. Does nothing if the journal is not open. */
+void ualds_journal_register(const ualds_registeredserver *pServer, int bMdns)
+{
+    ualds_journal_line line;
+    int i;
+
+    if (g_journal.fp == 0 || g_journal.bFailed) return;
+
+    memset(&line, 0, sizeof(line));
+    ualds_journal_addfield(&line, "R");
+    ualds_journal_addtime(&line, pServer->UpdateTime);
+    ualds_journal_addint(&line, bMdns ? 1 : 0);
+    ualds_journal_addfield(&line, pServer->szServerUri);
+    ualds_journal_addfield(&line, pServer->szProductUri);
+    ualds_journal_addint(&line, pServer->ServerType);
+    ualds_journal_addfield(&line, pServer->szGatewayServerUri);
+    ualds_journal_addfield(&line, pServer->szSemaphoreFilePath);
+    ualds_journal_addfield(&line, pServer->szMdnsServerName);
+    ualds_journal_addint(&line, pServer->nNoOfServerNames);
+    for (i = 0; i < pServer->nNoOfServerNames; i++)
+    {
+        ualds_journal_addfield(&line, pServer->pServerNames[i].szLocale);
+        ualds_journal_addfield(&line, pServer->pServerNames[i].szText);
+    }
+    ualds_journal_addint(&line, pServer->nNoOfDiscoveryUrls);
+    for (i = 0; i < pServer->nNoOfDiscoveryUrls; i++)
+    {
+        ualds_journal_addfield(&line, pServer->pszDiscoveryUrls[i]);
+    }
+    ualds_journal_addint(&line, pServer->nNoOfServerCapabilities);
+    for (i = 0; i < pServer->nNoOfServerCapabilities; i++)
+    {
+        ualds_journal_addfield(&line, pServer->pszServerCapabilities[i]);
+    }
+
+    ualds_journal_append(&line);
+}
+
+/** Appends a remove record for \c szServerUri. Does nothing if the journal is not open. */
+void ualds_journal_remove(const char *szServerUri)
+{
+    ualds_journal_line line;
+
+    if (g_journal.fp == 0 || g_journal.bFailed) return;
+
+    memset(&line, 0, sizeof(line));
+    ualds_journal_addfield(&line, "D");
+    ualds_journal_addtime(&line, time(0));
+    ualds_journal_addfield(&line, szServerUri);
+
+    ualds_journal_append(&line);
+}
+
+/** Returns 1 if the journal exceeds its maximum size or a write has failed. */
+int ualds_journal_needscompaction(void)
+{
+    if (g_journal.fp == 0) return 0;
+
+    return g_journal.bFailed || g_journal.size >= g_journal.maxSize;
+}
+
+/** Writes the settings as new snapshot and starts a new journal.
+ * The current journal is kept as backup, matching the settings backup file.
+ * If the journal cannot be reopened it is closed, so the caller falls back to
+ * writing the settings file directly.
+ * @return Zero if the snapshot was written.
+ */
+int ualds_journal_compact(void)
+{
+    int ret = ualds_settings_flush();
+
+    if (ret != 0 || g_journal.fp == 0) return ret;
+
+    ualds_platform_fclose(g_journal.fp);
+    g_journal.fp = 0;
+
+    if (ualds_platform_replacefile(g_journal.szPathBackup, g_journal.szPath, 0) != 0)
+    {
+        ualds_log(UALDS_LOG_WARNING, "Could not create journal backup file '%s'.", g_journal.szPathBackup);
+    }
+
+    g_journal.fp = ualds_platform_fopen(g_journal.szPath, "wb");
+    if (g_journal.fp == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Failed to open registration journal '%s', registration journal disabled.", g_journal.szPath);
+        ualds_journal_close();
+        return 0;
+    }
+    g_journal.size = 0;
+    g_journal.bFailed = 0;
+
+    return 0;
+}
+
+/**
+ * @}
+ */
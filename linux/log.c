@@ -32,6 +32,8 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <time.h>
+#include <semaphore.h>
+#include <sys/uio.h>
 #ifdef HAVE_OPCUA_STACK
 /* uastack includes */
 #include <opcua_platformdefs.h>
@@ -45,6 +47,17 @@
 #include "../settings.h"
 #include "log.h"
 
+/** maximum number of queued lines written with one writev call */
+#define UALDS_LOG_ASYNC_BATCH 64
+
+/** one entry of the async log queue */
+typedef struct _LogSlot
+{
+    unsigned int seq; /**< sequence number; tells producers and the writer who owns the slot */
+    unsigned int len;
+    char         line[UALDS_CONF_LOG_ASYNC_LINE_LENGTH];
+} LogSlot;
+
 /** internal logger state */
 static int       g_max_size = 100*1024*1024; // 100 MB default value, equivalent in bytes
 static int       g_logger_state = 0; /* 0=closed, 1=open */
@@ -52,11 +65,333 @@ static LogTarget g_target = UALDS_LOG_SYSLOG;
 static LogLevel  g_level = UALDS_LOG_EMERG;
 static FILE     *g_f = 0;
 static char     szLogfile[PATH_MAX];
+static long      g_file_size = 0;
+static pid_t     g_pid = 0;
+/** serializes writing and rotating in sync mode */
+static pthread_mutex_t g_file_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** async mode: producers format into a per-thread buffer and push the line into a
+ * bounded lock-free MPSC queue; a writer thread drains it with writev and rotates the file. */
+static int          g_async = 0;
+static int          g_async_running = 0;
+static int          g_atfork_registered = 0;
+static LogSlot     *g_ring = 0;
+static unsigned int g_ring_mask = 0;
+static unsigned int g_ring_head = 0; /* next slot to claim; shared by all producers */
+static unsigned int g_ring_tail = 0; /* next slot to write; owned by the writer */
+static unsigned int g_dropped = 0;   /* lines lost because the queue was full */
+static unsigned int g_dropped_reported = 0;
+static time_t       g_dropped_report_time = 0;
+static int          g_writer_wakeup = 0; /* a wakeup of the writer is pending */
+static int          g_writer_stop = 0;
+static sem_t        g_writer_sem;
+static pthread_t    g_writer;
+
+static __thread char   t_line[UALDS_CONF_LOG_ASYNC_LINE_LENGTH];
+static __thread time_t t_stamp_time = (time_t)-1;
+static __thread char   t_stamp[32];
+
+/** Returns the "Tue Nov 27 12:22:42" timestamp of the current second, formatted once per thread and second. */
+static const char* ualds_log_timestamp(void)
+{
+    time_t now = time(0);
+    struct tm tm_now;
+
+    if (now != t_stamp_time)
+    {
+        localtime_r(&now, &tm_now);
+        strftime(t_stamp, sizeof(t_stamp), "%a %b %e %H:%M:%S", &tm_now);
+        t_stamp_time = now;
+    }
+
+    return t_stamp;
+}
+
+/** Renames the full log file to a timestamped backup and starts a new one. */
+static void ualds_log_rotate(void)
+{
+    char szLogfile_backup[PATH_MAX];
+    time_t rawtime;
+    struct tm timeinfo;
+    char time_str[80];
+
+    fclose(g_f);
+
+    strlcpy(szLogfile_backup, szLogfile, PATH_MAX);
+
+    // get current time in string format
+    time(&rawtime);
+    localtime_r(&rawtime, &timeinfo);
+    strftime(time_str, 80, "%Y-%m-%d_%H-%M-%S", &timeinfo);
+
+    strlcat(szLogfile_backup, "_", PATH_MAX);
+    strlcat(szLogfile_backup, time_str, PATH_MAX);
+    strlcat(szLogfile_backup, ".log", PATH_MAX);
+
+    // rename file
+    ualds_platform_rename(szLogfile, szLogfile_backup);
+
+    // open log file
+    g_f = fopen(szLogfile, "a");
+    if (g_f == 0)
+    {
+        /* nowhere left to log to */
+        g_f = stderr;
+    }
+    g_file_size = 0;
+}
+
+/** Writes all iovecs, continuing after partial writes. */
+static void ualds_log_writev(struct iovec *iov, int iovcnt)
+{
+    ssize_t written;
+
+    while (iovcnt > 0)
+    {
+        written = writev(fileno(g_f), iov, iovcnt);
+        if (written < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+        g_file_size += written;
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+/** Writes up to UALDS_LOG_ASYNC_BATCH queued lines and returns their number. */
+static int ualds_log_write_batch(void)
+{
+    struct iovec iov[UALDS_LOG_ASYNC_BATCH];
+    unsigned int tail = g_ring_tail;
+    LogSlot *pSlot;
+    int i, n = 0;
+
+    while (n < UALDS_LOG_ASYNC_BATCH)
+    {
+        pSlot = &g_ring[(tail + n) & g_ring_mask];
+        if (__atomic_load_n(&pSlot->seq, __ATOMIC_ACQUIRE) != tail + n + 1) break;
+        iov[n].iov_base = pSlot->line;
+        iov[n].iov_len = pSlot->len;
+        n++;
+    }
+    if (n == 0) return 0;
+
+    ualds_log_writev(iov, n);
+
+    /* hand the slots back to the producers */
+    for (i = 0; i < n; i++)
+    {
+        pSlot = &g_ring[(tail + i) & g_ring_mask];
+        __atomic_store_n(&pSlot->seq, tail + i + g_ring_mask + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&g_ring_tail, tail + n, __ATOMIC_RELAXED);
+
+    if (g_target == UALDS_LOG_FILE && g_file_size >= g_max_size)
+    {
+        ualds_log_rotate();
+    }
+
+    return n;
+}
+
+/** Tells the operator in the log itself that lines were dropped. */
+static void ualds_log_report_dropped(void)
+{
+    unsigned int dropped = __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+    time_t now = time(0);
+    struct iovec iov;
+    char szLine[128];
+
+    if (dropped == g_dropped_reported) return;
+    /* at most one report per second, but always before the writer stops */
+    if (now == g_dropped_report_time && !__atomic_load_n(&g_writer_stop, __ATOMIC_ACQUIRE)) return;
+    g_dropped_report_time = now;
+
+    iov.iov_base = szLine;
+    iov.iov_len = snprintf(szLine, sizeof(szLine), "%s [%i]: Log queue full, %u messages dropped (%u in total).\n",
+                           ualds_log_timestamp(), g_pid, dropped - g_dropped_reported, dropped);
+    ualds_log_writev(&iov, 1);
+    g_dropped_reported = dropped;
+}
+
+static void* ualds_log_writer_main(void *arg)
+{
+    struct timespec timeout;
+
+    UALDS_UNUSED(arg);
+
+    for (;;)
+    {
+        while (ualds_log_write_batch() > 0);
+
+        ualds_log_report_dropped();
+        if (__atomic_load_n(&g_writer_stop, __ATOMIC_ACQUIRE)) break;
+
+        /* sleep until the queue fills up or the flush interval passed, so lines are written in batches */
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_nsec += UALDS_CONF_LOG_ASYNC_FLUSH_INTERVAL * 1000000L;
+        if (timeout.tv_nsec >= 1000000000L)
+        {
+            timeout.tv_nsec -= 1000000000L;
+            timeout.tv_sec++;
+        }
+        while (sem_timedwait(&g_writer_sem, &timeout) != 0 && errno == EINTR);
+        __atomic_store_n(&g_writer_wakeup, 0, __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+/** Wakes the writer early once a quarter of the queue is in use. */
+static void ualds_log_wakeup_writer(unsigned int pos)
+{
+    unsigned int pending = pos + 1 - __atomic_load_n(&g_ring_tail, __ATOMIC_RELAXED);
+
+    if (pending > (g_ring_mask >> 2) && !__atomic_exchange_n(&g_writer_wakeup, 1, __ATOMIC_ACQ_REL))
+    {
+        sem_post(&g_writer_sem);
+    }
+}
+
+static int ualds_log_start_writer(void)
+{
+    g_writer_stop = 0;
+    g_writer_wakeup = 0;
+    if (pthread_create(&g_writer, NULL, ualds_log_writer_main, NULL) != 0) return -1;
+    g_async_running = 1;
+    return 0;
+}
+
+/** Stops the writer thread after it has written all queued lines. */
+static void ualds_log_stop_writer(void)
+{
+    if (!g_async_running) return;
+    __atomic_store_n(&g_writer_stop, 1, __ATOMIC_SEQ_CST);
+    sem_post(&g_writer_sem);
+    pthread_join(g_writer, NULL);
+    g_async_running = 0;
+}
+
+/* daemon() forks and the writer thread does not survive it: drain and stop it before, restart it in both processes after */
+static void ualds_log_atfork_prepare(void)
+{
+    ualds_log_stop_writer();
+}
+
+static void ualds_log_atfork_parent(void)
+{
+    if (g_async && g_logger_state != 0) ualds_log_start_writer();
+}
+
+static void ualds_log_atfork_child(void)
+{
+    g_pid = getpid();
+    if (g_async && g_logger_state != 0) ualds_log_start_writer();
+}
+
+static int ualds_log_open_async(int queueSize)
+{
+    unsigned int size = 1;
+    unsigned int i;
+
+    while (size < (unsigned int)queueSize) size <<= 1;
+
+    g_ring = malloc(size * sizeof(LogSlot));
+    if (g_ring == 0) return -1;
+    for (i = 0; i < size; i++)
+    {
+        g_ring[i].seq = i;
+    }
+    g_ring_mask = size - 1;
+    g_ring_head = 0;
+    g_ring_tail = 0;
+    g_dropped = 0;
+    g_dropped_reported = 0;
+    sem_init(&g_writer_sem, 0, 0);
+
+    if (!g_atfork_registered)
+    {
+        pthread_atfork(ualds_log_atfork_prepare, ualds_log_atfork_parent, ualds_log_atfork_child);
+        g_atfork_registered = 1;
+    }
+
+    if (ualds_log_start_writer() != 0)
+    {
+        sem_destroy(&g_writer_sem);
+        free(g_ring);
+        g_ring = 0;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void ualds_log_close_async(void)
+{
+    ualds_log_stop_writer();
+    sem_destroy(&g_writer_sem);
+    free(g_ring);
+    g_ring = 0;
+}
+
+/** Formats a line into the per-thread buffer and queues it; drops it if the queue is full. */
+static void ualds_log_push(const char *format, va_list ap)
+{
+    unsigned int pos, seq;
+    LogSlot *pSlot;
+    int len, prefix;
+
+    prefix = snprintf(t_line, sizeof(t_line), "%s [%i]: ", ualds_log_timestamp(), g_pid);
+    len = vsnprintf(t_line + prefix, sizeof(t_line) - prefix, format, ap);
+    len = (len < 0) ? prefix : prefix + len;
+    if (len > (int)sizeof(t_line) - 1) len = sizeof(t_line) - 1; /* truncated */
+    t_line[len++] = '\n';
+
+    pos = __atomic_load_n(&g_ring_head, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        pSlot = &g_ring[pos & g_ring_mask];
+        seq = __atomic_load_n(&pSlot->seq, __ATOMIC_ACQUIRE);
+        if (seq == pos)
+        {
+            if (__atomic_compare_exchange_n(&g_ring_head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        }
+        else if ((int)(seq - pos) < 0)
+        {
+            /* queue full */
+            __atomic_fetch_add(&g_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        else
+        {
+            pos = __atomic_load_n(&g_ring_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(pSlot->line, t_line, len);
+    pSlot->len = len;
+    __atomic_store_n(&pSlot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    ualds_log_wakeup_writer(pos);
+}
 
 int ualds_openlog(LogTarget target, LogLevel level)
 {
     int ret = 0;
     char szLogfileSize[10];
+    char szValue[10];
+    int queueSize = UALDS_CONF_LOG_ASYNC_QUEUE_SIZE;
     int success;
 
     if (g_logger_state != 0) return 1;
@@ -64,6 +399,8 @@ int ualds_openlog(LogTarget target, LogLevel level)
     /* store configuration */
     g_target = target;
     g_level = level;
+    g_async = 0;
+    g_pid = getpid();
 
     switch (target)
     {
@@ -98,11 +435,28 @@ int ualds_openlog(LogTarget target, LogLevel level)
             ualds_settings_writestring("LogFileSize", szLogfileSize);
             ualds_settings_addemptyline();
         }
+        if (ualds_settings_readstring("LogAsync", szValue, sizeof(szValue)) == 0 && strcmp(szValue, "yes") == 0)
+        {
+            g_async = 1;
+            ualds_settings_readint("LogAsyncQueueSize", &queueSize);
+            if (queueSize <= 0) queueSize = UALDS_CONF_LOG_ASYNC_QUEUE_SIZE;
+        }
         
         ualds_settings_endgroup();
 
         g_f = fopen(szLogfile, "a");
-        if (g_f == 0) ret = -1;
+        if (g_f == 0)
+        {
+            ret = -1;
+            break;
+        }
+        fseek(g_f, 0, SEEK_END);
+        g_file_size = ftell(g_f);
+        if (g_async && ualds_log_open_async(queueSize) != 0)
+        {
+            /* fall back to synchronous logging */
+            g_async = 0;
+        }
         break;
     }
 
@@ -116,19 +470,19 @@ int ualds_openlog(LogTarget target, LogLevel level)
 
 void ualds_log(LogLevel level, const char *format, ...)
 {
-    char *szTimeStamp;
-    time_t now;
     va_list ap;
-    long currentPos;
-    char szLogfile_backup[PATH_MAX];
-    time_t rawtime;
-    struct tm * timeinfo;
-    char time_str[80];
 
     if (g_logger_state == 0 || level > g_level) return;
 
     va_start(ap, format);
 
+    if (g_async)
+    {
+        ualds_log_push(format, ap);
+        va_end(ap);
+        return;
+    }
+
     switch (g_target)
     {
     case UALDS_LOG_SYSLOG:
@@ -148,45 +502,18 @@ void ualds_log(LogLevel level, const char *format, ...)
         break;
     case UALDS_LOG_STDERR:
     case UALDS_LOG_FILE:
-        now = time(0);
-        szTimeStamp = ctime(&now); /* standard time format: "Tue Nov 27 12:22:42" */
-        szTimeStamp[19] = 0; /* remove linebreak from timestamp */
-        fprintf(g_f, "%s [%i]: ", szTimeStamp, getpid());
+        pthread_mutex_lock(&g_file_lock);
+        fprintf(g_f, "%s [%i]: ", ualds_log_timestamp(), g_pid);
         vfprintf(g_f, format, ap);
         fprintf(g_f, "\n");
         fflush(g_f);
 
-        currentPos = ftell(g_f);
-        if (currentPos != -1)
+        // Log file size is limited
+        if (g_target == UALDS_LOG_FILE && ftell(g_f) >= g_max_size)
         {
-            // Log file size is limited
-            if (currentPos >= g_max_size)
-            {
-                // backup File parameters
-                LogTarget tmp_target = g_target;
-                LogLevel tmp_level = g_level;
-
-                // close log file
-                ualds_closelog();
-
-                strlcpy(szLogfile_backup, szLogfile, PATH_MAX);
-
-                // get current time in string format
-                time(&rawtime);
-                timeinfo = localtime(&rawtime);
-                strftime(time_str, 80, "%Y-%m-%d_%H-%M-%S", timeinfo);
-
-                strlcat(szLogfile_backup, "_", PATH_MAX);
-                strlcat(szLogfile_backup, time_str, PATH_MAX);
-                strlcat(szLogfile_backup, ".log", PATH_MAX);
-
-                // rename file
-                ualds_platform_rename(szLogfile, szLogfile_backup);
-
-                // open log file
-                ualds_openlog(tmp_target, tmp_level);
-            }
+            ualds_log_rotate();
         }
+        pthread_mutex_unlock(&g_file_lock);
         break;
     }
 
@@ -197,6 +524,14 @@ void ualds_closelog(void)
 {
     if (g_logger_state == 0) return;
 
+    g_logger_state = 0;
+
+    if (g_async)
+    {
+        ualds_log_close_async();
+        g_async = 0;
+    }
+
     switch (g_target)
     {
     case UALDS_LOG_SYSLOG:
@@ -205,9 +540,7 @@ void ualds_closelog(void)
     case UALDS_LOG_STDERR:
         break;
     case UALDS_LOG_FILE:
-        fclose(g_f);
+        if (g_f != stderr) fclose(g_f);
         break;
     }
-
-    g_logger_state = 0;
 }
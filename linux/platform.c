@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <fcntl.h>
 
 /* local includes */
 #include "../config.h"
@@ -84,14 +85,24 @@ int ualds_platform_getfqhostname(char *szHostname, int len)
 
 int ualds_platform_gethostbyname(const char* host, char* szHostname, int len)
 {
-    struct hostent *pEnt = 0;
+    struct addrinfo hints;
+    struct addrinfo *pResult = 0;
+    int ret;
 
     UALDS_UNUSED(host);
-    pEnt = gethostbyname(szHostname);
-    if (pEnt == 0) return -1;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_flags = AI_CANONNAME;
+
+    /* getaddrinfo is reentrant, unlike gethostbyname */
+    ret = getaddrinfo(szHostname, NULL, &hints, &pResult);
+    if (ret != 0 || pResult == 0) return -1;
 
-    strncpy(szHostname, pEnt->h_name, len);
-    szHostname[len - 1] = 0;
+    if (pResult->ai_canonname)
+    {
+        strlcpy(szHostname, pResult->ai_canonname, len);
+    }
+    freeaddrinfo(pResult);
 
     return 0;
 }
@@ -222,6 +233,133 @@ int ualds_platform_fileexists(const char *szFile)
     return 0 == access(szFile, 0);
 }
 
+/** Flushes the stream buffers and the file content to disk. */
+int ualds_platform_fsync(UALDS_FILE *fp)
+{
+    if (fflush(fp) != 0) return -1;
+    return fsync(fileno(fp));
+}
+
+/** Atomically replaces \c szFile with \c szNewFile.
+ * If \c szBackupFile is not NULL the previous version of \c szFile is kept
+ * as hard link with this name, so \c szFile never disappears.
+ */
+int ualds_platform_replacefile(const char *szFile, const char *szNewFile, const char *szBackupFile)
+{
+    struct stat st;
+    char szDir[PATH_MAX];
+    char *pszSep;
+    int fd;
+
+    if (stat(szFile, &st) == 0)
+    {
+        /* keep the file permissions */
+        chmod(szNewFile, st.st_mode & 07777);
+
+        if (szBackupFile)
+        {
+            unlink(szBackupFile);
+            if (link(szFile, szBackupFile) != 0)
+            {
+                ualds_log(UALDS_LOG_WARNING, "Could not create backup file %s: %s", szBackupFile, strerror(errno));
+            }
+        }
+    }
+
+    if (rename(szNewFile, szFile) != 0) return -1;
+
+    /* sync the directory to make the rename persistent */
+    strlcpy(szDir, szFile, sizeof(szDir));
+    pszSep = strrchr(szDir, '/');
+    if (pszSep == 0)
+    {
+        strlcpy(szDir, ".", sizeof(szDir));
+    }
+    else
+    {
+        pszSep[pszSep == szDir ? 1 : 0] = 0;
+    }
+    fd = open(szDir, O_RDONLY);
+    if (fd != -1)
+    {
+        fsync(fd);
+        close(fd);
+    }
+
+    return 0;
+}
+
+/** Initializes a reader/writer lock.
+ * Writers are preferred, so continuous read traffic cannot starve them.
+ */
+int ualds_platform_rwlock_init(UALDS_RWLOCK *pLock)
+{
+    pthread_rwlockattr_t attr;
+    int ret;
+
+    pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    ret = pthread_rwlock_init(pLock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+
+    return ret;
+}
+
+static int g_wakeupPipe[2] = { -1, -1 };
+
+/** Creates the wakeup pipe, which allows interrupting ualds_platform_poll.
+ * @param pFd Receives the file descriptor which becomes readable when the wakeup is signalled.
+ */
+int ualds_platform_wakeup_open(UALDS_SOCKET *pFd)
+{
+    int i;
+
+    if (pipe(g_wakeupPipe) != 0) return errno;
+    for (i = 0; i < 2; i++)
+    {
+        fcntl(g_wakeupPipe[i], F_SETFL, fcntl(g_wakeupPipe[i], F_GETFL) | O_NONBLOCK);
+        fcntl(g_wakeupPipe[i], F_SETFD, FD_CLOEXEC);
+    }
+    *pFd = g_wakeupPipe[0];
+
+    return 0;
+}
+
+/** Signals the wakeup pipe. This is async-signal-safe, so it can be called from a signal handler. */
+void ualds_platform_wakeup_signal(void)
+{
+    int fd = g_wakeupPipe[1];
+
+    if (fd >= 0)
+    {
+        /* a full pipe is already signalled */
+        ssize_t ret = write(fd, "", 1);
+        UALDS_UNUSED(ret);
+    }
+}
+
+/** Resets the wakeup pipe after it was signalled. */
+void ualds_platform_wakeup_drain(void)
+{
+    char buf[64];
+
+    if (g_wakeupPipe[0] < 0) return;
+    while (read(g_wakeupPipe[0], buf, sizeof(buf)) > 0);
+}
+
+void ualds_platform_wakeup_close(void)
+{
+    int i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (g_wakeupPipe[i] >= 0) close(g_wakeupPipe[i]);
+        g_wakeupPipe[i] = -1;
+    }
+}
+
 int ualds_platform_mkpath(char *szFilePath)
 {
     if (szFilePath == NULL)
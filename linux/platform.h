@@ -53,6 +53,7 @@
 #include <signal.h>
 #include <errno.h>
 #include <err.h>
+#include <pthread.h>
 
 #define UALDS_DT_DIR 4
 #define UALDS_DT_REG 8
@@ -84,7 +85,7 @@ int ualds_platform_convert_hostname_to_ipv4(const char* host, char* ip);
 
 #define UALDS_FILE FILE
 #define ualds_platform_rename rename
-#define ualds_platform_rm rmdir
+#define ualds_platform_rm unlink
 #define ualds_platform_mkdir mkdir
 int ualds_platform_mkpath(char *szFilePath);
 void ualds_getOldLogFilename(const char *szLogFileName, char *szOldFileName, size_t bufSize, int maxRotateCount);
@@ -93,6 +94,8 @@ void ualds_getOldLogFilename(const char *szLogFileName, char *szOldFileName, siz
 #define ualds_platform_fread fread
 #define ualds_platform_fwrite fwrite
 #define ualds_platform_fprintf fprintf
+int ualds_platform_fsync(UALDS_FILE *fp);
+int ualds_platform_replacefile(const char *szFile, const char *szNewFile, const char *szBackupFile);
 #define ualds_stat stat
 #define ualds_platform_stat stat
 #define ualds_platform_fstat fstat
@@ -103,6 +106,22 @@ void ualds_getOldLogFilename(const char *szLogFileName, char *szOldFileName, siz
 #define ualds_platform_getapplicationpath(p, l)
 #define ualds_platform_sleep sleep
 
+#define UALDS_RWLOCK pthread_rwlock_t
+int ualds_platform_rwlock_init(UALDS_RWLOCK *pLock);
+#define ualds_platform_rwlock_destroy pthread_rwlock_destroy
+#define ualds_platform_rwlock_rdlock pthread_rwlock_rdlock
+#define ualds_platform_rwlock_rdunlock pthread_rwlock_unlock
+#define ualds_platform_rwlock_wrlock pthread_rwlock_wrlock
+#define ualds_platform_rwlock_wrunlock pthread_rwlock_unlock
+
+#define UALDS_SOCKET int
+#define UALDS_POLLFD struct pollfd
+#define ualds_platform_poll poll
+int ualds_platform_wakeup_open(UALDS_SOCKET *pFd);
+void ualds_platform_wakeup_signal(void);
+void ualds_platform_wakeup_drain(void);
+void ualds_platform_wakeup_close(void);
+
 int ualds_platform_strcpy_insensitive(const char *s1, const char *s2);
 
 #ifndef HAVE_STRLCPY
@@ -0,0 +1,632 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* system includes */
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+/* uastack includes */
+#include <opcua_serverstub.h>
+#include <opcua_core.h>
+/* local platform includes */
+#include <platform.h>
+/* local includes */
+#include "../config.h"
+#include "tracering.h"
+
+#define UALDS_TRACERING_MAGIC       "UALDSTR1"
+#define UALDS_TRACERING_MAX_ARGS    8
+#define UALDS_TRACERING_STRING_SIZE 96
+#define UALDS_TRACERING_NO_STRING   ((uint64_t)-1)
+
+/** One recorded trace call. The format string is only applied when a dump is decoded. */
+typedef struct _TraceRecord
+{
+    uint64_t timestamp; /**< CLOCK_REALTIME in ns; 0 marks an unused record */
+    uint64_t format;    /**< address of the format string in the recording process */
+    uint32_t level;
+    uint32_t tid;
+    uint16_t numArgs;
+    uint16_t truncated; /**< not all arguments fitted into the record */
+    uint32_t reserved;
+    uint64_t args[UALDS_TRACERING_MAX_ARGS]; /**< raw argument values; for %s the offset into str */
+    char     str[UALDS_TRACERING_STRING_SIZE]; /**< copies of the string arguments */
+} TraceRecord;
+
+/** The records of one thread; rings of terminated threads are reused. */
+typedef struct _TraceRing
+{
+    struct _TraceRing *next;
+    int                inUse;
+    uint32_t           head; /**< number of records written so far */
+    TraceRecord        records[1];
+} TraceRing;
+
+/** Header of a dump file; it is followed by the record arrays of all rings. */
+typedef struct _TraceDumpHeader
+{
+    char     magic[8];
+    char     version[32];
+    uint64_t anchor;     /**< address of ualds_tracering_open in the dumping process */
+    uint64_t imageSize;  /**< size of the executable image; the decoder must be the same build */
+    uint32_t recordSize;
+    uint32_t numRecords; /**< records per ring */
+} TraceDumpHeader;
+
+/** A parsed printf conversion specification. */
+typedef struct _TraceSpec
+{
+    int  numStars;   /**< '*' width and precision taking an int argument */
+    int  precisionStar; /**< the precision is the last '*' argument */
+    int  precision;  /**< literal precision or -1 */
+    char length;     /**< 0, 'H' (hh), 'h', 'l', 'q' (ll), 'z', 'j', 't' or 'L' */
+    char conversion; /**< 0 if unsupported */
+} TraceSpec;
+
+/* boundaries of the executable image, provided by the linker */
+extern char __executable_start[];
+extern char _end[];
+
+static TraceRing      *g_rings = 0;
+static unsigned int    g_numRecords = 0;
+static int             g_dumpFd = -1;
+static int             g_open = 0;
+static int             g_recording = 0; /**< checked by every record call; cleared first by close */
+static int             g_ringKeyCreated = 0;
+static pthread_key_t   g_ringKey;
+static __thread TraceRing *t_ring = 0;
+static __thread uint32_t   t_tid = 0;
+
+/** Parses the conversion specification starting at the '%' in p and returns the position after it. */
+static const char* ualds_tracering_parse_spec(const char *p, TraceSpec *pSpec)
+{
+    pSpec->numStars = 0;
+    pSpec->precisionStar = 0;
+    pSpec->precision = -1;
+    pSpec->length = 0;
+    pSpec->conversion = 0;
+
+    p++;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') p++;
+    if (*p == '*')
+    {
+        pSpec->numStars++;
+        p++;
+    }
+    else
+    {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '.')
+    {
+        p++;
+        if (*p == '*')
+        {
+            pSpec->numStars++;
+            pSpec->precisionStar = 1;
+            p++;
+        }
+        else
+        {
+            pSpec->precision = 0;
+            while (*p >= '0' && *p <= '9') pSpec->precision = pSpec->precision * 10 + (*p++ - '0');
+        }
+    }
+    switch (*p)
+    {
+    case 'h':
+        p++;
+        if (*p == 'h') { pSpec->length = 'H'; p++; } else pSpec->length = 'h';
+        break;
+    case 'l':
+        p++;
+        if (*p == 'l') { pSpec->length = 'q'; p++; } else pSpec->length = 'l';
+        break;
+    case 'z': case 'j': case 't': case 'L':
+        pSpec->length = *p++;
+        break;
+    default:
+        break;
+    }
+    switch (*p)
+    {
+    case 'd': case 'i': case 'c': case 'u': case 'o': case 'x': case 'X':
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+    case 's': case 'p': case 'n':
+        pSpec->conversion = *p++;
+        break;
+    default:
+        break;
+    }
+
+    return p;
+}
+
+/** Stores the trace arguments in the record, following the conversions of the format string. */
+static void ualds_tracering_capture(TraceRecord *pRec, const char *format, va_list ap)
+{
+    TraceSpec spec;
+    const char *p = format;
+    const char *s;
+    int n = 0, i, star, precision, strUsed = 0, len;
+    double d;
+
+    pRec->truncated = 0;
+
+    while (*p)
+    {
+        if (*p != '%')
+        {
+            p++;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            p += 2;
+            continue;
+        }
+        p = ualds_tracering_parse_spec(p, &spec);
+        if (spec.conversion == 0 || n + spec.numStars + 1 > UALDS_TRACERING_MAX_ARGS)
+        {
+            pRec->truncated = 1;
+            break;
+        }
+
+        precision = spec.precision;
+        for (i = 0; i < spec.numStars; i++)
+        {
+            star = va_arg(ap, int);
+            pRec->args[n++] = (uint64_t)(int64_t)star;
+            if (spec.precisionStar && i == spec.numStars - 1) precision = star;
+        }
+
+        switch (spec.conversion)
+        {
+        case 'd': case 'i': case 'c':
+            switch (spec.length)
+            {
+            case 'l': pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, long); break;
+            case 'q': pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, long long); break;
+            case 'z': pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, ssize_t); break;
+            case 'j': pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, intmax_t); break;
+            case 't': pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, ptrdiff_t); break;
+            default:  pRec->args[n++] = (uint64_t)(int64_t)va_arg(ap, int); break;
+            }
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            switch (spec.length)
+            {
+            case 'l': pRec->args[n++] = (uint64_t)va_arg(ap, unsigned long); break;
+            case 'q': pRec->args[n++] = (uint64_t)va_arg(ap, unsigned long long); break;
+            case 'z': pRec->args[n++] = (uint64_t)va_arg(ap, size_t); break;
+            case 'j': pRec->args[n++] = (uint64_t)va_arg(ap, uintmax_t); break;
+            case 't': pRec->args[n++] = (uint64_t)va_arg(ap, ptrdiff_t); break;
+            default:  pRec->args[n++] = (uint64_t)va_arg(ap, unsigned int); break;
+            }
+            break;
+        case 's':
+            s = va_arg(ap, const char*);
+            if (s == 0 || strUsed >= UALDS_TRACERING_STRING_SIZE)
+            {
+                pRec->args[n++] = UALDS_TRACERING_NO_STRING;
+                break;
+            }
+            len = UALDS_TRACERING_STRING_SIZE - strUsed - 1;
+            if (precision >= 0 && precision < len) len = precision;
+            len = strnlen(s, len);
+            memcpy(pRec->str + strUsed, s, len);
+            pRec->str[strUsed + len] = 0;
+            pRec->args[n++] = strUsed;
+            strUsed += len + 1;
+            break;
+        case 'p': case 'n':
+            pRec->args[n++] = (uint64_t)(uintptr_t)va_arg(ap, void*);
+            break;
+        default: /* floating point */
+            if (spec.length == 'L') d = (double)va_arg(ap, long double);
+            else d = va_arg(ap, double);
+            memcpy(&pRec->args[n++], &d, sizeof(d));
+            break;
+        }
+    }
+
+    pRec->numArgs = n;
+}
+
+static void ualds_tracering_detach(void *pRing)
+{
+    __atomic_store_n(&((TraceRing*)pRing)->inUse, 0, __ATOMIC_RELEASE);
+}
+
+/** Gives the calling thread a ring, reusing the ring of a terminated thread if possible. */
+static TraceRing* ualds_tracering_attach(void)
+{
+    TraceRing *pRing;
+    int expected;
+
+    for (pRing = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); pRing != 0; pRing = pRing->next)
+    {
+        expected = 0;
+        if (__atomic_compare_exchange_n(&pRing->inUse, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
+    }
+
+    if (pRing == 0)
+    {
+        pRing = calloc(1, offsetof(TraceRing, records) + g_numRecords * sizeof(TraceRecord));
+        if (pRing == 0) return 0;
+        pRing->inUse = 1;
+        pRing->next = __atomic_load_n(&g_rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&g_rings, &pRing->next, pRing, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    t_ring = pRing;
+    t_tid = (uint32_t)syscall(SYS_gettid);
+    pthread_setspecific(g_ringKey, pRing);
+
+    return pRing;
+}
+
+/** The uastack record hook; runs on the tracing thread and never formats. */
+static OpcUa_Void OPCUA_DLLCALL ualds_tracering_record(OpcUa_UInt32 level, const OpcUa_CharA *format, varg_list ap)
+{
+    TraceRing *pRing = t_ring;
+    TraceRecord *pRec;
+    struct timespec now;
+    uint32_t head;
+
+    if (__atomic_load_n(&g_recording, __ATOMIC_ACQUIRE) == 0) return;
+
+    if (pRing == 0)
+    {
+        pRing = ualds_tracering_attach();
+        if (pRing == 0) return;
+    }
+
+    head = pRing->head;
+    pRec = &pRing->records[head & (g_numRecords - 1)];
+    clock_gettime(CLOCK_REALTIME, &now);
+    pRec->timestamp = (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+    pRec->format = (uint64_t)(uintptr_t)format;
+    pRec->level = level;
+    pRec->tid = t_tid;
+    ualds_tracering_capture(pRec, format, ap);
+
+    __atomic_store_n(&pRing->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static void ualds_tracering_signal_handler(int sig)
+{
+    UALDS_UNUSED(sig);
+    ualds_tracering_dump();
+}
+
+static void ualds_tracering_set_handlers(int install)
+{
+    struct sigaction sa;
+    static const int crashSignals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+    size_t i;
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = install ? ualds_tracering_signal_handler : SIG_DFL;
+
+    /* dump on demand */
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, 0);
+
+    /* dump once on a crash, then let the default action terminate the process */
+    sa.sa_flags = SA_RESETHAND;
+    for (i = 0; i < sizeof(crashSignals) / sizeof(crashSignals[0]); i++)
+    {
+        sigaction(crashSignals[i], &sa, 0);
+    }
+}
+
+int ualds_tracering_open(unsigned int traceLevel, unsigned int numRecords, const char *szDumpFile)
+{
+    unsigned int size = 1;
+
+    if (g_open != 0) return 0;
+    if (traceLevel == 0 || numRecords == 0) return -1;
+
+    /* a power of two, so the ring index is a mask; rings kept from an earlier open keep their size */
+    while (size < numRecords) size <<= 1;
+    if (g_rings == 0) g_numRecords = size;
+
+    g_dumpFd = open(szDumpFile, O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+    if (g_dumpFd == -1) return -1;
+
+    if (g_ringKeyCreated == 0)
+    {
+        if (pthread_key_create(&g_ringKey, ualds_tracering_detach) != 0)
+        {
+            close(g_dumpFd);
+            g_dumpFd = -1;
+            return -1;
+        }
+        g_ringKeyCreated = 1;
+    }
+
+    g_open = 1;
+    __atomic_store_n(&g_recording, 1, __ATOMIC_RELEASE);
+    ualds_tracering_set_handlers(1);
+    OpcUa_Trace_SetRecordHook(ualds_tracering_record, traceLevel);
+
+    return 0;
+}
+
+void ualds_tracering_close(void)
+{
+    if (g_open == 0) return;
+
+    __atomic_store_n(&g_recording, 0, __ATOMIC_RELEASE);
+    OpcUa_Trace_SetRecordHook(OpcUa_Null, 0);
+    ualds_tracering_set_handlers(0);
+    g_open = 0;
+
+    /* Threads of the stack may still be inside ualds_tracering_record, so the rings and the thread key
+     * are not freed. They stay allocated until the process exits and are reused by a later open. */
+
+    close(g_dumpFd);
+    g_dumpFd = -1;
+}
+
+void ualds_tracering_dump(void)
+{
+    TraceDumpHeader header;
+    TraceRing *pRing;
+    off_t offset = 0;
+    size_t size = g_numRecords * sizeof(TraceRecord);
+
+    if (g_dumpFd == -1) return;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, UALDS_TRACERING_MAGIC, sizeof(header.magic));
+    strlcpy(header.version, UALDS_CONF_VERSION_STRING, sizeof(header.version));
+    header.anchor = (uint64_t)(uintptr_t)ualds_tracering_open;
+    header.imageSize = (uint64_t)(_end - __executable_start);
+    header.recordSize = sizeof(TraceRecord);
+    header.numRecords = g_numRecords;
+
+    /* only async-signal-safe calls from here on */
+    if (ftruncate(g_dumpFd, 0) != 0) return;
+    if (pwrite(g_dumpFd, &header, sizeof(header), offset) != (ssize_t)sizeof(header)) return;
+    offset += sizeof(header);
+
+    for (pRing = __atomic_load_n(&g_rings, __ATOMIC_ACQUIRE); pRing != 0; pRing = pRing->next)
+    {
+        if (pwrite(g_dumpFd, pRing->records, size, offset) != (ssize_t)size) return;
+        offset += size;
+    }
+}
+
+static int ualds_tracering_compare(const void *a, const void *b)
+{
+    const TraceRecord *pA = a, *pB = b;
+
+    if (pA->timestamp < pB->timestamp) return -1;
+    return (pA->timestamp > pB->timestamp) ? 1 : 0;
+}
+
+static const char* ualds_tracering_levelname(uint32_t level)
+{
+    if (level & OPCUA_TRACE_LEVEL_ERROR) return "ERROR";
+    if (level & OPCUA_TRACE_LEVEL_WARNING) return "WARN";
+    if (level & OPCUA_TRACE_LEVEL_SYSTEM) return "SYSTEM";
+    if (level & OPCUA_TRACE_LEVEL_INFO) return "INFO";
+    if (level & OPCUA_TRACE_LEVEL_DEBUG) return "DEBUG";
+    return "CONTENT";
+}
+
+#define UALDS_TRACERING_PRINTF(xValue) \
+    ((spec.numStars == 0) ? snprintf(szOut, sizeof(szOut), szSpec, xValue) : \
+     (spec.numStars == 1) ? snprintf(szOut, sizeof(szOut), szSpec, stars[0], xValue) : \
+                            snprintf(szOut, sizeof(szOut), szSpec, stars[0], stars[1], xValue))
+
+/** Prints one record, applying its format string to the recorded arguments. */
+static void ualds_tracering_print(const TraceRecord *pRec, const char *format)
+{
+    TraceSpec spec;
+    const char *p = format;
+    const char *start;
+    char szSpec[32];
+    char szOut[512];
+    char szTime[32];
+    int stars[2];
+    int n = 0, i, len;
+    int64_t sval;
+    uint64_t uval;
+    double d;
+    time_t seconds = (time_t)(pRec->timestamp / 1000000000u);
+    struct tm tmTime;
+
+    localtime_r(&seconds, &tmTime);
+    strftime(szTime, sizeof(szTime), "%a %b %e %H:%M:%S", &tmTime);
+    printf("%s.%06u [%u] %s: ", szTime, (unsigned int)(pRec->timestamp % 1000000000u / 1000u),
+           pRec->tid, ualds_tracering_levelname(pRec->level));
+
+    while (*p)
+    {
+        if (*p != '%')
+        {
+            /* the stack terminates its trace lines itself */
+            if (*p != '\n' || p[1] != 0) putchar(*p);
+            p++;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+        start = p;
+        p = ualds_tracering_parse_spec(p, &spec);
+        len = (int)(p - start);
+        if (spec.conversion == 0 || n + spec.numStars + 1 > pRec->numArgs || len >= (int)sizeof(szSpec))
+        {
+            break;
+        }
+        memcpy(szSpec, start, len);
+        szSpec[len] = 0;
+        for (i = 0; i < spec.numStars; i++)
+        {
+            stars[i] = (int)(int64_t)pRec->args[n++];
+        }
+
+        sval = (int64_t)pRec->args[n];
+        uval = pRec->args[n];
+        n++;
+        switch (spec.conversion)
+        {
+        case 'd': case 'i': case 'c':
+            switch (spec.length)
+            {
+            case 'l': UALDS_TRACERING_PRINTF((long)sval); break;
+            case 'q': UALDS_TRACERING_PRINTF((long long)sval); break;
+            case 'z': UALDS_TRACERING_PRINTF((ssize_t)sval); break;
+            case 'j': UALDS_TRACERING_PRINTF((intmax_t)sval); break;
+            case 't': UALDS_TRACERING_PRINTF((ptrdiff_t)sval); break;
+            default:  UALDS_TRACERING_PRINTF((int)sval); break;
+            }
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            switch (spec.length)
+            {
+            case 'l': UALDS_TRACERING_PRINTF((unsigned long)uval); break;
+            case 'q': UALDS_TRACERING_PRINTF((unsigned long long)uval); break;
+            case 'z': UALDS_TRACERING_PRINTF((size_t)uval); break;
+            case 'j': UALDS_TRACERING_PRINTF((uintmax_t)uval); break;
+            case 't': UALDS_TRACERING_PRINTF((ptrdiff_t)uval); break;
+            default:  UALDS_TRACERING_PRINTF((unsigned int)uval); break;
+            }
+            break;
+        case 's':
+            if (uval == UALDS_TRACERING_NO_STRING || uval >= UALDS_TRACERING_STRING_SIZE)
+            {
+                UALDS_TRACERING_PRINTF("...");
+            }
+            else
+            {
+                UALDS_TRACERING_PRINTF(pRec->str + uval);
+            }
+            break;
+        case 'p':
+            UALDS_TRACERING_PRINTF((void*)(uintptr_t)uval);
+            break;
+        case 'n':
+            szOut[0] = 0;
+            break;
+        default: /* floating point */
+            memcpy(&d, &uval, sizeof(d));
+            if (spec.length == 'L') UALDS_TRACERING_PRINTF((long double)d);
+            else UALDS_TRACERING_PRINTF(d);
+            break;
+        }
+        fputs(szOut, stdout);
+    }
+
+    if (pRec->truncated) fputs(" [...]", stdout);
+    putchar('\n');
+}
+
+int ualds_tracering_decode(const char *szDumpFile)
+{
+    TraceDumpHeader header;
+    TraceRecord *pRecords = 0;
+    TraceRecord *pNew;
+    size_t numRecords = 0, maxRecords = 0, numRead, kept, i;
+    uintptr_t format;
+    uintptr_t bias = (uintptr_t)ualds_tracering_open;
+    FILE *f;
+
+    f = fopen(szDumpFile, "rb");
+    if (f == 0)
+    {
+        fprintf(stderr, "Cannot open trace dump '%s'.\n", szDumpFile);
+        return -1;
+    }
+
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        memcmp(header.magic, UALDS_TRACERING_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(TraceRecord) || header.numRecords == 0)
+    {
+        fprintf(stderr, "'%s' is not a trace dump.\n", szDumpFile);
+        fclose(f);
+        return -1;
+    }
+    header.version[sizeof(header.version) - 1] = 0;
+    if (strcmp(header.version, UALDS_CONF_VERSION_STRING) != 0 ||
+        header.imageSize != (uint64_t)(_end - __executable_start))
+    {
+        fprintf(stderr, "The trace dump was written by another build (%s) and cannot be decoded by this executable.\n", header.version);
+        fclose(f);
+        return -1;
+    }
+    /* the format strings were recorded as addresses; relocate them into this process */
+    bias -= (uintptr_t)header.anchor;
+
+    for (;;)
+    {
+        if (numRecords + header.numRecords > maxRecords)
+        {
+            maxRecords = numRecords + header.numRecords;
+            pNew = realloc(pRecords, maxRecords * sizeof(TraceRecord));
+            if (pNew == 0) break;
+            pRecords = pNew;
+        }
+        numRead = fread(pRecords + numRecords, sizeof(TraceRecord), header.numRecords, f);
+        /* skip records which were never written */
+        for (i = 0, kept = numRecords; i < numRead; i++)
+        {
+            if (pRecords[numRecords + i].timestamp != 0) pRecords[kept++] = pRecords[numRecords + i];
+        }
+        numRecords = kept;
+        if (numRead < header.numRecords) break;
+    }
+    fclose(f);
+
+    qsort(pRecords, numRecords, sizeof(TraceRecord), ualds_tracering_compare);
+
+    for (i = 0; i < numRecords; i++)
+    {
+        format = (uintptr_t)pRecords[i].format + bias;
+        if (format < (uintptr_t)__executable_start || format >= (uintptr_t)_end) continue;
+        ualds_tracering_print(&pRecords[i], (const char*)format);
+    }
+
+    free(pRecords);
+
+    return 0;
+}
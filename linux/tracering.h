@@ -0,0 +1,48 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+#ifndef __TRACERING_H__
+#define __TRACERING_H__
+
+/** Starts recording uastack trace calls of the given trace levels into per-thread in-memory rings.
+ * The rings are written to szDumpFile on SIGUSR1 and when the process crashes.
+ * @param traceLevel OPCUA_TRACE_OUTPUT_LEVEL_* mask of the recorded trace levels.
+ * @param numRecords Number of records kept per thread.
+ * @param szDumpFile Path of the dump file; it is opened now, before privileges are dropped.
+ * @return Zero on success.
+ */
+int ualds_tracering_open(unsigned int traceLevel, unsigned int numRecords, const char *szDumpFile);
+/** Stops recording. The rings stay allocated, since other threads may still be recording. */
+void ualds_tracering_close(void);
+/** Writes the rings to the dump file. This function is async-signal-safe. */
+void ualds_tracering_dump(void);
+/** Prints a dump file written by this executable as text to stdout. */
+int ualds_tracering_decode(const char *szDumpFile);
+
+#endif /* __TRACERING_H__ */
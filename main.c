@@ -45,6 +45,8 @@
 #include <log.h>
 #ifdef _WIN32
 #include <crtdbg.h>
+#else
+#include <tracering.h>
 #endif /* _WIN32 */
 
 static void version(void)
@@ -63,6 +65,9 @@ static void usage(const char *szAppName)
 #ifdef HAVE_SERVICE_UNREGISTER
     fprintf(stderr, "[-u] ");
 #endif
+#ifndef _WIN32
+    fprintf(stderr, "[-T <dumpfile>] ");
+#endif
 #if defined(HAVE_SERVICE_START) || defined(HAVE_SERVICE_STOP) || defined(HAVE_SERVICE_STATUS)
     fprintf(stderr,"<command>");
 #endif
@@ -79,6 +84,10 @@ static void usage(const char *szAppName)
 #endif
 #ifdef HAVE_SERVICE_UNREGISTER
     fprintf(stderr, "  -u: Uninstalls the UA LDS service.\n");
+#endif
+#ifndef _WIN32
+    fprintf(stderr, "  -T: Decodes a trace ring dump file to standard output. The dump must have\n"
+            "      been written by the same build of ualds.\n");
 #endif
     fprintf(stderr, "  -h: Prints the synopsis and a short description of the possible options.\n");
 #if defined(HAVE_SERVICE_START) || defined(HAVE_SERVICE_STOP) || defined(HAVE_SERVICE_STATUS)
@@ -118,7 +127,11 @@ int main(int argc, char* argv[])
 #endif
     
     /* parse commandline arguments */
+#ifdef _WIN32
     while ((opt = getopt(argc, argv, "dDvhc:i:p:u")) != -1) {
+#else
+    while ((opt = getopt(argc, argv, "dDvhc:i:p:uT:")) != -1) {
+#endif
         switch (opt) {
         case 'd':
             debug = 1;
@@ -148,6 +161,11 @@ int main(int argc, char* argv[])
         case 'u':
             uninstall = 1;
             break;
+#ifndef _WIN32
+        case 'T':
+            exit(ualds_tracering_decode(optarg) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+            break;
+#endif
         default: /* '?' */
             usage(argv[0]);
             exit(EXIT_FAILURE);
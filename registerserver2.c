@@ -40,6 +40,7 @@
 #include "config.h"
 #include "settings.h"
 #include "ualds.h"
+#include "registry.h"
 #include "zeroconf.h"
 #include "findserversonnetwork.h"
 /* local platform includes */
@@ -71,10 +72,9 @@ OpcUa_StatusCode ualds_registerserver2(OpcUa_Endpoint        hEndpoint,
     OpcUa_RegisterServer2Response *pResponse;
     OpcUa_EncodeableType          *pResponseType = 0;
     OpcUa_StatusCode               uStatus = OpcUa_Good;
-    int i, k;
-    int numServers = 0;
+    int k;
+    OpcUa_MdnsDiscoveryConfiguration *mdnsCfg = OpcUa_Null;
     int bExists = 0;
-    char szServerUri[UALDS_CONF_MAX_URI_LENGTH];
     char *pszServerUri;
 
     UALDS_UNUSED(pRequestType);
@@ -159,53 +159,6 @@ OpcUa_StatusCode ualds_registerserver2(OpcUa_Endpoint        hEndpoint,
             if (bIsOnline != OpcUa_False)
             {
                 ualds_log(UALDS_LOG_INFO, "Registering server %s.", pszServerUri);
-                ualds_settings_begingroup("RegisteredServers");
-                ualds_settings_beginreadarray("Servers", &numServers);
-                /* check if requested server is already registered */
-                for (i=0; i<numServers; i++)
-                {
-                    ualds_settings_setarrayindex(i);
-                    ualds_settings_readstring("ServerUri", szServerUri, sizeof(szServerUri));
-                    if (strcmp(szServerUri, pszServerUri) == 0)
-                    {
-                        bExists = 1;
-                        break;
-                    }
-                }
-                ualds_settings_endarray();
-                if (bExists == 0)
-                {
-                    /* add new server */
-                    ualds_settings_beginwritearray("Servers", numServers+1);
-                    ualds_settings_setarrayindex(numServers);
-                    ualds_settings_writestring("ServerUri", pszServerUri);
-                    ualds_settings_endarray();
-                }
-                ualds_settings_endgroup();
-
-                /* update server info */
-                ualds_settings_begingroup(pszServerUri);
-                ualds_settings_writestring("ProductUri", OpcUa_String_GetRawString(&pRequest->Server.ProductUri));
-                ualds_settings_beginwritearray("ServerNames", pRequest->Server.NoOfServerNames);
-                for (i=0; i<pRequest->Server.NoOfServerNames; i++)
-                {
-                    ualds_settings_setarrayindex(i);
-                    ualds_settings_writestring("Locale", OpcUa_String_GetRawString(&pRequest->Server.ServerNames[i].Locale));
-                    ualds_settings_writestring("Text", OpcUa_String_GetRawString(&pRequest->Server.ServerNames[i].Text));
-                }
-                ualds_settings_endarray();
-                ualds_settings_writeint("ServerType", pRequest->Server.ServerType);
-                ualds_settings_writestring("GatewayServerUri", OpcUa_String_GetRawString(&pRequest->Server.GatewayServerUri));
-                ualds_settings_beginwritearray("DiscoveryUrls", pRequest->Server.NoOfDiscoveryUrls);
-
-                for (i=0; i<pRequest->Server.NoOfDiscoveryUrls; i++)
-                {
-                    ualds_settings_setarrayindex(i);
-                    ualds_settings_writestring("Url", OpcUa_String_GetRawString(&pRequest->Server.DiscoveryUrls[i]));
-                }
-                ualds_settings_endarray();
-                ualds_settings_writestring("SemaphoreFilePath", OpcUa_String_GetRawString(&pRequest->Server.SemaphoreFilePath));
-                ualds_settings_writetime_t("UpdateTime", time(0));
 
                 for (k = 0; k < pRequest->NoOfDiscoveryConfiguration; ++k)
                 {
@@ -214,32 +167,20 @@ OpcUa_StatusCode ualds_registerserver2(OpcUa_Endpoint        hEndpoint,
                     {
                         if (discoveryConfiguration->Body.EncodeableObject.Type->TypeId == OpcUaId_MdnsDiscoveryConfiguration)
                         {
-                            OpcUa_MdnsDiscoveryConfiguration* mdnsCfg = (OpcUa_MdnsDiscoveryConfiguration*)discoveryConfiguration->Body.EncodeableObject.Object;
-
-                            if (mdnsCfg)
-                            {
-                                ualds_settings_writestring("MdnsServerName", OpcUa_String_GetRawString(&mdnsCfg->MdnsServerName));
-
-                                if (mdnsCfg->NoOfServerCapabilities > 0)
-                                {
-                                    ualds_settings_beginwritearray("ServerCapabilities", mdnsCfg->NoOfServerCapabilities);
-                                    for (i = 0; i< mdnsCfg->NoOfServerCapabilities; i++)
-                                    {
-                                        ualds_settings_setarrayindex(i);
-                                        ualds_settings_writestring("Capability", OpcUa_String_GetRawString(&mdnsCfg->ServerCapabilities[i]));
-                                    }
-                                    ualds_settings_endarray();
-                                }
-                                break;
-                            }
+                            mdnsCfg = (OpcUa_MdnsDiscoveryConfiguration*)discoveryConfiguration->Body.EncodeableObject.Object;
+                            if (mdnsCfg) break;
                         }
                     }
                 }
 
-                ualds_settings_endgroup();
+                if (ualds_registry_register(&pRequest->Server, mdnsCfg, &bExists) != 0)
+                {
+                    ualds_log(UALDS_LOG_ERR, "Failed to register server %s.", pszServerUri);
+                    uStatus = OpcUa_BadOutOfMemory;
+                }
 
 #ifdef HAVE_HDS
-                if (bExists == 0)
+                if (bExists == 0 && OpcUa_IsGood(uStatus))
                 {
                     if (g_bEnableZeroconf == 0)
                     {
@@ -247,7 +188,7 @@ OpcUa_StatusCode ualds_registerserver2(OpcUa_Endpoint        hEndpoint,
                     }
                 }
 #endif
-                ualds_settings_flush();
+                ualds_settings_commit();
             }
             else
             {
@@ -259,9 +200,8 @@ OpcUa_StatusCode ualds_registerserver2(OpcUa_Endpoint        hEndpoint,
                     ualds_zeroconf_unregister_offline(pszServerUri);
                 }
 #endif
-                ualds_settings_removegroup(pszServerUri);
-                ualds_settings_flush();
-                ualds_expirationcheck();
+                ualds_registry_unregister(pszServerUri);
+                ualds_settings_commit();
             }
         }
 
@@ -0,0 +1,1007 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/**
+ * \addtogroup registry Registered Server Registry
+ * @{
+ *
+ *  The registry keeps all registered servers in memory as parsed structures,
+ *  indexed by their ServerUri using a hash table. Additionally all entries are
+ *  linked in registration order, which is the order of the "Servers" array in
+ *  the settings file. The first entry is always the LDS itself.
+ *
+ *  Entries which can expire are kept in a binary min-heap ordered by their
+ *  \c ExpiryTime, so the expiration check only needs to visit due entries:
+ *  - Entries without SemaphoreFilePath expire ExpirationMaxAge seconds after their last update.
+ *  - Entries with a semaphore file must be checked on each expiration check,
+ *    their ExpiryTime is set by the expiration check using ualds_registry_reschedule.
+ *  - Entries with the SemaphoreFilePath "*" never expire and are not contained in the heap.
+ *  - Entries where the SemaphoreFilePath key is missing are due immediately.
+ *
+ *  The settings file is only used as persistent backing store. All modifications
+ *  done using this API are written through to the settings engine, but are only
+ *  written to disk when ualds_settings_flush is called. If the registration journal
+ *  is open, each modification is additionally appended to the journal.
+ *
+ *  Thread safety: All functions which modify the registry or the settings must be
+ *  called with g_mutex held, so there is only one writer at a time. Additionally the
+ *  registry is protected by a reader/writer lock, which writers take internally only
+ *  while exchanging the in-memory data. Service handlers which only read the registry,
+ *  like FindServers, use ualds_registry_lockread instead of g_mutex. So readers never
+ *  block each other and are not blocked by writers which access the settings file
+ *  or by the mDNS processing.
+ *
+ *  Each change of the information returned by FindServers increments the registry
+ *  generation, so service handlers can cache results derived from the registry.
+ */
+
+/* system includes */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+/* uastack includes */
+#include <opcua_proxystub.h>
+#include <opcua_string.h>
+/* local includes */
+#include "config.h"
+#include "settings.h"
+#include "registry.h"
+#include "journal.h"
+/* local platform includes */
+#include <platform.h>
+#include <log.h>
+
+#define REGISTRY_INITIAL_BUCKETS 64
+
+struct _ualds_registry
+{
+    ualds_registeredserver **ppBuckets;
+    unsigned int             numBuckets;
+    int                      numServers;
+    ualds_registeredserver  *pFirst;
+    ualds_registeredserver  *pLast;
+    ualds_registeredserver **ppHeap;     /**< expiration heap, has the capacity of numBuckets */
+    int                      numHeap;
+};
+typedef struct _ualds_registry ualds_registry;
+
+static ualds_registry g_registry;
+static int            g_registryMaxAge = 600;
+static UALDS_RWLOCK   g_registryLock;
+static int            g_bRegistryLockInitialized = 0;
+static unsigned int   g_registryGeneration = 0;
+
+/** FNV-1a string hash. */
+static unsigned int ualds_registry_hash(const char *szKey)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*szKey)
+    {
+        hash ^= (unsigned char)*szKey++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/** strdup variant which maps NULL to an empty string. */
+static char* ualds_registry_strdup(const char *szValue)
+{
+    return strdup(szValue ? szValue : "");
+}
+
+static void ualds_registry_freestrings(char **pszStrings, int numStrings)
+{
+    int i;
+
+    if (pszStrings == 0) return;
+    for (i = 0; i < numStrings; i++)
+    {
+        free(pszStrings[i]);
+    }
+    free(pszStrings);
+}
+
+static void ualds_registry_freenames(ualds_localizedtext *pNames, int numNames)
+{
+    int i;
+
+    if (pNames == 0) return;
+    for (i = 0; i < numNames; i++)
+    {
+        free(pNames[i].szLocale);
+        free(pNames[i].szText);
+    }
+    free(pNames);
+}
+
+/** Frees \c pServer and all its members. The entry must not be linked into the registry. */
+void ualds_registry_freeserver(ualds_registeredserver *pServer)
+{
+    free(pServer->szServerUri);
+    free(pServer->szProductUri);
+    ualds_registry_freenames(pServer->pServerNames, pServer->nNoOfServerNames);
+    free(pServer->szGatewayServerUri);
+    ualds_registry_freestrings(pServer->pszDiscoveryUrls, pServer->nNoOfDiscoveryUrls);
+    free(pServer->szSemaphoreFilePath);
+    free(pServer->szMdnsServerName);
+    ualds_registry_freestrings(pServer->pszServerCapabilities, pServer->nNoOfServerCapabilities);
+    free(pServer);
+}
+
+/** Doubles the number of hash buckets and redistributes all entries. */
+static int ualds_registry_grow(void)
+{
+    unsigned int numBuckets = g_registry.numBuckets ? g_registry.numBuckets * 2 : REGISTRY_INITIAL_BUCKETS;
+    ualds_registeredserver **ppBuckets = calloc(numBuckets, sizeof(ualds_registeredserver*));
+    ualds_registeredserver *pServer;
+    unsigned int index;
+
+    ualds_registeredserver **ppHeap;
+
+    if (ppBuckets == 0) return ENOMEM;
+
+    /* the heap never contains more entries than the registry, so it grows with the hash table */
+    ppHeap = realloc(g_registry.ppHeap, numBuckets * sizeof(ualds_registeredserver*));
+    if (ppHeap == 0)
+    {
+        free(ppBuckets);
+        return ENOMEM;
+    }
+    g_registry.ppHeap = ppHeap;
+
+    for (pServer = g_registry.pFirst; pServer; pServer = pServer->pNext)
+    {
+        index = ualds_registry_hash(pServer->szServerUri) & (numBuckets - 1);
+        pServer->pHashNext = ppBuckets[index];
+        ppBuckets[index] = pServer;
+    }
+
+    free(g_registry.ppBuckets);
+    g_registry.ppBuckets = ppBuckets;
+    g_registry.numBuckets = numBuckets;
+
+    return 0;
+}
+
+static void ualds_registry_heapset(int index, ualds_registeredserver *pServer)
+{
+    g_registry.ppHeap[index] = pServer;
+    pServer->iHeapIndex = index;
+}
+
+/** Moves the heap element at \c index up or down until the heap order is restored. */
+static void ualds_registry_heapfix(int index)
+{
+    ualds_registeredserver *pServer = g_registry.ppHeap[index];
+    int parent;
+    int child;
+
+    /* sift up */
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+        if (g_registry.ppHeap[parent]->ExpiryTime <= pServer->ExpiryTime) break;
+        ualds_registry_heapset(index, g_registry.ppHeap[parent]);
+        index = parent;
+    }
+
+    /* sift down */
+    while ((child = 2 * index + 1) < g_registry.numHeap)
+    {
+        if (child + 1 < g_registry.numHeap &&
+            g_registry.ppHeap[child + 1]->ExpiryTime < g_registry.ppHeap[child]->ExpiryTime)
+        {
+            child++;
+        }
+        if (pServer->ExpiryTime <= g_registry.ppHeap[child]->ExpiryTime) break;
+        ualds_registry_heapset(index, g_registry.ppHeap[child]);
+        index = child;
+    }
+
+    ualds_registry_heapset(index, pServer);
+}
+
+static void ualds_registry_heapremove(ualds_registeredserver *pServer)
+{
+    int index = pServer->iHeapIndex;
+    ualds_registeredserver *pLast;
+
+    if (index < 0) return;
+
+    pServer->iHeapIndex = -1;
+    pLast = g_registry.ppHeap[--g_registry.numHeap];
+    if (pLast != pServer)
+    {
+        ualds_registry_heapset(index, pLast);
+        ualds_registry_heapfix(index);
+    }
+}
+
+/** Computes the ExpiryTime of \c pServer and updates its position in the expiration heap. */
+static void ualds_registry_schedule(ualds_registeredserver *pServer)
+{
+    if (pServer->szSemaphoreFilePath == 0)
+    {
+        /* no SemaphoreFilePath is stored, expires immediately */
+        pServer->ExpiryTime = 0;
+    }
+    else if (pServer->szSemaphoreFilePath[0] == 0)
+    {
+        pServer->ExpiryTime = pServer->UpdateTime + g_registryMaxAge;
+    }
+    else if (pServer->szSemaphoreFilePath[0] != '*')
+    {
+        /* check the semaphore file on the next expiration check */
+        pServer->ExpiryTime = 0;
+    }
+    else
+    {
+        /* never expires */
+        ualds_registry_heapremove(pServer);
+        return;
+    }
+
+    if (pServer->iHeapIndex < 0)
+    {
+        pServer->iHeapIndex = g_registry.numHeap++;
+        g_registry.ppHeap[pServer->iHeapIndex] = pServer;
+    }
+    ualds_registry_heapfix(pServer->iHeapIndex);
+}
+
+/** Creates a new empty entry for \c szServerUri and appends it to the registry. */
+static ualds_registeredserver* ualds_registry_add(const char *szServerUri)
+{
+    ualds_registeredserver *pServer;
+    unsigned int index;
+
+    if ((unsigned int)g_registry.numServers >= g_registry.numBuckets)
+    {
+        if (ualds_registry_grow() != 0) return 0;
+    }
+
+    pServer = calloc(1, sizeof(ualds_registeredserver));
+    if (pServer == 0) return 0;
+
+    pServer->szServerUri = strdup(szServerUri);
+    if (pServer->szServerUri == 0)
+    {
+        free(pServer);
+        return 0;
+    }
+    pServer->iHeapIndex = -1;
+
+    index = ualds_registry_hash(szServerUri) & (g_registry.numBuckets - 1);
+    pServer->pHashNext = g_registry.ppBuckets[index];
+    g_registry.ppBuckets[index] = pServer;
+
+    pServer->pPrev = g_registry.pLast;
+    if (g_registry.pLast)
+    {
+        g_registry.pLast->pNext = pServer;
+    }
+    else
+    {
+        g_registry.pFirst = pServer;
+    }
+    g_registry.pLast = pServer;
+    g_registry.numServers++;
+
+    return pServer;
+}
+
+/** Reads a string from the current settings group and returns a heap copy of it. */
+static char* ualds_registry_readstring(const char *szKey, int len)
+{
+    char szValue[PATH_MAX];
+
+    if (len > (int)sizeof(szValue)) len = sizeof(szValue);
+    szValue[0] = 0;
+    if (ualds_settings_readstring(szKey, szValue, len) != 0)
+    {
+        return 0;
+    }
+
+    return strdup(szValue);
+}
+
+/** Reads the array \c szArrayKey with the sub key \c szKey from the current settings group. */
+static int ualds_registry_readstringarray(const char *szArrayKey, const char *szKey, char ***ppszStrings)
+{
+    int numStrings = 0;
+    int i;
+    char **pszStrings;
+
+    *ppszStrings = 0;
+    if (ualds_settings_beginreadarray(szArrayKey, &numStrings) != 0 || numStrings <= 0)
+    {
+        ualds_settings_endarray();
+        return 0;
+    }
+
+    pszStrings = calloc(numStrings, sizeof(char*));
+    if (pszStrings)
+    {
+        for (i = 0; i < numStrings; i++)
+        {
+            ualds_settings_setarrayindex(i);
+            pszStrings[i] = ualds_registry_readstring(szKey, UALDS_CONF_MAX_URI_LENGTH);
+            if (pszStrings[i] == 0) pszStrings[i] = strdup("");
+        }
+    }
+    else
+    {
+        numStrings = 0;
+    }
+    ualds_settings_endarray();
+
+    *ppszStrings = pszStrings;
+    return numStrings;
+}
+
+/** Parses the settings group of \c pServer. */
+static void ualds_registry_readserver(ualds_registeredserver *pServer)
+{
+    int numNames = 0;
+    int i;
+    char szValue[20];
+
+    ualds_settings_begingroup(pServer->szServerUri);
+
+    pServer->szProductUri = ualds_registry_readstring("ProductUri", UALDS_CONF_MAX_URI_LENGTH);
+    if (pServer->szProductUri == 0) pServer->szProductUri = strdup("");
+
+    if (ualds_settings_beginreadarray("ServerNames", &numNames) == 0 && numNames > 0)
+    {
+        pServer->pServerNames = calloc(numNames, sizeof(ualds_localizedtext));
+        if (pServer->pServerNames)
+        {
+            pServer->nNoOfServerNames = numNames;
+            for (i = 0; i < numNames; i++)
+            {
+                ualds_settings_setarrayindex(i);
+                pServer->pServerNames[i].szLocale = ualds_registry_readstring("Locale", UALDS_CONF_MAX_URI_LENGTH);
+                if (pServer->pServerNames[i].szLocale == 0) pServer->pServerNames[i].szLocale = strdup("");
+                pServer->pServerNames[i].szText = ualds_registry_readstring("Text", UALDS_CONF_MAX_URI_LENGTH);
+                if (pServer->pServerNames[i].szText == 0) pServer->pServerNames[i].szText = strdup("");
+            }
+        }
+    }
+    ualds_settings_endarray();
+
+    pServer->ServerType = 0;
+    ualds_settings_readint("ServerType", &pServer->ServerType);
+
+    pServer->szGatewayServerUri = ualds_registry_readstring("GatewayServerUri", UALDS_CONF_MAX_URI_LENGTH);
+    if (pServer->szGatewayServerUri == 0) pServer->szGatewayServerUri = strdup("");
+
+    pServer->nNoOfDiscoveryUrls = ualds_registry_readstringarray("DiscoveryUrls", "Url", &pServer->pszDiscoveryUrls);
+
+    /* NULL marks a missing key, which makes the entry expire immediately */
+    pServer->szSemaphoreFilePath = ualds_registry_readstring("SemaphoreFilePath", PATH_MAX);
+
+    pServer->UpdateTime = 0;
+    if (ualds_settings_readstring("UpdateTime", szValue, sizeof(szValue)) == 0)
+    {
+        pServer->UpdateTime = (time_t)strtol(szValue, 0, 10);
+    }
+
+    pServer->szMdnsServerName = ualds_registry_readstring("MdnsServerName", UALDS_CONF_MAX_URI_LENGTH);
+    if (pServer->szMdnsServerName == 0) pServer->szMdnsServerName = strdup("");
+
+    pServer->nNoOfServerCapabilities = ualds_registry_readstringarray("ServerCapabilities", "Capability", &pServer->pszServerCapabilities);
+
+    ualds_settings_endgroup();
+}
+
+/** Initializes the registry lock. This must be called before any other registry function. */
+int ualds_registry_initialize(void)
+{
+    int ret = 0;
+
+    if (g_bRegistryLockInitialized == 0)
+    {
+        ret = ualds_platform_rwlock_init(&g_registryLock);
+        if (ret == 0) g_bRegistryLockInitialized = 1;
+    }
+
+    return ret;
+}
+
+/** Removes all entries from the registry and releases the registry lock. */
+void ualds_registry_cleanup(void)
+{
+    ualds_registry_clear();
+
+    if (g_bRegistryLockInitialized)
+    {
+        ualds_platform_rwlock_destroy(&g_registryLock);
+        g_bRegistryLockInitialized = 0;
+    }
+}
+
+/** Acquires the registry lock for reading.
+ * This allows using ualds_registry_count, ualds_registry_first and ualds_registry_find
+ * without holding g_mutex. The returned entries are only valid until ualds_registry_unlockread.
+ */
+void ualds_registry_lockread(void)
+{
+    ualds_platform_rwlock_rdlock(&g_registryLock);
+}
+
+/** Releases the registry lock acquired by ualds_registry_lockread. */
+void ualds_registry_unlockread(void)
+{
+    ualds_platform_rwlock_rdunlock(&g_registryLock);
+}
+
+/** Sets the ExpirationMaxAge in seconds for registrations without semaphore file. */
+void ualds_registry_setmaxage(int maxAge)
+{
+    ualds_registeredserver *pServer;
+
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+    g_registryMaxAge = maxAge;
+    for (pServer = g_registry.pFirst; pServer; pServer = pServer->pNext)
+    {
+        if (pServer->szSemaphoreFilePath && pServer->szSemaphoreFilePath[0] == 0)
+        {
+            ualds_registry_schedule(pServer);
+        }
+    }
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+}
+
+/** Builds the registry from the "RegisteredServers" section of the settings file.
+ * Any previously loaded content is discarded.
+ */
+int ualds_registry_load(void)
+{
+    int numServers = 0;
+    int i;
+    char szServerUri[UALDS_CONF_MAX_URI_LENGTH];
+    char **pszServerUris;
+    ualds_registeredserver *pServer;
+
+    ualds_registry_clear();
+
+    /* this happens only on startup, so the lock is kept while parsing */
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+
+    if (ualds_registry_grow() != 0)
+    {
+        ualds_platform_rwlock_wrunlock(&g_registryLock);
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        return ENOMEM;
+    }
+
+    /* read list of all registered servers */
+    ualds_settings_begingroup("RegisteredServers");
+    ualds_settings_beginreadarray("Servers", &numServers);
+    if (numServers < 1)
+    {
+        ualds_settings_endarray();
+        ualds_settings_endgroup();
+        ualds_platform_rwlock_wrunlock(&g_registryLock);
+        return 0;
+    }
+    pszServerUris = calloc(numServers, sizeof(char*));
+    if (pszServerUris == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        ualds_settings_endarray();
+        ualds_settings_endgroup();
+        ualds_platform_rwlock_wrunlock(&g_registryLock);
+        return ENOMEM;
+    }
+    for (i = 0; i < numServers; i++)
+    {
+        szServerUri[0] = 0;
+        ualds_settings_setarrayindex(i);
+        ualds_settings_readstring("ServerUri", szServerUri, sizeof(szServerUri));
+        pszServerUris[i] = strdup(szServerUri);
+    }
+    ualds_settings_endarray();
+    ualds_settings_endgroup();
+
+    /* parse server details */
+    for (i = 0; i < numServers; i++)
+    {
+        if (pszServerUris[i] == 0 || pszServerUris[i][0] == 0) continue;
+        if (ualds_registry_find(pszServerUris[i]) != 0)
+        {
+            ualds_log(UALDS_LOG_WARNING, "Ignoring duplicate registered server entry %s.", pszServerUris[i]);
+            continue;
+        }
+
+        pServer = ualds_registry_add(pszServerUris[i]);
+        if (pServer == 0)
+        {
+            ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+            break;
+        }
+        ualds_registry_readserver(pServer);
+        ualds_registry_schedule(pServer);
+    }
+    g_registryGeneration++;
+
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+
+    ualds_registry_freestrings(pszServerUris, numServers);
+
+    ualds_log(UALDS_LOG_DEBUG, "Loaded %i registered servers.", g_registry.numServers);
+
+    return 0;
+}
+
+/** Removes all entries from the registry. This does not modify the settings. */
+void ualds_registry_clear(void)
+{
+    ualds_registry registry;
+    ualds_registeredserver *pServer;
+    ualds_registeredserver *pNext;
+
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+    registry = g_registry;
+    memset(&g_registry, 0, sizeof(g_registry));
+    g_registryGeneration++;
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+
+    pServer = registry.pFirst;
+    while (pServer)
+    {
+        pNext = pServer->pNext;
+        ualds_registry_freeserver(pServer);
+        pServer = pNext;
+    }
+
+    free(registry.ppBuckets);
+    free(registry.ppHeap);
+}
+
+/** Returns the number of registered servers.
+ * The caller must hold g_mutex or the read lock, this applies to all read functions.
+ */
+int ualds_registry_count(void)
+{
+    return g_registry.numServers;
+}
+
+/** Returns the registry generation, which changes with each change of the FindServers information. */
+unsigned int ualds_registry_generation(void)
+{
+    return g_registryGeneration;
+}
+
+/** Returns the first registered server. Use the \c pNext member to iterate over all entries. */
+ualds_registeredserver* ualds_registry_first(void)
+{
+    return g_registry.pFirst;
+}
+
+/** Returns the registered server with the given ServerUri or NULL if it does not exist. */
+ualds_registeredserver* ualds_registry_find(const char *szServerUri)
+{
+    ualds_registeredserver *pServer;
+
+    if (szServerUri == 0 || g_registry.numBuckets == 0) return 0;
+
+    pServer = g_registry.ppBuckets[ualds_registry_hash(szServerUri) & (g_registry.numBuckets - 1)];
+    while (pServer)
+    {
+        if (strcmp(pServer->szServerUri, szServerUri) == 0)
+        {
+            return pServer;
+        }
+        pServer = pServer->pHashNext;
+    }
+
+    return 0;
+}
+
+/** Appends \c szServerUri to the persisted "Servers" array.
+ * The entry must already be contained in the registry.
+ */
+static void ualds_registry_appendserverlist(const char *szServerUri)
+{
+    ualds_settings_begingroup("RegisteredServers");
+    ualds_settings_beginwritearray("Servers", g_registry.numServers);
+    ualds_settings_setarrayindex(g_registry.numServers - 1);
+    ualds_settings_writestring("ServerUri", szServerUri);
+    ualds_settings_endarray();
+    ualds_settings_endgroup();
+}
+
+/** Writes the settings group of \c pEntry.
+ * The mDNS information is only written if \c bMdns is set, so a RegisterServer
+ * call does not touch the information of a previous RegisterServer2 call.
+ */
+static void ualds_registry_writeserver(const ualds_registeredserver *pEntry, int bMdns)
+{
+    int i;
+
+    ualds_settings_begingroup(pEntry->szServerUri);
+
+    ualds_settings_writestring("ProductUri", pEntry->szProductUri);
+
+    ualds_settings_beginwritearray("ServerNames", pEntry->nNoOfServerNames);
+    for (i = 0; i < pEntry->nNoOfServerNames; i++)
+    {
+        ualds_settings_setarrayindex(i);
+        ualds_settings_writestring("Locale", pEntry->pServerNames[i].szLocale);
+        ualds_settings_writestring("Text", pEntry->pServerNames[i].szText);
+    }
+    ualds_settings_endarray();
+
+    ualds_settings_writeint("ServerType", pEntry->ServerType);
+    ualds_settings_writestring("GatewayServerUri", pEntry->szGatewayServerUri);
+
+    ualds_settings_beginwritearray("DiscoveryUrls", pEntry->nNoOfDiscoveryUrls);
+    for (i = 0; i < pEntry->nNoOfDiscoveryUrls; i++)
+    {
+        ualds_settings_setarrayindex(i);
+        ualds_settings_writestring("Url", pEntry->pszDiscoveryUrls[i]);
+    }
+    ualds_settings_endarray();
+
+    ualds_settings_writestring("SemaphoreFilePath", pEntry->szSemaphoreFilePath ? pEntry->szSemaphoreFilePath : "");
+    ualds_settings_writetime_t("UpdateTime", pEntry->UpdateTime);
+
+    if (bMdns)
+    {
+        ualds_settings_writestring("MdnsServerName", pEntry->szMdnsServerName);
+
+        if (pEntry->nNoOfServerCapabilities > 0)
+        {
+            ualds_settings_beginwritearray("ServerCapabilities", pEntry->nNoOfServerCapabilities);
+            for (i = 0; i < pEntry->nNoOfServerCapabilities; i++)
+            {
+                ualds_settings_setarrayindex(i);
+                ualds_settings_writestring("Capability", pEntry->pszServerCapabilities[i]);
+            }
+            ualds_settings_endarray();
+        }
+    }
+
+    ualds_settings_endgroup();
+}
+
+/** Returns 1 if \c pEntry and \c pRecord contain the same information for FindServers. */
+static int ualds_registry_samediscovery(const ualds_registeredserver *pEntry, const ualds_registeredserver *pRecord)
+{
+    int i;
+
+    if (pEntry->ServerType != pRecord->ServerType ||
+        pEntry->nNoOfServerNames != pRecord->nNoOfServerNames ||
+        pEntry->nNoOfDiscoveryUrls != pRecord->nNoOfDiscoveryUrls ||
+        strcmp(pEntry->szProductUri, pRecord->szProductUri) != 0 ||
+        strcmp(pEntry->szGatewayServerUri, pRecord->szGatewayServerUri) != 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < pEntry->nNoOfServerNames; i++)
+    {
+        if (strcmp(pEntry->pServerNames[i].szLocale, pRecord->pServerNames[i].szLocale) != 0 ||
+            strcmp(pEntry->pServerNames[i].szText, pRecord->pServerNames[i].szText) != 0)
+        {
+            return 0;
+        }
+    }
+    for (i = 0; i < pEntry->nNoOfDiscoveryUrls; i++)
+    {
+        if (strcmp(pEntry->pszDiscoveryUrls[i], pRecord->pszDiscoveryUrls[i]) != 0) return 0;
+    }
+
+    return 1;
+}
+
+/** Moves the information of \c pRecord into the registry.
+ * The new values are exchanged under the write lock, the previous values are
+ * returned in \c pRecord and freed after the lock is released, so readers never
+ * see partially updated entries.
+ * @param pRecord The new server information. This function takes ownership.
+ * @param bMdns Set if \c pRecord contains mDNS information of a RegisterServer2 call.
+ * @param pbExists Receives 1 if the server was already registered, otherwise 0.
+ * @return The registry entry or NULL if out of memory.
+ */
+static ualds_registeredserver* ualds_registry_store(ualds_registeredserver *pRecord, int bMdns, int *pbExists)
+{
+    ualds_registeredserver *pEntry;
+    ualds_registeredserver old;
+
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+
+    pEntry = ualds_registry_find(pRecord->szServerUri);
+    *pbExists = pEntry != 0;
+    if (pEntry == 0)
+    {
+        pEntry = ualds_registry_add(pRecord->szServerUri);
+        if (pEntry == 0)
+        {
+            ualds_platform_rwlock_wrunlock(&g_registryLock);
+            ualds_registry_freeserver(pRecord);
+            return 0;
+        }
+        g_registryGeneration++;
+    }
+    else if (ualds_registry_samediscovery(pEntry, pRecord) == 0)
+    {
+        g_registryGeneration++;
+    }
+
+    /* exchange the server information */
+    old = *pEntry;
+    pEntry->szProductUri = pRecord->szProductUri;
+    pEntry->pServerNames = pRecord->pServerNames;
+    pEntry->nNoOfServerNames = pRecord->nNoOfServerNames;
+    pEntry->ServerType = pRecord->ServerType;
+    pEntry->szGatewayServerUri = pRecord->szGatewayServerUri;
+    pEntry->pszDiscoveryUrls = pRecord->pszDiscoveryUrls;
+    pEntry->nNoOfDiscoveryUrls = pRecord->nNoOfDiscoveryUrls;
+    pEntry->szSemaphoreFilePath = pRecord->szSemaphoreFilePath;
+    pEntry->UpdateTime = pRecord->UpdateTime;
+    pRecord->szProductUri = old.szProductUri;
+    pRecord->pServerNames = old.pServerNames;
+    pRecord->nNoOfServerNames = old.nNoOfServerNames;
+    pRecord->szGatewayServerUri = old.szGatewayServerUri;
+    pRecord->pszDiscoveryUrls = old.pszDiscoveryUrls;
+    pRecord->nNoOfDiscoveryUrls = old.nNoOfDiscoveryUrls;
+    pRecord->szSemaphoreFilePath = old.szSemaphoreFilePath;
+
+    /* a RegisterServer call does not touch the information of a previous RegisterServer2 call */
+    if (bMdns || pEntry->szMdnsServerName == 0)
+    {
+        pEntry->szMdnsServerName = pRecord->szMdnsServerName;
+        pRecord->szMdnsServerName = old.szMdnsServerName;
+    }
+    if (bMdns && pRecord->nNoOfServerCapabilities > 0)
+    {
+        pEntry->pszServerCapabilities = pRecord->pszServerCapabilities;
+        pEntry->nNoOfServerCapabilities = pRecord->nNoOfServerCapabilities;
+        pRecord->pszServerCapabilities = old.pszServerCapabilities;
+        pRecord->nNoOfServerCapabilities = old.nNoOfServerCapabilities;
+    }
+
+    ualds_registry_schedule(pEntry);
+
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+
+    /* free the previous values */
+    ualds_registry_freeserver(pRecord);
+
+    /* update settings, this is protected by g_mutex */
+    if (*pbExists == 0)
+    {
+        ualds_registry_appendserverlist(pEntry->szServerUri);
+    }
+    ualds_registry_writeserver(pEntry, bMdns);
+
+    return pEntry;
+}
+
+/** Adds or updates the registered server described by \c pServer.
+ * The information is stored in the registry and written through to the settings engine.
+ * If the registration journal is open, the change is appended to it.
+ * @param pServer The RegisteredServer information of the RegisterServer(2) request.
+ * @param pMdnsConfig Optional mDNS configuration of a RegisterServer2 request, can be NULL.
+ * @param pbExists Receives 1 if the server was already registered, otherwise 0.
+ * @return Zero on success.
+ */
+int ualds_registry_register(const OpcUa_RegisteredServer *pServer,
+                            const OpcUa_MdnsDiscoveryConfiguration *pMdnsConfig,
+                            int *pbExists)
+{
+    ualds_registeredserver *pRecord;
+    ualds_registeredserver *pEntry;
+    int i;
+
+    *pbExists = 0;
+
+    /* prepare the new entry outside of the lock */
+    pRecord = calloc(1, sizeof(ualds_registeredserver));
+    if (pRecord == 0) return ENOMEM;
+
+    pRecord->szServerUri = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->ServerUri));
+    pRecord->szProductUri = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->ProductUri));
+    if (pServer->NoOfServerNames > 0)
+    {
+        pRecord->pServerNames = calloc(pServer->NoOfServerNames, sizeof(ualds_localizedtext));
+        if (pRecord->pServerNames == 0)
+        {
+            ualds_registry_freeserver(pRecord);
+            return ENOMEM;
+        }
+        pRecord->nNoOfServerNames = pServer->NoOfServerNames;
+        for (i = 0; i < pServer->NoOfServerNames; i++)
+        {
+            pRecord->pServerNames[i].szLocale = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->ServerNames[i].Locale));
+            pRecord->pServerNames[i].szText = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->ServerNames[i].Text));
+        }
+    }
+    pRecord->ServerType = pServer->ServerType;
+    pRecord->szGatewayServerUri = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->GatewayServerUri));
+    if (pServer->NoOfDiscoveryUrls > 0)
+    {
+        pRecord->pszDiscoveryUrls = calloc(pServer->NoOfDiscoveryUrls, sizeof(char*));
+        if (pRecord->pszDiscoveryUrls == 0)
+        {
+            ualds_registry_freeserver(pRecord);
+            return ENOMEM;
+        }
+        pRecord->nNoOfDiscoveryUrls = pServer->NoOfDiscoveryUrls;
+        for (i = 0; i < pServer->NoOfDiscoveryUrls; i++)
+        {
+            pRecord->pszDiscoveryUrls[i] = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->DiscoveryUrls[i]));
+        }
+    }
+    pRecord->szSemaphoreFilePath = ualds_registry_strdup(OpcUa_String_GetRawString(&pServer->SemaphoreFilePath));
+    pRecord->UpdateTime = time(0);
+    if (pMdnsConfig)
+    {
+        pRecord->szMdnsServerName = ualds_registry_strdup(OpcUa_String_GetRawString(&pMdnsConfig->MdnsServerName));
+        if (pMdnsConfig->NoOfServerCapabilities > 0)
+        {
+            pRecord->pszServerCapabilities = calloc(pMdnsConfig->NoOfServerCapabilities, sizeof(char*));
+            if (pRecord->pszServerCapabilities == 0)
+            {
+                ualds_registry_freeserver(pRecord);
+                return ENOMEM;
+            }
+            pRecord->nNoOfServerCapabilities = pMdnsConfig->NoOfServerCapabilities;
+            for (i = 0; i < pMdnsConfig->NoOfServerCapabilities; i++)
+            {
+                pRecord->pszServerCapabilities[i] = ualds_registry_strdup(OpcUa_String_GetRawString(&pMdnsConfig->ServerCapabilities[i]));
+            }
+        }
+    }
+    else
+    {
+        pRecord->szMdnsServerName = strdup("");
+    }
+
+    pEntry = ualds_registry_store(pRecord, pMdnsConfig != 0, pbExists);
+    if (pEntry == 0) return ENOMEM;
+
+    ualds_journal_register(pEntry, pMdnsConfig != 0);
+
+    return 0;
+}
+
+/** Adds or updates a registered server from a journal record.
+ * The registry takes ownership of \c pRecord, which must be allocated like
+ * the registry's own entries. The record's UpdateTime is preserved.
+ * @param pRecord The parsed server information.
+ * @param bMdns Set if the record contains mDNS information of a RegisterServer2 call.
+ * @return Zero on success.
+ */
+int ualds_registry_restore(ualds_registeredserver *pRecord, int bMdns)
+{
+    int bExists;
+
+    if (ualds_registry_store(pRecord, bMdns, &bExists) == 0) return ENOMEM;
+
+    return 0;
+}
+
+/** Removes the server \c szServerUri from the registry and removes its settings group.
+ * This does not update the persisted "Servers" array, use ualds_registry_writeserverlist
+ * after removing one or more entries.
+ */
+int ualds_registry_remove(const char *szServerUri)
+{
+    ualds_registeredserver *pServer = ualds_registry_find(szServerUri);
+    ualds_registeredserver **ppLink;
+
+    ualds_settings_removegroup(szServerUri);
+
+    if (pServer == 0) return ENOENT;
+
+    ualds_journal_remove(szServerUri);
+
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+
+    /* unlink from hash bucket */
+    ppLink = &g_registry.ppBuckets[ualds_registry_hash(szServerUri) & (g_registry.numBuckets - 1)];
+    while (*ppLink != pServer)
+    {
+        ppLink = &(*ppLink)->pHashNext;
+    }
+    *ppLink = pServer->pHashNext;
+
+    /* unlink from registration order list */
+    if (pServer->pPrev) pServer->pPrev->pNext = pServer->pNext;
+    else g_registry.pFirst = pServer->pNext;
+    if (pServer->pNext) pServer->pNext->pPrev = pServer->pPrev;
+    else g_registry.pLast = pServer->pPrev;
+
+    ualds_registry_heapremove(pServer);
+    g_registry.numServers--;
+    g_registryGeneration++;
+
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+
+    ualds_registry_freeserver(pServer);
+
+    return 0;
+}
+
+/** Writes the list of registered servers to the "Servers" array of the settings. */
+int ualds_registry_writeserverlist(void)
+{
+    ualds_registeredserver *pServer;
+    int pos = 0;
+
+    ualds_settings_begingroup("RegisteredServers");
+    ualds_settings_removearray("Servers");
+    ualds_settings_beginwritearray("Servers", g_registry.numServers);
+    for (pServer = g_registry.pFirst; pServer; pServer = pServer->pNext)
+    {
+        ualds_settings_setarrayindex(pos++);
+        ualds_settings_writestring("ServerUri", pServer->szServerUri);
+    }
+    ualds_settings_endarray();
+    ualds_settings_endgroup();
+
+    return 0;
+}
+
+/** Removes the server \c szServerUri from the registry and updates the settings accordingly. */
+int ualds_registry_unregister(const char *szServerUri)
+{
+    int ret = ualds_registry_remove(szServerUri);
+
+    ualds_registry_writeserverlist();
+
+    return ret;
+}
+
+/** Returns the registered server with the lowest ExpiryTime or NULL if no entry can expire. */
+ualds_registeredserver* ualds_registry_nextexpiration(void)
+{
+    return g_registry.numHeap > 0 ? g_registry.ppHeap[0] : 0;
+}
+
+/** Sets the time of the next expiration check of \c pServer.
+ * This is used for entries with a semaphore file, which still exists.
+ */
+void ualds_registry_reschedule(ualds_registeredserver *pServer, time_t checkTime)
+{
+    if (pServer->iHeapIndex < 0) return;
+
+    ualds_platform_rwlock_wrlock(&g_registryLock);
+    pServer->ExpiryTime = checkTime;
+    ualds_registry_heapfix(pServer->iHeapIndex);
+    ualds_platform_rwlock_wrunlock(&g_registryLock);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,101 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+#ifndef __REGISTRY_H__
+#define __REGISTRY_H__
+
+/* system includes */
+#include <time.h>
+/* uastack includes */
+#include <opcua_proxystub.h>
+#include <opcua_types.h>
+
+/** A localized server name of a registered server. */
+struct _ualds_localizedtext
+{
+    char *szLocale;
+    char *szText;
+};
+typedef struct _ualds_localizedtext ualds_localizedtext;
+
+/** In-memory representation of one registered server.
+ * This mirrors the information persisted in the server's settings group,
+ * but in parsed form, so the service handlers don't need to go through
+ * the settings engine on each request.
+ * Strings which are not set in the settings file are empty strings,
+ * except \c szSemaphoreFilePath which is NULL if the key does not exist.
+ */
+struct _ualds_registeredserver
+{
+    char                 *szServerUri;
+    char                 *szProductUri;
+    int                   nNoOfServerNames;
+    ualds_localizedtext  *pServerNames;
+    int                   ServerType;
+    char                 *szGatewayServerUri;
+    int                   nNoOfDiscoveryUrls;
+    char                **pszDiscoveryUrls;
+    char                 *szSemaphoreFilePath;
+    time_t                UpdateTime;
+    char                 *szMdnsServerName;
+    int                   nNoOfServerCapabilities;
+    char                **pszServerCapabilities;
+    time_t                ExpiryTime; /**< the entry must be checked for expiration after this time */
+
+    /* internal list management, don't touch */
+    int                             iHeapIndex; /**< position in expiration heap, -1 if not contained */
+    struct _ualds_registeredserver *pHashNext;  /**< next entry in same hash bucket */
+    struct _ualds_registeredserver *pPrev;      /**< previous entry in registration order */
+    struct _ualds_registeredserver *pNext;      /**< next entry in registration order */
+};
+typedef struct _ualds_registeredserver ualds_registeredserver;
+
+int ualds_registry_initialize(void);
+void ualds_registry_cleanup(void);
+void ualds_registry_lockread(void);
+void ualds_registry_unlockread(void);
+void ualds_registry_setmaxage(int maxAge);
+int ualds_registry_load(void);
+void ualds_registry_clear(void);
+int ualds_registry_count(void);
+unsigned int ualds_registry_generation(void);
+ualds_registeredserver* ualds_registry_first(void);
+ualds_registeredserver* ualds_registry_find(const char *szServerUri);
+int ualds_registry_register(const OpcUa_RegisteredServer *pServer,
+                            const OpcUa_MdnsDiscoveryConfiguration *pMdnsConfig,
+                            int *pbExists);
+void ualds_registry_freeserver(ualds_registeredserver *pServer);
+int ualds_registry_restore(ualds_registeredserver *pRecord, int bMdns);
+int ualds_registry_remove(const char *szServerUri);
+int ualds_registry_writeserverlist(void);
+int ualds_registry_unregister(const char *szServerUri);
+ualds_registeredserver* ualds_registry_nextexpiration(void);
+void ualds_registry_reschedule(ualds_registeredserver *pServer, time_t checkTime);
+
+#endif /* __REGISTRY_H__ */
@@ -0,0 +1,427 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+
+/**
+ * \addtogroup rejected Rejected Certificate Store
+ * @{
+ *
+ *  Client certificates which are not trusted are saved in the rejected folder
+ *  of the certificate store as <SHA1 thumbprint>.der, so an administrator can
+ *  move them into the trust list.
+ *
+ *  The folder is scanned once on startup. Afterwards all certificates in the folder
+ *  are known from an in-memory index, which is maintained when certificates are added
+ *  or removed by the LDS itself:
+ *  - A hash table by thumbprint finds certificates which are already saved, these are not written again.
+ *  - A binary min-heap ordered by the creation time finds the oldest certificate,
+ *    which is removed when the folder is full or the certificate is older than the maximum age.
+ *
+ *  Certificates which are removed from the folder by somebody else stay in the index
+ *  until they are evicted, or until the same certificate is rejected again.
+ *
+ *  Thread safety: All functions are protected by an internal mutex.
+ */
+
+/* system includes */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/* uastack includes */
+#include <opcua_serverstub.h>
+#include <opcua_core.h>
+/* openssl includes */
+#if OPCUA_SUPPORT_PKI
+#include <openssl/sha.h>
+#endif /* OPCUA_SUPPORT_PKI */
+/* local includes */
+#include "config.h"
+#include "rejected.h"
+/* local platform includes */
+#include <platform.h>
+#include <log.h>
+
+#define REJECTED_INITIAL_BUCKETS 64
+#define REJECTED_THUMBPRINT_LENGTH 40
+#define REJECTED_SECONDS_PER_DAY 86400
+
+/** One certificate in the rejected folder. */
+struct _ualds_rejectedcert
+{
+    char                            szThumbprint[REJECTED_THUMBPRINT_LENGTH + 1];
+    time_t                          CreationTime;
+    int                             iHeapIndex; /**< position in the age heap */
+    struct _ualds_rejectedcert     *pHashNext;  /**< next entry in same hash bucket */
+};
+typedef struct _ualds_rejectedcert ualds_rejectedcert;
+
+struct _ualds_rejectedstore
+{
+    char                 szPath[PATH_MAX];
+    int                  maxCertificates;
+    int                  maxAgeDays;
+    ualds_rejectedcert **ppBuckets;
+    unsigned int         numBuckets;
+    ualds_rejectedcert **ppHeap;      /**< age heap, has the capacity of numBuckets */
+    int                  numHeap;     /**< number of certificates */
+};
+typedef struct _ualds_rejectedstore ualds_rejectedstore;
+
+static ualds_rejectedstore g_rejected;
+static OpcUa_Mutex         g_hRejectedMutex = OpcUa_Null;
+
+/** FNV-1a string hash. */
+static unsigned int ualds_rejected_hash(const char *szKey)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*szKey)
+    {
+        hash ^= (unsigned char)*szKey++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/** Doubles the number of hash buckets and redistributes all entries. */
+static int ualds_rejected_grow(void)
+{
+    unsigned int numBuckets = g_rejected.numBuckets ? g_rejected.numBuckets * 2 : REJECTED_INITIAL_BUCKETS;
+    ualds_rejectedcert **ppBuckets = calloc(numBuckets, sizeof(ualds_rejectedcert*));
+    ualds_rejectedcert **ppHeap;
+    ualds_rejectedcert *pCert;
+    unsigned int index;
+    int i;
+
+    if (ppBuckets == 0) return -1;
+
+    /* the heap contains all entries, so it grows with the hash table */
+    ppHeap = realloc(g_rejected.ppHeap, numBuckets * sizeof(ualds_rejectedcert*));
+    if (ppHeap == 0)
+    {
+        free(ppBuckets);
+        return -1;
+    }
+    g_rejected.ppHeap = ppHeap;
+
+    for (i = 0; i < g_rejected.numHeap; i++)
+    {
+        pCert = g_rejected.ppHeap[i];
+        index = ualds_rejected_hash(pCert->szThumbprint) & (numBuckets - 1);
+        pCert->pHashNext = ppBuckets[index];
+        ppBuckets[index] = pCert;
+    }
+
+    free(g_rejected.ppBuckets);
+    g_rejected.ppBuckets = ppBuckets;
+    g_rejected.numBuckets = numBuckets;
+
+    return 0;
+}
+
+static ualds_rejectedcert* ualds_rejected_find(const char *szThumbprint)
+{
+    ualds_rejectedcert *pCert;
+
+    if (g_rejected.numBuckets == 0) return 0;
+
+    pCert = g_rejected.ppBuckets[ualds_rejected_hash(szThumbprint) & (g_rejected.numBuckets - 1)];
+    while (pCert && strcmp(pCert->szThumbprint, szThumbprint) != 0)
+    {
+        pCert = pCert->pHashNext;
+    }
+
+    return pCert;
+}
+
+static void ualds_rejected_heapset(int index, ualds_rejectedcert *pCert)
+{
+    g_rejected.ppHeap[index] = pCert;
+    pCert->iHeapIndex = index;
+}
+
+/** Moves the heap element at \c index up or down until the heap order is restored. */
+static void ualds_rejected_heapfix(int index)
+{
+    ualds_rejectedcert *pCert = g_rejected.ppHeap[index];
+    int parent, child;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+        if (g_rejected.ppHeap[parent]->CreationTime <= pCert->CreationTime) break;
+        ualds_rejected_heapset(index, g_rejected.ppHeap[parent]);
+        index = parent;
+    }
+
+    while ((child = 2 * index + 1) < g_rejected.numHeap)
+    {
+        if (child + 1 < g_rejected.numHeap &&
+            g_rejected.ppHeap[child + 1]->CreationTime < g_rejected.ppHeap[child]->CreationTime)
+        {
+            child++;
+        }
+        if (pCert->CreationTime <= g_rejected.ppHeap[child]->CreationTime) break;
+        ualds_rejected_heapset(index, g_rejected.ppHeap[child]);
+        index = child;
+    }
+
+    ualds_rejected_heapset(index, pCert);
+}
+
+/** Adds a certificate to the index. */
+static int ualds_rejected_insert(const char *szThumbprint, time_t creationTime)
+{
+    ualds_rejectedcert *pCert;
+    unsigned int index;
+
+    if ((unsigned int)g_rejected.numHeap >= g_rejected.numBuckets)
+    {
+        if (ualds_rejected_grow() != 0) return -1;
+    }
+
+    pCert = malloc(sizeof(ualds_rejectedcert));
+    if (pCert == 0) return -1;
+    strlcpy(pCert->szThumbprint, szThumbprint, sizeof(pCert->szThumbprint));
+    pCert->CreationTime = creationTime;
+
+    index = ualds_rejected_hash(szThumbprint) & (g_rejected.numBuckets - 1);
+    pCert->pHashNext = g_rejected.ppBuckets[index];
+    g_rejected.ppBuckets[index] = pCert;
+
+    ualds_rejected_heapset(g_rejected.numHeap++, pCert);
+    ualds_rejected_heapfix(pCert->iHeapIndex);
+
+    return 0;
+}
+
+/** Removes a certificate from the index and frees it. */
+static void ualds_rejected_unlink(ualds_rejectedcert *pCert)
+{
+    ualds_rejectedcert **ppCert;
+    ualds_rejectedcert *pLast;
+    int index = pCert->iHeapIndex;
+
+    ppCert = &g_rejected.ppBuckets[ualds_rejected_hash(pCert->szThumbprint) & (g_rejected.numBuckets - 1)];
+    while (*ppCert != pCert) ppCert = &(*ppCert)->pHashNext;
+    *ppCert = pCert->pHashNext;
+
+    pLast = g_rejected.ppHeap[--g_rejected.numHeap];
+    if (pLast != pCert)
+    {
+        ualds_rejected_heapset(index, pLast);
+        ualds_rejected_heapfix(index);
+    }
+
+    free(pCert);
+}
+
+static void ualds_rejected_filepath(char *szPath, size_t len, const char *szThumbprint)
+{
+    strlcpy(szPath, g_rejected.szPath, len);
+    strlcat(szPath, "/", len);
+    strlcat(szPath, szThumbprint, len);
+    strlcat(szPath, ".der", len);
+}
+
+/** File filter for scandir, accepts <thumbprint>.der files. */
+static int ualds_rejected_filefilter(const struct ualds_dirent *entry)
+{
+    size_t len = strlen(entry->d_name);
+    return (len == REJECTED_THUMBPRINT_LENGTH + 4 && strcmp(entry->d_name + REJECTED_THUMBPRINT_LENGTH, ".der") == 0);
+}
+
+/** Removes the oldest certificates until there is room for one more certificate
+ * and all remaining certificates are younger than the maximum age.
+ */
+static void ualds_rejected_evict(time_t now)
+{
+    ualds_rejectedcert *pOldest;
+    char szPath[PATH_MAX];
+
+    while (g_rejected.numHeap > 0)
+    {
+        pOldest = g_rejected.ppHeap[0];
+        if (g_rejected.numHeap >= g_rejected.maxCertificates)
+        {
+            ualds_log(UALDS_LOG_DEBUG, "Reached maximum number of rejected certificates.");
+        }
+        else if ((now - pOldest->CreationTime) / REJECTED_SECONDS_PER_DAY > g_rejected.maxAgeDays)
+        {
+            ualds_log(UALDS_LOG_DEBUG, "Reached maximum age of rejected certificates.");
+        }
+        else
+        {
+            break;
+        }
+
+        ualds_rejected_filepath(szPath, sizeof(szPath), pOldest->szThumbprint);
+        ualds_log(UALDS_LOG_DEBUG, "Removing certificate %s.der from rejected folder.", pOldest->szThumbprint);
+        ualds_platform_rm(szPath);
+        ualds_rejected_unlink(pOldest);
+    }
+}
+
+/** Scans the rejected folder and builds the index.
+ * @param szRejectedPath The rejected folder.
+ * @param maxCertificates Maximum number of certificates in the folder.
+ * @param maxAgeDays Certificates older than this are removed when the next certificate is saved.
+ * @return Zero on success.
+ */
+int ualds_rejected_open(const char *szRejectedPath, int maxCertificates, int maxAgeDays)
+{
+    struct ualds_dirent **namelist;
+    struct ualds_stat statF;
+    char szPath[PATH_MAX];
+    char szThumbprint[REJECTED_THUMBPRINT_LENGTH + 1];
+    int numFiles, i;
+
+    if (g_hRejectedMutex != OpcUa_Null) ualds_rejected_close();
+
+    if (OpcUa_IsBad(OpcUa_Mutex_Create(&g_hRejectedMutex)))
+    {
+        g_hRejectedMutex = OpcUa_Null;
+        return -1;
+    }
+
+    memset(&g_rejected, 0, sizeof(g_rejected));
+    strlcpy(g_rejected.szPath, szRejectedPath, sizeof(g_rejected.szPath));
+    g_rejected.maxCertificates = maxCertificates;
+    g_rejected.maxAgeDays = maxAgeDays;
+
+    numFiles = ualds_platform_scandir(g_rejected.szPath, &namelist, ualds_rejected_filefilter, 0);
+    if (numFiles == -1) return 0;
+
+    for (i = 0; i < numFiles; i++)
+    {
+        strlcpy(szThumbprint, namelist[i]->d_name, sizeof(szThumbprint));
+        ualds_rejected_filepath(szPath, sizeof(szPath), szThumbprint);
+        if (ualds_platform_stat(szPath, &statF) == 0)
+        {
+            ualds_rejected_insert(szThumbprint, statF.st_ctime);
+        }
+        free(namelist[i]);
+    }
+    free(namelist);
+
+    ualds_log(UALDS_LOG_DEBUG, "Found %i certificates in rejected folder.", g_rejected.numHeap);
+
+    return 0;
+}
+
+/** Frees the index, the certificate files are kept. */
+void ualds_rejected_close(void)
+{
+    int i;
+
+    if (g_hRejectedMutex == OpcUa_Null) return;
+
+    for (i = 0; i < g_rejected.numHeap; i++)
+    {
+        free(g_rejected.ppHeap[i]);
+    }
+    free(g_rejected.ppHeap);
+    free(g_rejected.ppBuckets);
+    memset(&g_rejected, 0, sizeof(g_rejected));
+
+    OpcUa_Mutex_Delete(&g_hRejectedMutex);
+}
+
+/** Saves a rejected certificate in the rejected folder, unless it is already there.
+ * Old certificates are removed first to stay within the configured limits.
+ */
+void ualds_rejected_add(const OpcUa_ByteString *pCertificate)
+{
+#if OPCUA_SUPPORT_PKI
+    unsigned char hash[20];
+    char szThumbprint[REJECTED_THUMBPRINT_LENGTH + 1];
+    char szPath[PATH_MAX];
+    ualds_rejectedcert *pCert;
+    struct ualds_stat statF;
+    UALDS_FILE *f;
+    time_t now = time(0);
+    int i, j;
+    unsigned char h, l;
+
+    if (g_hRejectedMutex == OpcUa_Null) return;
+    if (pCertificate == OpcUa_Null) return;
+    if (pCertificate->Length <= 0) return;
+    if (pCertificate->Data == OpcUa_Null) return;
+
+    /* compute SHA1 hash from certificate data */
+    SHA1(pCertificate->Data, pCertificate->Length, hash);
+    for (i = 0, j = 0; i < 20; i++)
+    {
+        h = (hash[i] >> 4);
+        l = (hash[i] & 0xf);
+        /* hex string conversion */
+        szThumbprint[j++] = h > 9 ? 'A' + h - 10 : '0' + h;
+        szThumbprint[j++] = l > 9 ? 'A' + l - 10 : '0' + l;
+    }
+    szThumbprint[j++] = 0;
+    ualds_rejected_filepath(szPath, sizeof(szPath), szThumbprint);
+
+    OpcUa_Mutex_Lock(g_hRejectedMutex);
+
+    pCert = ualds_rejected_find(szThumbprint);
+    if (pCert)
+    {
+        /* already saved, unless the file was moved e.g. into the trust list */
+        if (ualds_platform_stat(szPath, &statF) == 0)
+        {
+            OpcUa_Mutex_Unlock(g_hRejectedMutex);
+            return;
+        }
+        ualds_rejected_unlink(pCert);
+    }
+
+    ualds_rejected_evict(now);
+
+    f = ualds_platform_fopen(szPath, "wb");
+    if (f)
+    {
+        ualds_platform_fwrite(pCertificate->Data, pCertificate->Length, 1, f);
+        ualds_platform_fclose(f);
+        ualds_rejected_insert(szThumbprint, now);
+    }
+    else
+    {
+        ualds_log(UALDS_LOG_ERR, "Failed to write certificate into rejected folder.");
+    }
+
+    OpcUa_Mutex_Unlock(g_hRejectedMutex);
+#else
+    OpcUa_ReferenceParameter(pCertificate);
+#endif /* OPCUA_SUPPORT_PKI */
+}
+
+/**
+ * @}
+ */
@@ -84,6 +84,7 @@ struct _Entry
     char *pszValue;
     int   parent; /* parent entry index, -1 if the entry has no parent. */
     int   line;   /* line no in config file */
+    int   next;   /* next entry index in the same hash bucket, -1 if this is the last one. */
 };
 typedef struct _Entry Entry;
 
@@ -95,17 +96,24 @@ struct _FileSettings
     int    iArrayIndex;
     Entry *pEntries;
     int    numEntries;
+    int    numRemoved;  /* number of removed entries (tombstones) in pEntries */
     int    EntrySize;
     int    index;
     int    CurrentGroup;
     int    modified;
     int    readOnly;  // if this is 1, we never write to the configuration file!
+    int   *pHashTable;  /* hash index of sections and keys, contains the first entry index of each bucket */
+    int    HashSize;    /* number of hash buckets, always a power of two */
+    int    HashValid;   /* 0 if the hash index must be rebuilt before the next lookup */
 };
 typedef struct _FileSettings FileSettings;
 
 #define ENTRY_STEP_SIZE 10
+#define HASH_MIN_SIZE 64
 
 static FileSettings g_settings;
+/** set if the settings were loaded from the backup file */
+static int g_bRestoredFromBackup = 0;
 
 /**
  * @brief Splits \c pszString into a string array using the separator \c cSep.
@@ -240,9 +248,56 @@ static char *trim(char *szText)
     return szText;
 }
 
+/** Removes all tombstones from the entry array and renumbers the parent indices.
+ * This invalidates all entry indices, so it must only be called when no entry index
+ * is held other than CurrentGroup, which gets updated.
+ */
+static void UaServer_FSBE_Compact(FileSettings *pFS)
+{
+    int *pNewIndex;
+    int i, pos = 0;
+    Entry *pEntry;
+
+    pNewIndex = malloc(pFS->numEntries * sizeof(int));
+    if (pNewIndex == 0) return;
+
+    /* move all valid entries to the front */
+    for (i = 0; i < pFS->numEntries; i++)
+    {
+        pEntry = &pFS->pEntries[i];
+        if (pEntry->type == Invalid)
+        {
+            pNewIndex[i] = -1;
+            continue;
+        }
+        pNewIndex[i] = pos;
+        if (pos != i) pFS->pEntries[pos] = *pEntry;
+        pos++;
+    }
+    pFS->numEntries = pos;
+    pFS->numRemoved = 0;
+
+    /* now correct "parent" of all entries, removed parents become -1 */
+    for (i = 0; i < pFS->numEntries; i++)
+    {
+        pEntry = &pFS->pEntries[i];
+        if (pEntry->parent != -1) pEntry->parent = pNewIndex[pEntry->parent];
+    }
+    if (pFS->CurrentGroup != -1) pFS->CurrentGroup = pNewIndex[pFS->CurrentGroup];
+
+    free(pNewIndex);
+
+    pFS->HashValid = 0;
+}
+
 static Entry* UaServer_FSBE_AddEntry(FileSettings *pFS)
 {
     Entry *pRet = 0;
+    if (pFS->EntrySize == pFS->numEntries && pFS->numRemoved > pFS->numEntries / 4)
+    {
+        /* reclaim removed entries instead of growing the array */
+        UaServer_FSBE_Compact(pFS);
+    }
     if (pFS->EntrySize == pFS->numEntries)
     {
         void *tmp = realloc(pFS->pEntries, (pFS->EntrySize+ENTRY_STEP_SIZE)*sizeof(Entry));
@@ -262,73 +317,182 @@ static Entry* UaServer_FSBE_AddEntry(FileSettings *pFS)
     pRet->pszKey = 0;
     pRet->pszValue = 0;
     pRet->parent = -1;
+    pRet->next = -1;
 
     pFS->numEntries++;
 
     return pRet;
 }
 
-static void UaServer_FSBE_RemoveEntry(FileSettings *pFS, int index)
+/** Computes the hash index value of a section or key using FNV-1a. */
+static unsigned int UaServer_FSBE_Hash(const char *szKey, int parent)
 {
-    Entry *pEntry = &pFS->pEntries[index];
+    unsigned int hash = 2166136261u ^ (unsigned int)parent;
 
-    if (pEntry->pszKey)
+    while (*szKey)
     {
-        free(pEntry->pszKey);
-        pEntry->pszKey = 0;
+        hash ^= (unsigned char)*szKey++;
+        hash *= 16777619u;
     }
-    if (pEntry->pszValue)
+
+    return hash;
+}
+
+/** Returns true if the entry type is part of the hash index. */
+#define UaServer_FSBE_IsHashed(pEntry) ((pEntry)->type == KeyValuePair || ((pEntry)->type == Section && (pEntry)->parent == -1))
+
+/** Adds the entry \c index to the hash index. */
+static void UaServer_FSBE_HashInsert(FileSettings *pFS, int index)
+{
+    Entry *pEntry = &pFS->pEntries[index];
+    unsigned int bucket;
+
+    if (!pFS->HashValid) return; /* gets indexed on the next rebuild */
+    if (pEntry->pszKey == 0) return;
+
+    if (pFS->numEntries > pFS->HashSize)
     {
-        free(pEntry->pszValue);
-        pEntry->pszValue = 0;
+        /* keep the load factor below one */
+        pFS->HashValid = 0;
+        return;
     }
 
-    // Move all following entries to this entry...
+    bucket = UaServer_FSBE_Hash(pEntry->pszKey, pEntry->parent) & (pFS->HashSize - 1);
+    pEntry->next = pFS->pHashTable[bucket];
+    pFS->pHashTable[bucket] = index;
+}
+
+/** Recreates the hash index for all entries.
+ * On allocation failure the index stays invalid and lookups fall back to a linear search.
+ */
+static void UaServer_FSBE_RebuildHash(FileSettings *pFS)
+{
+    int size = HASH_MIN_SIZE;
     int i;
-    for (i = index; i < pFS->numEntries - 1; i++)
+    unsigned int bucket;
+    Entry *pEntry;
+
+    while (size < 2 * pFS->numEntries) size *= 2;
+
+    if (size != pFS->HashSize)
     {
-        Entry *pEntryFrom = &pFS->pEntries[i + 1];
-        Entry *pEntryTo = &pFS->pEntries[i];
+        int *pTable = realloc(pFS->pHashTable, size * sizeof(int));
+        if (pTable == 0) return;
+        pFS->pHashTable = pTable;
+        pFS->HashSize = size;
+    }
 
-        *pEntryTo = *pEntryFrom;  // assign all values directly
+    for (i = 0; i < pFS->HashSize; i++)
+    {
+        pFS->pHashTable[i] = -1;
+    }
 
-        pEntryFrom->pszKey = 0;
-        pEntryFrom->pszValue = 0;
-        pEntryFrom->type = Invalid;
-        pEntryFrom->parent = -1;
-        pEntryFrom->line = 0;
+    /* insert in reverse order, so that each bucket chain is sorted by entry index */
+    for (i = pFS->numEntries - 1; i >= 0; i--)
+    {
+        pEntry = &pFS->pEntries[i];
+        pEntry->next = -1;
+        if (!UaServer_FSBE_IsHashed(pEntry) || pEntry->pszKey == 0) continue;
+
+        bucket = UaServer_FSBE_Hash(pEntry->pszKey, pEntry->parent) & (pFS->HashSize - 1);
+        pEntry->next = pFS->pHashTable[bucket];
+        pFS->pHashTable[bucket] = i;
     }
 
-    pFS->numEntries--; // we have now one entry less...
-    /*assert(*pFS->numEntries >= 0);*/
+    pFS->HashValid = 1;
+}
+
+/** Frees the hash index. */
+static void UaServer_FSBE_ClearHash(FileSettings *pFS)
+{
+    free(pFS->pHashTable);
+    pFS->pHashTable = 0;
+    pFS->HashSize = 0;
+    pFS->HashValid = 0;
+}
 
-    // be sure the last entry is cleared
-    Entry *pEntryToClear = &pFS->pEntries[pFS->numEntries];
+/** Returns the index of the first entry of the given type with matching key and parent, or -1. */
+static int UaServer_FSBE_Lookup(FileSettings *pFS, EntryType type, const char *szKey, int parent)
+{
+    int i;
+    int found = -1;
+    Entry *pEntry;
 
-    pEntryToClear->pszKey = 0;
-    pEntryToClear->pszValue = 0;
-    pEntryToClear->type = Invalid;
-    pEntryToClear->parent = -1;
-    pEntryToClear->line = 0;
+    if (!pFS->HashValid) UaServer_FSBE_RebuildHash(pFS);
 
-    // now correct "parent" of all entries...
-    int i2;
-    for (i2 = 0; i2 < pFS->numEntries; i2++)
+    if (pFS->HashValid)
     {
-        pEntry = &pFS->pEntries[i2];
-        if (pEntry->parent != -1)
+        i = pFS->pHashTable[UaServer_FSBE_Hash(szKey, parent) & (pFS->HashSize - 1)];
+        while (i != -1)
         {
-            if (pEntry->parent == index)
-            {
-                // we just removed this parent...
-                pEntry->parent = -1;
-            }
-            else if (pEntry->parent > index)
+            pEntry = &pFS->pEntries[i];
+            /* chains are not strictly sorted after inserts, so look for the lowest index */
+            if (pEntry->type == type
+                && pEntry->parent == parent
+                && (found == -1 || i < found)
+                && strcmp(pEntry->pszKey, szKey) == 0)
             {
-                pEntry->parent--;  // This entry has moved; now one less...
+                found = i;
             }
+            i = pEntry->next;
+        }
+        return found;
+    }
+
+    /* fallback if the hash index could not be allocated */
+    for (i=0; i<pFS->numEntries; i++)
+    {
+        if (pFS->pEntries[i].type == type
+            && pFS->pEntries[i].parent == parent
+            && pFS->pEntries[i].pszKey
+            && strcmp(pFS->pEntries[i].pszKey, szKey) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/** Removes the entry \c index.
+ * The entry stays in the array as tombstone, so all entry indices stay valid.
+ * Tombstones are reclaimed by UaServer_FSBE_Compact.
+ */
+static void UaServer_FSBE_RemoveEntry(FileSettings *pFS, int index)
+{
+    Entry *pEntry = &pFS->pEntries[index];
+    int *pLink;
+
+    if (pEntry->type == Invalid) return;
+
+    /* unlink from hash index */
+    if (pFS->HashValid && UaServer_FSBE_IsHashed(pEntry) && pEntry->pszKey)
+    {
+        pLink = &pFS->pHashTable[UaServer_FSBE_Hash(pEntry->pszKey, pEntry->parent) & (pFS->HashSize - 1)];
+        while (*pLink != -1 && *pLink != index)
+        {
+            pLink = &pFS->pEntries[*pLink].next;
         }
+        if (*pLink == index) *pLink = pEntry->next;
+    }
+
+    if (pEntry->pszKey)
+    {
+        free(pEntry->pszKey);
+        pEntry->pszKey = 0;
+    }
+    if (pEntry->pszValue)
+    {
+        free(pEntry->pszValue);
+        pEntry->pszValue = 0;
     }
+
+    pEntry->type = Invalid;
+    pEntry->parent = -1;
+    pEntry->next = -1;
+    pEntry->line = 0;
+
+    pFS->numRemoved++;
 }
 
 static Entry* UaServer_FSBE_AddKeyValuePair(FileSettings *pFS, const char *szKey, const char *szValue)
@@ -339,6 +503,9 @@ static Entry* UaServer_FSBE_AddKeyValuePair(FileSettings *pFS, const char *szKey
         pEntry->type = KeyValuePair;
         pEntry->pszKey = strdup(szKey);
         pEntry->pszValue = (szValue == 0) ? strdup("(null)") : strdup(szValue);
+        /* AddEntry may compact the entries, so CurrentGroup is only read afterwards */
+        pEntry->parent = pFS->CurrentGroup;
+        UaServer_FSBE_HashInsert(pFS, pFS->numEntries - 1);
     }
     return pEntry;
 }
@@ -371,44 +538,19 @@ static Entry* UaServer_FSBE_AddSection(FileSettings *pFS, const char *szSection)
     {
         pEntry->type = Section;
         pEntry->pszKey = strdup(szSection);
+        UaServer_FSBE_HashInsert(pFS, pFS->numEntries - 1);
     }
     return pEntry;
 }
 
 static int UaServer_FSBE_FindKey(FileSettings *pFS, const char *szKey, int parent)
 {
-    int i;
-
-    for (i=0; i<pFS->numEntries; i++)
-    {
-        if (pFS->pEntries[i].type == KeyValuePair
-            && pFS->pEntries[i].parent == parent
-            && pFS->pEntries[i].pszKey
-            && strcmp(pFS->pEntries[i].pszKey, szKey) == 0)
-        {
-            return i;
-        }
-    }
-
-    return -1;
+    return UaServer_FSBE_Lookup(pFS, KeyValuePair, szKey, parent);
 }
 
 static int UaServer_FSBE_FindSection(FileSettings *pFS, const char *szSection)
 {
-    int i;
-
-    for (i=0; i<pFS->numEntries; i++)
-    {
-        if (pFS->pEntries[i].type == Section
-            && pFS->pEntries[i].parent == -1
-            && pFS->pEntries[i].pszKey
-            && strcmp(pFS->pEntries[i].pszKey, szSection) == 0)
-        {
-            return i;
-        }
-    }
-
-    return -1;
+    return UaServer_FSBE_Lookup(pFS, Section, szSection, -1);
 }
 
 static int UaServer_FSBE_ParseConfigFile(char* path)
@@ -510,7 +652,6 @@ static int UaServer_FSBE_ParseConfigFile(char* path)
             pEntry = UaServer_FSBE_AddKeyValuePair(pFS, pszKey, pszValue);
             if (pEntry)
             {
-                pEntry->parent = pFS->CurrentGroup;
                 pEntry->line = iLine;
             }
             else
@@ -532,62 +673,202 @@ static int UaServer_FSBE_ParseConfigFile(char* path)
     return 0;
 }
 
-static void UaServer_FSBE_WriteConfigFile_Descriptor(FileSettings *pFS, UALDS_FILE *f)
+/** Returns the number of characters needed to write the entry to the configuration file. */
+static size_t UaServer_FSBE_EntryLength(const Entry *pEntry)
 {
+    switch (pEntry->type)
+    {
+    case KeyValuePair:
+        return strlen(pEntry->pszKey) + strlen(pEntry->pszValue) + 4; /* "key = value\n" */
+    case CommentLine:
+        return strlen(pEntry->pszKey);
+    case EmptyLine:
+        return 1;
+    case Section:
+        return strlen(pEntry->pszKey) + 3; /* "[section]\n" */
+    default:
+        return 0;
+    }
+}
+
+/** Writes the entry in configuration file format to \c pszText and returns the end of the written text. */
+static char* UaServer_FSBE_PrintEntry(const Entry *pEntry, char *pszText)
+{
+    size_t len;
+
+    switch (pEntry->type)
+    {
+    case KeyValuePair:
+        len = strlen(pEntry->pszKey);
+        memcpy(pszText, pEntry->pszKey, len);
+        pszText += len;
+        memcpy(pszText, " = ", 3);
+        pszText += 3;
+        len = strlen(pEntry->pszValue);
+        memcpy(pszText, pEntry->pszValue, len);
+        pszText += len;
+        *pszText++ = '\n';
+        break;
+    case CommentLine:
+        len = strlen(pEntry->pszKey);
+        memcpy(pszText, pEntry->pszKey, len);
+        pszText += len;
+        break;
+    case EmptyLine:
+        *pszText++ = '\n';
+        break;
+    case Section:
+        *pszText++ = '[';
+        len = strlen(pEntry->pszKey);
+        memcpy(pszText, pEntry->pszKey, len);
+        pszText += len;
+        *pszText++ = ']';
+        *pszText++ = '\n';
+        break;
+    default:
+        break;
+    }
+
+    return pszText;
+}
+
+/** Creates the content of the configuration file in one contiguous buffer.
+ * All global keys are written first, followed by each section and its entries.
+ * The entries of each section are grouped in a single pass, so this is linear
+ * in the number of entries.
+ *
+ * @param pFS The settings to write.
+ * @param pLen Returns the length of the text, without the terminating zero.
+ * @return Zero-terminated text which must be freed by the caller, or NULL if out of memory.
+ */
+static char* UaServer_FSBE_Serialize(FileSettings *pFS, size_t *pLen)
+{
+    int *pFirstChild;
+    int *pNextChild;
     int i, j;
-    if (f)
+    size_t len = 0;
+    char *pszText, *pszPos;
+    Entry *pEntry;
+
+    pFirstChild = malloc((2 * pFS->numEntries + 1) * sizeof(int));
+    if (pFirstChild == 0) return 0;
+    pNextChild = pFirstChild + pFS->numEntries;
+
+    /* build the list of children for each section, in reverse to keep the file order */
+    for (i = pFS->numEntries - 1; i >= 0; i--)
     {
-        /* write all global keys */
-        for (i = 0; i<pFS->numEntries; i++)
-        {
-            if (pFS->pEntries[i].parent != -1) continue;
+        pFirstChild[i] = -1;
+    }
+    for (i = pFS->numEntries - 1; i >= 0; i--)
+    {
+        pEntry = &pFS->pEntries[i];
+        pNextChild[i] = -1;
+        if (pEntry->type == Invalid) continue;
 
-            switch (pFS->pEntries[i].type)
-            {
-            case KeyValuePair:
-                ualds_platform_fprintf(f, "%s = %s\n", pFS->pEntries[i].pszKey, pFS->pEntries[i].pszValue);
-                break;
-            case CommentLine:
-                ualds_platform_fprintf(f, "%s", pFS->pEntries[i].pszKey);
-                break;
-            case EmptyLine:
-                ualds_platform_fprintf(f, "\n");
-                break;
-            default:
-                break;
-            }
+        if (pEntry->parent == -1)
+        {
+            len += UaServer_FSBE_EntryLength(pEntry);
         }
-
-        /* write all sections */
-        for (i = 0; i<pFS->numEntries; i++)
+        else if (pFS->pEntries[pEntry->parent].type == Section)
         {
-            if (pFS->pEntries[i].type == Section)
-            {
-                ualds_platform_fprintf(f, "[%s]\n", pFS->pEntries[i].pszKey);
+            len += UaServer_FSBE_EntryLength(pEntry);
+            pNextChild[i] = pFirstChild[pEntry->parent];
+            pFirstChild[pEntry->parent] = i;
+        }
+    }
+
+    pszText = malloc(len + 1);
+    if (pszText == 0)
+    {
+        free(pFirstChild);
+        return 0;
+    }
+    pszPos = pszText;
 
-                /* write all entries for this section */
-                for (j = 0; j<pFS->numEntries; j++)
-                {                    
-                    if (pFS->pEntries[j].parent != i) continue;
+    /* write all global keys */
+    for (i = 0; i < pFS->numEntries; i++)
+    {
+        pEntry = &pFS->pEntries[i];
+        if (pEntry->parent != -1 || pEntry->type == Section) continue;
+        pszPos = UaServer_FSBE_PrintEntry(pEntry, pszPos);
+    }
 
-                    switch (pFS->pEntries[j].type)
-                    {
-                    case KeyValuePair:
-                        ualds_platform_fprintf(f, "%s = %s\n", pFS->pEntries[j].pszKey, pFS->pEntries[j].pszValue);
-                        break;
-                    case CommentLine:
-                        ualds_platform_fprintf(f, "%s", pFS->pEntries[j].pszKey);
-                        break;
-                    case EmptyLine:
-                        ualds_platform_fprintf(f, "\n");
-                        break;
-                    default:
-                        break;
-                    }
-                }
-            }
+    /* write all sections */
+    for (i = 0; i < pFS->numEntries; i++)
+    {
+        if (pFS->pEntries[i].type != Section) continue;
+
+        pszPos = UaServer_FSBE_PrintEntry(&pFS->pEntries[i], pszPos);
+
+        /* write all entries for this section */
+        for (j = pFirstChild[i]; j != -1; j = pNextChild[j])
+        {
+            pszPos = UaServer_FSBE_PrintEntry(&pFS->pEntries[j], pszPos);
         }
     }
+    *pszPos = 0;
+
+    free(pFirstChild);
+
+    *pLen = (size_t)(pszPos - pszText);
+    return pszText;
+}
+
+/** Writes the settings to \c szPath.
+ * The file content is written to a temporary file first, which is synced to disk
+ * and then replaces \c szPath. So the file is always complete, even if the process
+ * crashes during write.
+ * @param szBackupPath If not NULL, the previous version of the file is kept as backup.
+ */
+static int UaServer_FSBE_SaveFile(FileSettings *pFS, const char *szPath, const char *szBackupPath)
+{
+    char szTmpPath[PATH_MAX];
+    char *pszText;
+    size_t len;
+    UALDS_FILE *f;
+    int ret = 0;
+
+    pszText = UaServer_FSBE_Serialize(pFS, &len);
+    if (pszText == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Could not write configuration file '%s': out of memory.", szPath);
+        return ENOMEM;
+    }
+
+    strlcpy(szTmpPath, szPath, sizeof(szTmpPath));
+    strlcat(szTmpPath, ".tmp", sizeof(szTmpPath));
+
+    f = ualds_platform_fopen(szTmpPath, "w");
+    if (f == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Could not create temporary configuration file '%s'.", szTmpPath);
+        free(pszText);
+        return EIO;
+    }
+
+    if (ualds_platform_fwrite(pszText, 1, len, f) != len ||
+        ualds_platform_fsync(f) != 0)
+    {
+        ret = EIO;
+    }
+    if (ualds_platform_fclose(f) != 0)
+    {
+        ret = EIO;
+    }
+    free(pszText);
+
+    if (ret == 0 && ualds_platform_replacefile(szPath, szTmpPath, szBackupPath) != 0)
+    {
+        ret = EIO;
+    }
+
+    if (ret != 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "Could not write configuration file '%s'.", szPath);
+        remove(szTmpPath);
+    }
+
+    return ret;
 }
 
 static int UaServer_FSBE_WriteConfigFile(void)
@@ -597,20 +878,13 @@ static int UaServer_FSBE_WriteConfigFile(void)
         return EPERM;
     }
 
-    UALDS_FILE *f_backup = ualds_platform_fopen(pFS->szPathBackup, "w");
-    if (f_backup)
+    if (UaServer_FSBE_SaveFile(pFS, pFS->szPath, pFS->szPathBackup) != 0)
     {
-        UaServer_FSBE_WriteConfigFile_Descriptor(pFS, f_backup);
-        ualds_platform_fclose(f_backup);
+        return EIO;
     }
 
-    UALDS_FILE *f_master = ualds_platform_fopen(pFS->szPath, "w");
-    if (f_master)
-    {
-        UaServer_FSBE_WriteConfigFile_Descriptor(pFS, f_master);
-        ualds_platform_fclose(f_master);
-    }
-    
+    pFS->modified = 0;
+
     return 0;
 }
 
@@ -621,12 +895,7 @@ void ualds_settings_update_config_file(void)
 {
     FileSettings *pFS = &g_settings;
 
-    UALDS_FILE *f_master = ualds_platform_fopen(pFS->szPath, "w");
-    if (f_master)
-    {
-        UaServer_FSBE_WriteConfigFile_Descriptor(pFS, f_master);
-        ualds_platform_fclose(f_master);
-    }
+    UaServer_FSBE_SaveFile(pFS, pFS->szPath, 0);
 }
 
 /* It will check if teh configuration is corrupt.
@@ -723,6 +992,47 @@ static int checkConfigConsistency(void)
         }
     }
 
+    // GENERAL/PersistenceMode
+    char tmpMode[32];
+    retCode = ualds_settings_readstring("PersistenceMode", tmpMode, sizeof(tmpMode));
+    if (retCode == 0)
+    {
+        if (strcmp(tmpMode, "sync") != 0 && strcmp(tmpMode, "batched") != 0)
+        {
+            return -1;
+        }
+    }
+
+    // GENERAL/PersistenceInterval
+    retCode = ualds_settings_readint("PersistenceInterval", &tmpVal);
+    if (retCode == 0)
+    {
+        if (tmpVal <= 0)
+        {
+            return -1;
+        }
+    }
+
+    // GENERAL/Journal
+    retCode = ualds_settings_readstring("Journal", tmpMode, sizeof(tmpMode));
+    if (retCode == 0)
+    {
+        if (strcmp(tmpMode, "yes") != 0 && strcmp(tmpMode, "no") != 0)
+        {
+            return -1;
+        }
+    }
+
+    // GENERAL/JournalMaxSize
+    retCode = ualds_settings_readint("JournalMaxSize", &tmpVal);
+    if (retCode == 0)
+    {
+        if (tmpVal <= 0)
+        {
+            return -1;
+        }
+    }
+
     // GENERAL
     retCode = ualds_settings_endgroup();
     if (retCode != 0)
@@ -1097,6 +1407,63 @@ static int checkConfigConsistency(void)
         }
     }
 
+    // Log/LogAsync [optional]
+    retCode = ualds_settings_readstring("LogAsync", tmpString, UALDS_CONF_MAX_URI_LENGTH);
+    if (retCode == 0)
+    {
+        if ((strcmp(tmpString, "yes") != 0) &&
+            (strcmp(tmpString, "no") != 0)
+            )
+        {
+            return -1;
+        }
+    }
+
+    // Log/LogAsyncQueueSize [optional]
+    retCode = ualds_settings_readint("LogAsyncQueueSize", &tmpVal);
+    if (retCode == 0)
+    {
+        if (tmpVal <= 0)
+        {
+            return -1;
+        }
+    }
+
+    // Log/TraceRing [optional]
+    retCode = ualds_settings_readstring("TraceRing", tmpString, UALDS_CONF_MAX_URI_LENGTH);
+    if (retCode == 0)
+    {
+        if ((strcmp(tmpString, "off") != 0) &&
+            (strcmp(tmpString, "error") != 0) &&
+            (strcmp(tmpString, "warn") != 0) &&
+            (strcmp(tmpString, "info") != 0) &&
+            (strcmp(tmpString, "debug") != 0)
+            )
+        {
+            return -1;
+        }
+    }
+
+    // Log/TraceRingSize [optional]
+    retCode = ualds_settings_readint("TraceRingSize", &tmpVal);
+    if (retCode == 0)
+    {
+        if (tmpVal <= 0 || tmpVal > 1048576)
+        {
+            return -1;
+        }
+    }
+
+    // Log/TraceRingFile [optional]
+    retCode = ualds_settings_readstring("TraceRingFile", tmpString, PATH_MAX);
+    if (retCode == 0)
+    {
+        if (strlen(tmpString) <= 0)
+        {
+            return -1;
+        }
+    }
+
     // Log
     retCode = ualds_settings_endgroup();
     if (retCode != 0)
@@ -1142,6 +1509,84 @@ static int checkConfigConsistency(void)
 
     // ---------------------------------------------------------
 
+    // ThreadPool [optional]
+    retCode = ualds_settings_begingroup("ThreadPool");
+    if (retCode == 0)
+    {
+        // ThreadPool/Enabled [optional]
+        retCode = ualds_settings_readstring("Enabled", tmpString, UALDS_CONF_MAX_URI_LENGTH);
+        if (retCode == 0)
+        {
+            if ((strcmp(tmpString, "yes") != 0) &&
+                (strcmp(tmpString, "no") != 0)
+                )
+            {
+                return -1;
+            }
+        }
+
+        // ThreadPool/MinThreads [optional]
+        retCode = ualds_settings_readint("MinThreads", &tmpVal);
+        if (retCode == 0)
+        {
+            if (tmpVal < 0)
+            {
+                return -1;
+            }
+        }
+
+        // ThreadPool/MaxThreads [optional]
+        retCode = ualds_settings_readint("MaxThreads", &tmpVal);
+        if (retCode == 0)
+        {
+            if (tmpVal <= 0)
+            {
+                return -1;
+            }
+        }
+
+        // ThreadPool/MaxJobs [optional]
+        retCode = ualds_settings_readint("MaxJobs", &tmpVal);
+        if (retCode == 0)
+        {
+            if (tmpVal <= 0)
+            {
+                return -1;
+            }
+        }
+
+        // ThreadPool/BlockOnAdd [optional]
+        retCode = ualds_settings_readstring("BlockOnAdd", tmpString, UALDS_CONF_MAX_URI_LENGTH);
+        if (retCode == 0)
+        {
+            if ((strcmp(tmpString, "yes") != 0) &&
+                (strcmp(tmpString, "no") != 0)
+                )
+            {
+                return -1;
+            }
+        }
+
+        // ThreadPool/Timeout [optional]
+        retCode = ualds_settings_readint("Timeout", &tmpVal);
+        if (retCode == 0)
+        {
+            if (tmpVal <= 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    // ThreadPool
+    retCode = ualds_settings_endgroup();
+    if (retCode != 0)
+    {
+        return -1;
+    }
+
+    // ---------------------------------------------------------
+
     // RegisteredServers
     retCode = ualds_settings_begingroup("RegisteredServers");
     if (retCode != 0)
@@ -1612,6 +2057,32 @@ static void loadDefaultSettings(void)
     retCode = ualds_settings_writeint("ReadOnlyCfg", 1);
     retCode = ualds_settings_addemptyline();
 
+    // General/PersistenceMode
+    retCode = ualds_settings_addcomment("# PersistenceMode: (default=sync) defines when changes of the registered servers are written to this file.");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("# sync: the file is written on each registration. batched: changes are collected and written every");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("# PersistenceInterval seconds (default=5) and on shutdown. Registrations since the last write are lost on a crash.");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("#PersistenceMode = batched");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("#PersistenceInterval = 5");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addemptyline();
+
+    // General/Journal
+    retCode = ualds_settings_addcomment("# Journal: (default=no) if enabled, registration changes are appended to the file <this file>.journal");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("# instead of rewriting this file. The journal is applied on startup and merged into this file when it");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("# exceeds JournalMaxSize kilobytes (default=1024).");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("#Journal = yes");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addcomment("#JournalMaxSize = 1024");
+    retCode = ualds_settings_addemptyline();
+    retCode = ualds_settings_addemptyline();
+
     // General
     retCode = ualds_settings_endgroup();
    
@@ -2003,6 +2474,7 @@ int ualds_settings_open(const char *szFilename)
     strlcat(g_settings.szPathBackup, ".bak", PATH_MAX);
 
     g_settings.CurrentGroup = -1;
+    g_bRestoredFromBackup = 0;
     UaServer_FSBE_ParseConfigFile(g_settings.szPath);
 
     // check if everything is ok
@@ -2036,6 +2508,7 @@ int ualds_settings_open_from_backup(const char *szFilename)
     strlcat(g_settings.szPathBackup, ".bak", PATH_MAX);
 
     g_settings.CurrentGroup = -1;
+    g_bRestoredFromBackup = 1;
     UaServer_FSBE_ParseConfigFile(g_settings.szPathBackup);
 
     return 0;
@@ -2048,6 +2521,7 @@ int ualds_settings_open_from_default(const char *szFilename)
     strlcpy(g_settings.szPathBackup, g_settings.szPath, PATH_MAX);
     strlcat(g_settings.szPathBackup, ".bak", PATH_MAX);
 
+    g_bRestoredFromBackup = 0;
     loadDefaultSettings();
 
     return 0;
@@ -2059,8 +2533,25 @@ int ualds_settings_open_from_default(const char *szFilename)
  */
 int ualds_settings_flush(void)
 {
-    UaServer_FSBE_WriteConfigFile();
-    return 0;
+    return UaServer_FSBE_WriteConfigFile();
+}
+
+/** Returns 1 if the settings have been modified since they were written the last time. */
+int ualds_settings_ismodified(void)
+{
+    return g_settings.modified;
+}
+
+/** Returns the path of the settings file. */
+const char* ualds_settings_path(void)
+{
+    return g_settings.szPath;
+}
+
+/** Returns 1 if the settings were loaded from the backup file. */
+int ualds_settings_isrestored(void)
+{
+    return g_bRestoredFromBackup;
 }
 
 /** Closes the file that was previously opened by ualds_settings_open.
@@ -2116,8 +2607,11 @@ int ualds_settings_close(int flush)
         ret = EINVAL;
     }
 
+    UaServer_FSBE_ClearHash(pFS);
+
     pFS->szArrayKey = 0;
     pFS->iArrayIndex = 0;
+    pFS->numRemoved = 0;
     pFS->EntrySize = 0;
     pFS->index = 0;
     pFS->CurrentGroup = 0;
@@ -2253,11 +2747,7 @@ int ualds_settings_writestring(const char *szKey, const char *szValue)
     {
         /* add new key */
         pEntry = UaServer_FSBE_AddKeyValuePair(pFS, pszKey, szValue);
-        if (pEntry)
-        {
-            pEntry->parent = pFS->CurrentGroup;
-        }
-        else
+        if (pEntry == 0)
         {
             return -1;
         }
@@ -2482,13 +2972,13 @@ int ualds_settings_removearray(const char *szArray)
     for (i=0; i<pFS->numEntries; i++)
     {
         pEntry = &pFS->pEntries[i];
-        if (pFS->CurrentGroup == pEntry->parent &&
+        if (pEntry->type != Invalid &&
+            pFS->CurrentGroup == pEntry->parent &&
             (pEntry->type == EmptyLine ||
              pEntry->pszKey == 0 ||
              strncmp(pEntry->pszKey, szKey, len) == 0))
         {
             UaServer_FSBE_RemoveEntry(pFS, i);
-            i--;  // decrement index, so we start using the next entry, because we really removed the entry!
         }
     }
 
@@ -2517,15 +3007,11 @@ int ualds_settings_removegroup(const char *szGroup)
             if (g_settings.pEntries[i].parent == index)
             {
                 UaServer_FSBE_RemoveEntry(pFS, i);
-                if (index > i)  // this normally does not happen, because the section is first created and then the childs..
-                {
-                    index--;
-                }
-                i--;  // decrement index, so we start using the next entry, because we really removed the entry!
             }
         }
         /* remove the section */
         UaServer_FSBE_RemoveEntry(pFS, index);
+        if (pFS->CurrentGroup == index) pFS->CurrentGroup = -1;
     }
 
     pFS->modified = 1;
@@ -2536,64 +3022,13 @@ int ualds_settings_removegroup(const char *szGroup)
 void ualds_settings_dump(char* pText)
 {
     FileSettings *pFS = &g_settings;
-    int i, j;
-    char szTemp[1024];
-    /* write all global keys */
-    for (i = 0; i<pFS->numEntries; i++)
-    {
-        if (pFS->pEntries[i].parent != -1) continue;
-
-        switch (pFS->pEntries[i].type)
-        {
-        case KeyValuePair:
-            sprintf(szTemp, "%s = %s\n", pFS->pEntries[i].pszKey, pFS->pEntries[i].pszValue);
-            strcat(pText, szTemp);
-            break;
-        case CommentLine:
-            sprintf(szTemp, "%s", pFS->pEntries[i].pszKey);
-            strcat(pText, szTemp);
-            break;
-        case EmptyLine:
-            sprintf(szTemp, "\n");
-            strcat(pText, szTemp);
-            break;
-        default:
-            break;
-        }
-    }
+    size_t len;
+    char *pszText = UaServer_FSBE_Serialize(pFS, &len);
 
-    /* write all sections */
-    for (i = 0; i<pFS->numEntries; i++)
+    if (pszText)
     {
-        if (pFS->pEntries[i].type == Section)
-        {
-            sprintf(szTemp, "[%s]\n", pFS->pEntries[i].pszKey);
-            strcat(pText, szTemp);
-
-            /* write all entries for this section */
-            for (j = 0; j<pFS->numEntries; j++)
-            {
-                if (pFS->pEntries[j].parent != i) continue;
-
-                switch (pFS->pEntries[j].type)
-                {
-                case KeyValuePair:
-                    sprintf(szTemp, "%s = %s\n", pFS->pEntries[j].pszKey, pFS->pEntries[j].pszValue);
-                    strcat(pText, szTemp);
-                    break;
-                case CommentLine:
-                    sprintf(szTemp, "%s", pFS->pEntries[j].pszKey);
-                    strcat(pText, szTemp);
-                    break;
-                case EmptyLine:
-                    sprintf(szTemp, "\n");
-                    strcat(pText, szTemp);
-                    break;
-                default:
-                    break;
-                }
-            }
-        }
+        strcat(pText, pszText);
+        free(pszText);
     }
 }
 
@@ -2625,9 +3060,12 @@ void ualds_settings_clear(void)
         free(pFS->pEntries);
         pFS->pEntries = 0;
         pFS->numEntries = 0;
+        pFS->numRemoved = 0;
         pFS->EntrySize = 0;
         pFS->modified = 0;
     }
+
+    UaServer_FSBE_ClearHash(pFS);
 }
 
 
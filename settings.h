@@ -40,6 +40,9 @@
 
 int ualds_settings_open(const char *szFilename);
 int ualds_settings_flush(void);
+int ualds_settings_ismodified(void);
+const char* ualds_settings_path(void);
+int ualds_settings_isrestored(void);
 void ualds_settings_update_config_file(void);
 int ualds_settings_close(int flush);
 int ualds_settings_begingroup(const char *szGroup);
@@ -33,6 +33,7 @@
 #include <getopt.h>
 #include <limits.h>
 #include <string.h>
+#include <errno.h>
 /* uastack includes */
 #include <opcua_serverstub.h>
 /* local includes */
@@ -280,6 +281,111 @@ void settings_test_removearray2()
     _ASSERTE(strlen(pszText) == 1711);
 }
 
+void settings_test_lookup1()
+{
+    ualds_settings_clear();
+    char szValue[256];
+    int numEndpoints = 0;
+
+    createDefaultSettings_General();
+    createDefaultSettings_CertificateInfo();
+
+    ualds_settings_begingroup("CertificateInfo");
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "US") == 0);
+    _ASSERTE(ualds_settings_readstring("ServerUri", szValue, sizeof(szValue)) == ENOENT);
+    ualds_settings_endgroup();
+
+    /* removing a group leaves its entries behind as removed entries */
+    ualds_settings_removegroup("General");
+
+    ualds_settings_begingroup("CertificateInfo");
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "US") == 0);
+    ualds_settings_writestring("Country", "DE");
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "DE") == 0);
+    ualds_settings_endgroup();
+
+    ualds_settings_begingroup("General");
+    _ASSERTE(ualds_settings_readstring("ServerUri", szValue, sizeof(szValue)) == ENOENT);
+    ualds_settings_endgroup();
+
+    /* adding the group again fills the entry array, which compacts it:
+     * all entries are renumbered and the lookup index is rebuilt */
+    createDefaultSettings_General();
+
+    ualds_settings_begingroup("General");
+    _ASSERTE(ualds_settings_readstring("ServerUri", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(ualds_settings_beginreadarray("Endpoints", &numEndpoints) == 0 && numEndpoints == 1);
+    ualds_settings_setarrayindex(0);
+    _ASSERTE(ualds_settings_readstring("Url", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "opc.tcp://[gethostname]:4840") == 0);
+    ualds_settings_endarray();
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == ENOENT);
+    ualds_settings_endgroup();
+
+    ualds_settings_begingroup("CertificateInfo");
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "DE") == 0);
+    _ASSERTE(ualds_settings_readstring("CommonName", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "UA Local Discovery Server") == 0);
+    _ASSERTE(ualds_settings_readstring("ServerUri", szValue, sizeof(szValue)) == ENOENT);
+    ualds_settings_writestring("Country", "US");
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    _ASSERTE(strcmp(szValue, "US") == 0);
+    ualds_settings_endgroup();
+}
+
+/* Writes new keys after removing a group, so that adding an entry reclaims the
+ * removed entries and renumbers the remaining ones while the key is written. */
+void settings_test_compact1()
+{
+    ualds_settings_clear();
+    char *pszText = calloc(1 * 1024 * 1024, 1);
+    char szKey[32];
+    char szValue[256];
+    char szLine[64];
+    const int numKeys = 40;
+    int i;
+
+    createDefaultSettings_General();  // 828
+    createDefaultSettings_CertificateInfo();  // 491
+    ualds_settings_removegroup("General");
+
+    ualds_settings_begingroup("CertificateInfo");
+    for (i = 0; i < numKeys; i++)
+    {
+        sprintf(szKey, "Extra%d", i);
+        sprintf(szValue, "%d", i);
+        _ASSERTE(ualds_settings_writestring(szKey, szValue) == 0);
+    }
+    ualds_settings_endgroup();
+
+    ualds_settings_begingroup("CertificateInfo");
+    for (i = 0; i < numKeys; i++)
+    {
+        sprintf(szKey, "Extra%d", i);
+        _ASSERTE(ualds_settings_readstring(szKey, szValue, sizeof(szValue)) == 0);
+        _ASSERTE(atoi(szValue) == i);
+    }
+    _ASSERTE(ualds_settings_readstring("Country", szValue, sizeof(szValue)) == 0);
+    ualds_settings_endgroup();
+
+    /* all new keys must be written out below their section */
+    pszText[0] = 0;
+    ualds_settings_dump(pszText);
+    _ASSERTE(strncmp(pszText, "[CertificateInfo]\n", 18) == 0);
+    for (i = 0; i < numKeys; i++)
+    {
+        sprintf(szLine, "\nExtra%d = %d\n", i, i);
+        _ASSERTE(strstr(pszText, szLine) != 0);
+    }
+
+    free(pszText);
+    ualds_settings_clear();
+}
+
 void settings_doTests()
 {
     settings_test_removegroup1();
@@ -288,5 +394,9 @@ void settings_doTests()
 
     settings_test_removearray1();
     settings_test_removearray2();
+
+    settings_test_lookup1();
+
+    settings_test_compact1();
 }
 
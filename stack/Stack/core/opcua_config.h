@@ -105,6 +105,15 @@
 /** @brief Using a special mutex struct with debug information. */
 #define OPCUA_MUTEX_ERROR_CHECKING                  OPCUA_CONFIG_NO
 
+/** @brief Number of request worker threads started with the endpoint if the proxystub configuration says -1. */
+#define OPCUA_SECURELISTENER_THREADPOOL_MINTHREADS  2
+
+/** @brief Maximum number of request worker threads if the proxystub configuration says -1. */
+#define OPCUA_SECURELISTENER_THREADPOOL_MAXTHREADS  8
+
+/** @brief Maximum number of queued requests if the proxystub configuration says -1. */
+#define OPCUA_SECURELISTENER_THREADPOOL_MAXJOBS     256
+
 /*============================================================================
  * timer
  *===========================================================================*/
@@ -206,7 +215,8 @@
 #define OPCUA_TCPLISTENER_DEFAULTCHUNKSIZE          ((OpcUa_UInt32)65536)
 #define OPCUA_TCPCONNECTION_DEFAULTCHUNKSIZE        ((OpcUa_UInt32)65536)
 
-/** @brief The maximum number of client connections supported by a tcp listener. (maybe one reserved, see below) */
+/** @brief The default maximum number of client connections supported by a tcp listener. (maybe one reserved, see below)
+ *  Overridden at runtime by OpcUa_ProxyStubConfiguration.iTcpListener_MaxConnections. */
 #ifndef OPCUA_TCPLISTENER_MAXCONNECTIONS
 #define OPCUA_TCPLISTENER_MAXCONNECTIONS            100
 #endif
@@ -217,12 +227,12 @@
 /** @brief Reserve one of the OPCUA_TCPLISTENER_MAXCONNECTIONS for an "MaxConnectionsReached" error channel?. */
 #define OPCUA_TCPLISTENER_USEEXTRAMAXCONNSOCKET     OPCUA_CONFIG_NO
 
-/** @brief The maximum number of sockets supported by a socket manager. */
+/** @brief The number of sockets supported by a socket manager if the creator does not request a limit. */
 #ifndef OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS
 #define OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS       110
 #endif
 
-/** @brief The maximum number of socket managers in multithreading config, supported by the socket module. */
+/** @brief The minimum number of spawned socket managers in multithreading config, supported by a socket manager. */
 #ifndef OPCUA_SOCKET_MAXMANAGERS
 #define OPCUA_SOCKET_MAXMANAGERS                    110
 #endif
@@ -129,6 +129,17 @@ OPCUA_EXPORT OpcUa_Void       OPCUA_DLLCALL OpcUa_ThreadCleanupOpenSSL( void);
 OPCUA_EXPORT OpcUa_StatusCode OPCUA_DLLCALL OpcUa_OpenSSLSeedPRNG(      OpcUa_Byte*  pEntropy,
                                                                         OpcUa_UInt32 nBytes);
 
+/* Trace */
+/** @brief Receives the unformatted arguments of a trace call. The argument list is only valid during the call. */
+typedef OpcUa_Void (OPCUA_DLLCALL OpcUa_Trace_PfnRecord)(             OpcUa_UInt32                uTraceLevel,
+                                                                        const OpcUa_CharA*          sFormat,
+                                                                        varg_list                   vaArguments);
+
+/** @brief Registers a hook which gets every trace call of the given levels before it is formatted,
+ *  independent of the trace output level. Pass OpcUa_Null to remove the hook. */
+OPCUA_EXPORT OpcUa_Void       OPCUA_DLLCALL OpcUa_Trace_SetRecordHook(  OpcUa_Trace_PfnRecord*      pfRecord,
+                                                                        OpcUa_UInt32                uRecordLevel);
+
 /* StringA */
 OPCUA_EXPORT OpcUa_Int32      OPCUA_DLLCALL OpcUa_StringA_vsnprintf(    OpcUa_StringA               sDest,
                                                                         OpcUa_UInt32                uCount,
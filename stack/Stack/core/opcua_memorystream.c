@@ -101,6 +101,49 @@ OpcUa_StatusCode OpcUa_MemoryStream_Read(
     return OpcUa_Buffer_Read(handle->pBuffer, buffer, count);
 }
 
+/*============================================================================
+ * OpcUa_MemoryStream_GetReadWindow
+ *===========================================================================*/
+static
+OpcUa_StatusCode OpcUa_MemoryStream_GetReadWindow(
+    OpcUa_InputStream*             istrm,
+    OpcUa_UInt32                   consumed,
+    OpcUa_Byte**                   data,
+    OpcUa_UInt32*                  count)
+{
+    OpcUa_MemoryStream* handle = OpcUa_Null;
+    OpcUa_Buffer*       buffer = OpcUa_Null;
+    OpcUa_StatusCode    uStatus = OpcUa_Good;
+
+    OpcUa_DeclareErrorTraceModule(OpcUa_Module_MemoryStream);
+
+    OpcUa_ReturnErrorIfArgumentNull(istrm);
+    OpcUa_ReturnErrorIfArgumentNull(data);
+    OpcUa_ReturnErrorIfArgumentNull(count);
+    OpcUa_ReturnErrorIfInvalidStream(istrm, GetReadWindow);
+
+    handle = (OpcUa_MemoryStream*)istrm->Handle;
+
+    if (handle->Closed)
+    {
+        return OpcUa_BadInvalidState;
+    }
+
+    uStatus = OpcUa_Buffer_Skip(handle->pBuffer, consumed);
+
+    if (OpcUa_IsBad(uStatus))
+    {
+        return uStatus;
+    }
+
+    buffer = (OpcUa_Buffer*)handle->pBuffer;
+
+    *data  = buffer->Data + buffer->Position;
+    *count = buffer->EndOfData - buffer->Position;
+
+    return OpcUa_Good;
+}
+
 /*============================================================================
  * OpcUa_MemoryStream_Write
  *===========================================================================*/
@@ -370,6 +413,7 @@ OpcUa_StatusCode OpcUa_MemoryStream_CreateReadable(
     (*istrm)->Close             = OpcUa_MemoryStream_Close;
     (*istrm)->Delete            = OpcUa_MemoryStream_Delete;
     (*istrm)->Read              = OpcUa_MemoryStream_Read;
+    (*istrm)->GetReadWindow     = OpcUa_MemoryStream_GetReadWindow;
     (*istrm)->AttachBuffer      = OpcUa_MemoryStream_AttachBuffer;
     (*istrm)->DetachBuffer      = OpcUa_MemoryStream_DetachBuffer;
     (*istrm)->GetChunkLength    = OpcUa_MemoryStream_GetChunkLength;
@@ -44,7 +44,7 @@
 # define OPCUA_PROXYSTUB_STATICCONFIGSTRING "default"
 #endif /* OPCUA_PROXYSTUB_STATICCONFIGSTRING */
 
-#define OPCUA_CONFIG_STRING_SIZE    800
+#define OPCUA_CONFIG_STRING_SIZE    1024
 
 OpcUa_Port_CallTable*               OpcUa_ProxyStub_g_PlatformLayerCalltable;
 OpcUa_ProxyStubConfiguration        OpcUa_ProxyStub_g_Configuration;
@@ -126,6 +126,8 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_MaxConnections", OpcUa_ProxyStub_g_Configuration.iTcpListener_MaxConnections);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpConnection_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpConnection_DefaultChunkSize);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpTransport_MaxMessageLength", OpcUa_ProxyStub_g_Configuration.iTcpTransport_MaxMessageLength);
@@ -169,6 +171,8 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "UpdateConfigString");
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
+    iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpListener_MaxConnections", OpcUa_ProxyStub_g_Configuration.iTcpListener_MaxConnections);
+    if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpConnection_DefaultChunkSize", OpcUa_ProxyStub_g_Configuration.iTcpConnection_DefaultChunkSize);
     if(iRes > 0){iPos += iRes;}else{OpcUa_GotoErrorWithStatus(OpcUa_BadOutOfMemory);}
     iRes = OpcUa_SnPrintfA(&OpcUa_ProxyStub_g_pConfigString[iPos], OPCUA_CONFIG_STRING_SIZE - iPos, "%s:%i\\", "iTcpTransport_MaxMessageLength", OpcUa_ProxyStub_g_Configuration.iTcpTransport_MaxMessageLength);
@@ -240,10 +244,30 @@ OpcUa_InitializeStatus(OpcUa_Module_ProxyStub, "ReInitialize");
     {
         OpcUa_ProxyStub_g_Configuration.iSerializer_MaxRecursionDepth            = OPCUA_ENCODER_MAXRECURSIONDEPTH;
     }
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MinThreads < 0)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MinThreads    = OPCUA_SECURELISTENER_THREADPOOL_MINTHREADS;
+    }
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxThreads <= 0)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxThreads    = OPCUA_SECURELISTENER_THREADPOOL_MAXTHREADS;
+    }
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxThreads < OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MinThreads)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxThreads    = OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MinThreads;
+    }
+    if(OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxJobs <= 0)
+    {
+        OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxJobs       = OPCUA_SECURELISTENER_THREADPOOL_MAXJOBS;
+    }
     if(OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize == -1)
     {
         OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize            = OPCUA_TCPLISTENER_DEFAULTCHUNKSIZE;
     }
+    if(OpcUa_ProxyStub_g_Configuration.iTcpListener_MaxConnections <= 0)
+    {
+        OpcUa_ProxyStub_g_Configuration.iTcpListener_MaxConnections              = OPCUA_TCPLISTENER_MAXCONNECTIONS;
+    }
     if(OpcUa_ProxyStub_g_Configuration.iTcpConnection_DefaultChunkSize == -1)
     {
         OpcUa_ProxyStub_g_Configuration.iTcpConnection_DefaultChunkSize          = OPCUA_TCPCONNECTION_DEFAULTCHUNKSIZE;
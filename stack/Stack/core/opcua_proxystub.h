@@ -76,23 +76,25 @@ typedef struct _OpcUa_ProxyStubConfiguration
     /** The maximum encodable object recursion depth. */
     OpcUa_Int32     iSerializer_MaxRecursionDepth;
 
-    /** This value is ignored. */
+    /** If true, each endpoint dispatches decoded requests to a pool of worker threads instead of calling the service handler on the listener thread. */
     OpcUa_Boolean   bSecureListener_ThreadPool_Enabled;
-    /** This value is ignored. */
+    /** The number of worker threads started with the endpoint. */
     OpcUa_Int32     iSecureListener_ThreadPool_MinThreads;
-    /** This value is ignored. */
+    /** The maximum number of worker threads; more are started while all workers are busy. */
     OpcUa_Int32     iSecureListener_ThreadPool_MaxThreads;
-    /** This value is ignored. */
+    /** The maximum number of requests waiting for a worker thread. */
     OpcUa_Int32     iSecureListener_ThreadPool_MaxJobs;
-    /** This value is ignored. */
+    /** If true, the listener thread waits for a free queue entry; otherwise requests exceeding MaxJobs are rejected with BadTooManyOperations. */
     OpcUa_Boolean   bSecureListener_ThreadPool_BlockOnAdd;
-    /** This value is ignored. */
+    /** The maximum time in milliseconds the listener thread waits for a free queue entry if BlockOnAdd is set. */
     OpcUa_UInt32    uSecureListener_ThreadPool_Timeout;
 
     /** If true, the TcpListener request a thread per client from the underlying socketmanager. Must not work with all platform layers. */
     OpcUa_Boolean   bTcpListener_ClientThreadsEnabled;
     /** The default and maximum size for message chunks in the server. Affects network performance and memory usage. */
     OpcUa_Int32     iTcpListener_DefaultChunkSize;
+    /** The maximum number of concurrent client connections per TcpListener. The socket table grows on demand up to this limit. */
+    OpcUa_Int32     iTcpListener_MaxConnections;
 
     /** The default (and requested) size for message chunks. Affects network performance and memory usage. */
     OpcUa_Int32     iTcpConnection_DefaultChunkSize;
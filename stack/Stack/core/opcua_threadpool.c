@@ -0,0 +1,344 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* base */
+#include <opcua.h>
+
+/* core */
+#include <opcua_mutex.h>
+#include <opcua_semaphore.h>
+#include <opcua_thread.h>
+
+/* self */
+#include <opcua_threadpool.h>
+
+/*============================================================================
+ * OpcUa_ThreadPoolJob
+ *===========================================================================*/
+/** @brief A queued function call. */
+typedef struct _OpcUa_ThreadPoolJob
+{
+    /** @brief The function to execute. */
+    OpcUa_PfnThreadPoolJobMain*     pfJob;
+    /** @brief The argument for the function. */
+    OpcUa_Void*                     pArgument;
+} OpcUa_ThreadPoolJob;
+
+/*============================================================================
+ * OpcUa_ThreadPoolInternal
+ *===========================================================================*/
+typedef struct _OpcUa_ThreadPoolInternal
+{
+    /** @brief Synchronizes access to the queue and the thread list. */
+    OpcUa_Mutex             Mutex;
+    /** @brief Counts queued jobs (and stop requests) for the workers. */
+    OpcUa_Semaphore         JobsAvailable;
+    /** @brief Counts free entries in the job queue. */
+    OpcUa_Semaphore         SlotsAvailable;
+    /** @brief Ring buffer holding uMaxJobs entries. */
+    OpcUa_ThreadPoolJob*    pJobs;
+    /** @brief Index of the oldest queued job. */
+    OpcUa_UInt32            uFirstJob;
+    /** @brief Number of queued jobs. */
+    OpcUa_UInt32            uNoOfJobs;
+    /** @brief Size of the job queue. */
+    OpcUa_UInt32            uMaxJobs;
+    /** @brief Worker threads; uMaxThreads entries of which uNoOfThreads are used. */
+    OpcUa_Thread*           pThreads;
+    /** @brief Number of started worker threads. */
+    OpcUa_UInt32            uNoOfThreads;
+    /** @brief Number of worker threads not executing a job. */
+    OpcUa_UInt32            uNoOfIdleThreads;
+    /** @brief Upper limit for uNoOfThreads. */
+    OpcUa_UInt32            uMaxThreads;
+    /** @brief Wait for a free queue entry in AddJob. */
+    OpcUa_Boolean           bBlockIfFull;
+    /** @brief Maximum time to wait for a free queue entry. */
+    OpcUa_UInt32            uTimeout;
+    /** @brief Set by Delete; workers exit once the queue is empty. */
+    OpcUa_Boolean           bShutdown;
+} OpcUa_ThreadPoolInternal;
+
+/*============================================================================
+ * OpcUa_ThreadPool_WorkerMain
+ *===========================================================================*/
+static
+OpcUa_Void OpcUa_ThreadPool_WorkerMain(OpcUa_Void* a_pArgument)
+{
+    OpcUa_ThreadPoolInternal*   pThreadPool = (OpcUa_ThreadPoolInternal*)a_pArgument;
+    OpcUa_ThreadPoolJob         Job;
+
+    for(;;)
+    {
+        OPCUA_P_SEMAPHORE_WAIT(pThreadPool->JobsAvailable);
+
+        OPCUA_P_MUTEX_LOCK(pThreadPool->Mutex);
+
+        if(pThreadPool->uNoOfJobs == 0)
+        {
+            /* no job but a stop request from OpcUa_ThreadPool_Delete */
+            pThreadPool->uNoOfIdleThreads--;
+            OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+            break;
+        }
+
+        Job = pThreadPool->pJobs[pThreadPool->uFirstJob];
+        pThreadPool->uFirstJob = (pThreadPool->uFirstJob + 1) % pThreadPool->uMaxJobs;
+        pThreadPool->uNoOfJobs--;
+        pThreadPool->uNoOfIdleThreads--;
+
+        OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+
+        OPCUA_P_SEMAPHORE_POST(pThreadPool->SlotsAvailable, 1);
+
+        Job.pfJob(Job.pArgument);
+
+        OPCUA_P_MUTEX_LOCK(pThreadPool->Mutex);
+        pThreadPool->uNoOfIdleThreads++;
+        OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+    }
+}
+
+/*============================================================================
+ * OpcUa_ThreadPool_StartThread
+ *===========================================================================*/
+/* INFO: Pool is locked during this call. */
+static
+OpcUa_StatusCode OpcUa_ThreadPool_StartThread(OpcUa_ThreadPoolInternal* a_pThreadPool)
+{
+    OpcUa_Thread hThread = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Thread, "ThreadPool_StartThread");
+
+    uStatus = OpcUa_Thread_Create(&hThread, OpcUa_ThreadPool_WorkerMain, a_pThreadPool);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* count the new thread as idle before it runs to keep AddJob from overprovisioning */
+    a_pThreadPool->uNoOfIdleThreads++;
+
+    uStatus = OpcUa_Thread_Start(hThread);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    a_pThreadPool->pThreads[a_pThreadPool->uNoOfThreads++] = hThread;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(hThread != OpcUa_Null)
+    {
+        a_pThreadPool->uNoOfIdleThreads--;
+        OpcUa_Thread_Delete(&hThread);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_ThreadPool_Create
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_ThreadPool_Create(   OpcUa_ThreadPool*   a_phThreadPool,
+                                            OpcUa_UInt32        a_uMinThreads,
+                                            OpcUa_UInt32        a_uMaxThreads,
+                                            OpcUa_UInt32        a_uMaxJobs,
+                                            OpcUa_Boolean       a_bBlockIfFull,
+                                            OpcUa_UInt32        a_uTimeout)
+{
+    OpcUa_ThreadPoolInternal*   pThreadPool = OpcUa_Null;
+    OpcUa_UInt32                uIndex      = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Thread, "ThreadPool_Create");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_phThreadPool);
+    OpcUa_ReturnErrorIfTrue(a_uMaxThreads == 0, OpcUa_BadInvalidArgument);
+    OpcUa_ReturnErrorIfTrue(a_uMaxJobs == 0, OpcUa_BadInvalidArgument);
+    OpcUa_ReturnErrorIfTrue(a_uMinThreads > a_uMaxThreads, OpcUa_BadInvalidArgument);
+
+    *a_phThreadPool = OpcUa_Null;
+
+    pThreadPool = (OpcUa_ThreadPoolInternal*)OpcUa_Alloc(sizeof(OpcUa_ThreadPoolInternal));
+    OpcUa_ReturnErrorIfAllocFailed(pThreadPool);
+    OpcUa_MemSet(pThreadPool, 0, sizeof(OpcUa_ThreadPoolInternal));
+
+    pThreadPool->uMaxJobs       = a_uMaxJobs;
+    pThreadPool->uMaxThreads    = a_uMaxThreads;
+    pThreadPool->bBlockIfFull   = a_bBlockIfFull;
+    pThreadPool->uTimeout       = a_uTimeout;
+
+    pThreadPool->pJobs = (OpcUa_ThreadPoolJob*)OpcUa_Alloc(a_uMaxJobs * sizeof(OpcUa_ThreadPoolJob));
+    OpcUa_GotoErrorIfAllocFailed(pThreadPool->pJobs);
+
+    pThreadPool->pThreads = (OpcUa_Thread*)OpcUa_Alloc(a_uMaxThreads * sizeof(OpcUa_Thread));
+    OpcUa_GotoErrorIfAllocFailed(pThreadPool->pThreads);
+
+    uStatus = OPCUA_P_MUTEX_CREATE(&pThreadPool->Mutex);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    /* every queued job and every stop request posts once */
+    uStatus = OPCUA_P_SEMAPHORE_CREATE(&pThreadPool->JobsAvailable, 0, a_uMaxJobs + a_uMaxThreads);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OPCUA_P_SEMAPHORE_CREATE(&pThreadPool->SlotsAvailable, a_uMaxJobs, a_uMaxJobs);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OPCUA_P_MUTEX_LOCK(pThreadPool->Mutex);
+    for(uIndex = 0; uIndex < a_uMinThreads && OpcUa_IsGood(uStatus); uIndex++)
+    {
+        uStatus = OpcUa_ThreadPool_StartThread(pThreadPool);
+    }
+    OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_phThreadPool = (OpcUa_ThreadPool)pThreadPool;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    OpcUa_ThreadPool_Delete((OpcUa_ThreadPool*)&pThreadPool);
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_ThreadPool_Delete
+ *===========================================================================*/
+OpcUa_Void OpcUa_ThreadPool_Delete(OpcUa_ThreadPool* a_phThreadPool)
+{
+    OpcUa_ThreadPoolInternal*   pThreadPool = OpcUa_Null;
+    OpcUa_UInt32                uIndex      = 0;
+
+    if(a_phThreadPool == OpcUa_Null || *a_phThreadPool == OpcUa_Null)
+    {
+        return;
+    }
+
+    pThreadPool = (OpcUa_ThreadPoolInternal*)*a_phThreadPool;
+    *a_phThreadPool = OpcUa_Null;
+
+    if(pThreadPool->Mutex != OpcUa_Null)
+    {
+        OPCUA_P_MUTEX_LOCK(pThreadPool->Mutex);
+        pThreadPool->bShutdown = OpcUa_True;
+        OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+
+        /* the workers finish the queued jobs before they see the stop requests */
+        if(pThreadPool->uNoOfThreads > 0)
+        {
+            OPCUA_P_SEMAPHORE_POST(pThreadPool->JobsAvailable, pThreadPool->uNoOfThreads);
+        }
+
+        for(uIndex = 0; uIndex < pThreadPool->uNoOfThreads; uIndex++)
+        {
+            OpcUa_Thread_WaitForShutdown(pThreadPool->pThreads[uIndex], OPCUA_INFINITE);
+            OpcUa_Thread_Delete(&pThreadPool->pThreads[uIndex]);
+        }
+
+        OPCUA_P_MUTEX_DELETE(&pThreadPool->Mutex);
+    }
+
+    if(pThreadPool->JobsAvailable != OpcUa_Null)
+    {
+        OPCUA_P_SEMAPHORE_DELETE(&pThreadPool->JobsAvailable);
+    }
+
+    if(pThreadPool->SlotsAvailable != OpcUa_Null)
+    {
+        OPCUA_P_SEMAPHORE_DELETE(&pThreadPool->SlotsAvailable);
+    }
+
+    OpcUa_Free(pThreadPool->pThreads);
+    OpcUa_Free(pThreadPool->pJobs);
+    OpcUa_Free(pThreadPool);
+}
+
+/*============================================================================
+ * OpcUa_ThreadPool_AddJob
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_ThreadPool_AddJob(   OpcUa_ThreadPool            a_hThreadPool,
+                                            OpcUa_PfnThreadPoolJobMain* a_pfJob,
+                                            OpcUa_Void*                 a_pArgument)
+{
+    OpcUa_ThreadPoolInternal*   pThreadPool = (OpcUa_ThreadPoolInternal*)a_hThreadPool;
+    OpcUa_UInt32                uLastJob    = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_Thread, "ThreadPool_AddJob");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_hThreadPool);
+    OpcUa_ReturnErrorIfArgumentNull(a_pfJob);
+
+    /* reserve a queue entry */
+    uStatus = OPCUA_P_SEMAPHORE_TIMEDWAIT(  pThreadPool->SlotsAvailable,
+                                            pThreadPool->bBlockIfFull?pThreadPool->uTimeout:0);
+    OpcUa_ReturnErrorIfBad(uStatus);
+    OpcUa_ReturnErrorIfTrue(uStatus == OpcUa_GoodNonCriticalTimeout, OpcUa_BadResourceUnavailable);
+
+    OPCUA_P_MUTEX_LOCK(pThreadPool->Mutex);
+
+    if(pThreadPool->bShutdown != OpcUa_False)
+    {
+        OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+        OPCUA_P_SEMAPHORE_POST(pThreadPool->SlotsAvailable, 1);
+        return OpcUa_BadShutdown;
+    }
+
+    uLastJob = (pThreadPool->uFirstJob + pThreadPool->uNoOfJobs) % pThreadPool->uMaxJobs;
+    pThreadPool->pJobs[uLastJob].pfJob     = a_pfJob;
+    pThreadPool->pJobs[uLastJob].pArgument = a_pArgument;
+    pThreadPool->uNoOfJobs++;
+
+    /* grow if every worker is busy; the job is still served by the existing workers if this fails */
+    if(     pThreadPool->uNoOfIdleThreads < pThreadPool->uNoOfJobs
+        &&  pThreadPool->uNoOfThreads < pThreadPool->uMaxThreads)
+    {
+        uStatus = OpcUa_ThreadPool_StartThread(pThreadPool);
+
+        if(OpcUa_IsBad(uStatus))
+        {
+            OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_ThreadPool_AddJob: Could not start additional worker (%u running)!\n", pThreadPool->uNoOfThreads);
+
+            if(pThreadPool->uNoOfThreads == 0)
+            {
+                /* nobody would ever run the job; take it back and let the caller handle the request */
+                pThreadPool->uNoOfJobs--;
+                OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+                OPCUA_P_SEMAPHORE_POST(pThreadPool->SlotsAvailable, 1);
+                return uStatus;
+            }
+
+            uStatus = OpcUa_Good;
+        }
+    }
+
+    OPCUA_P_MUTEX_UNLOCK(pThreadPool->Mutex);
+
+    OPCUA_P_SEMAPHORE_POST(pThreadPool->JobsAvailable, 1);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
@@ -0,0 +1,109 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+#ifndef _OpcUa_ThreadPool_H_
+#define _OpcUa_ThreadPool_H_ 1
+
+OPCUA_BEGIN_EXTERN_C
+
+/*============================================================================
+ * Type Definition
+ *===========================================================================*/
+
+/**
+ * @brief Function executed by a worker thread.
+ */
+typedef OpcUa_Void (OpcUa_PfnThreadPoolJobMain)(OpcUa_Void* pArgument);
+
+/**
+ * @brief Describes a thread pool handle.
+ */
+typedef OpcUa_Void* OpcUa_ThreadPool;
+
+/*============================================================================
+ * Type Management
+ *===========================================================================*/
+
+/**
+ * @brief Create a thread pool with a bounded job queue.
+ *
+ * The pool starts uMinThreads worker threads and adds more, up to uMaxThreads,
+ * whenever a job is queued while no worker is idle. Jobs are executed in the
+ * order they were added.
+ *
+ * @param phThreadPool  [out] Contains the created thread pool or OpcUa_Null.
+ * @param uMinThreads   [in]  Number of worker threads started immediately.
+ * @param uMaxThreads   [in]  Maximum number of worker threads.
+ * @param uMaxJobs      [in]  Maximum number of jobs waiting for a worker.
+ * @param bBlockIfFull  [in]  Let OpcUa_ThreadPool_AddJob wait for a free slot if the queue is full.
+ * @param uTimeout      [in]  Maximum time in milliseconds to wait for a free slot.
+ *
+ * @return An error code for the operation.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode    OpcUa_ThreadPool_Create(    OpcUa_ThreadPool*    phThreadPool,
+                                                OpcUa_UInt32         uMinThreads,
+                                                OpcUa_UInt32         uMaxThreads,
+                                                OpcUa_UInt32         uMaxJobs,
+                                                OpcUa_Boolean        bBlockIfFull,
+                                                OpcUa_UInt32         uTimeout);
+
+/**
+ * @brief Delete a thread pool.
+ *
+ * Jobs still in the queue are executed before the worker threads terminate.
+ * Must not be called from within a job.
+ *
+ * @param phThreadPool [in/out] Pointer to the thread pool handle.
+ */
+OPCUA_EXPORT
+OpcUa_Void          OpcUa_ThreadPool_Delete(    OpcUa_ThreadPool*    phThreadPool);
+
+/*============================================================================
+ * Type Operations
+ *===========================================================================*/
+
+/**
+ * @brief Queue a job for execution by one of the worker threads.
+ *
+ * @param hThreadPool [in] The thread pool handle.
+ * @param pfJob       [in] The function to execute.
+ * @param pArgument   [in] The argument passed to the function.
+ *
+ * @return OpcUa_BadResourceUnavailable if the queue is full, OpcUa_BadShutdown if the pool is being deleted,
+ *         the error of the thread creation if the pool has no worker thread to run the job.
+ */
+OPCUA_EXPORT
+OpcUa_StatusCode    OpcUa_ThreadPool_AddJob(    OpcUa_ThreadPool            hThreadPool,
+                                                OpcUa_PfnThreadPoolJobMain* pfJob,
+                                                OpcUa_Void*                 pArgument);
+
+OPCUA_END_EXTERN_C
+
+#endif /* _OpcUa_ThreadPool_H_ */
@@ -33,6 +33,7 @@
 #include <opcua_thread.h>
 
 #include <opcua_trace.h>
+#include <opcua_core.h>
 
 #define OPCUA_P_TRACE               OpcUa_ProxyStub_g_PlatformLayerCalltable->Trace
 #define OPCUA_P_TRACE_INITIALIZE    OpcUa_ProxyStub_g_PlatformLayerCalltable->TraceInitialize
@@ -58,6 +59,15 @@ OpcUa_CharA OpcUa_Trace_g_aTraceBuffer[OPCUA_TRACE_MAXLENGTH];
 OpcUa_Mutex OpcUa_Trace_s_pLock = OpcUa_Null;
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
+/*============================================================================
+ * Trace Record Hook
+ *===========================================================================*/
+/**
+* Optional hook for unformatted trace calls and the levels it wants.
+*/
+OpcUa_Trace_PfnRecord*  OpcUa_Trace_s_pfRecord      = OpcUa_Null;
+OpcUa_UInt32            OpcUa_Trace_s_uRecordLevel  = 0;
+
 
 /*============================================================================
  * Trace Initialize
@@ -146,6 +156,21 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_ChangeTraceLevel(OpcUa_UInt32 a_uNewTraceLe
     return;
 }
 
+/*============================================================================
+ * Set Trace Record Hook
+ *===========================================================================*/
+/**
+ * Register a hook for unformatted trace calls of the given levels.
+ * @param a_pfRecord   The hook or OpcUa_Null.
+ * @param a_uRecordLevel The trace levels passed to the hook.
+ */
+OpcUa_Void OPCUA_DLLCALL OpcUa_Trace_SetRecordHook(OpcUa_Trace_PfnRecord* a_pfRecord,
+                                                   OpcUa_UInt32           a_uRecordLevel)
+{
+    OpcUa_Trace_s_uRecordLevel = (a_pfRecord != OpcUa_Null)?a_uRecordLevel:0;
+    OpcUa_Trace_s_pfRecord     = a_pfRecord;
+}
+
 OpcUa_Boolean OPCUA_DLLCALL OpcUa_Trace_Nop(OpcUa_UInt32     a_uTraceLevel,
 #if OPCUA_TRACE_FILE_LINE_INFO
                                             OpcUa_CharA*     a_sFile,
@@ -182,6 +207,22 @@ OpcUa_Boolean OPCUA_DLLCALL OpcUa_Trace_Imp(OpcUa_UInt32    a_uTraceLevel,
 #if OPCUA_TRACE_ENABLE
     OpcUa_Boolean bTraced = OpcUa_False;
 
+    /* the record hook gets the raw arguments; it does not format and does not need the lock */
+    if(OpcUa_Trace_s_pfRecord != OpcUa_Null && (a_uTraceLevel & OpcUa_Trace_s_uRecordLevel) != 0)
+    {
+        varg_list argumentList;
+        VA_START(argumentList, a_sFormat);
+        OpcUa_Trace_s_pfRecord(a_uTraceLevel, a_sFormat, argumentList);
+        VA_END(argumentList);
+    }
+
+    /* most trace calls are filtered out; don't take the lock for them */
+    if(    OpcUa_ProxyStub_g_Configuration.bProxyStub_Trace_Enabled == OpcUa_False
+        || (a_uTraceLevel & OpcUa_ProxyStub_g_Configuration.uProxyStub_Trace_Level) == 0)
+    {
+        return OpcUa_False;
+    }
+
 #if OPCUA_USE_SYNCHRONISATION
     if(OpcUa_Trace_s_pLock == OpcUa_Null)
     {
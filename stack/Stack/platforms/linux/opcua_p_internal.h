@@ -53,6 +53,30 @@
 /** @brief Maximum wait time for socket module (in Milli sec) at the blocking point. */
 #define OPCUA_SOCKET_MAXLOOPTIME (OpcUa_UInt32)1000 /* reloop after 1 second to be secure against hangs */
 
+/** @brief Number of socket entries a socket manager allocates at once when its socket table grows. */
+#define OPCUA_P_SOCKETMANAGER_CHUNKSIZE 64
+
+/** @brief Let the socket manager wait with epoll on an incrementally maintained interest set instead of select. */
+#ifndef OPCUA_P_SOCKETMANAGER_USE_EPOLL
+#define OPCUA_P_SOCKETMANAGER_USE_EPOLL OPCUA_CONFIG_NO
+#endif
+
+/** @brief Maximum number of ready sockets fetched by one epoll_wait call. */
+#define OPCUA_P_SOCKETMANAGER_EPOLL_MAXEVENTS 64
+
+/** @brief Number of successful certificate validations remembered per cached certificate store (0 disables the cache). */
+#define OPCUA_P_PKI_VALIDATIONCACHE_SIZE 128
+
+/** @brief Maximum time in seconds a remembered certificate validation is reused. */
+#define OPCUA_P_PKI_VALIDATIONCACHE_MAXAGE 3600
+
+/** @brief Number of parsed RSA keys kept by the OpenSSL RSA functions to avoid decoding the same key again. */
+#define OPCUA_P_OPENSSL_RSA_KEYCACHE_SIZE 32
+
+/** @brief Number of keyed HMAC contexts kept for reuse, which covers the signing keys of this many secure channel tokens.
+ *         A key stays in the cache after its token expired until this many newer keys were used. */
+#define OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE 64
+
 /**********************************************************************************/
 /*/  Trace Modules.                                                              /*/
 /**********************************************************************************/
@@ -107,6 +131,10 @@
 # error PKI support is required for SSL; globally define OPCUA_SUPPORT_PKI
 #endif
 
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL && !OPCUA_MULTITHREADED
+# error The epoll socket manager requires OPCUA_MULTITHREADED; the single threaded timers are driven by select
+#endif
+
 /**********************************************************************************/
 /*/  Internally used function prototypes.                                        /*/
 /**********************************************************************************/
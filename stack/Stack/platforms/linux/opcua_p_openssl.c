@@ -105,8 +105,9 @@ static void OpcUa_P_OpenSSL_Lock(int mode, int type, const char *file, int line)
  *===========================================================================*/
 OpcUa_StatusCode OpcUa_P_OpenSSL_Initialize(OpcUa_Void)
 {
+    OpcUa_StatusCode uStatus;
 #if OPCUA_USE_SYNCHRONISATION
-    OpcUa_StatusCode uStatus = OpcUa_P_Mutex_Create(&OpenSSL_Mutex);
+    uStatus = OpcUa_P_Mutex_Create(&OpenSSL_Mutex);
     OpcUa_ReturnErrorIfBad(uStatus);
     CRYPTO_set_id_callback(OpcUa_P_Thread_GetCurrentThreadId);
     CRYPTO_set_locking_callback(OpcUa_P_OpenSSL_Lock);
@@ -116,7 +117,11 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_Initialize(OpcUa_Void)
     SSL_library_init();
     SSL_load_error_strings();
 #endif /* OPCUA_P_SOCKETMANAGER_SUPPORT_SSL */
-    return OpcUa_Good;
+    uStatus = OpcUa_P_OpenSSL_RSA_InitializeKeyCache();
+    OpcUa_ReturnErrorIfBad(uStatus);
+    uStatus = OpcUa_P_OpenSSL_HMAC_InitializeKeyCache();
+    OpcUa_ReturnErrorIfBad(uStatus);
+    return OpcUa_P_OpenSSL_PKI_InitializeStoreCache();
 }
 
 /*============================================================================
@@ -124,6 +129,9 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_Initialize(OpcUa_Void)
  *===========================================================================*/
 OpcUa_Void OpcUa_P_OpenSSL_Cleanup(OpcUa_Void)
 {
+    OpcUa_P_OpenSSL_PKI_CleanupStoreCache();
+    OpcUa_P_OpenSSL_RSA_CleanupKeyCache();
+    OpcUa_P_OpenSSL_HMAC_CleanupKeyCache();
 #if OPCUA_P_SOCKETMANAGER_SUPPORT_SSL
 #if OPENSSL_VERSION_NUMBER >= 0x1000200fL && !defined(OPENSSL_NO_COMP)
     SSL_COMP_free_compression_methods();
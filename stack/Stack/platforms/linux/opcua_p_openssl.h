@@ -42,6 +42,36 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_Initialize(void);
 */
 OpcUa_Void OpcUa_P_OpenSSL_Cleanup(void);
 
+/**
+  @brief Initializes the cache of prebuilt X509 certificate stores.
+*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_InitializeStoreCache(void);
+
+/**
+  @brief Releases all cached X509 certificate stores.
+*/
+OpcUa_Void OpcUa_P_OpenSSL_PKI_CleanupStoreCache(void);
+
+/**
+  @brief Initializes the cache of parsed RSA keys.
+*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_InitializeKeyCache(void);
+
+/**
+  @brief Releases all cached RSA keys.
+*/
+OpcUa_Void OpcUa_P_OpenSSL_RSA_CleanupKeyCache(void);
+
+/**
+  @brief Initializes the cache of keyed HMAC contexts.
+*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_InitializeKeyCache(void);
+
+/**
+  @brief Releases all cached HMAC contexts.
+*/
+OpcUa_Void OpcUa_P_OpenSSL_HMAC_CleanupKeyCache(void);
+
 /**
   @brief cleans up the OpenSSL library.
 */
@@ -35,13 +35,64 @@
 
 /* System Headers */
 #include <memory.h>
-#include <openssl/aes.h>
+#include <openssl/evp.h>
 
 /* own headers */
 #include <opcua_p_openssl.h>
 
 /*** AES SYMMETRIC ENCRYPTION ***/
 
+/*============================================================================
+ * OpcUa_P_OpenSSL_AES_CBC_Cipher
+ *===========================================================================*/
+/* Runs AES-CBC without padding over whole blocks through EVP, which selects
+ * the hardware accelerated implementation when the CPU provides one. */
+static OpcUa_StatusCode OpcUa_P_OpenSSL_AES_CBC_Cipher(
+    OpcUa_Byte*             a_pInput,
+    OpcUa_UInt32            a_inputLen,
+    OpcUa_Key*              a_key,
+    OpcUa_Byte*             a_pInitalVector,
+    OpcUa_Byte*             a_pOutput,
+    int                     a_bEncrypt)
+{
+    const EVP_CIPHER*   pCipher;
+    EVP_CIPHER_CTX*     pCtx        = OpcUa_Null;
+    int                 iOutputLen  = 0;
+
+    OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "AES_CBC_Cipher");
+
+    switch(a_key->Key.Length)
+    {
+    case 16: pCipher = EVP_aes_128_cbc(); break;
+    case 24: pCipher = EVP_aes_192_cbc(); break;
+    case 32: pCipher = EVP_aes_256_cbc(); break;
+    default: OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+    }
+
+    pCtx = EVP_CIPHER_CTX_new();
+    OpcUa_GotoErrorIfAllocFailed(pCtx);
+
+    if(EVP_CipherInit_ex(pCtx, pCipher, OpcUa_Null, a_key->Key.Data, a_pInitalVector, a_bEncrypt) != 1 ||
+       EVP_CIPHER_CTX_set_padding(pCtx, 0) != 1 ||
+       EVP_CipherUpdate(pCtx, a_pOutput, &iOutputLen, a_pInput, (int)a_inputLen) != 1 ||
+       (OpcUa_UInt32)iOutputLen != a_inputLen)
+    {
+        OpcUa_GotoErrorWithStatus(OpcUa_Bad);
+    }
+
+    EVP_CIPHER_CTX_free(pCtx);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pCtx != OpcUa_Null)
+    {
+        EVP_CIPHER_CTX_free(pCtx);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_P_OpenSSL_AES_CBC_Encrypt
  *===========================================================================*/
@@ -54,10 +105,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_AES_CBC_Encrypt(
     OpcUa_Byte*             a_pCipherText,
     OpcUa_UInt32*           a_pCipherTextLen)
 {
-    AES_KEY         key;
-
-    OpcUa_Byte      pInitalVector[16];
-
     OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "AES_CBC_Encrypt");
 
     OpcUa_ReferenceParameter(a_pProvider);
@@ -82,23 +129,14 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_AES_CBC_Encrypt(
         OpcUa_ReturnStatusCode;
     }
 
-    /* we have to pass the key length in bits instead of bytes */
-    if(AES_set_encrypt_key(a_key->Key.Data, a_key->Key.Length * 8, &key) < 0)
-    {
-        uStatus = OpcUa_Bad;
-        OpcUa_GotoErrorIfBad(uStatus);
-    }
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-    OpcUa_P_Memory_MemCpy(pInitalVector, 16, a_pInitalVector, 16);
-
     /* encrypt data */
-    AES_cbc_encrypt(    a_pPlainText,
-                        a_pCipherText,
-                        a_plainTextLen,
-                        &key,
-                        pInitalVector,
-                        AES_ENCRYPT);
+    uStatus = OpcUa_P_OpenSSL_AES_CBC_Cipher(   a_pPlainText,
+                                                a_plainTextLen,
+                                                a_key,
+                                                a_pInitalVector,
+                                                a_pCipherText,
+                                                1);
+    OpcUa_GotoErrorIfBad(uStatus);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -118,9 +156,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_AES_CBC_Decrypt(
     OpcUa_Byte*             a_pPlainText,
     OpcUa_UInt32*           a_pPlainTextLen)
 {
-    AES_KEY         key;
-    OpcUa_Byte      pInitalVector[16];
-
     OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "AES_CBC_Decrypt");
 
     OpcUa_ReferenceParameter(a_pProvider);
@@ -145,22 +180,14 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_AES_CBC_Decrypt(
         OpcUa_ReturnStatusCode;
     }
 
-    /* we have to pass the key length in bits instead of bytes */
-    if(AES_set_decrypt_key(a_key->Key.Data, a_key->Key.Length * 8, &key) < 0)
-    {
-        OpcUa_GotoErrorWithStatus(OpcUa_Bad);
-    }
-
-    /* copy the IV because the AES_cbc_encrypt function overwrites it. */
-    OpcUa_P_Memory_MemCpy(pInitalVector, 16, a_pInitalVector, 16);
-
     /* decrypt ciphertext */
-    AES_cbc_encrypt(    a_pCipherText,
-                        a_pPlainText,
-                        a_cipherTextLen,
-                        &key,
-                        pInitalVector,
-                        AES_DECRYPT);
+    uStatus = OpcUa_P_OpenSSL_AES_CBC_Cipher(   a_pCipherText,
+                                                a_cipherTextLen,
+                                                a_key,
+                                                a_pInitalVector,
+                                                a_pPlainText,
+                                                0);
+    OpcUa_GotoErrorIfBad(uStatus);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
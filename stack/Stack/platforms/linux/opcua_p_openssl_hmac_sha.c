@@ -30,15 +30,266 @@
 /* UA platform definitions */
 #include <opcua_p_internal.h>
 #include <opcua_p_memory.h>
+#include <opcua_p_mutex.h>
 
 #if OPCUA_REQUIRE_OPENSSL
 /* System Headers */
 #include <openssl/hmac.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif
 
 
 /* own headers */
 #include <opcua_p_openssl.h>
 
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+/*============================================================================
+ * Keyed HMAC context cache
+ *===========================================================================*/
+/* A secure channel signs and verifies every chunk with the same few keys.
+ * Instead of deriving the inner and outer pad state from the key on each
+ * call, a MAC context keyed with each recently used key is kept and
+ * duplicated for the computation. Entries are found by FNV-1a hash and
+ * confirmed by comparing the key; the least recently used one is replaced
+ * and its key cleansed.
+ * The cache does not know when a security token expires, so the copy of a
+ * key and its keyed context stay in memory until OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE
+ * newer keys have been used or the platform layer is cleaned up. */
+typedef struct _OpcUa_P_OpenSSL_HMAC_KeyCacheEntry
+{
+    OpcUa_UInt32    uHash;
+    const EVP_MD*   pMd;
+    OpcUa_Int32     iLength;
+    OpcUa_Byte*     pKey;
+    EVP_MAC_CTX*    pCtx;
+    OpcUa_UInt32    uLastUse;
+} OpcUa_P_OpenSSL_HMAC_KeyCacheEntry;
+
+static EVP_MAC* g_pHmac = OpcUa_Null;
+static OpcUa_P_OpenSSL_HMAC_KeyCacheEntry g_HmacKeyCache[OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE];
+static OpcUa_UInt32 g_uHmacKeyCacheClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex g_hHmacKeyCacheMutex = OpcUa_Null;
+# define OPCUA_P_HMAC_KEYCACHE_LOCK()   OpcUa_P_Mutex_Lock(g_hHmacKeyCacheMutex)
+# define OPCUA_P_HMAC_KEYCACHE_UNLOCK() OpcUa_P_Mutex_Unlock(g_hHmacKeyCacheMutex)
+#else
+# define OPCUA_P_HMAC_KEYCACHE_LOCK()
+# define OPCUA_P_HMAC_KEYCACHE_UNLOCK()
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+static void OpcUa_P_OpenSSL_HMAC_KeyCache_ClearEntry(OpcUa_P_OpenSSL_HMAC_KeyCacheEntry* a_pEntry)
+{
+    if(a_pEntry->pKey != OpcUa_Null)
+    {
+        OPENSSL_cleanse(a_pEntry->pKey, a_pEntry->iLength);
+        OpcUa_P_Memory_Free(a_pEntry->pKey);
+    }
+    if(a_pEntry->pCtx != OpcUa_Null)
+    {
+        EVP_MAC_CTX_free(a_pEntry->pCtx);
+    }
+    OpcUa_MemSet(a_pEntry, 0, sizeof(OpcUa_P_OpenSSL_HMAC_KeyCacheEntry));
+}
+
+/* Creates a MAC context keyed with the given digest and key. */
+static EVP_MAC_CTX* OpcUa_P_OpenSSL_HMAC_NewKeyedContext(const EVP_MD* a_pMd, OpcUa_Key* a_key)
+{
+    EVP_MAC_CTX*    pCtx = EVP_MAC_CTX_new(g_pHmac);
+    OSSL_PARAM      params[2];
+
+    if(pCtx == OpcUa_Null)
+    {
+        return OpcUa_Null;
+    }
+
+    params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char*)EVP_MD_get0_name(a_pMd), 0);
+    params[1] = OSSL_PARAM_construct_end();
+
+    if(EVP_MAC_init(pCtx, a_key->Key.Data, (size_t)a_key->Key.Length, params) != 1)
+    {
+        EVP_MAC_CTX_free(pCtx);
+        return OpcUa_Null;
+    }
+
+    return pCtx;
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_HMAC_InitializeKeyCache
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_InitializeKeyCache(OpcUa_Void)
+{
+    OpcUa_MemSet(g_HmacKeyCache, 0, sizeof(g_HmacKeyCache));
+    g_uHmacKeyCacheClock = 0;
+
+    g_pHmac = EVP_MAC_fetch(OpcUa_Null, OSSL_MAC_NAME_HMAC, OpcUa_Null);
+    if(g_pHmac == OpcUa_Null)
+    {
+        return OpcUa_BadInternalError;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    return OpcUa_P_Mutex_Create(&g_hHmacKeyCacheMutex);
+#else
+    return OpcUa_Good;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_HMAC_CleanupKeyCache
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_OpenSSL_HMAC_CleanupKeyCache(OpcUa_Void)
+{
+    OpcUa_UInt32 i;
+
+    for(i = 0; i < OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE; i++)
+    {
+        OpcUa_P_OpenSSL_HMAC_KeyCache_ClearEntry(&g_HmacKeyCache[i]);
+    }
+
+    if(g_pHmac != OpcUa_Null)
+    {
+        EVP_MAC_free(g_pHmac);
+        g_pHmac = OpcUa_Null;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(g_hHmacKeyCacheMutex != OpcUa_Null)
+    {
+        OpcUa_P_Mutex_Delete(&g_hHmacKeyCacheMutex);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_HMAC_Compute
+ *===========================================================================*/
+/* Computes the HMAC of the data with the given digest and key into a_pMac.
+ * Returns 1 on success, like HMAC(). */
+static int OpcUa_P_OpenSSL_HMAC_Compute(
+    const EVP_MD*       a_pMd,
+    OpcUa_Key*          a_key,
+    OpcUa_Byte*         a_pData,
+    OpcUa_UInt32        a_dataLen,
+    OpcUa_ByteString*   a_pMac)
+{
+    OpcUa_P_OpenSSL_HMAC_KeyCacheEntry* pEntry      = OpcUa_Null;
+    EVP_MAC_CTX*                        pCtx        = OpcUa_Null;
+    EVP_MAC_CTX*                        pTemplate   = OpcUa_Null;
+    OpcUa_Byte*                         pKey        = OpcUa_Null;
+    OpcUa_UInt32                        uHash       = 2166136261u;
+    size_t                              macLength   = 0;
+    OpcUa_Int32                         i;
+    int                                 iOk         = 0;
+
+    if(a_key->Key.Length < 0 || g_pHmac == OpcUa_Null)
+    {
+        return 0;
+    }
+
+    for(i = 0; i < a_key->Key.Length; i++)
+    {
+        uHash = (uHash ^ a_key->Key.Data[i]) * 16777619u;
+    }
+
+    OPCUA_P_HMAC_KEYCACHE_LOCK();
+    for(i = 0; i < OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE; i++)
+    {
+        if(g_HmacKeyCache[i].pCtx != OpcUa_Null &&
+           g_HmacKeyCache[i].uHash == uHash &&
+           g_HmacKeyCache[i].pMd == a_pMd &&
+           g_HmacKeyCache[i].iLength == a_key->Key.Length &&
+           memcmp(g_HmacKeyCache[i].pKey, a_key->Key.Data, a_key->Key.Length) == 0)
+        {
+            g_HmacKeyCache[i].uLastUse = ++g_uHmacKeyCacheClock;
+            pCtx = EVP_MAC_CTX_dup(g_HmacKeyCache[i].pCtx);
+            pEntry = &g_HmacKeyCache[i];
+            break;
+        }
+    }
+    OPCUA_P_HMAC_KEYCACHE_UNLOCK();
+
+    if(pEntry == OpcUa_Null)
+    {
+        /* not cached yet: key a new template and keep it */
+        pCtx = OpcUa_P_OpenSSL_HMAC_NewKeyedContext(a_pMd, a_key);
+        if(pCtx != OpcUa_Null &&
+           (pTemplate = EVP_MAC_CTX_dup(pCtx)) != OpcUa_Null &&
+           (pKey = (OpcUa_Byte*)OpcUa_P_Memory_Alloc(a_key->Key.Length > 0 ? a_key->Key.Length : 1)) != OpcUa_Null)
+        {
+            memcpy(pKey, a_key->Key.Data, a_key->Key.Length);
+
+            OPCUA_P_HMAC_KEYCACHE_LOCK();
+            for(i = 0; i < OPCUA_P_OPENSSL_HMAC_KEYCACHE_SIZE; i++)
+            {
+                if(g_HmacKeyCache[i].pCtx == OpcUa_Null)
+                {
+                    pEntry = &g_HmacKeyCache[i];
+                    break;
+                }
+                if(pEntry == OpcUa_Null || g_HmacKeyCache[i].uLastUse < pEntry->uLastUse)
+                {
+                    pEntry = &g_HmacKeyCache[i];
+                }
+            }
+            OpcUa_P_OpenSSL_HMAC_KeyCache_ClearEntry(pEntry);
+            pEntry->uHash       = uHash;
+            pEntry->pMd         = a_pMd;
+            pEntry->iLength     = a_key->Key.Length;
+            pEntry->pKey        = pKey;
+            pEntry->pCtx        = pTemplate;
+            pEntry->uLastUse    = ++g_uHmacKeyCacheClock;
+            OPCUA_P_HMAC_KEYCACHE_UNLOCK();
+        }
+        else if(pTemplate != OpcUa_Null)
+        {
+            EVP_MAC_CTX_free(pTemplate);
+        }
+    }
+
+    if(pCtx == OpcUa_Null)
+    {
+        return 0;
+    }
+
+    iOk = EVP_MAC_update(pCtx, a_pData, a_dataLen);
+    if(iOk == 1)
+    {
+        iOk = EVP_MAC_final(pCtx, a_pMac->Data, &macLength, (size_t)EVP_MD_get_size(a_pMd));
+    }
+    if(iOk == 1)
+    {
+        a_pMac->Length = (OpcUa_Int32)macLength;
+    }
+
+    EVP_MAC_CTX_free(pCtx);
+    return iOk;
+}
+#else /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+/* EVP_MAC needs OpenSSL 3.0; older versions compute every HMAC from the key. */
+OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_InitializeKeyCache(OpcUa_Void)
+{
+    return OpcUa_Good;
+}
+
+OpcUa_Void OpcUa_P_OpenSSL_HMAC_CleanupKeyCache(OpcUa_Void)
+{
+}
+
+static int OpcUa_P_OpenSSL_HMAC_Compute(
+    const EVP_MD*       a_pMd,
+    OpcUa_Key*          a_key,
+    OpcUa_Byte*         a_pData,
+    OpcUa_UInt32        a_dataLen,
+    OpcUa_ByteString*   a_pMac)
+{
+    return HMAC(a_pMd, a_key->Key.Data, a_key->Key.Length, a_pData, a_dataLen,
+                a_pMac->Data, (unsigned int*)&(a_pMac->Length)) != OpcUa_Null;
+}
+#endif /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+
 /*============================================================================
  * OpcUa_P_OpenSSL_HMAC_SHA1_Generate
  *===========================================================================*/
@@ -66,7 +317,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_SHA1_Generate(
         OpcUa_ReturnStatusCode;
     }
 
-    if(HMAC(EVP_sha1(),a_key->Key.Data,a_key->Key.Length,a_pData,a_dataLen,a_pMac->Data,(unsigned int*)&(a_pMac->Length)) == OpcUa_Null)
+    if(OpcUa_P_OpenSSL_HMAC_Compute(EVP_sha1(), a_key, a_pData, a_dataLen, a_pMac) != 1)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
     }
@@ -103,7 +354,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_SHA2_224_Generate(
         OpcUa_ReturnStatusCode;
     }
 
-    if(HMAC(EVP_sha224(),a_key->Key.Data,a_key->Key.Length,a_pData,a_dataLen,a_pMac->Data,(unsigned int*)&(a_pMac->Length)) == OpcUa_Null)
+    if(OpcUa_P_OpenSSL_HMAC_Compute(EVP_sha224(), a_key, a_pData, a_dataLen, a_pMac) != 1)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
     }
@@ -140,7 +391,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_SHA2_256_Generate(
         OpcUa_ReturnStatusCode;
     }
 
-    if(HMAC(EVP_sha256(),a_key->Key.Data,a_key->Key.Length,a_pData,a_dataLen,a_pMac->Data,(unsigned int*)&(a_pMac->Length)) == OpcUa_Null)
+    if(OpcUa_P_OpenSSL_HMAC_Compute(EVP_sha256(), a_key, a_pData, a_dataLen, a_pMac) != 1)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
     }
@@ -177,7 +428,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_SHA2_384_Generate(
         OpcUa_ReturnStatusCode;
     }
 
-    if(HMAC(EVP_sha384(),a_key->Key.Data,a_key->Key.Length,a_pData,a_dataLen,a_pMac->Data,(unsigned int*)&(a_pMac->Length)) == OpcUa_Null)
+    if(OpcUa_P_OpenSSL_HMAC_Compute(EVP_sha384(), a_key, a_pData, a_dataLen, a_pMac) != 1)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
     }
@@ -214,7 +465,7 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_HMAC_SHA2_512_Generate(
         OpcUa_ReturnStatusCode;
     }
 
-    if(HMAC(EVP_sha512(),a_key->Key.Data,a_key->Key.Length,a_pData,a_dataLen,a_pMac->Data,(unsigned int*)&(a_pMac->Length)) == OpcUa_Null)
+    if(OpcUa_P_OpenSSL_HMAC_Compute(EVP_sha512(), a_key, a_pData, a_dataLen, a_pMac) != 1)
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
     }
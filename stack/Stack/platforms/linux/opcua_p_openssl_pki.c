@@ -41,12 +41,19 @@
 #include <openssl/x509_vfy.h>
 #include <openssl/x509v3.h>
 #include <openssl/pkcs12.h>
+#include <openssl/sha.h>
 #include <sys/types.h>
+#include <sys/inotify.h>
 #include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
 
 
 
 /* own headers */
+#include <opcua_p_mutex.h>
+#include <opcua_p_openssl.h>
 #include <opcua_p_openssl_pki.h>
 
 #define MAX_PATH 512
@@ -171,29 +178,24 @@ static OpcUa_Int OpcUa_P_OpenSSL_CertificateStore_Verify_Callback(int a_ok, X509
 }
 
 /*============================================================================
- * OpcUa_P_OpenSSL_CertificateStore_Open
+ * OpcUa_P_OpenSSL_PKI_BuildCertificateStore
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
-    OpcUa_PKIProvider*          a_pProvider,
-    OpcUa_Void**                a_ppCertificateStore)           /* type depends on store implementation */
+/* Creates a new X509_STORE and loads the trust list, untrusted list and
+ * CRLs of the given configuration from disk. */
+static OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_BuildCertificateStore(
+    OpcUa_P_OpenSSL_CertificateStore_Config*    pCertificateStoreCfg,
+    OpcUa_Void**                                a_ppCertificateStore)
 {
-    OpcUa_P_OpenSSL_CertificateStore_Config*    pCertificateStoreCfg;
     X509_STORE*         pStore;
     X509_LOOKUP*        pLookup;
     char                CertFile[MAX_PATH];
     struct dirent **dirlist = NULL;
     int numCertificates = 0, i;
 
-OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
-
-    OpcUa_ReturnErrorIfArgumentNull(a_pProvider);
-    OpcUa_ReturnErrorIfArgumentNull(a_pProvider->Handle);
-    OpcUa_ReturnErrorIfArgumentNull(a_ppCertificateStore);
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_BuildCertificateStore");
 
     *a_ppCertificateStore = OpcUa_Null;
 
-    pCertificateStoreCfg = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pProvider->Handle;
-
     if(!(*a_ppCertificateStore = pStore = X509_STORE_new()))
     {
         OpcUa_GotoErrorWithStatus(OpcUa_Bad);
@@ -415,6 +417,467 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * Certificate store cache
+ *===========================================================================*/
+/* Building a store parses every certificate and CRL of the configured
+ * directories, which is far too expensive to repeat for each secure channel.
+ * Stores are therefore built once per configuration and shared through the
+ * X509_STORE reference count. An inotify descriptor per entry watches the
+ * directories the store was loaded from; pending events mark the store stale
+ * and the next open rebuilds it. Channels arriving while the rebuild is in
+ * progress keep using the previous store.
+ * Each entry also remembers the SHA-256 digests of certificates that
+ * validated successfully against its current store, so clients reconnecting
+ * with the same certificate skip chain building. These results are dropped
+ * whenever the store is rebuilt and expire at the earliest NotAfter of the
+ * validated chain or nextUpdate of the loaded CRLs. */
+#define OPCUA_P_PKI_STORECACHE_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | \
+                                           IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+#if OPENSSL_VERSION_NUMBER < 0x1010000fL
+# define X509_STORE_up_ref(xStore) CRYPTO_add(&(xStore)->references, 1, CRYPTO_LOCK_X509_STORE)
+#endif
+
+typedef struct _OpcUa_P_OpenSSL_PKI_ValidationCacheSlot
+{
+    OpcUa_Byte                              Digest[SHA256_DIGEST_LENGTH];
+    time_t                                  Expires;
+    OpcUa_UInt32                            uLastUse;
+} OpcUa_P_OpenSSL_PKI_ValidationCacheSlot;
+
+typedef struct _OpcUa_P_OpenSSL_PKI_StoreCacheEntry OpcUa_P_OpenSSL_PKI_StoreCacheEntry;
+struct _OpcUa_P_OpenSSL_PKI_StoreCacheEntry
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry*    pNext;
+    /* cache key: copy of the relevant configuration values */
+    char*                                   TrustList;
+    char*                                   RevocationList;
+    char*                                   UntrustedList;
+    OpcUa_UInt32                            Flags;
+    /* the shared store, one reference is owned by the cache */
+    X509_STORE*                             pStore;
+    /* inotify descriptor watching the store's sources, -1 if not watched */
+    int                                     iNotifyFd;
+    OpcUa_Boolean                           bBuilding;
+    /* earliest nextUpdate of the CRLs loaded into pStore, 0 if none */
+    time_t                                  CrlNextUpdate;
+    /* certificates validated against pStore, least recently used is evicted */
+    OpcUa_P_OpenSSL_PKI_ValidationCacheSlot* pResults;
+    OpcUa_UInt32                            uResultCount;
+    OpcUa_UInt32                            uResultClock;
+};
+
+static OpcUa_P_OpenSSL_PKI_StoreCacheEntry* g_pStoreCache = OpcUa_Null;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex g_hStoreCacheMutex = OpcUa_Null;
+# define OPCUA_P_PKI_STORECACHE_LOCK()   OpcUa_P_Mutex_Lock(g_hStoreCacheMutex)
+# define OPCUA_P_PKI_STORECACHE_UNLOCK() OpcUa_P_Mutex_Unlock(g_hStoreCacheMutex)
+#else
+# define OPCUA_P_PKI_STORECACHE_LOCK()
+# define OPCUA_P_PKI_STORECACHE_UNLOCK()
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+static int OpcUa_P_OpenSSL_PKI_StoreCache_StrEqual(const char* a, const char* b)
+{
+    if(a == OpcUa_Null || b == OpcUa_Null) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static char* OpcUa_P_OpenSSL_PKI_StoreCache_StrDup(const char* a_pSrc, OpcUa_Boolean* a_pbFailed)
+{
+    char* pDst;
+
+    if(a_pSrc == OpcUa_Null) return OpcUa_Null;
+    pDst = (char*)OpcUa_P_Memory_Alloc((OpcUa_UInt32)strlen(a_pSrc) + 1);
+    if(pDst == OpcUa_Null)
+    {
+        *a_pbFailed = OpcUa_True;
+        return OpcUa_Null;
+    }
+    strcpy(pDst, a_pSrc);
+    return pDst;
+}
+
+static void OpcUa_P_OpenSSL_PKI_StoreCache_FreeEntry(OpcUa_P_OpenSSL_PKI_StoreCacheEntry* a_pEntry)
+{
+    if(a_pEntry->pStore != OpcUa_Null) X509_STORE_free(a_pEntry->pStore);
+    if(a_pEntry->iNotifyFd >= 0) close(a_pEntry->iNotifyFd);
+    if(a_pEntry->TrustList != OpcUa_Null) OpcUa_P_Memory_Free(a_pEntry->TrustList);
+    if(a_pEntry->RevocationList != OpcUa_Null) OpcUa_P_Memory_Free(a_pEntry->RevocationList);
+    if(a_pEntry->UntrustedList != OpcUa_Null) OpcUa_P_Memory_Free(a_pEntry->UntrustedList);
+    if(a_pEntry->pResults != OpcUa_Null) OpcUa_P_Memory_Free(a_pEntry->pResults);
+    OpcUa_P_Memory_Free(a_pEntry);
+}
+
+/* Returns the entry matching the configuration, creating it if necessary.
+ * Must be called with the cache lock held. */
+static OpcUa_P_OpenSSL_PKI_StoreCacheEntry* OpcUa_P_OpenSSL_PKI_StoreCache_Find(OpcUa_P_OpenSSL_CertificateStore_Config* a_pCfg)
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry*    pEntry;
+    OpcUa_Boolean                           bFailed = OpcUa_False;
+
+    for(pEntry = g_pStoreCache; pEntry != OpcUa_Null; pEntry = pEntry->pNext)
+    {
+        if(pEntry->Flags == a_pCfg->Flags &&
+           OpcUa_P_OpenSSL_PKI_StoreCache_StrEqual(pEntry->TrustList, a_pCfg->CertificateTrustListLocation) &&
+           OpcUa_P_OpenSSL_PKI_StoreCache_StrEqual(pEntry->RevocationList, a_pCfg->CertificateRevocationListLocation) &&
+           OpcUa_P_OpenSSL_PKI_StoreCache_StrEqual(pEntry->UntrustedList, a_pCfg->CertificateUntrustedListLocation))
+        {
+            return pEntry;
+        }
+    }
+
+    pEntry = (OpcUa_P_OpenSSL_PKI_StoreCacheEntry*)OpcUa_P_Memory_Alloc(sizeof(OpcUa_P_OpenSSL_PKI_StoreCacheEntry));
+    if(pEntry == OpcUa_Null) return OpcUa_Null;
+    OpcUa_MemSet(pEntry, 0, sizeof(OpcUa_P_OpenSSL_PKI_StoreCacheEntry));
+    pEntry->iNotifyFd = -1;
+    pEntry->Flags = a_pCfg->Flags;
+    pEntry->TrustList = OpcUa_P_OpenSSL_PKI_StoreCache_StrDup(a_pCfg->CertificateTrustListLocation, &bFailed);
+    pEntry->RevocationList = OpcUa_P_OpenSSL_PKI_StoreCache_StrDup(a_pCfg->CertificateRevocationListLocation, &bFailed);
+    pEntry->UntrustedList = OpcUa_P_OpenSSL_PKI_StoreCache_StrDup(a_pCfg->CertificateUntrustedListLocation, &bFailed);
+    if(bFailed)
+    {
+        OpcUa_P_OpenSSL_PKI_StoreCache_FreeEntry(pEntry);
+        return OpcUa_Null;
+    }
+
+    pEntry->pNext = g_pStoreCache;
+    g_pStoreCache = pEntry;
+    return pEntry;
+}
+
+/* Creates an inotify descriptor watching every location the store of the
+ * entry is loaded from. Returns -1 if any of them cannot be watched; such
+ * stores are not cached. */
+static int OpcUa_P_OpenSSL_PKI_StoreCache_Watch(OpcUa_P_OpenSSL_PKI_StoreCacheEntry* a_pEntry)
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if(fd < 0) return -1;
+
+    if(!(a_pEntry->Flags & OPCUA_P_PKI_OPENSSL_DONT_ADD_TRUST_LIST_TO_ROOT_CERTIFICATES) &&
+       (a_pEntry->TrustList == OpcUa_Null ||
+        inotify_add_watch(fd, a_pEntry->TrustList, OPCUA_P_PKI_STORECACHE_WATCH_MASK) < 0))
+    {
+        goto Error;
+    }
+
+    if((a_pEntry->Flags & OPCUA_P_PKI_OPENSSL_ADD_UNTRUSTED_LIST_TO_ROOT_CERTIFICATES) &&
+       (a_pEntry->UntrustedList == OpcUa_Null ||
+        inotify_add_watch(fd, a_pEntry->UntrustedList, OPCUA_P_PKI_STORECACHE_WATCH_MASK) < 0))
+    {
+        goto Error;
+    }
+
+    if((a_pEntry->Flags & OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL) &&
+       (a_pEntry->RevocationList == OpcUa_Null ||
+        inotify_add_watch(fd, a_pEntry->RevocationList, OPCUA_P_PKI_STORECACHE_WATCH_MASK) < 0))
+    {
+        goto Error;
+    }
+
+    return fd;
+
+Error:
+    close(fd);
+    return -1;
+}
+
+/* Drains the inotify descriptor of the entry.
+ * Returns OpcUa_True if any of the watched locations changed. */
+static OpcUa_Boolean OpcUa_P_OpenSSL_PKI_StoreCache_Changed(OpcUa_P_OpenSSL_PKI_StoreCacheEntry* a_pEntry)
+{
+    char            buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    OpcUa_Boolean   bChanged = OpcUa_False;
+    ssize_t         len;
+
+    for(;;)
+    {
+        len = read(a_pEntry->iNotifyFd, buf, sizeof(buf));
+        if(len > 0)
+        {
+            bChanged = OpcUa_True;
+            continue;
+        }
+        if(len < 0 && errno == EINTR) continue;
+        if(len < 0 && errno == EAGAIN) break;
+        /* unexpected error: do not trust the watch any longer */
+        return OpcUa_True;
+    }
+
+    return bChanged;
+}
+
+/* Converts an ASN.1 time into a time_t, relative to a_Now. */
+static time_t OpcUa_P_OpenSSL_PKI_StoreCache_AsnTime(const ASN1_TIME* a_pTime, time_t a_Now)
+{
+    int iDays, iSeconds;
+
+    if(a_pTime == OpcUa_Null || ASN1_TIME_diff(&iDays, &iSeconds, OpcUa_Null, a_pTime) != 1)
+    {
+        return a_Now;
+    }
+    return a_Now + (time_t)iDays * 86400 + iSeconds;
+}
+
+/* Returns the earliest nextUpdate of all CRLs held by the store, 0 if none. */
+static time_t OpcUa_P_OpenSSL_PKI_StoreCache_CrlNextUpdate(X509_STORE* a_pStore)
+{
+    STACK_OF(X509_OBJECT)*  pObjects;
+    X509_OBJECT*            pObject;
+    time_t                  now = time(OpcUa_Null);
+    time_t                  next = 0, t;
+    int                     i;
+
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    pObjects = X509_STORE_get0_objects(a_pStore);
+#else
+    pObjects = a_pStore->objs;
+#endif
+    for(i = 0; i < sk_X509_OBJECT_num(pObjects); i++)
+    {
+        pObject = sk_X509_OBJECT_value(pObjects, i);
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+        if(X509_OBJECT_get_type(pObject) != X509_LU_CRL) continue;
+        t = OpcUa_P_OpenSSL_PKI_StoreCache_AsnTime(X509_CRL_get0_nextUpdate(X509_OBJECT_get0_X509_CRL(pObject)), now);
+#else
+        if(pObject->type != X509_LU_CRL) continue;
+        t = OpcUa_P_OpenSSL_PKI_StoreCache_AsnTime(X509_CRL_get_nextUpdate(pObject->data.crl), now);
+#endif
+        if(next == 0 || t < next) next = t;
+    }
+
+    return next;
+}
+
+/* Returns the entry currently serving a_pStore, OpcUa_Null if the store is
+ * not cached or stale. Must be called with the cache lock held. */
+static OpcUa_P_OpenSSL_PKI_StoreCacheEntry* OpcUa_P_OpenSSL_PKI_StoreCache_FindByStore(OpcUa_Void* a_pStore)
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry* pEntry;
+
+    for(pEntry = g_pStoreCache; pEntry != OpcUa_Null; pEntry = pEntry->pNext)
+    {
+        if(pEntry->pStore == (X509_STORE*)a_pStore)
+        {
+            return pEntry->iNotifyFd >= 0 ? pEntry : OpcUa_Null;
+        }
+    }
+    return OpcUa_Null;
+}
+
+/* Checks whether the certificate with the given digest was validated
+ * successfully against a_pStore and the result has not expired yet. */
+static OpcUa_Boolean OpcUa_P_OpenSSL_PKI_StoreCache_IsValidated(OpcUa_Void* a_pStore, const OpcUa_Byte* a_pDigest)
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry*    pEntry;
+    OpcUa_P_OpenSSL_PKI_ValidationCacheSlot* pSlot;
+    OpcUa_Boolean                           bFound = OpcUa_False;
+    OpcUa_UInt32                            i;
+
+    OPCUA_P_PKI_STORECACHE_LOCK();
+    pEntry = OpcUa_P_OpenSSL_PKI_StoreCache_FindByStore(a_pStore);
+    for(i = 0; pEntry != OpcUa_Null && i < pEntry->uResultCount; i++)
+    {
+        pSlot = &pEntry->pResults[i];
+        if(memcmp(pSlot->Digest, a_pDigest, SHA256_DIGEST_LENGTH) != 0) continue;
+        if(time(OpcUa_Null) < pSlot->Expires)
+        {
+            pSlot->uLastUse = ++pEntry->uResultClock;
+            bFound = OpcUa_True;
+        }
+        else
+        {
+            *pSlot = pEntry->pResults[--pEntry->uResultCount];
+        }
+        break;
+    }
+    OPCUA_P_PKI_STORECACHE_UNLOCK();
+
+    return bFound;
+}
+
+/* Remembers a successful validation of the certificate with the given
+ * digest against a_pStore until a_Expires or the next CRL update. */
+static void OpcUa_P_OpenSSL_PKI_StoreCache_AddValidated(OpcUa_Void* a_pStore, const OpcUa_Byte* a_pDigest, time_t a_Expires)
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry*    pEntry;
+    OpcUa_P_OpenSSL_PKI_ValidationCacheSlot* pSlot = OpcUa_Null;
+    OpcUa_UInt32                            i;
+
+    OPCUA_P_PKI_STORECACHE_LOCK();
+    pEntry = OpcUa_P_OpenSSL_PKI_StoreCache_FindByStore(a_pStore);
+    if(pEntry != OpcUa_Null && (pEntry->Flags & OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL) &&
+       pEntry->CrlNextUpdate != 0 && pEntry->CrlNextUpdate < a_Expires)
+    {
+        a_Expires = pEntry->CrlNextUpdate;
+    }
+    if(pEntry == OpcUa_Null || a_Expires <= time(OpcUa_Null))
+    {
+        OPCUA_P_PKI_STORECACHE_UNLOCK();
+        return;
+    }
+
+    if(pEntry->pResults == OpcUa_Null)
+    {
+        pEntry->pResults = (OpcUa_P_OpenSSL_PKI_ValidationCacheSlot*)OpcUa_P_Memory_Alloc(OPCUA_P_PKI_VALIDATIONCACHE_SIZE * sizeof(OpcUa_P_OpenSSL_PKI_ValidationCacheSlot));
+        if(pEntry->pResults == OpcUa_Null)
+        {
+            OPCUA_P_PKI_STORECACHE_UNLOCK();
+            return;
+        }
+    }
+
+    for(i = 0; i < pEntry->uResultCount; i++)
+    {
+        if(memcmp(pEntry->pResults[i].Digest, a_pDigest, SHA256_DIGEST_LENGTH) == 0)
+        {
+            pSlot = &pEntry->pResults[i];
+            break;
+        }
+        if(pEntry->uResultCount == OPCUA_P_PKI_VALIDATIONCACHE_SIZE &&
+           (pSlot == OpcUa_Null || pEntry->pResults[i].uLastUse < pSlot->uLastUse))
+        {
+            pSlot = &pEntry->pResults[i];
+        }
+    }
+    if(i == pEntry->uResultCount && pEntry->uResultCount < OPCUA_P_PKI_VALIDATIONCACHE_SIZE)
+    {
+        pSlot = &pEntry->pResults[pEntry->uResultCount++];
+    }
+
+    memcpy(pSlot->Digest, a_pDigest, SHA256_DIGEST_LENGTH);
+    pSlot->Expires = a_Expires;
+    pSlot->uLastUse = ++pEntry->uResultClock;
+    OPCUA_P_PKI_STORECACHE_UNLOCK();
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_InitializeStoreCache
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_InitializeStoreCache(OpcUa_Void)
+{
+#if OPCUA_USE_SYNCHRONISATION
+    return OpcUa_P_Mutex_Create(&g_hStoreCacheMutex);
+#else
+    return OpcUa_Good;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_PKI_CleanupStoreCache
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_OpenSSL_PKI_CleanupStoreCache(OpcUa_Void)
+{
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry* pEntry;
+
+    while(g_pStoreCache != OpcUa_Null)
+    {
+        pEntry = g_pStoreCache;
+        g_pStoreCache = pEntry->pNext;
+        OpcUa_P_OpenSSL_PKI_StoreCache_FreeEntry(pEntry);
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(g_hStoreCacheMutex != OpcUa_Null)
+    {
+        OpcUa_P_Mutex_Delete(&g_hStoreCacheMutex);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_CertificateStore_Open
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_OpenCertificateStore(
+    OpcUa_PKIProvider*          a_pProvider,
+    OpcUa_Void**                a_ppCertificateStore)           /* type depends on store implementation */
+{
+    OpcUa_P_OpenSSL_CertificateStore_Config*    pCertificateStoreCfg;
+    OpcUa_P_OpenSSL_PKI_StoreCacheEntry*        pEntry;
+    X509_STORE*                                 pStore          = OpcUa_Null;
+    X509_STORE*                                 pOldStore       = OpcUa_Null;
+    int                                         iNotifyFd       = -1;
+    time_t                                      CrlNextUpdate   = 0;
+
+OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_OpenCertificateStore");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider);
+    OpcUa_ReturnErrorIfArgumentNull(a_pProvider->Handle);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppCertificateStore);
+
+    *a_ppCertificateStore = OpcUa_Null;
+
+    pCertificateStoreCfg = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pProvider->Handle;
+
+    OPCUA_P_PKI_STORECACHE_LOCK();
+    pEntry = OpcUa_P_OpenSSL_PKI_StoreCache_Find(pCertificateStoreCfg);
+    if(pEntry == OpcUa_Null)
+    {
+        OPCUA_P_PKI_STORECACHE_UNLOCK();
+        return OpcUa_P_OpenSSL_PKI_BuildCertificateStore(pCertificateStoreCfg, a_ppCertificateStore);
+    }
+
+    if(pEntry->iNotifyFd >= 0 && OpcUa_P_OpenSSL_PKI_StoreCache_Changed(pEntry))
+    {
+        /* stale: rebuild, the old store stays in use until then */
+        close(pEntry->iNotifyFd);
+        pEntry->iNotifyFd = -1;
+    }
+
+    if(pEntry->pStore != OpcUa_Null && (pEntry->iNotifyFd >= 0 || pEntry->bBuilding))
+    {
+        X509_STORE_up_ref(pEntry->pStore);
+        *a_ppCertificateStore = pEntry->pStore;
+        OPCUA_P_PKI_STORECACHE_UNLOCK();
+        return OpcUa_Good;
+    }
+
+    if(pEntry->bBuilding)
+    {
+        /* first build still in progress, build a private store meanwhile */
+        OPCUA_P_PKI_STORECACHE_UNLOCK();
+        return OpcUa_P_OpenSSL_PKI_BuildCertificateStore(pCertificateStoreCfg, a_ppCertificateStore);
+    }
+
+    pEntry->bBuilding = OpcUa_True;
+    OPCUA_P_PKI_STORECACHE_UNLOCK();
+
+    /* watch before loading, so changes made during the build are not lost */
+    iNotifyFd = OpcUa_P_OpenSSL_PKI_StoreCache_Watch(pEntry);
+    uStatus = OpcUa_P_OpenSSL_PKI_BuildCertificateStore(pCertificateStoreCfg, (OpcUa_Void**)&pStore);
+    if(OpcUa_IsGood(uStatus))
+    {
+        CrlNextUpdate = OpcUa_P_OpenSSL_PKI_StoreCache_CrlNextUpdate(pStore);
+    }
+
+    OPCUA_P_PKI_STORECACHE_LOCK();
+    pOldStore = pEntry->pStore;
+    pEntry->pStore = OpcUa_Null;
+    pEntry->uResultCount = 0;
+    if(OpcUa_IsGood(uStatus) && iNotifyFd >= 0)
+    {
+        X509_STORE_up_ref(pStore);
+        pEntry->pStore = pStore;
+        pEntry->iNotifyFd = iNotifyFd;
+        pEntry->CrlNextUpdate = CrlNextUpdate;
+        iNotifyFd = -1;
+    }
+    pEntry->bBuilding = OpcUa_False;
+    OPCUA_P_PKI_STORECACHE_UNLOCK();
+
+    if(pOldStore != OpcUa_Null) X509_STORE_free(pOldStore);
+    if(iNotifyFd >= 0) close(iNotifyFd);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    *a_ppCertificateStore = pStore;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_P_OpenSSL_CertificateStore_Close
  *===========================================================================*/
@@ -457,6 +920,8 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_PKI_ValidateCertificate(
     char                CertFile[MAX_PATH];
     struct dirent **dirlist = NULL;
     int numCertificates = 0, i;
+    OpcUa_Byte          Digest[SHA256_DIGEST_LENGTH];
+    OpcUa_Boolean       bCacheResult;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
 
@@ -468,6 +933,20 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
 
     pCertificateStoreCfg = (OpcUa_P_OpenSSL_CertificateStore_Config*)a_pProvider->Handle;
 
+    /* CRLs of an index directory are loaded lazily, their nextUpdate is unknown */
+    bCacheResult = OPCUA_P_PKI_VALIDATIONCACHE_SIZE > 0 && a_pCertificate->Length > 0 &&
+                   !((pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_CHECK_REVOCATION_ALL) &&
+                     (pCertificateStoreCfg->Flags & OPCUA_P_PKI_OPENSSL_REVOCATION_LIST_IS_INDEX));
+    if(bCacheResult)
+    {
+        SHA256(a_pCertificate->Data, (size_t)a_pCertificate->Length, Digest);
+        if(OpcUa_P_OpenSSL_PKI_StoreCache_IsValidated(a_pCertificateStore, Digest))
+        {
+            *a_pValidationCode = X509_V_OK;
+            OpcUa_ReturnStatusCode;
+        }
+    }
+
     /* convert DER encoded bytestring certificate to openssl X509 certificate */
     p = a_pCertificate->Data;
     if(!(pX509Certificate = d2i_X509((X509**)OpcUa_Null, &p, a_pCertificate->Length)))
@@ -631,6 +1110,23 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "PKI_ValidateCertificate");
         }
     }
 
+    if(bCacheResult)
+    {
+        STACK_OF(X509)*  chain  = X509_STORE_CTX_get_chain(verify_ctx);
+        time_t           now    = time(OpcUa_Null);
+        time_t           expires = now + OPCUA_P_PKI_VALIDATIONCACHE_MAXAGE;
+        time_t           t;
+        int              n;
+
+        for(n = 0; n < sk_X509_num(chain); n++)
+        {
+            t = OpcUa_P_OpenSSL_PKI_StoreCache_AsnTime(X509_get_notAfter(sk_X509_value(chain, n)), now);
+            if(t < expires) expires = t;
+        }
+
+        OpcUa_P_OpenSSL_PKI_StoreCache_AddValidated(a_pCertificateStore, Digest, expires);
+    }
+
     X509_STORE_CTX_free(verify_ctx);
     X509_free(pX509Certificate);
     if(pX509Chain != OpcUa_Null)
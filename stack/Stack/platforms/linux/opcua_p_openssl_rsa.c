@@ -30,6 +30,7 @@
 /* UA platform definitions */
 #include <opcua_p_internal.h>
 #include <opcua_p_memory.h>
+#include <opcua_p_mutex.h>
 
 #if OPCUA_REQUIRE_OPENSSL
 
@@ -45,8 +46,180 @@
 #define get_pkey_rsa(evp) EVP_PKEY_get0_RSA(evp)
 #else
 #define get_pkey_rsa(evp) ((evp)->pkey.rsa)
+#define EVP_PKEY_up_ref(evp) CRYPTO_add(&(evp)->references, 1, CRYPTO_LOCK_EVP_PKEY)
 #endif
 
+/*============================================================================
+ * Parsed key cache
+ *===========================================================================*/
+/* Keys reach the RSA functions as DER encodings, and decoding a private key
+ * costs far more than the padding and bookkeeping around the RSA operation
+ * itself. The server key and the public keys of connected peers are used
+ * over and over, so the parsed EVP_PKEY of recently used encodings is kept
+ * and shared by reference. Entries are found by FNV-1a hash and confirmed by
+ * comparing the full encoding; the least recently used one is replaced. */
+typedef struct _OpcUa_P_OpenSSL_RSA_KeyCacheEntry
+{
+    OpcUa_UInt32    uHash;
+    OpcUa_UInt      uType;
+    OpcUa_Int32     iLength;
+    OpcUa_Byte*     pEncoding;
+    EVP_PKEY*       pKey;
+    OpcUa_UInt32    uLastUse;
+} OpcUa_P_OpenSSL_RSA_KeyCacheEntry;
+
+static OpcUa_P_OpenSSL_RSA_KeyCacheEntry g_RsaKeyCache[OPCUA_P_OPENSSL_RSA_KEYCACHE_SIZE];
+static OpcUa_UInt32 g_uRsaKeyCacheClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+static OpcUa_Mutex g_hRsaKeyCacheMutex = OpcUa_Null;
+# define OPCUA_P_RSA_KEYCACHE_LOCK()   OpcUa_P_Mutex_Lock(g_hRsaKeyCacheMutex)
+# define OPCUA_P_RSA_KEYCACHE_UNLOCK() OpcUa_P_Mutex_Unlock(g_hRsaKeyCacheMutex)
+#else
+# define OPCUA_P_RSA_KEYCACHE_LOCK()
+# define OPCUA_P_RSA_KEYCACHE_UNLOCK()
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+static void OpcUa_P_OpenSSL_RSA_KeyCache_ClearEntry(OpcUa_P_OpenSSL_RSA_KeyCacheEntry* a_pEntry)
+{
+    if(a_pEntry->pEncoding != OpcUa_Null)
+    {
+        OPENSSL_cleanse(a_pEntry->pEncoding, a_pEntry->iLength);
+        OpcUa_P_Memory_Free(a_pEntry->pEncoding);
+    }
+    if(a_pEntry->pKey != OpcUa_Null)
+    {
+        EVP_PKEY_free(a_pEntry->pKey);
+    }
+    OpcUa_MemSet(a_pEntry, 0, sizeof(OpcUa_P_OpenSSL_RSA_KeyCacheEntry));
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_RSA_InitializeKeyCache
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_InitializeKeyCache(OpcUa_Void)
+{
+    OpcUa_MemSet(g_RsaKeyCache, 0, sizeof(g_RsaKeyCache));
+    g_uRsaKeyCacheClock = 0;
+#if OPCUA_USE_SYNCHRONISATION
+    return OpcUa_P_Mutex_Create(&g_hRsaKeyCacheMutex);
+#else
+    return OpcUa_Good;
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_RSA_CleanupKeyCache
+ *===========================================================================*/
+OpcUa_Void OpcUa_P_OpenSSL_RSA_CleanupKeyCache(OpcUa_Void)
+{
+    OpcUa_UInt32 i;
+
+    for(i = 0; i < OPCUA_P_OPENSSL_RSA_KEYCACHE_SIZE; i++)
+    {
+        OpcUa_P_OpenSSL_RSA_KeyCache_ClearEntry(&g_RsaKeyCache[i]);
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    if(g_hRsaKeyCacheMutex != OpcUa_Null)
+    {
+        OpcUa_P_Mutex_Delete(&g_hRsaKeyCacheMutex);
+    }
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+ * OpcUa_P_OpenSSL_RSA_GetKey
+ *===========================================================================*/
+/* Returns the parsed form of an Rsa_Private or Rsa_Public key, or OpcUa_Null
+ * if it cannot be decoded. The caller releases it with EVP_PKEY_free. */
+static EVP_PKEY* OpcUa_P_OpenSSL_RSA_GetKey(const OpcUa_Key* a_pKey)
+{
+    OpcUa_P_OpenSSL_RSA_KeyCacheEntry*  pEntry  = OpcUa_Null;
+    EVP_PKEY*                           pKey    = OpcUa_Null;
+    const unsigned char*                pData   = a_pKey->Key.Data;
+    OpcUa_Byte*                         pEncoding;
+    OpcUa_UInt32                        uHash   = 2166136261u;
+    OpcUa_Int32                         i;
+
+    if(a_pKey->Key.Length <= 0)
+    {
+        return OpcUa_Null;
+    }
+
+    for(i = 0; i < a_pKey->Key.Length; i++)
+    {
+        uHash = (uHash ^ a_pKey->Key.Data[i]) * 16777619u;
+    }
+
+    OPCUA_P_RSA_KEYCACHE_LOCK();
+    for(i = 0; i < OPCUA_P_OPENSSL_RSA_KEYCACHE_SIZE; i++)
+    {
+        if(g_RsaKeyCache[i].pKey != OpcUa_Null &&
+           g_RsaKeyCache[i].uHash == uHash &&
+           g_RsaKeyCache[i].uType == a_pKey->Type &&
+           g_RsaKeyCache[i].iLength == a_pKey->Key.Length &&
+           memcmp(g_RsaKeyCache[i].pEncoding, a_pKey->Key.Data, a_pKey->Key.Length) == 0)
+        {
+            g_RsaKeyCache[i].uLastUse = ++g_uRsaKeyCacheClock;
+            pKey = g_RsaKeyCache[i].pKey;
+            EVP_PKEY_up_ref(pKey);
+            break;
+        }
+    }
+    OPCUA_P_RSA_KEYCACHE_UNLOCK();
+
+    if(pKey != OpcUa_Null)
+    {
+        return pKey;
+    }
+
+    if(a_pKey->Type == OpcUa_Crypto_KeyType_Rsa_Private)
+    {
+        pKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_pKey->Key.Length);
+    }
+    else
+    {
+        pKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_pKey->Key.Length);
+    }
+    if(pKey == OpcUa_Null)
+    {
+        return OpcUa_Null;
+    }
+
+    pEncoding = (OpcUa_Byte*)OpcUa_P_Memory_Alloc(a_pKey->Key.Length);
+    if(pEncoding == OpcUa_Null)
+    {
+        /* still usable, just not cached */
+        return pKey;
+    }
+    memcpy(pEncoding, a_pKey->Key.Data, a_pKey->Key.Length);
+
+    OPCUA_P_RSA_KEYCACHE_LOCK();
+    for(i = 0; i < OPCUA_P_OPENSSL_RSA_KEYCACHE_SIZE; i++)
+    {
+        if(g_RsaKeyCache[i].pKey == OpcUa_Null)
+        {
+            pEntry = &g_RsaKeyCache[i];
+            break;
+        }
+        if(pEntry == OpcUa_Null || g_RsaKeyCache[i].uLastUse < pEntry->uLastUse)
+        {
+            pEntry = &g_RsaKeyCache[i];
+        }
+    }
+    OpcUa_P_OpenSSL_RSA_KeyCache_ClearEntry(pEntry);
+    pEntry->uHash       = uHash;
+    pEntry->uType       = a_pKey->Type;
+    pEntry->iLength     = a_pKey->Key.Length;
+    pEntry->pEncoding   = pEncoding;
+    pEntry->pKey        = pKey;
+    pEntry->uLastUse    = ++g_uRsaKeyCacheClock;
+    EVP_PKEY_up_ref(pKey);
+    OPCUA_P_RSA_KEYCACHE_UNLOCK();
+
+    return pKey;
+}
+
 /*============================================================================
  * OpcUa_P_OpenSSL_RSA_GenerateKeys
  *===========================================================================*/
@@ -131,7 +304,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_Public_GetKeyLength(
     OpcUa_UInt32*           a_pKeyLen)
 {
     EVP_PKEY*       pPublicKey      = OpcUa_Null;
-    const unsigned char *pData;
 
     OpcUa_UInt32    uKeySize            = 0;
 
@@ -148,8 +320,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Public_GetKeyLength");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_publicKey.Key.Data;
-    pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_publicKey.Key.Length);
+    pPublicKey = OpcUa_P_OpenSSL_RSA_GetKey(&a_publicKey);
 
     if(pPublicKey == OpcUa_Null)
     {
@@ -202,7 +373,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_Public_Encrypt(
     OpcUa_UInt32    uCipherTextPosition = 0;
     OpcUa_UInt32    uBytesToEncrypt     = 0;
     OpcUa_Int32     iEncryptedBytes     = 0;
-    const unsigned char *pData;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Public_Encrypt");
 
@@ -225,8 +395,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Public_Encrypt");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_publicKey->Key.Data;
-    pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_publicKey->Key.Length);
+    pPublicKey = OpcUa_P_OpenSSL_RSA_GetKey(a_publicKey);
 
     if(pPublicKey == OpcUa_Null)
     {
@@ -335,7 +504,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_Private_Decrypt(
     OpcUa_UInt32    iCipherText     = 0;
     OpcUa_UInt32    decDataSize     = 0;
 
-    const unsigned char *pData;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Private_Decrypt");
 
@@ -359,8 +527,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Private_Decrypt");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_privateKey->Key.Data;
-    pPrivateKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_privateKey->Key.Length);
+    pPrivateKey = OpcUa_P_OpenSSL_RSA_GetKey(a_privateKey);
 
     if(pPrivateKey == OpcUa_Null)
     {
@@ -474,7 +641,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_Private_Sign(
     OpcUa_ByteString*     a_pSignature)       /* output length >= key length */
 {
     EVP_PKEY*               pSSLPrivateKey  = OpcUa_Null;
-    const unsigned char*    pData           = OpcUa_Null;
     int                     iErr            = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Private_Sign");
@@ -487,12 +653,11 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Private_Sign");
     OpcUa_ReturnErrorIfArgumentNull(a_privateKey);
     OpcUa_ReturnErrorIfArgumentNull(a_pSignature);
     OpcUa_ReturnErrorIfArgumentNull(a_pSignature->Data);
-    pData = a_privateKey->Key.Data;
-    OpcUa_ReturnErrorIfArgumentNull(pData);
+    OpcUa_ReturnErrorIfArgumentNull(a_privateKey->Key.Data);
     OpcUa_ReturnErrorIfTrue((a_privateKey->Type != OpcUa_Crypto_KeyType_Rsa_Private), OpcUa_BadInvalidArgument);
 
     /* convert private key and check key length against buffer length */
-    pSSLPrivateKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_privateKey->Key.Length);
+    pSSLPrivateKey = OpcUa_P_OpenSSL_RSA_GetKey(a_privateKey);
     OpcUa_GotoErrorIfTrue((pSSLPrivateKey == OpcUa_Null), OpcUa_BadUnexpectedError);
     OpcUa_GotoErrorIfTrue((a_pSignature->Length < RSA_size(get_pkey_rsa(pSSLPrivateKey))), OpcUa_BadInvalidArgument);
 
@@ -526,7 +691,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_Public_Verify(
 {
     EVP_PKEY*            pPublicKey      = OpcUa_Null;
     OpcUa_Int32          keySize         = 0;
-    const unsigned char *pData;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Public_Verify");
 
@@ -542,8 +706,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_Public_Verify");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_publicKey->Key.Data;
-    pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_publicKey->Key.Length);
+    pPublicKey = OpcUa_P_OpenSSL_RSA_GetKey(a_publicKey);
 
     if(pPublicKey == OpcUa_Null)
     {
@@ -607,7 +770,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_SHA256_Public_Encrypt(
     OpcUa_UInt32    uBytesToEncrypt     = 0;
     size_t          iEncryptedBytes     = 0;
     int             ret                 = 0;
-    const unsigned char *pData;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_SHA256_Public_Encrypt");
 
@@ -630,8 +792,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_SHA256_Public_Encrypt");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_publicKey->Key.Data;
-    pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_publicKey->Key.Length);
+    pPublicKey = OpcUa_P_OpenSSL_RSA_GetKey(a_publicKey);
 
     if(pPublicKey == OpcUa_Null)
     {
@@ -738,7 +899,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_SHA256_Private_Decrypt(
     OpcUa_UInt32    decDataSize     = 0;
     int             ret             = 0;
 
-    const unsigned char *pData;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_SHA256_Private_Decrypt");
 
@@ -762,8 +922,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_SHA256_Private_Decrypt");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_privateKey->Key.Data;
-    pPrivateKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_privateKey->Key.Length);
+    pPrivateKey = OpcUa_P_OpenSSL_RSA_GetKey(a_privateKey);
 
     if(pPrivateKey == OpcUa_Null)
     {
@@ -876,7 +1035,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_PSS_Private_Sign(
 #else
     EVP_PKEY_CTX*           pCtx            = OpcUa_Null;
     EVP_PKEY*               pSSLPrivateKey  = OpcUa_Null;
-    const unsigned char*    pData           = OpcUa_Null;
     int                     ret             = 0;
     size_t                  siglen          = 0;
 
@@ -890,12 +1048,11 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_PSS_Private_Sign");
     OpcUa_ReturnErrorIfArgumentNull(a_privateKey);
     OpcUa_ReturnErrorIfArgumentNull(a_pSignature);
     OpcUa_ReturnErrorIfArgumentNull(a_pSignature->Data);
-    pData = a_privateKey->Key.Data;
-    OpcUa_ReturnErrorIfArgumentNull(pData);
+    OpcUa_ReturnErrorIfArgumentNull(a_privateKey->Key.Data);
     OpcUa_ReturnErrorIfTrue((a_privateKey->Type != OpcUa_Crypto_KeyType_Rsa_Private), OpcUa_BadInvalidArgument);
 
     /* convert private key and check key length against buffer length */
-    pSSLPrivateKey = d2i_PrivateKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_privateKey->Key.Length);
+    pSSLPrivateKey = OpcUa_P_OpenSSL_RSA_GetKey(a_privateKey);
     OpcUa_GotoErrorIfTrue((pSSLPrivateKey == OpcUa_Null), OpcUa_BadUnexpectedError);
     OpcUa_GotoErrorIfTrue((a_pSignature->Length < RSA_size(get_pkey_rsa(pSSLPrivateKey))), OpcUa_BadInvalidArgument);
 
@@ -952,7 +1109,6 @@ OpcUa_StatusCode OpcUa_P_OpenSSL_RSA_PSS_Public_Verify(
 #else
     EVP_PKEY_CTX*        pCtx            = OpcUa_Null;
     EVP_PKEY*            pPublicKey      = OpcUa_Null;
-    const unsigned char *pData           = OpcUa_Null;
     int                  ret             = 0;
 
 OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_PSS_Public_Verify");
@@ -969,8 +1125,7 @@ OpcUa_InitializeStatus(OpcUa_Module_P_OpenSSL, "RSA_PSS_Public_Verify");
         OpcUa_GotoErrorWithStatus(OpcUa_BadInvalidArgument);
     }
 
-    pData = a_publicKey->Key.Data;
-    pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, OpcUa_Null, &pData, a_publicKey->Key.Length);
+    pPublicKey = OpcUa_P_OpenSSL_RSA_GetKey(a_publicKey);
 
     if(pPublicKey == OpcUa_Null)
     {
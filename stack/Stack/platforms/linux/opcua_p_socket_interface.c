@@ -91,7 +91,7 @@ OpcUa_Void OpcUa_P_SocketManager_ServerLoopThread(OpcUa_Void* a_pArgument)
         OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-        for(iSocketManagerSlot = 0; iSocketManagerSlot < OPCUA_SOCKET_MAXMANAGERS; iSocketManagerSlot++)
+        for(iSocketManagerSlot = 0; iSocketManagerSlot < (OpcUa_Int32)pInternalSocketManager->uintMaxManagers; iSocketManagerSlot++)
         {
             if(pInternalSocketManager->pSocketManagers[iSocketManagerSlot] != OpcUa_Null)
             {
@@ -137,6 +137,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "NewSignalSocket");
 
     OpcUa_GotoErrorIfArgumentNull(a_pSocketManager);
 
+    uStatus = OpcUa_P_SocketManager_CreateEpoll(a_pSocketManager);
+    OpcUa_GotoErrorIfBad(uStatus);
+
     pIntSignalSocket = (OpcUa_InternalSocket*)OpcUa_SocketManager_FindFreeSocket(a_pSocketManager, OpcUa_True);
 
     if(pIntSignalSocket == OpcUa_Null)
@@ -171,6 +174,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "NewSignalSocket");
     }
 
     OPCUA_SOCKET_SETVALID(pIntSignalSocket);
+    OpcUa_P_Socket_UpdateEpoll(pIntSignalSocket);
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -181,6 +185,8 @@ OpcUa_BeginErrorHandling;
         OPCUA_SOCKET_INVALIDATE(pIntSignalSocket);
     }
 
+    OpcUa_P_SocketManager_CloseEpoll(a_pSocketManager);
+
 OpcUa_FinishErrorHandling;
 }
 
@@ -293,12 +299,13 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SocketManager_Create");
         return OpcUa_BadInvalidArgument;
     }
 
-    if(a_nSockets > OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS)
+    /* the socket table grows on demand, so a_nSockets is only an upper limit */
+    if(a_nSockets >= OpcUa_UInt32_Max)
     {
         return OpcUa_BadInvalidArgument;
     }
 
-    /* set number of socket to maximum */
+    /* set number of socket to default */
     if(a_nSockets == 0)
     {
         a_nSockets = OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS;
@@ -330,7 +337,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SocketManager_Create");
     OpcUa_GotoErrorIfBad(uStatus);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    /* preallocate socket structures for all possible sockets (maxsockets) */
+    /* prepare the socket table for all possible sockets (maxsockets) */
     uStatus = OpcUa_SocketManager_CreateSockets((OpcUa_SocketManager)pInternalSocketManager, a_nSockets);
     OpcUa_GotoErrorIfBad(uStatus);
 
@@ -362,9 +369,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SocketManager_Create");
         uStatus = OpcUa_P_Semaphore_Create(&pInternalSocketManager->pStartupSemaphore, 0, 1);
         OpcUa_GotoErrorIfBad(uStatus);
 
-        pInternalSocketManager->pSocketManagers = OpcUa_P_Memory_Alloc(sizeof(OpcUa_InternalSocketManager*) * OPCUA_SOCKET_MAXMANAGERS);
+        /* every accepted connection may get its own socket manager */
+        pInternalSocketManager->uintMaxManagers = (a_nSockets > OPCUA_SOCKET_MAXMANAGERS)?a_nSockets:OPCUA_SOCKET_MAXMANAGERS;
+
+        pInternalSocketManager->pSocketManagers = OpcUa_P_Memory_Alloc(sizeof(OpcUa_InternalSocketManager*) * pInternalSocketManager->uintMaxManagers);
         OpcUa_GotoErrorIfAllocFailed(pInternalSocketManager->pSocketManagers);
-        OpcUa_MemSet(pInternalSocketManager->pSocketManagers, 0, sizeof(OpcUa_InternalSocketManager*) * OPCUA_SOCKET_MAXMANAGERS);
+        OpcUa_MemSet(pInternalSocketManager->pSocketManagers, 0, sizeof(OpcUa_InternalSocketManager*) * pInternalSocketManager->uintMaxManagers);
     }
 
     /* if multithreaded, create and start the server thread if the list is not the global list. */
@@ -400,13 +410,14 @@ OpcUa_BeginErrorHandling;
         {
             OpcUa_P_RawSocket_Close(pInternalSocketManager->pCookie);
         }
-        if(pInternalSocketManager->pSockets != OpcUa_Null)
+        OpcUa_P_SocketManager_CloseEpoll(pInternalSocketManager);
+        if(pInternalSocketManager->ppSocketChunks != OpcUa_Null)
         {
-            if(pInternalSocketManager->pSockets[0].rawSocket != (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID)
+            if(OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, 0)->rawSocket != (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID)
             {
-                OpcUa_P_RawSocket_Close(pInternalSocketManager->pSockets[0].rawSocket);
+                OpcUa_P_RawSocket_Close(OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, 0)->rawSocket);
             }
-            OpcUa_P_Memory_Free(pInternalSocketManager->pSockets);
+            OpcUa_SocketManager_DeleteSockets(pInternalSocketManager);
         }
 #if OPCUA_USE_SYNCHRONISATION
         if(pInternalSocketManager->pMutex != OpcUa_Null)
@@ -465,26 +476,27 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_SocketManager_Delete(OpcUa_SocketManager* a_pSo
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
     /* handle the socket list content (close, cleanup, etc.) */
-    if(pInternalSocketManager->pSockets != OpcUa_Null)
+    if(pInternalSocketManager->ppSocketChunks != OpcUa_Null)
     {
-        for(uintIndex = 0; uintIndex < pInternalSocketManager->uintMaxSockets; uintIndex++)
+        for(uintIndex = 0; uintIndex < pInternalSocketManager->uintSockets; uintIndex++)
         {
-            OpcUa_Socket pSocketTemp = &(pInternalSocketManager->pSockets[uintIndex]);
+            OpcUa_InternalSocket* pSocketTemp = OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, uintIndex);
 
-            if(   (pInternalSocketManager->pSockets[uintIndex].bSocketIsInUse != OpcUa_False)
-               && (pInternalSocketManager->pSockets[uintIndex].bInvalidSocket == OpcUa_False))
+            if(   (pSocketTemp->bSocketIsInUse != OpcUa_False)
+               && (pSocketTemp->bInvalidSocket == OpcUa_False))
             {
                 OpcUa_Socket_HandleEvent(pSocketTemp, OPCUA_SOCKET_CLOSE_EVENT);
-                OpcUa_P_RawSocket_Close(pInternalSocketManager->pSockets[uintIndex].rawSocket);
+                OpcUa_P_RawSocket_Close(pSocketTemp->rawSocket);
             }
 
             OpcUa_Socket_Clear(pSocketTemp);
         }
 
-        OpcUa_P_Memory_Free(pInternalSocketManager->pSockets);
-    } /* if(pInternalSocketManager->pSockets != OpcUa_Null) */
+        OpcUa_SocketManager_DeleteSockets(pInternalSocketManager);
+    } /* if(pInternalSocketManager->ppSocketChunks != OpcUa_Null) */
 
     OpcUa_P_RawSocket_Close(pInternalSocketManager->pCookie);
+    OpcUa_P_SocketManager_CloseEpoll(pInternalSocketManager);
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
@@ -683,6 +695,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateClient");
     *a_pSocket = pNewClientSocket;
 
     OPCUA_SOCKET_SETVALID(pNewClientSocket);
+    OpcUa_P_Socket_UpdateEpoll(pNewClientSocket);
 
     /* break loop to add new socket into eventing */
     uStatus = OpcUa_P_SocketManager_InterruptLoop(  a_hSocketManager,
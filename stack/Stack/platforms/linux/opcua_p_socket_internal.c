@@ -57,6 +57,10 @@
 /* platform layer includes */
 #include <opcua_p_timer.h> /* for timered select */
 
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+#include <sys/epoll.h>
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+
 
 /*============================================================================
  * Read Socket.
@@ -81,6 +85,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "Read");
         OpcUa_P_Mutex_Lock(pInternalSocket->pSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
         pInternalSocket->Flags.EventMask |= OPCUA_SOCKET_READ_EVENT;
+        OpcUa_P_Socket_UpdateEpoll(pInternalSocket);
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Unlock(pInternalSocket->pSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
@@ -221,6 +226,7 @@ static OpcUa_Int32 OpcUa_P_SocketService_Write( OpcUa_Socket    a_pSocket,
         OpcUa_P_Mutex_Lock(pInternalSocket->pSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
         pInternalSocket->Flags.EventMask |= OPCUA_SOCKET_WRITE_EVENT;
+        OpcUa_P_Socket_UpdateEpoll(pInternalSocket);
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Unlock(pInternalSocket->pSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
@@ -272,6 +278,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "Close");
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_P_Socket_Close: Shutting down socket %p!\n", a_pSocket);
     uStatus = OpcUa_P_RawSocket_Shutdown(pInternalSocket->rawSocket, OPCUA_P_SOCKET_SD_BOTH);
 
+    /* the hangup caused by the shutdown lets the serve loop finish the close */
+    OpcUa_P_Socket_UpdateEpoll(pInternalSocket);
+
 #if OPCUA_MULTITHREADED
     /* the if this is a client connection in a own thread, the loop should be notified to shut down */
     if(pInternalSocket->Flags.bOwnThread != 0)
@@ -466,10 +475,57 @@ OpcUa_Void OpcUa_SocketManager_Initialize(OpcUa_SocketManager a_pSocketManager)
 
     pInternalSocketManager = (OpcUa_InternalSocketManager*)a_pSocketManager;
 
-    pInternalSocketManager->pSockets                = OpcUa_Null;
+    pInternalSocketManager->ppSocketChunks          = OpcUa_Null;
+    pInternalSocketManager->uintSockets             = 0;
     pInternalSocketManager->uintMaxSockets          = 0;
+    pInternalSocketManager->pFreeSockets            = OpcUa_Null;
     pInternalSocketManager->pCookie                 = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
     pInternalSocketManager->uintLastExternalEvent   = OPCUA_SOCKET_NO_EVENT;
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+    pInternalSocketManager->iEpollFd                = -1;
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+}
+
+/*============================================================================
+ * Allocate the next chunk of the socket table and add it to the free list.
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_SocketManager_AddSocketChunk(OpcUa_InternalSocketManager* a_pSocketManager)
+{
+    OpcUa_UInt32            ntemp   = 0;
+    OpcUa_UInt32            uIndex  = 0;
+    OpcUa_InternalSocket*   pChunk  = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "AddSocketChunk");
+
+    /* sockets never move once allocated, so the loops can grow the table while iterating */
+    pChunk = (OpcUa_InternalSocket *)OpcUa_P_Memory_Alloc(sizeof(OpcUa_InternalSocket) * OPCUA_P_SOCKETMANAGER_CHUNKSIZE);
+    OpcUa_GotoErrorIfAllocFailed(pChunk);
+
+    /* initialize the whole chunk with zero */
+    OpcUa_MemSet(pChunk, 0, sizeof(OpcUa_InternalSocket) * OPCUA_P_SOCKETMANAGER_CHUNKSIZE);
+
+    /* link in reverse order, so the lowest index is handed out first */
+    for(ntemp = OPCUA_P_SOCKETMANAGER_CHUNKSIZE; ntemp > 0; ntemp--)
+    {
+        uIndex = a_pSocketManager->uintSockets + ntemp - 1;
+
+        OpcUa_Socket_Initialize(&pChunk[ntemp - 1]);
+        pChunk[ntemp - 1].uintIndex = uIndex;
+
+        /* the signal socket is taken explicitly and never put into the free list */
+        if(uIndex != 0 && uIndex < a_pSocketManager->uintMaxSockets)
+        {
+            pChunk[ntemp - 1].pNextFree      = a_pSocketManager->pFreeSockets;
+            a_pSocketManager->pFreeSockets   = &pChunk[ntemp - 1];
+        }
+    }
+
+    a_pSocketManager->ppSocketChunks[a_pSocketManager->uintSockets / OPCUA_P_SOCKETMANAGER_CHUNKSIZE] = pChunk;
+    a_pSocketManager->uintSockets += OPCUA_P_SOCKETMANAGER_CHUNKSIZE;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
@@ -479,7 +535,7 @@ OpcUa_StatusCode OpcUa_SocketManager_CreateSockets(
     OpcUa_SocketManager a_pSocketManager,
     OpcUa_UInt32        a_uMaxSockets)
 {
-    OpcUa_UInt32                 ntemp                  = 0;
+    OpcUa_UInt32                 uChunks                = 0;
     OpcUa_InternalSocketManager* pInternalSocketManager = OpcUa_Null;
 
 OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSockets");
@@ -492,18 +548,20 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSockets");
     OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    pInternalSocketManager->pSockets = (OpcUa_InternalSocket *)OpcUa_P_Memory_Alloc(sizeof(OpcUa_InternalSocket) * a_uMaxSockets);
-    OpcUa_GotoErrorIfAllocFailed(pInternalSocketManager->pSockets);
+    /* only the chunk table is sized for the maximum, the chunks are allocated when needed */
+    uChunks = (a_uMaxSockets + OPCUA_P_SOCKETMANAGER_CHUNKSIZE - 1) / OPCUA_P_SOCKETMANAGER_CHUNKSIZE;
 
-    /* initialize the whole socket list with zero */
-    OpcUa_MemSet(pInternalSocketManager->pSockets, 0, sizeof(OpcUa_InternalSocket) * a_uMaxSockets);
-
-    for(ntemp = 0; ntemp < a_uMaxSockets; ntemp++)
-    {
-        OpcUa_Socket_Initialize(&(pInternalSocketManager->pSockets[ntemp]));
-    }
+    pInternalSocketManager->ppSocketChunks = (OpcUa_InternalSocket **)OpcUa_P_Memory_Alloc(sizeof(OpcUa_InternalSocket*) * uChunks);
+    OpcUa_GotoErrorIfAllocFailed(pInternalSocketManager->ppSocketChunks);
+    OpcUa_MemSet(pInternalSocketManager->ppSocketChunks, 0, sizeof(OpcUa_InternalSocket*) * uChunks);
 
+    pInternalSocketManager->uintSockets    = 0;
     pInternalSocketManager->uintMaxSockets = a_uMaxSockets;
+    pInternalSocketManager->pFreeSockets   = OpcUa_Null;
+
+    /* the first chunk holds the signal socket */
+    uStatus = OpcUa_SocketManager_AddSocketChunk(pInternalSocketManager);
+    OpcUa_GotoErrorIfBad(uStatus);
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
@@ -511,9 +569,44 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateSockets");
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
+
+    if(pInternalSocketManager != OpcUa_Null)
+    {
+        OpcUa_SocketManager_DeleteSockets(pInternalSocketManager);
+
+#if OPCUA_USE_SYNCHRONISATION
+        OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+    }
+
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * Free the Sockets in the List
+ *===========================================================================*/
+OpcUa_Void OpcUa_SocketManager_DeleteSockets(OpcUa_SocketManager a_pSocketManager)
+{
+    OpcUa_UInt32                 uChunk                 = 0;
+    OpcUa_InternalSocketManager* pInternalSocketManager = (OpcUa_InternalSocketManager*)a_pSocketManager;
+
+    if(pInternalSocketManager == OpcUa_Null || pInternalSocketManager->ppSocketChunks == OpcUa_Null)
+    {
+        return;
+    }
+
+    for(uChunk = 0; uChunk < pInternalSocketManager->uintSockets / OPCUA_P_SOCKETMANAGER_CHUNKSIZE; uChunk++)
+    {
+        OpcUa_P_Memory_Free(pInternalSocketManager->ppSocketChunks[uChunk]);
+    }
+
+    OpcUa_P_Memory_Free(pInternalSocketManager->ppSocketChunks);
+
+    pInternalSocketManager->ppSocketChunks = OpcUa_Null;
+    pInternalSocketManager->uintSockets    = 0;
+    pInternalSocketManager->pFreeSockets   = OpcUa_Null;
+}
+
 /************************* Internal Helper Functions *************************/
 
 /*============================================================================
@@ -553,6 +646,7 @@ OpcUa_StatusCode OpcUa_SocketManager_InternalCreateServer(
     pInternalSocket->usPort                 = a_uPort;
 
     OPCUA_SOCKET_SETVALID(pInternalSocket);
+    OpcUa_P_Socket_UpdateEpoll(pInternalSocket);
 
     *a_ppSocket = pInternalSocket;
 
@@ -597,6 +691,17 @@ OpcUa_StatusCode OpcUa_Socket_HandleAcceptEvent(    OpcUa_Socket a_pListenSocket
         return OpcUa_BadCommunicationError;
     }
 
+#if !OPCUA_P_SOCKETMANAGER_USE_EPOLL
+    /* select can not wait on system sockets beyond the fd_set, however large the socket table is */
+    if(pAcceptInternalSocket->rawSocket >= FD_SETSIZE)
+    {
+        OpcUa_P_RawSocket_Close(pAcceptInternalSocket->rawSocket);
+        pAcceptInternalSocket->rawSocket = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
+        OPCUA_SOCKET_INVALIDATE(pAcceptInternalSocket);
+        return OpcUa_BadMaxConnectionsReached;
+    }
+#endif /* !OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+
     OpcUa_P_RawSocket_SetBlockMode ( pAcceptInternalSocket->rawSocket,
                                      OpcUa_False);
 
@@ -613,6 +718,7 @@ OpcUa_StatusCode OpcUa_Socket_HandleAcceptEvent(    OpcUa_Socket a_pListenSocket
     pAcceptInternalSocket->uintLastAccess         = OpcUa_P_GetTickCount();
 
     OPCUA_SOCKET_SETVALID(pAcceptInternalSocket);
+    OpcUa_P_Socket_UpdateEpoll(pAcceptInternalSocket);
 
     return OpcUa_Good;
 }
@@ -628,7 +734,7 @@ static OpcUa_Int32 OpcUa_SocketManager_GetSocketManagerSlot(OpcUa_InternalSocket
 
     /* we are synchronized via the pStartupSemaphore... */
 
-    for(iSocketManagerSlot = 0; iSocketManagerSlot < OPCUA_SOCKET_MAXMANAGERS; iSocketManagerSlot++)
+    for(iSocketManagerSlot = 0; iSocketManagerSlot < (OpcUa_Int32)a_pSocketManager->uintMaxManagers; iSocketManagerSlot++)
     {
         if(a_pSocketManager->pSocketManagers[iSocketManagerSlot] == OpcUa_Null)
         {
@@ -689,17 +795,26 @@ OpcUa_Void OpcUa_SocketManager_AcceptHandlerThread(OpcUa_Void* a_pArgument)
     OpcUa_Int32                 iSocketManagerSlot  = -1;
     OpcUa_InternalSocket*       pClientSocket       = OpcUa_Null;
     OpcUa_InternalSocket        ClientSocket[2]; /* one for the client, one for _signals_ */
+    OpcUa_InternalSocket*       pClientSockets      = ClientSocket; /* the only chunk of the socket table */
     OpcUa_InternalSocketManager SpawnedSocketManager;
 
 
     OpcUa_MemSet(&ClientSocket, 0, sizeof(OpcUa_InternalSocket) * 2);
     OpcUa_MemSet(&SpawnedSocketManager, 0, sizeof(OpcUa_InternalSocketManager));
 
+    ClientSocket[0].uintIndex                       = 0;
+    ClientSocket[1].uintIndex                       = 1;
+
     SpawnedSocketManager.pThread                    = pSocketManager->pSpawnedThread;
+    SpawnedSocketManager.uintSockets                = 2;
     SpawnedSocketManager.uintMaxSockets             = 2;
-    SpawnedSocketManager.pSockets                   = ClientSocket;
+    SpawnedSocketManager.ppSocketChunks             = &pClientSockets;
+    SpawnedSocketManager.pFreeSockets               = &ClientSocket[1];
     SpawnedSocketManager.pCookie                    = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
     SpawnedSocketManager.uintLastExternalEvent      = OPCUA_SOCKET_NO_EVENT;
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+    SpawnedSocketManager.iEpollFd                   = -1;
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
 
     SpawnedSocketManager.Flags.bSpawnThreadOnAccept = 0;
     SpawnedSocketManager.Flags.bRejectOnThreadFail  = 0;
@@ -782,6 +897,7 @@ OpcUa_Void OpcUa_SocketManager_AcceptHandlerThread(OpcUa_Void* a_pArgument)
             OpcUa_P_RawSocket_Close(ClientSocket[1].rawSocket);
         }
         OpcUa_P_RawSocket_Close(SpawnedSocketManager.pCookie);
+        OpcUa_P_SocketManager_CloseEpoll(&SpawnedSocketManager);
 
         OpcUa_P_Mutex_Unlock(SpawnedSocketManager.pMutex);
         OpcUa_P_Mutex_Delete(&SpawnedSocketManager.pMutex);
@@ -804,6 +920,7 @@ OpcUa_Void OpcUa_SocketManager_AcceptHandlerThread(OpcUa_Void* a_pArgument)
             OpcUa_P_RawSocket_Close(SpawnedSocketManager.pCookie);
             OpcUa_P_RawSocket_Close(ClientSocket[0].rawSocket);
         }
+        OpcUa_P_SocketManager_CloseEpoll(&SpawnedSocketManager);
         if(SpawnedSocketManager.pMutex != OpcUa_Null)
         {
             OpcUa_P_Mutex_Delete(&SpawnedSocketManager.pMutex);
@@ -924,6 +1041,8 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "HandleEvent");
 
     }; /* end of event dispatcher */
 
+    OpcUa_P_Socket_UpdateEpoll(pInternalSocket);
+
     /* begin dispatching of remaining events */
     if(pInternalSocket->pfnEventCallback != OpcUa_Null)
     {
@@ -960,6 +1079,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "SetEventMask");
                           OpcUa_BadCommunicationError);
 
     ((OpcUa_InternalSocket*)a_pSocket)->Flags.EventMask = (OpcUa_Int)a_uEventMask;
+    OpcUa_P_Socket_UpdateEpoll((OpcUa_InternalSocket*)a_pSocket);
 
     OpcUa_P_SocketManager_SignalEvent(  ((OpcUa_InternalSocket*)a_pSocket)->pSocketManager,
                                         OPCUA_SOCKET_RENEWLOOP_EVENT,
@@ -996,59 +1116,100 @@ OpcUa_FinishErrorHandling;
 OpcUa_Socket OpcUa_SocketManager_FindFreeSocket(    OpcUa_SocketManager     a_pSocketManager,
                                                     OpcUa_Boolean           a_bIsSignalSocket)
 {
-    OpcUa_UInt32                 uIndex       = 0;
-    OpcUa_Boolean                bFound       = OpcUa_False;
+    OpcUa_InternalSocket*        pInternalSocket         = OpcUa_Null;
     OpcUa_InternalSocketManager* pInternalSocketManager  = (OpcUa_InternalSocketManager*)a_pSocketManager;
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    for(uIndex = 0; uIndex < pInternalSocketManager->uintMaxSockets; uIndex++)
+    if(a_bIsSignalSocket)
     {
-        if(uIndex == 0 && !a_bIsSignalSocket)
+        /* the signal socket always occupies the first entry */
+        pInternalSocket = OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, 0);
+
+        if(pInternalSocket->bSocketIsInUse != OpcUa_False)
         {
-            continue;
+            pInternalSocket = OpcUa_Null;
+        }
+    }
+    else
+    {
+        /* grow the table by one chunk if all allocated sockets are in use */
+        if(   pInternalSocketManager->pFreeSockets == OpcUa_Null
+           && pInternalSocketManager->uintSockets  <  pInternalSocketManager->uintMaxSockets)
+        {
+            OpcUa_SocketManager_AddSocketChunk(pInternalSocketManager);
         }
 
-        if(pInternalSocketManager->pSockets[uIndex].bSocketIsInUse == OpcUa_False)
+        pInternalSocket = pInternalSocketManager->pFreeSockets;
+
+        if(pInternalSocket != OpcUa_Null)
         {
-            pInternalSocketManager->pSockets[uIndex].bInvalidSocket         = OpcUa_True;
-            pInternalSocketManager->pSockets[uIndex].Flags.bClosedSocket    = OpcUa_False;
-            pInternalSocketManager->pSockets[uIndex].Flags.bOwnThread       = OpcUa_False;
-            pInternalSocketManager->pSockets[uIndex].Flags.bFromApplication = OpcUa_False;
-            pInternalSocketManager->pSockets[uIndex].Flags.EventMask        = 0;
-            pInternalSocketManager->pSockets[uIndex].uintTimeout            = 0;
-            pInternalSocketManager->pSockets[uIndex].uintLastAccess         = OpcUa_P_GetTickCount();
-            pInternalSocketManager->pSockets[uIndex].pvUserData             = OpcUa_Null;
-            pInternalSocketManager->pSockets[uIndex].pfnEventCallback       = OpcUa_Null;
-            pInternalSocketManager->pSockets[uIndex].pSocketManager         = (OpcUa_InternalSocketManager *)a_pSocketManager;
-            pInternalSocketManager->pSockets[uIndex].rawSocket              = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
-            pInternalSocketManager->pSockets[uIndex].bSocketIsInUse         = OpcUa_True;
-
-            bFound = OpcUa_True;
-
-            break; /* for loop */
+            pInternalSocketManager->pFreeSockets = pInternalSocket->pNextFree;
+            pInternalSocket->pNextFree           = OpcUa_Null;
         }
     }
 
+    if(pInternalSocket != OpcUa_Null)
+    {
+        pInternalSocket->bInvalidSocket         = OpcUa_True;
+        pInternalSocket->Flags.bClosedSocket    = OpcUa_False;
+        pInternalSocket->Flags.bOwnThread       = OpcUa_False;
+        pInternalSocket->Flags.bFromApplication = OpcUa_False;
+        pInternalSocket->Flags.EventMask        = 0;
+        pInternalSocket->uintTimeout            = 0;
+        pInternalSocket->uintLastAccess         = OpcUa_P_GetTickCount();
+        pInternalSocket->pvUserData             = OpcUa_Null;
+        pInternalSocket->pfnEventCallback       = OpcUa_Null;
+        pInternalSocket->pSocketManager         = (OpcUa_InternalSocketManager *)a_pSocketManager;
+        pInternalSocket->rawSocket              = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+        pInternalSocket->uintEpollEvents        = 0;
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+        pInternalSocket->bSocketIsInUse         = OpcUa_True;
+    }
+
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    if(bFound)
-    {
-        return &(pInternalSocketManager->pSockets[uIndex]);
-    }
-    else
+    return pInternalSocket;
+}
+
+/*============================================================================
+ * Return a socket to the free list of its socket manager.
+ *===========================================================================*/
+OpcUa_Void OpcUa_SocketManager_ReleaseSocket(OpcUa_Socket a_pSocket)
+{
+    OpcUa_InternalSocket*        pInternalSocket         = (OpcUa_InternalSocket*)a_pSocket;
+    OpcUa_InternalSocketManager* pInternalSocketManager  = pInternalSocket->pSocketManager;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* a socket may be released on more than one path, but must be linked only once */
+    if(pInternalSocket->bSocketIsInUse != OpcUa_False)
     {
-        return OpcUa_Null;
+        pInternalSocket->bSocketIsInUse = OpcUa_False;
+
+        if(pInternalSocket->uintIndex != 0)
+        {
+            pInternalSocket->pNextFree           = pInternalSocketManager->pFreeSockets;
+            pInternalSocketManager->pFreeSockets = pInternalSocket;
+        }
     }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
 }
 
 
 
 
+#if !OPCUA_P_SOCKETMANAGER_USE_EPOLL
 /*============================================================================
 * Main socket based server loop.
 *===========================================================================*/
@@ -1135,7 +1296,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "P_ServeLoop");
 
         /* check for external events */
         /* right after possible select delay */
-        if (OPCUA_P_SOCKET_ARRAY_ISSET(pInternalSocketManager->pSockets[0].rawSocket, &readFdSet))
+        if (OPCUA_P_SOCKET_ARRAY_ISSET(OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, 0)->rawSocket, &readFdSet))
         {
             uStatus = OpcUa_P_Socket_HandleExternalEvent(pInternalSocketManager);
             OpcUa_GotoErrorIfBad(uStatus);
@@ -1173,6 +1334,429 @@ OpcUa_BeginErrorHandling;
 
 OpcUa_FinishErrorHandling;
 }
+#else /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+
+/*============================================================================
+* Create the epoll instance of a socket manager.
+*===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SocketManager_CreateEpoll(OpcUa_SocketManager a_pSocketManager)
+{
+    OpcUa_InternalSocketManager* pInternalSocketManager = (OpcUa_InternalSocketManager*)a_pSocketManager;
+
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "CreateEpoll");
+
+    OpcUa_GotoErrorIfArgumentNull(a_pSocketManager);
+
+    pInternalSocketManager->iEpollFd             = epoll_create1(EPOLL_CLOEXEC);
+    pInternalSocketManager->uintLastTimeoutCheck = OpcUa_P_GetTickCount();
+
+    if(pInternalSocketManager->iEpollFd < 0)
+    {
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_P_SocketManager_CreateEpoll: epoll_create1 failed with errno %i\n", errno);
+        OpcUa_GotoErrorWithStatus(OpcUa_BadResourceUnavailable);
+    }
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+* Close the epoll instance of a socket manager.
+*===========================================================================*/
+OpcUa_Void OpcUa_P_SocketManager_CloseEpoll(OpcUa_SocketManager a_pSocketManager)
+{
+    OpcUa_InternalSocketManager* pInternalSocketManager = (OpcUa_InternalSocketManager*)a_pSocketManager;
+
+    if(pInternalSocketManager != OpcUa_Null && pInternalSocketManager->iEpollFd >= 0)
+    {
+        close(pInternalSocketManager->iEpollFd);
+        pInternalSocketManager->iEpollFd = -1;
+    }
+}
+
+/*============================================================================
+* Map the state and event mask of a socket to epoll events.
+*===========================================================================*/
+static OpcUa_UInt32 OpcUa_P_Socket_GetEpollEvents(OpcUa_InternalSocket* a_pSocket)
+{
+    OpcUa_UInt32 uEvents = 0;
+
+    if(    (a_pSocket->bSocketIsInUse == OpcUa_False)
+        || (a_pSocket->bInvalidSocket != OpcUa_False)
+        || (a_pSocket->rawSocket      == (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID))
+    {
+        return 0;
+    }
+
+    /* a closed socket only waits for the hangup caused by its shutdown */
+    if(a_pSocket->Flags.bClosedSocket != OpcUa_False)
+    {
+        return EPOLLIN;
+    }
+
+    /* same selection as the read and write fd_sets of the select loop */
+    if(a_pSocket->Flags.EventMask & OPCUA_SOCKET_READ_EVENT)
+    {
+        uEvents |= EPOLLIN;
+    }
+
+    if(a_pSocket->Flags.EventMask & (OPCUA_SOCKET_WRITE_EVENT | OPCUA_SOCKET_CONNECT_EVENT))
+    {
+        uEvents |= EPOLLOUT;
+    }
+
+    /* epoll always reports hangups and errors; a socket which is neither read nor written */
+    /* must not be registered, else a dead peer would wake the loop until it reads again.  */
+    if(uEvents != 0 && (a_pSocket->Flags.EventMask & OPCUA_SOCKET_EXCEPT_EVENT))
+    {
+        uEvents |= EPOLLPRI;
+    }
+
+    return uEvents;
+}
+
+/*============================================================================
+* Update the epoll registration of a socket.
+*===========================================================================*/
+OpcUa_Void OpcUa_P_Socket_UpdateEpoll(OpcUa_InternalSocket* a_pSocket)
+{
+    OpcUa_InternalSocketManager*    pInternalSocketManager  = OpcUa_Null;
+    OpcUa_UInt32                    uEvents                 = 0;
+    struct epoll_event              Event;
+    int                             apiResult               = 0;
+
+    if(a_pSocket == OpcUa_Null || a_pSocket->pSocketManager == OpcUa_Null)
+    {
+        return;
+    }
+
+    pInternalSocketManager = a_pSocket->pSocketManager;
+
+    if(pInternalSocketManager->iEpollFd < 0)
+    {
+        return;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    uEvents = OpcUa_P_Socket_GetEpollEvents(a_pSocket);
+
+    if(uEvents != a_pSocket->uintEpollEvents)
+    {
+        OpcUa_MemSet(&Event, 0, sizeof(Event));
+        Event.events   = uEvents;
+        /* the slot and the system socket identify the socket, so stale events can be detected */
+        Event.data.u64 = ((OpcUa_UInt64)a_pSocket->uintIndex << 32) | (OpcUa_UInt32)a_pSocket->rawSocket;
+
+        if(uEvents == 0)
+        {
+            /* fails harmlessly if the system socket was closed before */
+            epoll_ctl(pInternalSocketManager->iEpollFd, EPOLL_CTL_DEL, a_pSocket->rawSocket, &Event);
+        }
+        else
+        {
+            apiResult = epoll_ctl(pInternalSocketManager->iEpollFd,
+                                  (a_pSocket->uintEpollEvents == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD,
+                                  a_pSocket->rawSocket,
+                                  &Event);
+
+            /* the registration vanishes when a system socket is closed and may be out of date */
+            if(apiResult != 0 && (errno == EEXIST || errno == ENOENT))
+            {
+                apiResult = epoll_ctl(pInternalSocketManager->iEpollFd,
+                                      (errno == EEXIST) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                                      a_pSocket->rawSocket,
+                                      &Event);
+            }
+
+            if(apiResult != 0)
+            {
+                OpcUa_Trace(OPCUA_TRACE_LEVEL_ERROR, "OpcUa_P_Socket_UpdateEpoll: epoll_ctl failed for socket %i with errno %i\n", a_pSocket->rawSocket, errno);
+                uEvents = 0;
+            }
+        }
+
+        a_pSocket->uintEpollEvents = uEvents;
+    }
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+}
+
+/*============================================================================
+* Fire the close event for a closed socket and release it.
+*===========================================================================*/
+static OpcUa_Void OpcUa_P_Socket_FinishClose(OpcUa_InternalSocket* a_pSocket)
+{
+    OpcUa_Socket_HandleEvent(a_pSocket, OPCUA_SOCKET_CLOSE_EVENT);
+
+    /* unregister before the system socket number can be reused */
+    a_pSocket->bInvalidSocket = OpcUa_True;
+
+    OpcUa_P_Socket_UpdateEpoll(a_pSocket);
+
+    OpcUa_P_RawSocket_Close(a_pSocket->rawSocket);
+
+    a_pSocket->rawSocket = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
+
+    OpcUa_SocketManager_ReleaseSocket(a_pSocket);
+}
+
+/*============================================================================
+* Check if an epoll event still belongs to the socket in the reported slot.
+*===========================================================================*/
+static OpcUa_Boolean OpcUa_P_Socket_IsEpollTarget(OpcUa_InternalSocket*   a_pSocket,
+                                                  OpcUa_RawSocket         a_RawSocket)
+{
+    return (   (a_pSocket->bSocketIsInUse != OpcUa_False)
+            && (a_pSocket->bInvalidSocket == OpcUa_False)
+            && (a_pSocket->rawSocket      == a_RawSocket));
+}
+
+/*============================================================================
+* Handle the epoll events reported for one socket.
+*===========================================================================*/
+static OpcUa_Void OpcUa_P_Socket_HandleEpollEvents(OpcUa_InternalSocket*   a_pSocket,
+                                                   OpcUa_RawSocket         a_RawSocket,
+                                                   OpcUa_UInt32            a_uEpollEvents)
+{
+    OpcUa_UInt32 uintLocalEvent = 0;
+
+    /* same order as the select loop: except, write, read */
+    if(    (a_uEpollEvents & EPOLLPRI)
+        && OpcUa_P_Socket_IsEpollTarget(a_pSocket, a_RawSocket)
+        && (a_pSocket->Flags.bClosedSocket == OpcUa_False)
+        && (a_pSocket->Flags.EventMask & OPCUA_SOCKET_EXCEPT_EVENT))
+    {
+        OpcUa_Socket_HandleEvent(a_pSocket, OPCUA_SOCKET_EXCEPT_EVENT);
+    }
+
+    if(    (a_uEpollEvents & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+        && OpcUa_P_Socket_IsEpollTarget(a_pSocket, a_RawSocket)
+        && (a_pSocket->Flags.bClosedSocket == OpcUa_False)
+        && (a_pSocket->Flags.EventMask & (OPCUA_SOCKET_WRITE_EVENT | OPCUA_SOCKET_CONNECT_EVENT)))
+    {
+        if(a_pSocket->Flags.EventMask & OPCUA_SOCKET_CONNECT_EVENT)
+        {
+            int       apiResult = 0, value = 0;
+            socklen_t size      = sizeof(value);
+
+            uintLocalEvent = OPCUA_SOCKET_CONNECT_EVENT;
+
+            /* the real reason for exception events is received through getsockopt with SO_ERROR */
+            apiResult = getsockopt(a_pSocket->rawSocket, SOL_SOCKET, SO_ERROR, (char*)&value, &size);
+            if(apiResult == 0 && value != 0)
+            {
+                uintLocalEvent = OPCUA_SOCKET_EXCEPT_EVENT;
+            }
+        }
+        else
+        {
+            uintLocalEvent = OPCUA_SOCKET_WRITE_EVENT;
+        }
+
+        OpcUa_Socket_HandleEvent(a_pSocket, uintLocalEvent);
+    }
+
+    if(    (a_uEpollEvents & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        && OpcUa_P_Socket_IsEpollTarget(a_pSocket, a_RawSocket)
+        && (a_pSocket->Flags.bClosedSocket == OpcUa_False)
+        && (a_pSocket->Flags.EventMask & OPCUA_SOCKET_READ_EVENT))
+    {
+        if(a_pSocket->Flags.EventMask & OPCUA_SOCKET_ACCEPT_EVENT)
+        {
+            uintLocalEvent = OPCUA_SOCKET_ACCEPT_EVENT;
+        }
+        else
+        {
+            uintLocalEvent = OPCUA_SOCKET_READ_EVENT;
+        }
+
+        OpcUa_Socket_HandleEvent(a_pSocket, uintLocalEvent);
+    }
+
+    if(    OpcUa_P_Socket_IsEpollTarget(a_pSocket, a_RawSocket)
+        && (a_pSocket->Flags.bClosedSocket != OpcUa_False))
+    {
+        OpcUa_P_Socket_FinishClose(a_pSocket);
+    }
+}
+
+/*============================================================================
+* Check all sockets for timeouts and closes which did not cause an epoll event.
+*===========================================================================*/
+static OpcUa_Void OpcUa_P_Socket_CheckTimeouts(OpcUa_InternalSocketManager* a_pSocketManager)
+{
+    OpcUa_UInt32            uintIndex           = 0;
+    OpcUa_UInt32            uintTimeDifference  = 0;
+    OpcUa_InternalSocket*   pSocket             = OpcUa_Null;
+
+    for(uintIndex = 1; uintIndex < a_pSocketManager->uintSockets; uintIndex++)
+    {
+        pSocket = OPCUA_P_SOCKETMANAGER_GETSOCKET(a_pSocketManager, uintIndex);
+
+        if(    (pSocket->bSocketIsInUse == OpcUa_False)
+            || (pSocket->bInvalidSocket != OpcUa_False))
+        {
+            continue;
+        }
+
+        /* Only check timeout, if a timeout value is set for the socket */
+        if(pSocket->Flags.bClosedSocket == OpcUa_False && pSocket->uintTimeout != 0)
+        {
+            uintTimeDifference = OpcUa_P_GetTickCount() - pSocket->uintLastAccess;
+
+            if((int)uintTimeDifference > (int)pSocket->uintTimeout)
+            {
+                /* the connection on this socket timed out */
+                OpcUa_Socket_HandleEvent(pSocket, OPCUA_SOCKET_TIMEOUT_EVENT);
+            }
+        }
+
+        if(    (pSocket->bSocketIsInUse      != OpcUa_False)
+            && (pSocket->bInvalidSocket      == OpcUa_False)
+            && (pSocket->Flags.bClosedSocket != OpcUa_False))
+        {
+            OpcUa_P_Socket_FinishClose(pSocket);
+        }
+    }
+}
+
+/*============================================================================
+* Main socket based server loop.
+*===========================================================================*/
+OpcUa_StatusCode OpcUa_P_SocketManager_ServeLoopInternal(   OpcUa_SocketManager   a_pSocketManager,
+                                                            OpcUa_UInt32          a_msecTimeout,
+                                                            OpcUa_Boolean         bRunOnce)
+{
+    struct epoll_event              aEvents[OPCUA_P_SOCKETMANAGER_EPOLL_MAXEVENTS];
+    int                             iReady                  = 0;
+    int                             iEvent                  = 0;
+    OpcUa_UInt32                    uintIndex               = 0;
+    OpcUa_Boolean                   bExternalEvent          = OpcUa_False;
+    OpcUa_InternalSocketManager*    pInternalSocketManager  = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Socket, "P_ServeLoop");
+
+    /* cap */
+    if(a_msecTimeout > OPCUA_SOCKET_MAXLOOPTIME)
+    {
+        a_msecTimeout = OPCUA_SOCKET_MAXLOOPTIME;
+    }
+
+    if(a_pSocketManager == OpcUa_Null)
+    {
+        return OpcUa_BadInvalidArgument;
+    }
+
+    pInternalSocketManager = (OpcUa_InternalSocketManager*)a_pSocketManager;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+    /* the serving loop */
+    do
+    {
+#if OPCUA_USE_SYNCHRONISATION
+        OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+        /****************************************************************/
+        /* This is the only point in the whole engine, where blocking   */
+        /* of the current thread is allowed. Else, processing of        */
+        /* network events is slowed down!                               */
+        iReady = epoll_wait(pInternalSocketManager->iEpollFd,
+                            aEvents,
+                            OPCUA_P_SOCKETMANAGER_EPOLL_MAXEVENTS,
+                            (int)a_msecTimeout);
+        /*                                                              */
+        /****************************************************************/
+
+#if OPCUA_USE_SYNCHRONISATION
+        OpcUa_P_Mutex_Lock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+        if(iReady < 0)
+        {
+            if(errno != EINTR)
+            {
+                uStatus = OpcUa_BadCommunicationError;
+                goto Error;
+            }
+
+            iReady = 0;
+        }
+
+        /* check for external events */
+        /* right after possible wait delay */
+        bExternalEvent = OpcUa_False;
+
+        for(iEvent = 0; iEvent < iReady; iEvent++)
+        {
+            if((aEvents[iEvent].data.u64 >> 32) == 0)
+            {
+                bExternalEvent = OpcUa_True;
+            }
+        }
+
+        if(bExternalEvent != OpcUa_False)
+        {
+            uStatus = OpcUa_P_Socket_HandleExternalEvent(pInternalSocketManager);
+            OpcUa_GotoErrorIfBad(uStatus);
+
+            /* continue if a renew event was signalled */
+            if(OpcUa_IsEqual(OpcUa_GoodCallAgain))
+            {
+                continue;
+            }
+
+            /* leave if a shutdown event was signalled */
+            if(OpcUa_IsEqual(OpcUa_GoodShutdownEvent))
+            {
+                break;
+            }
+        }
+
+        /* Handle Events by calling the registered callbacks (only the ready sockets) */
+        for(iEvent = 0; iEvent < iReady; iEvent++)
+        {
+            uintIndex = (OpcUa_UInt32)(aEvents[iEvent].data.u64 >> 32);
+
+            if(uintIndex != 0 && uintIndex < pInternalSocketManager->uintSockets)
+            {
+                OpcUa_P_Socket_HandleEpollEvents(OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, uintIndex),
+                                                 (OpcUa_RawSocket)(OpcUa_UInt32)aEvents[iEvent].data.u64,
+                                                 aEvents[iEvent].events);
+            }
+        }
+
+        if(OpcUa_P_GetTickCount() - pInternalSocketManager->uintLastTimeoutCheck >= OPCUA_SOCKET_MAXLOOPTIME)
+        {
+            pInternalSocketManager->uintLastTimeoutCheck = OpcUa_P_GetTickCount();
+            OpcUa_P_Socket_CheckTimeouts(pInternalSocketManager);
+        }
+
+    } while(!bRunOnce);
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+#if OPCUA_USE_SYNCHRONISATION
+    OpcUa_P_Mutex_Unlock(pInternalSocketManager->pMutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+
+OpcUa_FinishErrorHandling;
+}
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
 
 /*============================================================================
 * FillFdSet
@@ -1184,23 +1768,25 @@ int OpcUa_P_Socket_FillFdSet(  OpcUa_SocketManager     pSocketManager,
 {
     OpcUa_UInt32                    uintIndex      = 0;
     OpcUa_UInt32                    uintTempEvent  = 0;
+    OpcUa_InternalSocket*           pSocket        = OpcUa_Null;
     OpcUa_InternalSocketManager*    pInternalSocketManager    = (OpcUa_InternalSocketManager*)pSocketManager;
 
     OPCUA_P_SOCKET_ARRAY_ZERO(pSocketArray);
 
-    for(uintIndex = 0; uintIndex < pInternalSocketManager->uintMaxSockets; uintIndex++)
+    for(uintIndex = 0; uintIndex < pInternalSocketManager->uintSockets; uintIndex++)
     {
+        pSocket       = OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, uintIndex);
         uintTempEvent = uintEvent;
 
         /* if socket used and valid */
-        if(     (pInternalSocketManager->pSockets[uintIndex].bSocketIsInUse  != OpcUa_False)
-            &&  (pInternalSocketManager->pSockets[uintIndex].bInvalidSocket  == OpcUa_False))
+        if(     (pSocket->bSocketIsInUse  != OpcUa_False)
+            &&  (pSocket->bInvalidSocket  == OpcUa_False))
         {
             /* is connect event wished by caller? */
             if((uintTempEvent & OPCUA_SOCKET_CONNECT_EVENT) != 0)
             {
                 /* and is connect event wished by socket? */
-                if(((pInternalSocketManager->pSockets[uintIndex].Flags.EventMask) & OPCUA_SOCKET_CONNECT_EVENT) != 0)
+                if(((pSocket->Flags.EventMask) & OPCUA_SOCKET_CONNECT_EVENT) != 0)
                 {
                     /* then set to connect only */
                     uintTempEvent = OPCUA_SOCKET_CONNECT_EVENT;
@@ -1213,12 +1799,12 @@ int OpcUa_P_Socket_FillFdSet(  OpcUa_SocketManager     pSocketManager,
             }
 
             /* if only uintTemp is wished, set the socket in the fd_set */
-            if(((pInternalSocketManager->pSockets[uintIndex].Flags.EventMask) & uintTempEvent) == uintTempEvent)
+            if(((pSocket->Flags.EventMask) & uintTempEvent) == uintTempEvent)
             {
-                OPCUA_P_SOCKET_ARRAY_SET(pInternalSocketManager->pSockets[uintIndex].rawSocket, pSocketArray);
-                if (pInternalSocketManager->pSockets[uintIndex].rawSocket > max)
+                OPCUA_P_SOCKET_ARRAY_SET(pSocket->rawSocket, pSocketArray);
+                if (pSocket->rawSocket > max)
                 {
-                    max = pInternalSocketManager->pSockets[uintIndex].rawSocket;
+                    max = pSocket->rawSocket;
                 }
             }
         }
@@ -1329,25 +1915,27 @@ OpcUa_Void OpcUa_P_Socket_HandleFdSet(  OpcUa_SocketManager     a_pSocketManager
     OpcUa_UInt32                    uintIndex           = 0;
     OpcUa_UInt32                    uintLocalEvent      = 0;
     OpcUa_UInt32                    uintTimeDifference  = 0; /* seconds */
+    OpcUa_InternalSocket*           pSocket             = OpcUa_Null;
 
-    for(uintIndex = 1; uintIndex < pInternalSocketManager->uintMaxSockets; uintIndex++)
+    for(uintIndex = 1; uintIndex < pInternalSocketManager->uintSockets; uintIndex++)
     {
+        pSocket        = OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, uintIndex);
         uintLocalEvent = a_uEvent;
 
-        if(    (pInternalSocketManager->pSockets[uintIndex].bSocketIsInUse != OpcUa_False)
-           &&  (pInternalSocketManager->pSockets[uintIndex].bInvalidSocket == OpcUa_False))
+        if(    (pSocket->bSocketIsInUse != OpcUa_False)
+           &&  (pSocket->bInvalidSocket == OpcUa_False))
         {
-            if(   (pInternalSocketManager->pSockets[uintIndex].Flags.bClosedSocket == OpcUa_False)
-               && OPCUA_P_SOCKET_ARRAY_ISSET(pInternalSocketManager->pSockets[uintIndex].rawSocket, a_pSocketArray))
+            if(   (pSocket->Flags.bClosedSocket == OpcUa_False)
+               && OPCUA_P_SOCKET_ARRAY_ISSET(pSocket->rawSocket, a_pSocketArray))
             {
-                if((uintLocalEvent == OPCUA_SOCKET_READ_EVENT) && (pInternalSocketManager->pSockets[uintIndex].Flags.EventMask & OPCUA_SOCKET_ACCEPT_EVENT))
+                if((uintLocalEvent == OPCUA_SOCKET_READ_EVENT) && (pSocket->Flags.EventMask & OPCUA_SOCKET_ACCEPT_EVENT))
                 {
                     uintLocalEvent = OPCUA_SOCKET_ACCEPT_EVENT;
                 }
 
                 if(uintLocalEvent & OPCUA_SOCKET_CONNECT_EVENT)
                 {
-                    if(pInternalSocketManager->pSockets[uintIndex].Flags.EventMask & OPCUA_SOCKET_CONNECT_EVENT)
+                    if(pSocket->Flags.EventMask & OPCUA_SOCKET_CONNECT_EVENT)
                     {
                         uintLocalEvent = OPCUA_SOCKET_CONNECT_EVENT;
                     }
@@ -1362,41 +1950,41 @@ OpcUa_Void OpcUa_P_Socket_HandleFdSet(  OpcUa_SocketManager     a_pSocketManager
                 {
                     int       apiResult = 0, value = 0;
                     socklen_t size      = sizeof(value);
-                    apiResult = getsockopt(pInternalSocketManager->pSockets[uintIndex].rawSocket, SOL_SOCKET, SO_ERROR, (char*)&value, &size);
+                    apiResult = getsockopt(pSocket->rawSocket, SOL_SOCKET, SO_ERROR, (char*)&value, &size);
                     if(apiResult == 0 && value != 0)
                     {
                         uintLocalEvent = OPCUA_SOCKET_EXCEPT_EVENT;
                     }
                 }
 
-                OpcUa_Socket_HandleEvent(&pInternalSocketManager->pSockets[uintIndex], uintLocalEvent);
+                OpcUa_Socket_HandleEvent(pSocket, uintLocalEvent);
             }
 
             else if(uintLocalEvent == OPCUA_SOCKET_EXCEPT_EVENT)
             {
                 /* Only check timeout, if a timeout value is set for the socket */
-                if(pInternalSocketManager->pSockets[uintIndex].uintTimeout != 0)
+                if(pSocket->uintTimeout != 0)
                 {
                     /* check for Timeout too */
-                    uintTimeDifference = OpcUa_P_GetTickCount() - pInternalSocketManager->pSockets[uintIndex].uintLastAccess;
+                    uintTimeDifference = OpcUa_P_GetTickCount() - pSocket->uintLastAccess;
 
-                    if((int)uintTimeDifference > (int)pInternalSocketManager->pSockets[uintIndex].uintTimeout)
+                    if((int)uintTimeDifference > (int)pSocket->uintTimeout)
                     {
                         /* the connection on this socket timed out */
-                        OpcUa_Socket_HandleEvent(&pInternalSocketManager->pSockets[uintIndex], OPCUA_SOCKET_TIMEOUT_EVENT);
+                        OpcUa_Socket_HandleEvent(pSocket, OPCUA_SOCKET_TIMEOUT_EVENT);
                     }
                 }
             }
 
-            if(pInternalSocketManager->pSockets[uintIndex].Flags.bClosedSocket != OpcUa_False)
+            if(pSocket->Flags.bClosedSocket != OpcUa_False)
             {
-                OpcUa_Socket_HandleEvent(&pInternalSocketManager->pSockets[uintIndex], OPCUA_SOCKET_CLOSE_EVENT);
+                OpcUa_Socket_HandleEvent(pSocket, OPCUA_SOCKET_CLOSE_EVENT);
 
-                OpcUa_P_RawSocket_Close(pInternalSocketManager->pSockets[uintIndex].rawSocket);
+                OpcUa_P_RawSocket_Close(pSocket->rawSocket);
 
-                pInternalSocketManager->pSockets[uintIndex].rawSocket = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
+                pSocket->rawSocket = (OpcUa_RawSocket)OPCUA_P_SOCKET_INVALID;
 
-                pInternalSocketManager->pSockets[uintIndex].bSocketIsInUse = OpcUa_False;
+                OpcUa_SocketManager_ReleaseSocket(pSocket);
             }
 
         }
@@ -1419,7 +2007,7 @@ OpcUa_InitializeStatus(OpcUa_Module_Socket, "P_HandleExternalEvent");
 
     OpcUa_GotoErrorIfArgumentNull(a_pSocketManager);
 
-    OpcUa_P_RawSocket_Read(pInternalSocketManager->pSockets[0].rawSocket, dummy, sizeof(dummy));
+    OpcUa_P_RawSocket_Read(OPCUA_P_SOCKETMANAGER_GETSOCKET(pInternalSocketManager, 0)->rawSocket, dummy, sizeof(dummy));
 
     if(pInternalSocketManager->uintLastExternalEvent != OPCUA_SOCKET_NO_EVENT)
     {
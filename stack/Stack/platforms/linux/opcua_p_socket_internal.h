@@ -85,6 +85,11 @@ struct _OpcUa_InternalSocket
     } Flags;
     OpcUa_UInt32                 uintTimeout;        /* interval until connection is considered timed out */
     OpcUa_UInt32                 uintLastAccess;     /* system tick count in seconds when last action on this socket took place */
+    OpcUa_UInt32                 uintIndex;          /* position of this socket in the socket table of its socket manager */
+    OpcUa_InternalSocket*        pNextFree;          /* next unused socket in the free list of the socket manager */
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+    OpcUa_UInt32                 uintEpollEvents;    /* events this socket is registered for in the epoll set, 0 if not registered */
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
 };
 
 /**
@@ -92,12 +97,19 @@ struct _OpcUa_InternalSocket
 */
 struct _OpcUa_InternalSocketManager
 {
-    OpcUa_InternalSocket*   pSockets;                 /* the sockets */
+    OpcUa_InternalSocket**  ppSocketChunks;           /* the sockets, allocated in chunks of OPCUA_P_SOCKETMANAGER_CHUNKSIZE on demand */
+    OpcUa_UInt32            uintSockets;              /* how many socket entries are allocated in the chunks */
     OpcUa_UInt32            uintMaxSockets;           /* how many socket entries can this list hold at maximum. Mind the signal socket!  */
+    OpcUa_InternalSocket*   pFreeSockets;             /* allocated but unused socket entries (without the signal socket) */
     OpcUa_RawSocket         pCookie;                  /* wakeup event socket */
     OpcUa_UInt32            uintLastExternalEvent;    /* the last occurred event */
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+    int                     iEpollFd;                 /* epoll instance holding the interest set of all sockets */
+    OpcUa_UInt32            uintLastTimeoutCheck;     /* tick count of the last sweep for timed out and closed sockets */
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
 #if OPCUA_MULTITHREADED
     OpcUa_InternalSocketManager** pSocketManagers;    /* the spawned socket managers go there */
+    OpcUa_UInt32            uintMaxManagers;          /* how many spawned socket managers fit into pSocketManagers */
     OpcUa_RawThread         pSpawnedThread;           /* the spawned accept thread */
     OpcUa_Semaphore         pStartupSemaphore;        /* wait on this semaphore to synchronize the accept thread */
     OpcUa_RawThread         pThreadToJoin;            /* the next thread to be joined */
@@ -115,21 +127,23 @@ struct _OpcUa_InternalSocketManager
 };
 
 /*
-* Sets a socket to invalid.
+* Get the socket with the given index from the socket table of a socket manager.
 */
+#define OPCUA_P_SOCKETMANAGER_GETSOCKET(xSocketManager, xIndex)                                    \
+    (&((xSocketManager)->ppSocketChunks[(xIndex) / OPCUA_P_SOCKETMANAGER_CHUNKSIZE]                \
+                                       [(xIndex) % OPCUA_P_SOCKETMANAGER_CHUNKSIZE]))
+
+/*
+* Sets a socket to invalid and returns it to the free list of its socket manager.
+*/
+#define OPCUA_SOCKET_INVALIDATE(a)      OpcUa_SocketManager_ReleaseSocket(a)
 #if OPCUA_USE_SYNCHRONISATION
-#define OPCUA_SOCKET_INVALIDATE(a)      do {                                                    \
-                                             OpcUa_P_Mutex_Lock((a)->pSocketManager->pMutex);   \
-                                             (a)->bSocketIsInUse = OpcUa_False;                 \
-                                             OpcUa_P_Mutex_Unlock((a)->pSocketManager->pMutex); \
-                                        } while(0)
 #define OPCUA_SOCKET_SETVALID(a)        do {                                                    \
                                              OpcUa_P_Mutex_Lock((a)->pSocketManager->pMutex);   \
                                              (a)->bInvalidSocket = OpcUa_False;                 \
                                              OpcUa_P_Mutex_Unlock((a)->pSocketManager->pMutex); \
                                         } while(0)
 #else
-#define OPCUA_SOCKET_INVALIDATE(a)      ((a)->bSocketIsInUse = OpcUa_False)
 #define OPCUA_SOCKET_SETVALID(a)        ((a)->bInvalidSocket = OpcUa_False)
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
@@ -165,6 +179,11 @@ OpcUa_Void          OpcUa_SocketManager_Initialize(OpcUa_SocketManager pSocketMa
 OpcUa_StatusCode    OpcUa_SocketManager_CreateSockets(  OpcUa_SocketManager     pSocketManager,
                                                         OpcUa_UInt32            uintMaxSockets);
 
+/*============================================================================
+ * Free the Sockets in the given list
+ *===========================================================================*/
+OpcUa_Void          OpcUa_SocketManager_DeleteSockets(  OpcUa_SocketManager     pSocketManager);
+
 /*============================================================================
  * Set the event mask for this socket.
  *===========================================================================*/
@@ -193,6 +212,11 @@ OpcUa_UInt16        OpcUa_Socket_HToNS(         OpcUa_UInt16 hstShort);
 OpcUa_Socket        OpcUa_SocketManager_FindFreeSocket( OpcUa_SocketManager pSocketManager,
                                                         OpcUa_Boolean       bIsSignalSocket);
 
+/*============================================================================
+ * Return a socket found with FindFreeSocket to its socket manager.
+ *===========================================================================*/
+OpcUa_Void          OpcUa_SocketManager_ReleaseSocket(  OpcUa_Socket        pSocket);
+
 /*============================================================================
  * Take action based on socket and event.
  *===========================================================================*/
@@ -225,6 +249,38 @@ OpcUa_Void OpcUa_P_Socket_HandleFdSet(OpcUa_SocketManager   SocketManager,
                                       OpcUa_P_Socket_Array* SocketArray,
                                       OpcUa_UInt32          Event);
 
+#if OPCUA_P_SOCKETMANAGER_USE_EPOLL
+/*!
+ * @brief Create the epoll instance of a socket manager.
+ *
+ * @param pSocketManager   [in]    The socket manager to create the epoll instance for.
+ *
+ * @return A "Good" status code if no error occurred, a "Bad" status code otherwise.
+ */
+OpcUa_StatusCode OpcUa_P_SocketManager_CreateEpoll(OpcUa_SocketManager SocketManager);
+
+/*!
+ * @brief Close the epoll instance of a socket manager, if one was created.
+ *
+ * @param pSocketManager   [in]    The socket manager owning the epoll instance.
+ */
+OpcUa_Void OpcUa_P_SocketManager_CloseEpoll(OpcUa_SocketManager SocketManager);
+
+/*!
+ * @brief Bring the epoll registration of a socket in line with its state and event mask.
+ *
+ * Must be called whenever EventMask, bInvalidSocket, bSocketIsInUse or bClosedSocket
+ * of a socket changed and before its system socket is closed.
+ *
+ * @param pSocket   [in]    The socket to update.
+ */
+OpcUa_Void OpcUa_P_Socket_UpdateEpoll(OpcUa_InternalSocket* pSocket);
+#else
+#define OpcUa_P_SocketManager_CreateEpoll(xSocketManager) OpcUa_Good
+#define OpcUa_P_SocketManager_CloseEpoll(xSocketManager)
+#define OpcUa_P_Socket_UpdateEpoll(xSocket)
+#endif /* OPCUA_P_SOCKETMANAGER_USE_EPOLL */
+
 /*!
  * @brief Handle an externally triggered event.
  *
@@ -27,13 +27,16 @@
 * http://opcfoundation.org/License/MIT/1.00/
 * ======================================================================*/
 
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
 #include <opcua_p_internal.h>
 #include <opcua_p_memory.h>
 #include <opcua_p_mutex.h>
 #include <opcua_p_utilities.h>
 
 #include <opcua_p_thread.h>
-#include <opcua_p_semaphore.h>
 
 #include <opcua_p_socket.h>
 
@@ -42,8 +45,14 @@
 /*============================================================================
 * Global Variables
 *===========================================================================*/
-/* The timer list. */
-OpcUa_P_InternalTimer   g_OpcUa_P_Timer_Timers[OPCUA_P_TIMER_NO_OF_TIMERS];
+/* The timers, kept as a binary min-heap ordered by due time. */
+OpcUa_P_InternalTimer** g_OpcUa_P_Timer_Heap            = OpcUa_Null;
+/* The number of timers in the heap. */
+OpcUa_UInt32            g_OpcUa_P_Timer_uNoOfTimers     = 0;
+/* The number of slots allocated for the heap. */
+OpcUa_UInt32            g_OpcUa_P_Timer_uMaxNoOfTimers  = 0;
+/* Deleted timers; they are reused instead of freed, so a stale handle stays readable. */
+OpcUa_P_InternalTimer*  g_OpcUa_P_Timer_pFreeList       = OpcUa_Null;
 
 #if OPCUA_USE_SYNCHRONISATION
 /* Synchronize access to the timer list. */
@@ -53,26 +62,185 @@ OpcUa_Mutex             g_OpcUa_P_Timer_pTimers_Mutex   = OpcUa_Null;
 #if OPCUA_MULTITHREADED
 /* In MT config, the timer is realized by a thread. */
 OpcUa_RawThread         g_pTimerThread                  = OpcUa_Null;
-OpcUa_Semaphore         g_hTimerAddedSemaphore          = OpcUa_Null;
+/* The timer thread sleeps on this timerfd, which is armed for the nearest due time. */
+int                     g_iTimerFd                      = -1;
 OpcUa_Boolean           g_bStopTimerThread              = OpcUa_False;
 
 static OpcUa_Void OpcUa_P_Timer_Thread(OpcUa_Void* pArguments);
 #endif /* OPCUA_MULTITHREADED */
 
+/*============================================================================
+* Timer heap helpers; the caller holds the timer mutex.
+*===========================================================================*/
+/* wrap-around safe comparison of tick counts */
+#define OPCUA_P_TIMER_IS_DUE(xDueTime, xNow) ((OpcUa_Int32)((xDueTime) - (xNow)) <= 0)
+
+static
+OpcUa_Void OpcUa_P_Timer_Heap_Swap(OpcUa_UInt32 a_uIndex1,
+                                   OpcUa_UInt32 a_uIndex2)
+{
+    OpcUa_P_InternalTimer* pInternalTimer = g_OpcUa_P_Timer_Heap[a_uIndex1];
+
+    g_OpcUa_P_Timer_Heap[a_uIndex1] = g_OpcUa_P_Timer_Heap[a_uIndex2];
+    g_OpcUa_P_Timer_Heap[a_uIndex2] = pInternalTimer;
+
+    g_OpcUa_P_Timer_Heap[a_uIndex1]->uHeapIndex = a_uIndex1;
+    g_OpcUa_P_Timer_Heap[a_uIndex2]->uHeapIndex = a_uIndex2;
+}
+
+static
+OpcUa_Boolean OpcUa_P_Timer_Heap_Less(OpcUa_UInt32 a_uIndex1,
+                                      OpcUa_UInt32 a_uIndex2)
+{
+    return (OpcUa_Int32)(g_OpcUa_P_Timer_Heap[a_uIndex1]->uDueTime - g_OpcUa_P_Timer_Heap[a_uIndex2]->uDueTime) < 0;
+}
+
+static
+OpcUa_Void OpcUa_P_Timer_Heap_SiftUp(OpcUa_UInt32 a_uIndex)
+{
+    while(a_uIndex > 0 && OpcUa_P_Timer_Heap_Less(a_uIndex, (a_uIndex - 1) / 2))
+    {
+        OpcUa_P_Timer_Heap_Swap(a_uIndex, (a_uIndex - 1) / 2);
+        a_uIndex = (a_uIndex - 1) / 2;
+    }
+}
+
+static
+OpcUa_Void OpcUa_P_Timer_Heap_SiftDown(OpcUa_UInt32 a_uIndex)
+{
+    OpcUa_UInt32 uChild = 0;
+
+    for(;;)
+    {
+        uChild = 2 * a_uIndex + 1;
+        if(uChild >= g_OpcUa_P_Timer_uNoOfTimers)
+        {
+            break;
+        }
+
+        if(uChild + 1 < g_OpcUa_P_Timer_uNoOfTimers && OpcUa_P_Timer_Heap_Less(uChild + 1, uChild))
+        {
+            uChild++;
+        }
+
+        if(!OpcUa_P_Timer_Heap_Less(uChild, a_uIndex))
+        {
+            break;
+        }
+
+        OpcUa_P_Timer_Heap_Swap(a_uIndex, uChild);
+        a_uIndex = uChild;
+    }
+}
+
+static
+OpcUa_StatusCode OpcUa_P_Timer_Heap_Insert(OpcUa_P_InternalTimer* a_pInternalTimer)
+{
+    if(g_OpcUa_P_Timer_uNoOfTimers == g_OpcUa_P_Timer_uMaxNoOfTimers)
+    {
+        OpcUa_UInt32            uMaxNoOfTimers = g_OpcUa_P_Timer_uMaxNoOfTimers * 2;
+        OpcUa_P_InternalTimer** pHeap          = OpcUa_Null;
+
+        if(uMaxNoOfTimers == 0)
+        {
+            uMaxNoOfTimers = OPCUA_P_TIMER_INITIAL_NO_OF_TIMERS;
+        }
+
+        pHeap = (OpcUa_P_InternalTimer**)OpcUa_P_Memory_ReAlloc(g_OpcUa_P_Timer_Heap,
+                                                                uMaxNoOfTimers * sizeof(OpcUa_P_InternalTimer*));
+        if(pHeap == OpcUa_Null)
+        {
+            return OpcUa_BadOutOfMemory;
+        }
+
+        g_OpcUa_P_Timer_Heap           = pHeap;
+        g_OpcUa_P_Timer_uMaxNoOfTimers = uMaxNoOfTimers;
+    }
+
+    a_pInternalTimer->uHeapIndex = g_OpcUa_P_Timer_uNoOfTimers;
+    g_OpcUa_P_Timer_Heap[g_OpcUa_P_Timer_uNoOfTimers++] = a_pInternalTimer;
+    OpcUa_P_Timer_Heap_SiftUp(a_pInternalTimer->uHeapIndex);
+
+    return OpcUa_Good;
+}
+
+static
+OpcUa_Void OpcUa_P_Timer_Heap_Remove(OpcUa_P_InternalTimer* a_pInternalTimer)
+{
+    OpcUa_UInt32            uIndex      = a_pInternalTimer->uHeapIndex;
+    OpcUa_P_InternalTimer*  pLastTimer  = OpcUa_Null;
+
+    g_OpcUa_P_Timer_uNoOfTimers--;
+
+    if(uIndex != g_OpcUa_P_Timer_uNoOfTimers)
+    {
+        /* move the last timer into the gap and restore the heap order */
+        pLastTimer = g_OpcUa_P_Timer_Heap[g_OpcUa_P_Timer_uNoOfTimers];
+        OpcUa_P_Timer_Heap_Swap(uIndex, g_OpcUa_P_Timer_uNoOfTimers);
+        OpcUa_P_Timer_Heap_SiftUp(uIndex);
+        OpcUa_P_Timer_Heap_SiftDown(pLastTimer->uHeapIndex);
+    }
+
+    g_OpcUa_P_Timer_Heap[g_OpcUa_P_Timer_uNoOfTimers] = OpcUa_Null;
+}
+
+/* INFO: Timer mutex is locked during this call. The timer may be stale; it is
+   still readable because deleted timers stay in the free list. */
+static
+OpcUa_Boolean OpcUa_P_Timer_Heap_Contains(OpcUa_P_InternalTimer* a_pInternalTimer)
+{
+    return a_pInternalTimer->uHeapIndex < g_OpcUa_P_Timer_uNoOfTimers &&
+           g_OpcUa_P_Timer_Heap[a_pInternalTimer->uHeapIndex] == a_pInternalTimer;
+}
+
+#if OPCUA_MULTITHREADED
+/*============================================================================
+* Arm the timerfd for the nearest due time; the caller holds the timer mutex.
+*===========================================================================*/
+static
+OpcUa_Void OpcUa_P_Timer_SetWakeup(OpcUa_Void)
+{
+    struct itimerspec   Wakeup;
+    OpcUa_Int32         iTimeout = 0;
+
+    OpcUa_MemSet(&Wakeup, 0, sizeof(Wakeup));
+
+    if(g_bStopTimerThread != OpcUa_False)
+    {
+        /* wake up immediately */
+        Wakeup.it_value.tv_nsec = 1;
+    }
+    else if(g_OpcUa_P_Timer_uNoOfTimers > 0)
+    {
+        iTimeout = (OpcUa_Int32)(g_OpcUa_P_Timer_Heap[0]->uDueTime - OpcUa_P_GetTickCount());
+        if(iTimeout > 0)
+        {
+            Wakeup.it_value.tv_sec  = iTimeout / 1000;
+            Wakeup.it_value.tv_nsec = (iTimeout % 1000) * 1000000;
+        }
+        else
+        {
+            Wakeup.it_value.tv_nsec = 1;
+        }
+    }
+    /* else disarm; the thread sleeps until a timer gets created */
+
+    timerfd_settime(g_iTimerFd, 0, &Wakeup, NULL);
+}
+#endif /* OPCUA_MULTITHREADED */
+
 /*============================================================================
 * Fire and recalculate timers.
 *===========================================================================*/
 /**
- * Description
- * @return Description
+ * Fires all due timers and reschedules them.
+ * @return The time in msec until the next timer is due, or 0 if the timer thread shall stop.
  */
 static
 OpcUa_UInt32 OpcUa_P_Timer_ProcessTimers(OpcUa_Void)
 {
-    OpcUa_UInt16            uIndex;
     OpcUa_P_InternalTimer*  pInternalTimer;
     OpcUa_UInt32            uNow;
-    OpcUa_UInt32            uProStart;
     OpcUa_UInt32            uElapsed;
     OpcUa_UInt32            uNearest = OPCUA_TIMER_MAX_WAIT;
 
@@ -90,46 +258,47 @@ OpcUa_UInt32 OpcUa_P_Timer_ProcessTimers(OpcUa_Void)
     }
 #endif /* OPCUA_MULTITHREADED */
 
-    uProStart       = OpcUa_P_GetTickCount();
-    for(uIndex = 0; uIndex < OPCUA_P_TIMER_NO_OF_TIMERS; uIndex++)
+    uNow = OpcUa_P_GetTickCount();
+
+    while(g_OpcUa_P_Timer_uNoOfTimers > 0)
+    {
+        pInternalTimer = g_OpcUa_P_Timer_Heap[0];
+
+        if(!OPCUA_P_TIMER_IS_DUE(pInternalTimer->uDueTime, uNow))
+        {
+            break;
+        }
+
+        /* reschedule before firing; the callback may delete or create timers */
+        uElapsed                    = uNow - pInternalTimer->uLastFired;
+        pInternalTimer->uLastFired  = uNow;
+        pInternalTimer->uDueTime    = uNow + pInternalTimer->msecInterval;
+        OpcUa_P_Timer_Heap_SiftDown(0);
+
+        /* Fire Timer */
+        if(pInternalTimer->TimerCallback != OpcUa_Null)
+        {
+            pInternalTimer->TimerCallback(  pInternalTimer->CallbackData,
+                                            pInternalTimer,
+                                            uElapsed);
+        }
+    }
+
+    if(g_OpcUa_P_Timer_uNoOfTimers > 0)
     {
-        if(g_OpcUa_P_Timer_Timers[uIndex].bUsed != OpcUa_False)
+        /* calculate time to next fire event */
+        uElapsed = g_OpcUa_P_Timer_Heap[0]->uDueTime - OpcUa_P_GetTickCount();
+        if((OpcUa_Int32)uElapsed <= 0) uElapsed = 1;
+
+        if(uElapsed < uNearest)
         {
-            pInternalTimer  = &g_OpcUa_P_Timer_Timers[uIndex];
-            uNow            = OpcUa_P_GetTickCount();
-
-            /* check for overflow of GetTickCount/uNow */
-            uElapsed = uNow - pInternalTimer->uLastFired;
-
-            /*if(uNow >= pInternalTimer->uDueTime)*/
-            if(uElapsed >= pInternalTimer->msecInterval)
-            {
-                /* Fire Timer */
-                pInternalTimer->uLastFired  = uNow;
-
-                if(pInternalTimer->TimerCallback != OpcUa_Null)
-                {
-                    pInternalTimer->TimerCallback(  pInternalTimer->CallbackData,
-                                                    pInternalTimer,
-                                                    uElapsed);
-                }
-
-                /* update duetime */
-                pInternalTimer->uDueTime = pInternalTimer->uLastFired + pInternalTimer->msecInterval;
-            }
-
-            /* calculate time to next fire event for the current timer */
-            /* HINT: use uElapsed as helper only! */
-            uElapsed = pInternalTimer->uDueTime - uProStart;
-            if (uElapsed == 0) uElapsed = 1;
-
-            /* get the minimum */
-            if(uElapsed < uNearest)
-            {
-                uNearest = uElapsed;
-            }
-        } /* if(g_OpcUa_P_Timer_Timers[uIndex].bUsed != OpcUa_False) */
-    } /* for(uIndex = 0; uIndex < OPCUA_P_TIMER_NO_OF_TIMERS; uIndex++) */
+            uNearest = uElapsed;
+        }
+    }
+
+#if OPCUA_MULTITHREADED
+    OpcUa_P_Timer_SetWakeup();
+#endif /* OPCUA_MULTITHREADED */
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
@@ -156,15 +325,13 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_InitializeTimers(OpcUa_Void)
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
 #if OPCUA_MULTITHREADED
-    uStatus = OpcUa_P_Semaphore_Create( &g_hTimerAddedSemaphore,
-                                        0,  /* not signalled */
-                                        1); /* max 1 post */
-    if(OpcUa_IsBad(uStatus))
+    g_iTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if(g_iTimerFd == -1)
     {
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Delete(&g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
-        return uStatus;
+        return OpcUa_BadInternalError;
     }
 
     g_bStopTimerThread = OpcUa_False;
@@ -172,7 +339,8 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_InitializeTimers(OpcUa_Void)
     uStatus = OpcUa_P_Thread_Create(&g_pTimerThread);
     if(OpcUa_IsBad(uStatus))
     {
-        OpcUa_P_Semaphore_Delete(&g_hTimerAddedSemaphore);
+        close(g_iTimerFd);
+        g_iTimerFd = -1;
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Delete(&g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
@@ -185,7 +353,8 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_InitializeTimers(OpcUa_Void)
     if(OpcUa_IsBad(uStatus))
     {
         OpcUa_P_Thread_Delete(&g_pTimerThread);
-        OpcUa_P_Semaphore_Delete(&g_hTimerAddedSemaphore);
+        close(g_iTimerFd);
+        g_iTimerFd = -1;
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Delete(&g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
@@ -205,7 +374,7 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_InitializeTimers(OpcUa_Void)
  */
 OpcUa_Void OPCUA_DLLCALL OpcUa_P_Timer_CleanupTimers(OpcUa_Void)
 {
-    OpcUa_UInt32 uIndex = 0;
+    OpcUa_P_InternalTimer* pInternalTimer = OpcUa_Null;
 
 #if OPCUA_MULTITHREADED
     /* signal thread to stop */
@@ -213,30 +382,39 @@ OpcUa_Void OPCUA_DLLCALL OpcUa_P_Timer_CleanupTimers(OpcUa_Void)
     OpcUa_P_Mutex_Lock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
     g_bStopTimerThread = OpcUa_True;
+    OpcUa_P_Timer_SetWakeup();
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    OpcUa_P_Semaphore_Post(g_hTimerAddedSemaphore, 1);
     OpcUa_P_Thread_Delete(&g_pTimerThread);
 #endif /* OPCUA_MULTITHREADED */
 
     /* no other thread should access this list by now! */
-    for(uIndex = 0; uIndex < OPCUA_P_TIMER_NO_OF_TIMERS; uIndex++)
+    while(g_OpcUa_P_Timer_uNoOfTimers > 0)
     {
-        if(g_OpcUa_P_Timer_Timers[uIndex].bUsed != OpcUa_False)
-        {
-            /* we should have a clear for this ... */
-            OpcUa_P_InternalTimer* pInternalTimer = &g_OpcUa_P_Timer_Timers[uIndex];
-            OpcUa_P_Timer_Delete((OpcUa_Timer*)&pInternalTimer);
-        }
+        /* we should have a clear for this ... */
+        pInternalTimer = g_OpcUa_P_Timer_Heap[g_OpcUa_P_Timer_uNoOfTimers - 1];
+        OpcUa_P_Timer_Delete((OpcUa_Timer*)&pInternalTimer);
+    }
+
+    OpcUa_P_Memory_Free(g_OpcUa_P_Timer_Heap);
+    g_OpcUa_P_Timer_Heap           = OpcUa_Null;
+    g_OpcUa_P_Timer_uMaxNoOfTimers = 0;
+
+    while(g_OpcUa_P_Timer_pFreeList != OpcUa_Null)
+    {
+        pInternalTimer            = g_OpcUa_P_Timer_pFreeList;
+        g_OpcUa_P_Timer_pFreeList = pInternalTimer->pNextFree;
+        OpcUa_P_Memory_Free(pInternalTimer);
     }
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Delete(&g_OpcUa_P_Timer_pTimers_Mutex);
 #endif
 #if OPCUA_MULTITHREADED
-    OpcUa_P_Semaphore_Delete(&g_hTimerAddedSemaphore);
+    close(g_iTimerFd);
+    g_iTimerFd = -1;
 #endif /* OPCUA_MULTITHREADED */
 
     return;
@@ -263,7 +441,8 @@ static OpcUa_StatusCode OpcUa_P_Timer_Initialize(OpcUa_P_InternalTimer*  a_pInte
     OpcUa_ReturnErrorIfArgumentNull(a_pInternalTimer);
     OpcUa_ReturnErrorIfTrue((a_msecInterval == 0), OpcUa_BadInvalidArgument);
 
-    a_pInternalTimer->bUsed         = OpcUa_False;
+    a_pInternalTimer->uHeapIndex    = 0;
+    a_pInternalTimer->pNextFree     = OpcUa_Null;
     a_pInternalTimer->CallbackData  = a_pvCallbackData;
     a_pInternalTimer->KillCallback  = a_fpKillCallback;
     a_pInternalTimer->TimerCallback = a_fpTimerCallback;
@@ -281,20 +460,15 @@ static OpcUa_StatusCode OpcUa_P_Timer_Initialize(OpcUa_P_InternalTimer*  a_pInte
 static
 OpcUa_Void OpcUa_P_Timer_Thread(OpcUa_Void* a_pvArguments)
 {
-    OpcUa_UInt32 uTimeout = 0;
+    OpcUa_UInt64 uExpirations = 0;
 
     OpcUa_ReferenceParameter(a_pvArguments);
 
-    for(;;)
+    /* ProcessTimers rearms the timerfd for the next due timer */
+    while(OpcUa_P_Timer_ProcessTimers() != 0)
     {
-        uTimeout = OpcUa_P_Timer_ProcessTimers();
-
-        if(uTimeout != 0)
-        {
-            /* wait for timeout */
-            OpcUa_P_Semaphore_TimedWait(g_hTimerAddedSemaphore, uTimeout);
-        }
-        else
+        /* wait until the nearest timer is due or the list changed */
+        if(read(g_iTimerFd, &uExpirations, sizeof(uExpirations)) == -1 && errno != EINTR)
         {
             /* exit thread */
             break;
@@ -423,7 +597,6 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Timer_Create(OpcUa_Timer*            a_ph
 {
     OpcUa_P_InternalTimer*  pInternalTimer   = OpcUa_Null;
     OpcUa_StatusCode        uStatus          = OpcUa_Good;
-    OpcUa_UInt16            uIndex           = 0;
 
     if(a_phTimer == OpcUa_Null)
     {
@@ -436,23 +609,22 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Timer_Create(OpcUa_Timer*            a_ph
     OpcUa_P_Mutex_Lock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
-    /* look for free timer slot */
-    for(uIndex = 0; uIndex < OPCUA_P_TIMER_NO_OF_TIMERS; uIndex++)
+    /* reuse a deleted timer if possible */
+    pInternalTimer = g_OpcUa_P_Timer_pFreeList;
+    if(pInternalTimer != OpcUa_Null)
     {
-        if(g_OpcUa_P_Timer_Timers[uIndex].bUsed == OpcUa_False)
-        {
-            pInternalTimer = &g_OpcUa_P_Timer_Timers[uIndex];
-            pInternalTimer->bUsed = OpcUa_True;
-            break;
-        }
+        g_OpcUa_P_Timer_pFreeList = pInternalTimer->pNextFree;
     }
-
-    if(pInternalTimer == OpcUa_Null)
+    else
     {
+        pInternalTimer = (OpcUa_P_InternalTimer*)OpcUa_P_Memory_Alloc(sizeof(OpcUa_P_InternalTimer));
+        if(pInternalTimer == OpcUa_Null)
+        {
 #if OPCUA_USE_SYNCHRONISATION
-        OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
+            OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
-        return OpcUa_BadResourceUnavailable;
+            return OpcUa_BadOutOfMemory;
+        }
     }
 
     uStatus = OpcUa_P_Timer_Initialize(pInternalTimer,
@@ -461,22 +633,28 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Timer_Create(OpcUa_Timer*            a_ph
         a_fpKillCallback,
         a_pvCallbackData);
 
+    if(OpcUa_IsGood(uStatus))
+    {
+        uStatus = OpcUa_P_Timer_Heap_Insert(pInternalTimer);
+    }
+
     if(OpcUa_IsBad(uStatus))
     {
-        pInternalTimer->bUsed = OpcUa_False;
+        pInternalTimer->pNextFree = g_OpcUa_P_Timer_pFreeList;
+        g_OpcUa_P_Timer_pFreeList = pInternalTimer;
 
 #if OPCUA_USE_SYNCHRONISATION
         OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
-
         return uStatus;
     }
 
-    pInternalTimer->bUsed = OpcUa_True;
-
 #if OPCUA_MULTITHREADED
-    /* trigger event for timer thread. */
-    OpcUa_P_Semaphore_Post(g_hTimerAddedSemaphore, 1);
+    /* the new timer is due first; rearm the timer thread. */
+    if(pInternalTimer->uHeapIndex == 0)
+    {
+        OpcUa_P_Timer_SetWakeup();
+    }
 #endif /* OPCUA_MULTITHREADED */
 
     *a_phTimer = pInternalTimer;
@@ -501,21 +679,25 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Timer_Delete(OpcUa_Timer* a_phTimer)
     OpcUa_P_InternalTimer* pInternalTimer = OpcUa_Null;
     OpcUa_UInt32           uNow           = 0;
     OpcUa_UInt32           uElapsed       = 0;
-    OpcUa_UInt16           uIndex         = 0;
 
     OpcUa_ReturnErrorIfArgumentNull(a_phTimer);
     OpcUa_ReturnErrorIfArgumentNull(*a_phTimer);
 
     pInternalTimer = (OpcUa_P_InternalTimer*)*a_phTimer;
-    if(pInternalTimer->bUsed == OpcUa_False)
-    {
-        return OpcUa_BadInvalidArgument;
-    }
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Lock(g_OpcUa_P_Timer_pTimers_Mutex);
 #endif /* OPCUA_USE_SYNCHRONISATION */
 
+    /* the handle may be stale; check that it is still in the heap */
+    if(!OpcUa_P_Timer_Heap_Contains(pInternalTimer))
+    {
+#if OPCUA_USE_SYNCHRONISATION
+        OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
+#endif /* OPCUA_USE_SYNCHRONISATION */
+        return OpcUa_BadInvalidArgument;
+    }
+
     uNow     = OpcUa_P_GetTickCount();
     uElapsed = uNow - pInternalTimer->uLastFired;
 
@@ -527,15 +709,12 @@ OpcUa_StatusCode OPCUA_DLLCALL OpcUa_P_Timer_Delete(OpcUa_Timer* a_phTimer)
                                         uElapsed);
     }
 
-    /* look for matching timer slot and free it */
-    for(uIndex = 0; uIndex < OPCUA_P_TIMER_NO_OF_TIMERS; uIndex++)
-    {
-        if(&g_OpcUa_P_Timer_Timers[uIndex] == pInternalTimer)
-        {
-            g_OpcUa_P_Timer_Timers[uIndex].bUsed = OpcUa_False;
-            break;
-        }
-    }
+    /* unlink the timer; a stale wakeup of the timer thread is harmless */
+    OpcUa_P_Timer_Heap_Remove(pInternalTimer);
+
+    /* keep the block for reuse; stale handles to it must stay readable */
+    pInternalTimer->pNextFree = g_OpcUa_P_Timer_pFreeList;
+    g_OpcUa_P_Timer_pFreeList = pInternalTimer;
 
 #if OPCUA_USE_SYNCHRONISATION
     OpcUa_P_Mutex_Unlock(g_OpcUa_P_Timer_pTimers_Mutex);
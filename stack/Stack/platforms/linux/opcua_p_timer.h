@@ -35,9 +35,9 @@ OPCUA_BEGIN_EXTERN_C
 /*============================================================================
  * Defines
  *===========================================================================*/
-/** @brief The number of timers available to the system. */
-#ifndef OPCUA_P_TIMER_NO_OF_TIMERS
-#define OPCUA_P_TIMER_NO_OF_TIMERS   200
+/** @brief The number of timer slots allocated when the first timer is created. The timer heap doubles when full. */
+#ifndef OPCUA_P_TIMER_INITIAL_NO_OF_TIMERS
+#define OPCUA_P_TIMER_INITIAL_NO_OF_TIMERS   32
 #endif
 
 /*============================================================================
@@ -45,8 +45,8 @@ OPCUA_BEGIN_EXTERN_C
  *===========================================================================*/
 typedef struct _OpcUa_P_InternalTimer
 {
-    /** @brief  */
-    OpcUa_Boolean           bUsed;
+    /** @brief Position of the timer in the timer heap. */
+    OpcUa_UInt32            uHeapIndex;
     /** @brief  */
     OpcUa_UInt32            msecInterval;
     /** @brief  */
@@ -59,6 +59,8 @@ typedef struct _OpcUa_P_InternalTimer
     OpcUa_UInt32            uLastFired;
     /** @brief  */
     OpcUa_UInt32            uDueTime;
+    /** @brief Next block in the free list while the timer is deleted. */
+    struct _OpcUa_P_InternalTimer* pNextFree;
 
 } OpcUa_P_InternalTimer;
 
@@ -34,6 +34,7 @@
 
 /* core */
 #include <opcua_mutex.h>
+#include <opcua_threadpool.h>
 
 /* types */
 #include <opcua_types.h>
@@ -96,6 +97,17 @@ struct _OpcUa_EndpointContext
 
     /** @brief The id of the corresponding securechannel. */
     OpcUa_UInt32            uSecureChannelId;
+
+#if OPCUA_MULTITHREADED
+    /** @brief The endpoint which received the request; set while the request is queued. */
+    OpcUa_Endpoint          hEndpoint;
+
+    /** @brief The decoded request; owned by the context while the request is queued. */
+    OpcUa_Void*             pRequest;
+
+    /** @brief The type of the decoded request. */
+    OpcUa_EncodeableType*   pRequestType;
+#endif /* OPCUA_MULTITHREADED */
 };
 
 typedef struct _OpcUa_EndpointContext OpcUa_EndpointContext;
@@ -251,6 +263,11 @@ OpcUa_Void OpcUa_Endpoint_Delete(OpcUa_Endpoint* a_phEndpoint)
         OpcUa_EndpointInternal* pEndpointInt = (OpcUa_EndpointInternal*)*a_phEndpoint;
         *a_phEndpoint = OpcUa_Null;
 
+#if OPCUA_MULTITHREADED
+        /* only if the endpoint was not closed before; queued requests need the unlocked endpoint */
+        OpcUa_ThreadPool_Delete(&pEndpointInt->ThreadPool);
+#endif /* OPCUA_MULTITHREADED */
+
         OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
         OpcUa_Listener_Delete(&pEndpointInt->TransportListener);
         OpcUa_Listener_Delete(&pEndpointInt->SecureListener);
@@ -537,6 +554,19 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "Open");
 
     pEndpointInt->Status = OpcUa_BadWaitingForResponse;
 
+#if OPCUA_MULTITHREADED
+    /* start the worker threads before the first request can arrive */
+    if(OpcUa_ProxyStub_g_Configuration.bSecureListener_ThreadPool_Enabled != OpcUa_False)
+    {
+        uStatus = OpcUa_ThreadPool_Create(  &pEndpointInt->ThreadPool,
+                                            (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MinThreads,
+                                            (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxThreads,
+                                            (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iSecureListener_ThreadPool_MaxJobs,
+                                            OpcUa_ProxyStub_g_Configuration.bSecureListener_ThreadPool_BlockOnAdd,
+                                            OpcUa_ProxyStub_g_Configuration.uSecureListener_ThreadPool_Timeout);
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+#endif /* OPCUA_MULTITHREADED */
 
     /* open the endpoint. */
     uStatus = OpcUa_Listener_Open(  pEndpointInt->SecureListener,
@@ -554,6 +584,9 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "Open");
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
 
+#if OPCUA_MULTITHREADED
+    OpcUa_ThreadPool_Delete(&pEndpointInt->ThreadPool);
+#endif /* OPCUA_MULTITHREADED */
     OpcUa_Listener_Delete(&pEndpointInt->TransportListener);
     OpcUa_Listener_Delete(&pEndpointInt->SecureListener);
     OpcUa_Encoder_Delete(&pEndpointInt->Encoder);
@@ -581,6 +614,19 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "Close");
 
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_Close: Cleaning up!\n");
 
+#if OPCUA_MULTITHREADED
+    if(pEndpointInt->ThreadPool != OpcUa_Null)
+    {
+        /* answer the queued requests while the endpoint is still open; new requests are processed inline */
+        OpcUa_ThreadPool hThreadPool = pEndpointInt->ThreadPool;
+        pEndpointInt->ThreadPool = OpcUa_Null;
+
+        OPCUA_P_MUTEX_UNLOCK(pEndpointInt->Mutex);
+        OpcUa_ThreadPool_Delete(&hThreadPool);
+        OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
+    }
+#endif /* OPCUA_MULTITHREADED */
+
     pEndpointInt->State = eOpcUa_Endpoint_State_Closed;
 
     /* close listener */
@@ -777,6 +823,82 @@ static OpcUa_Void OpcUa_Endpoint_DeleteContext( OpcUa_Endpoint a_hEndpoint,
     }
 }
 
+#if OPCUA_MULTITHREADED
+/*============================================================================
+ * OpcUa_Endpoint_SendFault
+ *===========================================================================*/
+/* Answers a request with a service fault. Deletes the context unless the endpoint is closed. */
+static OpcUa_StatusCode OpcUa_Endpoint_SendFault(   OpcUa_Endpoint          a_hEndpoint,
+                                                    OpcUa_Handle*           a_phContext,
+                                                    OpcUa_RequestHeader*    a_pRequestHeader,
+                                                    OpcUa_StatusCode        a_uServiceResult)
+{
+    OpcUa_Void*             pFault      = OpcUa_Null;
+    OpcUa_EncodeableType*   pFaultType  = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "SendFault");
+
+    uStatus = OpcUa_ServerApi_CreateFault(  a_pRequestHeader,
+                                            a_uServiceResult,
+                                            OpcUa_Null,
+                                            OpcUa_Null,
+                                            OpcUa_Null,
+                                            &pFault,
+                                            &pFaultType);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    uStatus = OpcUa_Endpoint_EndSendResponse(   a_hEndpoint,
+                                                a_phContext,
+                                                OpcUa_Good,
+                                                pFault,
+                                                pFaultType);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    OpcUa_EncodeableObject_Delete(pFaultType, &pFault);
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+
+    if(pFault != OpcUa_Null)
+    {
+        OpcUa_EncodeableObject_Delete(pFaultType, &pFault);
+    }
+
+OpcUa_FinishErrorHandling;
+}
+
+/*============================================================================
+ * OpcUa_Endpoint_InvokeServiceJob
+ *===========================================================================*/
+/* Thread pool job: calls the service handler for a queued request. The endpoint is not locked. */
+static OpcUa_Void OpcUa_Endpoint_InvokeServiceJob(OpcUa_Void* a_pArgument)
+{
+    OpcUa_EndpointContext*  pContext        = (OpcUa_EndpointContext*)a_pArgument;
+    OpcUa_Endpoint          hEndpoint       = pContext->hEndpoint;
+    OpcUa_Void*             pRequest        = pContext->pRequest;
+    OpcUa_EncodeableType*   pRequestType    = pContext->pRequestType;
+    OpcUa_StatusCode        uStatus         = OpcUa_Good;
+
+    /* the context belongs to the service handler from now on */
+    pContext->pRequest = OpcUa_Null;
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_InvokeServiceJob: Invoking service handler!\n");
+
+    uStatus = pContext->ServiceType.BeginInvoke(    hEndpoint,
+                                                    pContext,
+                                                    &pRequest,
+                                                    pRequestType);
+
+    OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_InvokeServiceJob: Service handler returned! (0x%08X)\n", uStatus);
+
+    /* does nothing if callee before nulled the parameter */
+    if(pRequest != OpcUa_Null)
+    {
+        OpcUa_EncodeableObject_Delete(pRequestType, &pRequest);
+    }
+}
+#endif /* OPCUA_MULTITHREADED */
+
 /*============================================================================
  * OpcUa_Endpoint_BeginProcessRequest
  *===========================================================================*/
@@ -891,6 +1013,47 @@ OpcUa_InitializeStatus(OpcUa_Module_Endpoint, "BeginProcessRequest");
 
 #endif /* OPCUA_ENDPOINT_PREALLOCATE_RESPONSESTREAM */
 
+#if OPCUA_MULTITHREADED
+    if(pEndpointInt->ThreadPool != OpcUa_Null)
+    {
+        OpcUa_ThreadPool hThreadPool = pEndpointInt->ThreadPool;
+
+        pContext->hEndpoint     = a_hEndpoint;
+        pContext->pRequest      = pRequest;
+        pContext->pRequestType  = pRequestType;
+
+        /* service handlers may lock the endpoint; do not hold it while waiting for a queue entry */
+        OPCUA_P_MUTEX_UNLOCK(pEndpointInt->Mutex);
+        uStatus = OpcUa_ThreadPool_AddJob(hThreadPool, OpcUa_Endpoint_InvokeServiceJob, pContext);
+        OPCUA_P_MUTEX_LOCK(pEndpointInt->Mutex);
+
+        if(OpcUa_IsGood(uStatus))
+        {
+            /* request and context are owned by the job now */
+            OpcUa_ReturnStatusCode;
+        }
+
+        pContext->pRequest = OpcUa_Null;
+
+        OpcUa_Trace(OPCUA_TRACE_LEVEL_WARNING, "OpcUa_Endpoint_BeginProcessRequest: Could not queue request (0x%08X)! Rejecting it.\n", uStatus);
+
+        /* answer with a service fault instead of letting the client time out */
+        uStatus = OpcUa_Endpoint_SendFault( a_hEndpoint,
+                                            (OpcUa_Handle*)&pContext,
+                                            (OpcUa_RequestHeader*)pRequest,
+                                            OpcUa_BadTooManyOperations);
+        if(pContext != OpcUa_Null)
+        {
+            /* nothing was sent; undo BeginSendResponse */
+            OpcUa_GotoError;
+        }
+
+        OpcUa_EncodeableObject_Delete(pRequestType, &pRequest);
+
+        OpcUa_ReturnStatusCode;
+    }
+#endif /* OPCUA_MULTITHREADED */
+
     OpcUa_Trace(OPCUA_TRACE_LEVEL_DEBUG, "OpcUa_Endpoint_BeginProcessRequest: Invoking service handler!\n");
 
     uStatus = pContext->ServiceType.BeginInvoke(    a_hEndpoint,
@@ -96,6 +96,11 @@ typedef struct _OpcUa_EndpointInternal
 
     /*! @brief The current status of the endpoint. */
     OpcUa_StatusCode Status;
+
+#if OPCUA_MULTITHREADED
+    /*! @brief The worker threads executing the service handlers (OpcUa_Null if requests are processed inline). */
+    OpcUa_ThreadPool ThreadPool;
+#endif /* OPCUA_MULTITHREADED */
 } OpcUa_EndpointInternal;
 
 OPCUA_END_EXTERN_C
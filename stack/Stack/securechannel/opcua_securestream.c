@@ -480,6 +480,14 @@ static OpcUa_StatusCode OpcUa_SecureStream_Read(    OpcUa_InputStream*
                                                     OpcUa_Byte*                    pTargetBuffer,
                                                     OpcUa_UInt32*                  pCount);
 
+/**
+  @brief Exposes the unread data of the current chunk. Implements GetReadWindow of the OpcUa_InputStream "interface".
+*/
+static OpcUa_StatusCode OpcUa_SecureStream_GetReadWindow(   OpcUa_InputStream*  pIstrm,
+                                                            OpcUa_UInt32        uConsumed,
+                                                            OpcUa_Byte**        ppData,
+                                                            OpcUa_UInt32*       pCount);
+
 /**
   @brief @brief Writes data from a given output stream. Implements Write of the OpcUa_OutputStream "interface".
 */
@@ -790,6 +798,50 @@ OpcUa_BeginErrorHandling;
 OpcUa_FinishErrorHandling;
 }
 
+/*============================================================================
+ * OpcUa_SecureStream_GetReadWindow
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_SecureStream_GetReadWindow(   OpcUa_InputStream*  a_pIstrm,
+                                                            OpcUa_UInt32        a_uConsumed,
+                                                            OpcUa_Byte**        a_ppData,
+                                                            OpcUa_UInt32*       a_pCount)
+{
+    OpcUa_SecureStream* pSecureStream   = OpcUa_Null;
+    OpcUa_Buffer*       pBuffer         = OpcUa_Null;
+
+OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "GetReadWindow");
+
+    OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
+    OpcUa_ReturnErrorIfArgumentNull(a_ppData);
+    OpcUa_ReturnErrorIfArgumentNull(a_pCount);
+
+    OpcUa_ReturnErrorIfInvalidObject(OpcUa_SecureStream, a_pIstrm, GetReadWindow);
+
+    pSecureStream = (OpcUa_SecureStream*)a_pIstrm->Handle;
+
+    /* verify stream state */
+    if(pSecureStream->IsClosed)
+    {
+        uStatus = OpcUa_BadInvalidState;
+        OpcUa_GotoErrorIfBad(uStatus);
+    }
+
+    /* the window never spans chunks; crossing into the next buffer is left to Read */
+    pBuffer = &pSecureStream->Buffers[pSecureStream->nCurrentReadBuffer];
+
+    uStatus = OpcUa_Buffer_Skip(pBuffer, a_uConsumed);
+    OpcUa_GotoErrorIfBad(uStatus);
+
+    pSecureStream->nAbsolutePosition += a_uConsumed;
+
+    *a_ppData = pBuffer->Data + pBuffer->Position;
+    *a_pCount = pBuffer->EndOfData - pBuffer->Position;
+
+OpcUa_ReturnStatusCode;
+OpcUa_BeginErrorHandling;
+OpcUa_FinishErrorHandling;
+}
+
 /*============================================================================
  * OpcUa_SecureStream_EncodeAsymmetricSecurityHeader
  *===========================================================================*/
@@ -2057,6 +2109,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateInput");
     (*a_ppIstrm)->Close       = OpcUa_SecureStream_Close;
     (*a_ppIstrm)->Delete      = OpcUa_SecureStream_Delete;
     (*a_ppIstrm)->Read        = OpcUa_SecureStream_Read;
+    (*a_ppIstrm)->GetReadWindow = OpcUa_SecureStream_GetReadWindow;
     (*a_ppIstrm)->DetachBuffer= OpcUa_SecureStream_DetachBuffer;
     (*a_ppIstrm)->AttachBuffer= OpcUa_SecureStream_AttachBuffer;
 
@@ -2184,6 +2237,7 @@ OpcUa_InitializeStatus(OpcUa_Module_SecureStream, "CreateOpenSecureChannelInput"
     (*a_ppSecureIstrm)->Close       = OpcUa_SecureStream_Close;
     (*a_ppSecureIstrm)->Delete      = OpcUa_SecureStream_Delete;
     (*a_ppSecureIstrm)->Read        = OpcUa_SecureStream_Read;
+    (*a_ppSecureIstrm)->GetReadWindow = OpcUa_SecureStream_GetReadWindow;
 
 OpcUa_ReturnStatusCode;
 OpcUa_BeginErrorHandling;
@@ -46,8 +46,11 @@
  *
  * Stores the state of a memory stream.
  *
- * Istrm  - The stream to write data to.
- * Closed - Whether the encoder has been closed.
+ * Istrm       - The stream to write data to.
+ * Closed      - Whether the encoder has been closed.
+ * WindowStart - The unread data of the stream's current buffer, if exposed.
+ * Cursor      - The next byte to decode from the window.
+ * WindowEnd   - The end of the window.
  *===========================================================================*/
 typedef struct _OpcUa_BinaryDecoder
 {
@@ -56,6 +59,9 @@ typedef struct _OpcUa_BinaryDecoder
     OpcUa_MessageContext* Context;
     OpcUa_Boolean         Closed;
     OpcUa_UInt32          RecursionDepth;
+    OpcUa_Byte*           WindowStart;
+    OpcUa_Byte*           Cursor;
+    OpcUa_Byte*           WindowEnd;
 }
 OpcUa_BinaryDecoder;
 
@@ -77,6 +83,99 @@ pHandle = (OpcUa_BinaryDecoder*)a_pDecoder->Handle; \
 OpcUa_ReturnErrorIfArgumentNull(pHandle); \
 OpcUa_ReturnErrorIfTrue(pHandle->Closed, OpcUa_BadInvalidState);
 
+/*============================================================================
+ * OpcUa_BinaryDecoder_SyncStream
+ *
+ * Values that lie completely inside the current buffer of the stream are
+ * decoded in place from the window; the stream only learns about them here.
+ * Must be called before the stream is used directly. Also refreshes the
+ * window, which stays empty if the stream does not support GetReadWindow.
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_BinaryDecoder_SyncStream(
+    OpcUa_BinaryDecoder* a_pHandle)
+{
+    OpcUa_InputStream*  pIstrm  = a_pHandle->Istrm;
+    OpcUa_Byte*         pData   = OpcUa_Null;
+    OpcUa_UInt32        uCount  = 0;
+    OpcUa_StatusCode    uStatus = OpcUa_Good;
+
+    if (pIstrm->GetReadWindow != OpcUa_Null)
+    {
+        uStatus = pIstrm->GetReadWindow(pIstrm, (OpcUa_UInt32)(a_pHandle->Cursor - a_pHandle->WindowStart), &pData, &uCount);
+
+        if (OpcUa_IsBad(uStatus))
+        {
+            pData  = OpcUa_Null;
+            uCount = 0;
+        }
+    }
+
+    a_pHandle->WindowStart = pData;
+    a_pHandle->Cursor      = pData;
+    a_pHandle->WindowEnd   = (pData != OpcUa_Null) ? pData + uCount : OpcUa_Null;
+
+    return uStatus;
+}
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadBytes
+ *
+ * Copies raw bytes out of the window. Falls back to the stream when they
+ * are not all in the current buffer, i.e. at a chunk boundary.
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_BinaryDecoder_ReadBytes(
+    OpcUa_BinaryDecoder* a_pHandle,
+    OpcUa_Byte*          a_pTarget,
+    OpcUa_UInt32*        a_pCount)
+{
+    OpcUa_StatusCode uStatus = OpcUa_Good;
+    OpcUa_StatusCode uSyncStatus = OpcUa_Good;
+
+    if (*a_pCount <= (OpcUa_UInt32)(a_pHandle->WindowEnd - a_pHandle->Cursor))
+    {
+        if (*a_pCount > 0)
+        {
+            uStatus = OpcUa_MemCpy(a_pTarget, *a_pCount, a_pHandle->Cursor, *a_pCount);
+            a_pHandle->Cursor += *a_pCount;
+        }
+
+        return uStatus;
+    }
+
+    uStatus = OpcUa_BinaryDecoder_SyncStream(a_pHandle);
+
+    if (OpcUa_IsBad(uStatus))
+    {
+        return uStatus;
+    }
+
+    uStatus = a_pHandle->Istrm->Read(a_pHandle->Istrm, a_pTarget, a_pCount);
+    uSyncStatus = OpcUa_BinaryDecoder_SyncStream(a_pHandle);
+
+    return OpcUa_IsBad(uStatus) ? uStatus : uSyncStatus;
+}
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_DecodeFixedLengthType
+ *===========================================================================*/
+#define OpcUa_BinaryDecoder_DecodeFixedLengthType(xType) \
+if ((OpcUa_UInt32)(pHandle->WindowEnd - pHandle->Cursor) >= sizeof(OpcUa_##xType##_Wire)) \
+{ \
+    OpcUa_SwapBytes(a_pValue, pHandle->Cursor, sizeof(OpcUa_##xType##_Wire)); \
+    pHandle->Cursor += sizeof(OpcUa_##xType##_Wire); \
+} \
+else \
+{ \
+    uStatus = OpcUa_BinaryDecoder_SyncStream(pHandle); \
+    OpcUa_GotoErrorIfBad(uStatus); \
+    \
+    uStatus = OpcUa_##xType##_BinaryDecode(a_pValue, pHandle->Istrm); \
+    OpcUa_GotoErrorIfBad(uStatus); \
+    \
+    uStatus = OpcUa_BinaryDecoder_SyncStream(pHandle); \
+    OpcUa_GotoErrorIfBad(uStatus); \
+}
+
 /*============================================================================
  * OpcUa_Decode_FixedLengthType
  *===========================================================================*/
@@ -112,8 +211,7 @@ OpcUa_ReturnErrorIfArgumentNull(a_pValue); \
 OpcUa_ReferenceParameter(a_sFieldName); \
 OpcUa_BinaryDecoder_VerifyState(xType); \
 \
-uStatus = OpcUa_##xType##_BinaryDecode(a_pValue, pHandle->Istrm); \
-OpcUa_GotoErrorIfBad(uStatus); \
+OpcUa_BinaryDecoder_DecodeFixedLengthType(xType); \
 \
 OpcUa_ReturnStatusCode; \
 OpcUa_BeginErrorHandling; \
@@ -227,6 +325,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_Open");
     ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->Istrm          = a_pIstrm;
     ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->Context        = a_pContext;
     ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->RecursionDepth = 0;
+    ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->WindowStart    = OpcUa_Null;
+    ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->Cursor         = OpcUa_Null;
+    ((OpcUa_BinaryDecoder*)pDecoderContext->Handle)->WindowEnd      = OpcUa_Null;
+
+    /* decode from the stream's buffer where possible */
+    OpcUa_BinaryDecoder_SyncStream((OpcUa_BinaryDecoder*)pDecoderContext->Handle);
 
     *a_phDecodeContext = pDecoderContext;
 
@@ -260,6 +364,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_Close");
 
     pDecoderContext = (struct _OpcUa_Decoder*)*a_phDecodeContext;
 
+    /* leave the stream positioned behind the decoded data */
+    if (pDecoderContext->Handle != OpcUa_Null)
+    {
+        OpcUa_BinaryDecoder_SyncStream((OpcUa_BinaryDecoder*)pDecoderContext->Handle);
+    }
+
     OpcUa_Free(pDecoderContext->Handle);
     OpcUa_Free(pDecoderContext);
 
@@ -695,27 +805,93 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadDouble(
 }
 
 /*============================================================================
- * OpcUa_String_BinaryDecode
+ * OpcUa_BinaryDecoder_PfnReadBytes
+ *
+ * Reads raw bytes for the shared decode helpers below. The source is either
+ * the input stream (OpcUa_X_BinaryDecode) or the decoder handle, which reads
+ * from the window and only falls back to the stream at a chunk boundary.
+ * The helpers use it for the variable length data only; fixed length fields
+ * are loaded from the window directly when the decoder handle is passed.
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_String_BinaryDecode(
-    OpcUa_String*      a_pValue,
-    OpcUa_UInt32       a_nMaxStringLength,
-    OpcUa_InputStream* a_pIstrm)
+typedef OpcUa_StatusCode (OpcUa_BinaryDecoder_PfnReadBytes)(
+    OpcUa_Void*   a_pSource,
+    OpcUa_Byte*   a_pBuffer,
+    OpcUa_UInt32* a_pCount);
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadStreamBytes
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_BinaryDecoder_ReadStreamBytes(
+    OpcUa_Void*   a_pSource,
+    OpcUa_Byte*   a_pBuffer,
+    OpcUa_UInt32* a_pCount)
+{
+    OpcUa_InputStream* pIstrm = (OpcUa_InputStream*)a_pSource;
+
+    return pIstrm->Read(pIstrm, a_pBuffer, a_pCount);
+}
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadWindowBytes
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_BinaryDecoder_ReadWindowBytes(
+    OpcUa_Void*   a_pSource,
+    OpcUa_Byte*   a_pBuffer,
+    OpcUa_UInt32* a_pCount)
+{
+    return OpcUa_BinaryDecoder_ReadBytes((OpcUa_BinaryDecoder*)a_pSource, a_pBuffer, a_pCount);
+}
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadWireValue
+ *
+ * Reads one fixed length value for the helpers below. Like
+ * OpcUa_BinaryDecoder_DecodeFixedLengthType it swaps the value in place from
+ * the window of a_pHandle; a_pfnRead is only used without a decoder handle
+ * or when the value crosses the end of the window.
+ *===========================================================================*/
+#define OpcUa_BinaryDecoder_ReadWireValue(xType, xValue) \
+if (a_pHandle != OpcUa_Null && (OpcUa_UInt32)(a_pHandle->WindowEnd - a_pHandle->Cursor) >= sizeof(OpcUa_##xType##_Wire)) \
+{ \
+    OpcUa_SwapBytes(xValue, a_pHandle->Cursor, sizeof(OpcUa_##xType##_Wire)); \
+    a_pHandle->Cursor += sizeof(OpcUa_##xType##_Wire); \
+} \
+else \
+{ \
+    OpcUa_##xType##_Wire oWire; \
+    OpcUa_UInt32 uWireBytesRead = sizeof(OpcUa_##xType##_Wire); \
+ \
+    uStatus = a_pfnRead(a_pSource, (OpcUa_Byte*)&oWire, &uWireBytesRead); \
+    OpcUa_GotoErrorIfBad(uStatus); \
+ \
+    if (uWireBytesRead != sizeof(OpcUa_##xType##_Wire)) \
+    { \
+        OpcUa_GotoErrorWithStatus(OpcUa_BadNotSupported); \
+    } \
+ \
+    OpcUa_SwapBytes(xValue, &oWire, sizeof(OpcUa_##xType##_Wire)); \
+}
+
+/*============================================================================
+ * OpcUa_BinaryDecoder_DecodeString
+ *===========================================================================*/
+static OpcUa_StatusCode OpcUa_BinaryDecoder_DecodeString(
+    OpcUa_BinaryDecoder*              a_pHandle,
+    OpcUa_BinaryDecoder_PfnReadBytes* a_pfnRead,
+    OpcUa_Void*                       a_pSource,
+    OpcUa_UInt32                      a_nMaxStringLength,
+    OpcUa_String*                     a_pValue)
 {
     OpcUa_Int32 nLength = -1;
     OpcUa_UInt32 uBytesRead = 0;
     OpcUa_StringA pRawString = OpcUa_Null;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_String_BinaryDecode");
-
-    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
-    OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
+    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_DecodeString");
 
     OpcUa_String_Initialize(a_pValue);
 
     /* decode length */
-    uStatus = OpcUa_Int32_BinaryDecode(&nLength, a_pIstrm);
-    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_BinaryDecoder_ReadWireValue(Int32, &nLength);
 
     /* check for null string */
     if (nLength == -1)
@@ -735,7 +911,7 @@ OpcUa_StatusCode OpcUa_String_BinaryDecode(
 
     /* read bytes of string */
     uBytesRead = nLength;
-    uStatus = a_pIstrm->Read(a_pIstrm, (OpcUa_Byte*)pRawString, &uBytesRead);
+    uStatus = a_pfnRead(a_pSource, (OpcUa_Byte*)pRawString, &uBytesRead);
     OpcUa_GotoErrorIfBad(uStatus);
 
     if (uBytesRead != (OpcUa_UInt32)nLength)
@@ -747,7 +923,7 @@ OpcUa_StatusCode OpcUa_String_BinaryDecode(
     pRawString[nLength] = '\0';
 
     /* attach string */
-	uStatus = OpcUa_String_AttachToString(pRawString, nLength, 0, OpcUa_False, OpcUa_True, a_pValue);
+    uStatus = OpcUa_String_AttachToString(pRawString, nLength, 0, OpcUa_False, OpcUa_True, a_pValue);
     OpcUa_GotoErrorIfBad(uStatus);
 
     OpcUa_ReturnStatusCode;
@@ -760,133 +936,201 @@ OpcUa_StatusCode OpcUa_String_BinaryDecode(
 }
 
 /*============================================================================
- * OpcUa_BinaryDecoder_ReadString
+ * OpcUa_BinaryDecoder_DecodeDateTime
  *===========================================================================*/
-static
-OpcUa_StatusCode OpcUa_BinaryDecoder_ReadString(
-    struct _OpcUa_Decoder* a_pDecoder,
-    OpcUa_StringA          a_sFieldName,
-    OpcUa_String*          a_pValue)
+static OpcUa_StatusCode OpcUa_BinaryDecoder_DecodeDateTime(
+    OpcUa_BinaryDecoder*              a_pHandle,
+    OpcUa_BinaryDecoder_PfnReadBytes* a_pfnRead,
+    OpcUa_Void*                       a_pSource,
+    OpcUa_DateTime*                   a_pValue)
 {
-    OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
+    OpcUa_Int64 nValue = 0;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_ReadString");
+    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_DecodeDateTime");
 
-    OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
-    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
-    OpcUa_ReferenceParameter(a_sFieldName);
-    OpcUa_BinaryDecoder_VerifyState(String);
+    OpcUa_DateTime_Initialize(a_pValue);
 
-    uStatus = OpcUa_String_BinaryDecode(a_pValue, pHandle->Context->MaxStringLength, pHandle->Istrm);
-    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_BinaryDecoder_ReadWireValue(Int64, &nValue);
+
+    a_pValue->dwHighDateTime = (OpcUa_UInt32)(nValue >> 32);
+    a_pValue->dwLowDateTime  = (OpcUa_UInt32)(nValue &  0x00000000FFFFFFFF);
 
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
-    /* nothing to do */
+    OpcUa_DateTime_Clear(a_pValue);
 
     OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
- * OpcUa_DateTime_BinaryDecode
+ * OpcUa_BinaryDecoder_DecodeGuid
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_DateTime_BinaryDecode(
-    OpcUa_DateTime*    a_pValue,
-    OpcUa_InputStream* a_pIstrm)
+static OpcUa_StatusCode OpcUa_BinaryDecoder_DecodeGuid(
+    OpcUa_BinaryDecoder*              a_pHandle,
+    OpcUa_BinaryDecoder_PfnReadBytes* a_pfnRead,
+    OpcUa_Void*                       a_pSource,
+    OpcUa_Guid*                       a_pValue)
 {
-    OpcUa_Int64 nValue = 0;
+    OpcUa_UInt32 uBytesRead = 0;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_DateTime_BinaryDecode");
+    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_DecodeGuid");
 
-    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
-    OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
+    OpcUa_Guid_Initialize(a_pValue);
 
-    OpcUa_DateTime_Initialize(a_pValue);
+    OpcUa_BinaryDecoder_ReadWireValue(UInt32, &a_pValue->Data1);
+    OpcUa_BinaryDecoder_ReadWireValue(UInt16, &a_pValue->Data2);
+    OpcUa_BinaryDecoder_ReadWireValue(UInt16, &a_pValue->Data3);
 
-    uStatus = OpcUa_Int64_BinaryDecode(&nValue, a_pIstrm);
+    uBytesRead = sizeof(a_pValue->Data4);
+    uStatus = a_pfnRead(a_pSource, (OpcUa_Byte*)a_pValue->Data4, &uBytesRead);
     OpcUa_GotoErrorIfBad(uStatus);
 
-    a_pValue->dwHighDateTime = (OpcUa_UInt32)(nValue >> 32);
-    a_pValue->dwLowDateTime  = (OpcUa_UInt32)(nValue &  0x00000000FFFFFFFF);
+    if (uBytesRead != sizeof(a_pValue->Data4))
+    {
+        OpcUa_GotoErrorWithStatus(OpcUa_BadExpectedStreamToBlock);
+    }
 
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
-    OpcUa_DateTime_Clear(a_pValue);
+    OpcUa_Guid_Clear(a_pValue);
 
     OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
- * OpcUa_BinaryDecoder_ReadDateTime
+ * OpcUa_BinaryDecoder_DecodeByteString
  *===========================================================================*/
-static
-OpcUa_StatusCode OpcUa_BinaryDecoder_ReadDateTime(
-    struct _OpcUa_Decoder* a_pDecoder,
-    OpcUa_StringA          a_sFieldName,
-    OpcUa_DateTime*        a_pValue)
+static OpcUa_StatusCode OpcUa_BinaryDecoder_DecodeByteString(
+    OpcUa_BinaryDecoder*              a_pHandle,
+    OpcUa_BinaryDecoder_PfnReadBytes* a_pfnRead,
+    OpcUa_Void*                       a_pSource,
+    OpcUa_UInt32                      a_nMaxByteStringLength,
+    OpcUa_ByteString*                 a_pValue)
 {
-    OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
+    OpcUa_Int32 nLength = -1;
+    OpcUa_UInt32 uBytesRead = 0;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_ReadDateTime");
+    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_DecodeByteString");
 
-    OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
-    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
-    OpcUa_ReferenceParameter(a_sFieldName);
-    OpcUa_BinaryDecoder_VerifyState(DateTime);
+    OpcUa_ByteString_Initialize(a_pValue);
+
+    /* decode length */
+    OpcUa_BinaryDecoder_ReadWireValue(Int32, &nLength);
+
+    /* check for null string */
+    if (nLength == -1)
+    {
+        OpcUa_ReturnStatusCode;
+    }
+
+    /* check maximum string length */
+    if (a_nMaxByteStringLength > 0 && (OpcUa_UInt32)nLength > a_nMaxByteStringLength)
+    {
+        OpcUa_GotoErrorWithStatus(OpcUa_BadEncodingLimitsExceeded);
+    }
+
+    /* allocate bytes for string */
+    a_pValue->Data = (OpcUa_Byte*)OpcUa_Alloc(nLength);
 
-    uStatus = OpcUa_DateTime_BinaryDecode(a_pValue, pHandle->Istrm);
+    OpcUa_GotoErrorIfAllocFailed(a_pValue->Data);
+    a_pValue->Length = nLength;
+
+    /* read bytes of string */
+    uBytesRead = nLength;
+    uStatus = a_pfnRead(a_pSource, a_pValue->Data, &uBytesRead);
     OpcUa_GotoErrorIfBad(uStatus);
 
+    if (uBytesRead != (OpcUa_UInt32)nLength)
+    {
+        OpcUa_GotoErrorWithStatus(OpcUa_BadExpectedStreamToBlock);
+    }
+
     OpcUa_ReturnStatusCode;
     OpcUa_BeginErrorHandling;
 
-    /* nothing to do */
+    OpcUa_ByteString_Clear(a_pValue);
 
     OpcUa_FinishErrorHandling;
 }
 
 /*============================================================================
- * OpcUa_Guid_BinaryDecode
+ * OpcUa_String_BinaryDecode
  *===========================================================================*/
-OpcUa_StatusCode OpcUa_Guid_BinaryDecode(
-    OpcUa_Guid*        a_pValue,
+OpcUa_StatusCode OpcUa_String_BinaryDecode(
+    OpcUa_String*      a_pValue,
+    OpcUa_UInt32       a_nMaxStringLength,
     OpcUa_InputStream* a_pIstrm)
 {
-    OpcUa_UInt32 uBytesRead = 0;
-
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_Guid_BinaryDecode");
-
     OpcUa_ReturnErrorIfArgumentNull(a_pValue);
     OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
 
-    OpcUa_Guid_Initialize(a_pValue);
+    return OpcUa_BinaryDecoder_DecodeString(OpcUa_Null, OpcUa_BinaryDecoder_ReadStreamBytes, a_pIstrm, a_nMaxStringLength, a_pValue);
+}
 
-    uStatus = OpcUa_UInt32_BinaryDecode(&a_pValue->Data1, a_pIstrm);
-    OpcUa_GotoErrorIfBad(uStatus);
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadString
+ *===========================================================================*/
+static
+OpcUa_StatusCode OpcUa_BinaryDecoder_ReadString(
+    struct _OpcUa_Decoder* a_pDecoder,
+    OpcUa_StringA          a_sFieldName,
+    OpcUa_String*          a_pValue)
+{
+    OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
 
-    uStatus = OpcUa_UInt16_BinaryDecode(&a_pValue->Data2, a_pIstrm);
-    OpcUa_GotoErrorIfBad(uStatus);
+    OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
+    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+    OpcUa_ReferenceParameter(a_sFieldName);
+    OpcUa_BinaryDecoder_VerifyState(String);
 
-    uStatus = OpcUa_UInt16_BinaryDecode(&a_pValue->Data3, a_pIstrm);
-    OpcUa_GotoErrorIfBad(uStatus);
+    return OpcUa_BinaryDecoder_DecodeString(pHandle, OpcUa_BinaryDecoder_ReadWindowBytes, pHandle, pHandle->Context->MaxStringLength, a_pValue);
+}
 
-    uBytesRead = sizeof(a_pValue->Data4);
-    uStatus = a_pIstrm->Read(a_pIstrm, (OpcUa_Byte*)a_pValue->Data4, &uBytesRead);
-    OpcUa_GotoErrorIfBad(uStatus);
+/*============================================================================
+ * OpcUa_DateTime_BinaryDecode
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_DateTime_BinaryDecode(
+    OpcUa_DateTime*    a_pValue,
+    OpcUa_InputStream* a_pIstrm)
+{
+    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+    OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
 
-    if (uBytesRead != sizeof(a_pValue->Data4))
-    {
-        OpcUa_GotoErrorWithStatus(OpcUa_BadExpectedStreamToBlock);
-    }
+    return OpcUa_BinaryDecoder_DecodeDateTime(OpcUa_Null, OpcUa_BinaryDecoder_ReadStreamBytes, a_pIstrm, a_pValue);
+}
 
-    OpcUa_ReturnStatusCode;
-    OpcUa_BeginErrorHandling;
+/*============================================================================
+ * OpcUa_BinaryDecoder_ReadDateTime
+ *===========================================================================*/
+static
+OpcUa_StatusCode OpcUa_BinaryDecoder_ReadDateTime(
+    struct _OpcUa_Decoder* a_pDecoder,
+    OpcUa_StringA          a_sFieldName,
+    OpcUa_DateTime*        a_pValue)
+{
+    OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
 
-    OpcUa_Guid_Clear(a_pValue);
+    OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
+    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+    OpcUa_ReferenceParameter(a_sFieldName);
+    OpcUa_BinaryDecoder_VerifyState(DateTime);
 
-    OpcUa_FinishErrorHandling;
+    return OpcUa_BinaryDecoder_DecodeDateTime(pHandle, OpcUa_BinaryDecoder_ReadWindowBytes, pHandle, a_pValue);
+}
+
+/*============================================================================
+ * OpcUa_Guid_BinaryDecode
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Guid_BinaryDecode(
+    OpcUa_Guid*        a_pValue,
+    OpcUa_InputStream* a_pIstrm)
+{
+    OpcUa_ReturnErrorIfArgumentNull(a_pValue);
+    OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
+
+    return OpcUa_BinaryDecoder_DecodeGuid(OpcUa_Null, OpcUa_BinaryDecoder_ReadStreamBytes, a_pIstrm, a_pValue);
 }
 
 /*============================================================================
@@ -900,22 +1144,12 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadGuid(
 {
     OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_ReadGuid");
-
     OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
     OpcUa_ReturnErrorIfArgumentNull(a_pValue);
     OpcUa_ReferenceParameter(a_sFieldName);
     OpcUa_BinaryDecoder_VerifyState(Guid);
 
-    uStatus = OpcUa_Guid_BinaryDecode(a_pValue, pHandle->Istrm);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-    OpcUa_ReturnStatusCode;
-    OpcUa_BeginErrorHandling;
-
-    /* nothing to do */
-
-    OpcUa_FinishErrorHandling;
+    return OpcUa_BinaryDecoder_DecodeGuid(pHandle, OpcUa_BinaryDecoder_ReadWindowBytes, pHandle, a_pValue);
 }
 
 /*============================================================================
@@ -926,54 +1160,10 @@ OpcUa_StatusCode OpcUa_ByteString_BinaryDecode(
     OpcUa_UInt32       a_nMaxByteStringLength,
     OpcUa_InputStream* a_pIstrm)
 {
-    OpcUa_Int32 nLength = -1;
-    OpcUa_UInt32 uBytesRead = 0;
-
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_ByteString_BinaryDecode");
-
     OpcUa_ReturnErrorIfArgumentNull(a_pValue);
     OpcUa_ReturnErrorIfArgumentNull(a_pIstrm);
 
-    OpcUa_ByteString_Initialize(a_pValue);
-
-    /* decode length */
-    uStatus = OpcUa_Int32_BinaryDecode(&nLength,a_pIstrm);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-    /* check for null string */
-    if (nLength == -1)
-    {
-        OpcUa_ReturnStatusCode;
-    }
-
-    /* check maximum string length */
-    if (a_nMaxByteStringLength > 0 && (OpcUa_UInt32)nLength > a_nMaxByteStringLength)
-    {
-        OpcUa_GotoErrorWithStatus(OpcUa_BadEncodingLimitsExceeded);
-    }
-
-    /* allocate bytes for string */
-    a_pValue->Data = (OpcUa_Byte*)OpcUa_Alloc(nLength);
-
-    OpcUa_GotoErrorIfAllocFailed(a_pValue->Data);
-    a_pValue->Length = nLength;
-
-    /* read bytes of string */
-    uBytesRead = nLength;
-    uStatus = a_pIstrm->Read(a_pIstrm, a_pValue->Data, &uBytesRead);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-    if (uBytesRead != (OpcUa_UInt32)nLength)
-    {
-        OpcUa_GotoErrorWithStatus(OpcUa_BadExpectedStreamToBlock);
-    }
-
-    OpcUa_ReturnStatusCode;
-    OpcUa_BeginErrorHandling;
-
-    OpcUa_ByteString_Clear(a_pValue);
-
-    OpcUa_FinishErrorHandling;
+    return OpcUa_BinaryDecoder_DecodeByteString(OpcUa_Null, OpcUa_BinaryDecoder_ReadStreamBytes, a_pIstrm, a_nMaxByteStringLength, a_pValue);
 }
 
 /*============================================================================
@@ -987,22 +1177,12 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadByteString(
 {
     OpcUa_BinaryDecoder* pHandle = OpcUa_Null;
 
-    OpcUa_InitializeStatus(OpcUa_Module_Serializer, "OpcUa_BinaryDecoder_ReadByteString");
-
     OpcUa_ReturnErrorIfArgumentNull(a_pDecoder);
     OpcUa_ReturnErrorIfArgumentNull(a_pValue);
     OpcUa_ReferenceParameter(a_sFieldName);
     OpcUa_BinaryDecoder_VerifyState(ByteString);
 
-    uStatus = OpcUa_ByteString_BinaryDecode(a_pValue, pHandle->Context->MaxByteStringLength, pHandle->Istrm);
-    OpcUa_GotoErrorIfBad(uStatus);
-
-    OpcUa_ReturnStatusCode;
-    OpcUa_BeginErrorHandling;
-
-    /* nothing to do */
-
-    OpcUa_FinishErrorHandling;
+    return OpcUa_BinaryDecoder_DecodeByteString(pHandle, OpcUa_BinaryDecoder_ReadWindowBytes, pHandle, pHandle->Context->MaxByteStringLength, a_pValue);
 }
 
 /*============================================================================
@@ -1253,7 +1433,7 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadStatusCode(
     OpcUa_ReferenceParameter(a_sFieldName);
     OpcUa_BinaryDecoder_VerifyState(StatusCode);
 
-    uStatus = OpcUa_UInt32_BinaryDecode(a_pValue, pHandle->Istrm);
+    uStatus = OpcUa_BinaryDecoder_ReadUInt32(a_pDecoder, OpcUa_Null, a_pValue);
     OpcUa_GotoErrorIfBad(uStatus);
 
     OpcUa_ReturnStatusCode;
@@ -1581,6 +1761,9 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadExtensionObject(
         OpcUa_GotoErrorIfBad(uStatus);
 
         /* get the start position */
+        uStatus = OpcUa_BinaryDecoder_SyncStream(pHandle);
+        OpcUa_GotoErrorIfBad(uStatus);
+
         uStatus = pHandle->Istrm->GetPosition((OpcUa_Stream*)pHandle->Istrm, &uBodyStart);
         OpcUa_GotoErrorIfBad(uStatus);
 
@@ -1594,6 +1777,9 @@ OpcUa_StatusCode OpcUa_BinaryDecoder_ReadExtensionObject(
         OpcUa_GotoErrorIfBad(uStatus);
 
         /* get the end position */
+        uStatus = OpcUa_BinaryDecoder_SyncStream(pHandle);
+        OpcUa_GotoErrorIfBad(uStatus);
+
         uStatus = pHandle->Istrm->GetPosition((OpcUa_Stream*)pHandle->Istrm, &uBodyEnd);
         OpcUa_GotoErrorIfBad(uStatus);
 
@@ -46,6 +46,22 @@ OpcUa_StatusCode OpcUa_Stream_Read(
     return istrm->Read(istrm, buffer, count);
 }
 
+/*============================================================================
+ * OpcUa_Stream_GetReadWindow
+ *===========================================================================*/
+OpcUa_StatusCode OpcUa_Stream_GetReadWindow(
+    OpcUa_InputStream*             istrm,
+    OpcUa_UInt32                   consumed,
+    OpcUa_Byte**                   data,
+    OpcUa_UInt32*                  count)
+{
+    OpcUa_DeclareErrorTraceModule(OpcUa_Module_Stream);
+    OpcUa_ReturnErrorIfArgumentNull(istrm);
+    OpcUa_ReturnErrorIfArgumentNull(istrm->GetReadWindow);
+
+    return istrm->GetReadWindow(istrm, consumed, data, count);
+}
+
 /*============================================================================
  * OpcUa_Stream_Write
  *===========================================================================*/
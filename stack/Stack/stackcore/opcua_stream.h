@@ -79,6 +79,34 @@ typedef OpcUa_StatusCode (OpcUa_Stream_PfnRead)(
     OpcUa_Byte*                    buffer,
     OpcUa_UInt32*                  count);
 
+/**
+  @brief Consumes data read in place and returns the unread data of the current buffer.
+
+  Lets a reader decode directly from the stream's buffer instead of copying each
+  value out with Read. The first 'consumed' bytes of the previously returned window
+  are skipped, then the remaining bytes of the buffer the stream currently reads from
+  are returned without being consumed. Data beyond the current buffer (i.e. in the
+  next chunk) is only reachable through Read.
+
+  Streams that do not keep their data in a buffer leave this function null.
+
+  @param istrm    [in]  The stream.
+  @param consumed [in]  The number of bytes of the last window that have been used.
+  @param data     [out] The first unread byte in the current buffer.
+  @param count    [out] The number of unread bytes in the current buffer.
+*/
+OPCUA_EXPORT OpcUa_StatusCode OpcUa_Stream_GetReadWindow(
+    OpcUa_InputStream*             istrm,
+    OpcUa_UInt32                   consumed,
+    OpcUa_Byte**                   data,
+    OpcUa_UInt32*                  count);
+
+typedef OpcUa_StatusCode (OpcUa_Stream_PfnGetReadWindow)(
+    OpcUa_InputStream*             istrm,
+    OpcUa_UInt32                   consumed,
+    OpcUa_Byte**                   data,
+    OpcUa_UInt32*                  count);
+
 /**
   @brief Writes data to the stream.
 
@@ -270,6 +298,9 @@ typedef struct _OpcUa_Stream
     /*! @brief Reads data from the stream. */
     OpcUa_Stream_PfnRead* Read;
 
+    /*! @brief Exposes the unread data of the current buffer (optional). */
+    OpcUa_Stream_PfnGetReadWindow* GetReadWindow;
+
     /************************************************************/
 
     /*! @brief Only if the type of stream OpcUa_StreamType_Output. */
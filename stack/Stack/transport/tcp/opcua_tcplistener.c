@@ -154,6 +154,8 @@ struct _OpcUa_TcpListener
     OpcUa_Void*                 CallbackData;
     /** @brief The default message chunk size for communicating with this listener. */
     OpcUa_UInt32                DefaultChunkSize;
+    /** @brief The maximum number of concurrent client connections of this listener. */
+    OpcUa_UInt32                MaxConnections;
     /** @brief This list contains all pending requests, which are not fully received
      *  yet. Once a request is completely received, it gets dispatched to the
      *  upper layer. */
@@ -229,6 +231,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "Create");
     /* initialize listener pTcpListener */
     pTcpListener->SanityCheck = OpcUa_TcpListener_SanityCheck;
     pTcpListener->DefaultChunkSize = OpcUa_ProxyStub_g_Configuration.iTcpListener_DefaultChunkSize;
+    pTcpListener->MaxConnections = (OpcUa_UInt32)OpcUa_ProxyStub_g_Configuration.iTcpListener_MaxConnections;
 
     uStatus = OPCUA_P_MUTEX_CREATE(&(pTcpListener->Mutex));
     OpcUa_GotoErrorIfBad(uStatus);
@@ -1110,7 +1113,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "ProcessHelloMessage");
     OpcUa_TcpListener_ConnectionManager_GetConnectionCount(pTcpListener->ConnectionManager,
                                                            &uConnections);
 
-    if(uConnections >= OPCUA_TCPLISTENER_MAXCONNECTIONS)
+    if(uConnections >= pTcpListener->MaxConnections)
     {
         uStatus = OpcUa_TcpListener_CloseConnection(a_pListener,
                                                     pConnection,
@@ -1967,7 +1970,7 @@ OpcUa_InitializeStatus(OpcUa_Module_TcpListener, "Open");
     }
 
     uStatus = OPCUA_P_SOCKETMANAGER_CREATE( &(pTcpListener->SocketManager),
-                                            OPCUA_TCPLISTENER_MAXCONNECTIONS + 1, /* add one for listen socket */
+                                            pTcpListener->MaxConnections + 1, /* add one for listen socket */
                                             uSocketManagerFlags);
     OpcUa_GotoErrorIfBad(uStatus);
 
@@ -0,0 +1,261 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* Measures the binary decoding of discovery service requests: the message
+ * bodies in tools/messages are decoded from a memory stream with the binary
+ * decoder, as the server stub does for a received request.
+ *
+ * usage: decode_bench [iterations] [message directory]
+ *
+ * Each body is also re-encoded and compared with the input, and truncated
+ * copies of it must be rejected by the decoder.
+ *
+ * The bodies start with the type id of the request:
+ *   findservers.bin      FindServers with 2 locales and 20 server uris
+ *   getendpoints.bin     GetEndpoints with 1 locale and 1 profile uri
+ *   registerserver2.bin  RegisterServer2 with 16 discovery urls and an
+ *                        mDNS discovery configuration
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/* uastack includes */
+#include <opcua_serverstub.h>
+#include <opcua_core.h>
+#include <opcua_memorystream.h>
+#include <opcua_binaryencoder.h>
+#include <opcua_encoder.h>
+#include <opcua_decoder.h>
+
+#ifndef DECODE_BENCH_MESSAGES
+#define DECODE_BENCH_MESSAGES "messages"
+#endif
+
+#define BENCH_MAX_MESSAGE 65536
+
+extern OpcUa_EncodeableTypeTable OpcUa_ProxyStub_g_EncodeableTypes;
+extern OpcUa_StringTable OpcUa_ProxyStub_g_NamespaceUris;
+
+static const char *g_szMessages[] =
+{
+    "findservers.bin",
+    "getendpoints.bin",
+    "registerserver2.bin"
+};
+
+static OpcUa_Decoder *g_pDecoder = OpcUa_Null;
+static OpcUa_Encoder *g_pEncoder = OpcUa_Null;
+static OpcUa_Byte g_message[BENCH_MAX_MESSAGE];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void init_context(OpcUa_MessageContext *pContext)
+{
+    OpcUa_MessageContext_Initialize(pContext);
+    pContext->KnownTypes = &OpcUa_ProxyStub_g_EncodeableTypes;
+    pContext->NamespaceUris = &OpcUa_ProxyStub_g_NamespaceUris;
+}
+
+/* Decodes one message; on success the whole input must have been consumed. */
+static OpcUa_StatusCode decode(OpcUa_Byte *pData, OpcUa_UInt32 length, OpcUa_EncodeableType **ppType, OpcUa_Void **ppMessage)
+{
+    OpcUa_InputStream *pIstrm = OpcUa_Null;
+    OpcUa_Handle hDecodeContext = OpcUa_Null;
+    OpcUa_MessageContext context;
+    OpcUa_UInt32 position = 0;
+    OpcUa_StatusCode uStatus;
+
+    *ppType = OpcUa_Null;
+    *ppMessage = OpcUa_Null;
+
+    uStatus = OpcUa_MemoryStream_CreateReadable(pData, length, &pIstrm);
+    if (OpcUa_IsBad(uStatus))
+    {
+        return uStatus;
+    }
+
+    init_context(&context);
+    uStatus = g_pDecoder->Open(g_pDecoder, pIstrm, &context, &hDecodeContext);
+    if (OpcUa_IsGood(uStatus))
+    {
+        uStatus = g_pDecoder->ReadMessage((OpcUa_Decoder*)hDecodeContext, ppType, ppMessage);
+        OpcUa_Decoder_Close(g_pDecoder, &hDecodeContext);
+    }
+
+    pIstrm->GetPosition((OpcUa_Stream*)pIstrm, &position);
+    if (OpcUa_IsGood(uStatus) && position != length)
+    {
+        fprintf(stderr, "decoded %u of %u bytes\n", position, length);
+        uStatus = OpcUa_BadDecodingError;
+    }
+
+    OpcUa_Stream_Close((OpcUa_Stream*)pIstrm);
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pIstrm);
+    OpcUa_MessageContext_Clear(&context);
+    return uStatus;
+}
+
+/* Re-encodes a decoded message and compares it with the input. */
+static int check_roundtrip(OpcUa_EncodeableType *pType, OpcUa_Void *pMessage, OpcUa_Byte *pData, OpcUa_UInt32 length)
+{
+    OpcUa_OutputStream *pOstrm = OpcUa_Null;
+    OpcUa_Handle hEncodeContext = OpcUa_Null;
+    OpcUa_MessageContext context;
+    OpcUa_Byte *pBuffer = OpcUa_Null;
+    OpcUa_UInt32 bufferLength = 0;
+    OpcUa_UInt32 position = 0;
+    int same = 0;
+
+    if (OpcUa_IsBad(OpcUa_MemoryStream_CreateWriteable(4096, 0, &pOstrm)))
+    {
+        return 0;
+    }
+
+    init_context(&context);
+    if (OpcUa_IsGood(g_pEncoder->Open(g_pEncoder, pOstrm, &context, &hEncodeContext)))
+    {
+        OpcUa_StatusCode uStatus = g_pEncoder->WriteMessage((OpcUa_Encoder*)hEncodeContext, pMessage, pType);
+        OpcUa_Encoder_Close(g_pEncoder, &hEncodeContext);
+
+        if (OpcUa_IsGood(uStatus))
+        {
+            pOstrm->GetPosition((OpcUa_Stream*)pOstrm, &position);
+            OpcUa_Stream_Close((OpcUa_Stream*)pOstrm);
+            OpcUa_MemoryStream_GetBuffer(pOstrm, &pBuffer, &bufferLength);
+            same = position == length && memcmp(pBuffer, pData, length) == 0;
+        }
+    }
+
+    OpcUa_Stream_Delete((OpcUa_Stream**)&pOstrm);
+    OpcUa_MessageContext_Clear(&context);
+    return same;
+}
+
+static int bench_message(const char *szDirectory, const char *szName, int iterations)
+{
+    char szPath[1024];
+    OpcUa_EncodeableType *pType = OpcUa_Null;
+    OpcUa_Void *pMessage = OpcUa_Null;
+    OpcUa_UInt32 length;
+    OpcUa_UInt32 cut;
+    int same;
+    int truncatedAccepted = 0;
+    double start;
+    int i;
+    FILE *pFile;
+
+    snprintf(szPath, sizeof(szPath), "%s/%s", szDirectory, szName);
+    pFile = fopen(szPath, "rb");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", szPath);
+        return 1;
+    }
+    length = (OpcUa_UInt32)fread(g_message, 1, sizeof(g_message), pFile);
+    fclose(pFile);
+
+    if (OpcUa_IsBad(decode(g_message, length, &pType, &pMessage)))
+    {
+        fprintf(stderr, "%s: decoding failed\n", szName);
+        return 1;
+    }
+    same = check_roundtrip(pType, pMessage, g_message, length);
+    OpcUa_EncodeableObject_Delete(pType, &pMessage);
+
+    for (cut = 0; cut < length; cut += length / 97 + 1)
+    {
+        if (OpcUa_IsGood(decode(g_message, cut, &pType, &pMessage)))
+        {
+            truncatedAccepted++;
+            OpcUa_EncodeableObject_Delete(pType, &pMessage);
+        }
+    }
+
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+        decode(g_message, length, &pType, &pMessage);
+        OpcUa_EncodeableObject_Delete(pType, &pMessage);
+    }
+
+    printf("%-20s %5u B: %.3f us/decode, roundtrip %s, truncated %s\n",
+           szName, length, (now() - start) / iterations * 1e6,
+           same ? "identical" : "DIFFERENT", truncatedAccepted ? "ACCEPTED" : "rejected");
+
+    return (same ? 0 : 1) + (truncatedAccepted ? 1 : 0);
+}
+
+int main(int argc, char **argv)
+{
+    OpcUa_Handle hPlatformLayer = OpcUa_Null;
+    OpcUa_ProxyStubConfiguration stackConfig;
+    int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+    const char *szDirectory = argc > 2 ? argv[2] : DECODE_BENCH_MESSAGES;
+    int errors = 0;
+    size_t i;
+
+    if (iterations < 1)
+    {
+        fprintf(stderr, "usage: %s [iterations] [message directory]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&stackConfig, 0xff, sizeof(stackConfig));
+    stackConfig.bProxyStub_Trace_Enabled = OpcUa_False;
+    stackConfig.uProxyStub_Trace_Level = 0;
+    if (OpcUa_IsBad(OpcUa_P_Initialize(&hPlatformLayer)) ||
+        OpcUa_IsBad(OpcUa_ProxyStub_Initialize(hPlatformLayer, &stackConfig)) ||
+        OpcUa_IsBad(OpcUa_BinaryDecoder_Create(&g_pDecoder)) ||
+        OpcUa_IsBad(OpcUa_BinaryEncoder_Create(&g_pEncoder)))
+    {
+        fprintf(stderr, "stack initialization failed\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < sizeof(g_szMessages) / sizeof(g_szMessages[0]); i++)
+    {
+        errors += bench_message(szDirectory, g_szMessages[i], iterations);
+    }
+
+    printf("errors: %d\n", errors);
+
+    OpcUa_Decoder_Delete(&g_pDecoder);
+    OpcUa_Encoder_Delete(&g_pEncoder);
+    OpcUa_ProxyStub_Clear();
+    OpcUa_P_Clean(&hPlatformLayer);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
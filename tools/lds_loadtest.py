@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+# Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+#
+# OPC Foundation MIT License 1.00
+# The complete license agreement can be found here:
+# http://opcfoundation.org/License/MIT/1.00/
+#
+# Concurrent discovery client load test for the LDS.
+#
+# Opens N opc.tcp connections with SecurityPolicy None at the same time, keeps all
+# of them open while every client issues one FindServers request, then closes them.
+# This checks that the server accepts the configured MaxConnections and that all
+# sockets are released again afterwards.
+#
+# Example (server configured with MaxConnections = 5000, open file limit raised):
+#   ulimit -n 20000
+#   opcualds -d -c /etc/ualds.conf &
+#   tools/lds_loadtest.py --clients 5000 --pid $!
+
+import argparse
+import os
+import socket
+import struct
+import sys
+import threading
+import time
+
+POLICY_NONE = b"http://opcfoundation.org/UA/SecurityPolicy#None"
+
+ID_OPENSECURECHANNELREQUEST = 446
+ID_CLOSESECURECHANNELREQUEST = 452
+ID_FINDSERVERSREQUEST = 422
+
+
+def encode_string(value):
+    if value is None:
+        return struct.pack("<i", -1)
+    return struct.pack("<i", len(value)) + value
+
+
+def encode_nodeid(identifier):
+    # four byte node id encoding, namespace 0
+    return b"\x01\x00" + struct.pack("<H", identifier)
+
+
+def encode_requestheader(handle):
+    # null auth token, timestamp, handle, diagnostics, audit id, timeout, no additional header
+    return (b"\x00\x00" + struct.pack("<qII", 0, handle, 0) + encode_string(None) +
+            struct.pack("<I", 10000) + b"\x00\x00\x00")
+
+
+def recv_exact(sock, count):
+    data = b""
+    while len(data) < count:
+        chunk = sock.recv(count - len(data))
+        if not chunk:
+            raise IOError("connection closed by server")
+        data += chunk
+    return data
+
+
+def recv_message(sock):
+    header = recv_exact(sock, 8)
+    return header[:4], recv_exact(sock, struct.unpack("<I", header[4:])[0] - 8)
+
+
+class Reader:
+    def __init__(self, data, offset=0):
+        self.data = data
+        self.offset = offset
+
+    def read(self, fmt):
+        value = struct.unpack_from("<" + fmt, self.data, self.offset)[0]
+        self.offset += struct.calcsize("<" + fmt)
+        return value
+
+    def skip_bytestring(self):
+        length = self.read("i")
+        if length > 0:
+            self.offset += length
+
+    def skip_nodeid(self):
+        encoding = self.read("B")
+        if encoding == 0:
+            self.offset += 1
+        elif encoding == 1:
+            self.offset += 3
+        else:
+            raise ValueError("unexpected node id encoding %d" % encoding)
+
+    def read_responseheader(self):
+        self.read("q")
+        self.read("I")
+        result = self.read("I")
+        if self.read("B") != 0:
+            raise ValueError("unexpected diagnostic info")
+        for _ in range(max(self.read("i"), 0)):
+            self.skip_bytestring()
+        self.skip_nodeid()
+        if self.read("B") != 0:
+            raise ValueError("unexpected additional header")
+        return result
+
+
+class Client:
+    """Minimal opc.tcp client, SecurityPolicy None only."""
+
+    def __init__(self, host, port, url):
+        self.sock = socket.create_connection((host, port))
+        self.url = url.encode()
+        self.sequence = 1
+        self.request = 1
+
+        body = struct.pack("<IIIII", 0, 65536, 65536, 0, 0) + encode_string(self.url)
+        self._send(b"HELF", body)
+        kind, _ = recv_message(self.sock)
+        if kind != b"ACKF":
+            raise IOError("Hello rejected: %r" % kind)
+
+        body = (struct.pack("<I", 0) + encode_string(POLICY_NONE) + encode_string(None) +
+                encode_string(None) + struct.pack("<II", self.sequence, self.request) +
+                encode_nodeid(ID_OPENSECURECHANNELREQUEST) + encode_requestheader(1) +
+                struct.pack("<III", 0, 0, 1) + encode_string(b"") + struct.pack("<I", 600000))
+        self._send(b"OPNF", body)
+        kind, data = recv_message(self.sock)
+        if kind != b"OPNF":
+            raise IOError("OpenSecureChannel rejected: %r" % kind)
+        reader = Reader(data)
+        self.channel = reader.read("I")
+        reader.skip_bytestring()
+        reader.skip_bytestring()
+        reader.skip_bytestring()
+        reader.read("I")
+        reader.read("I")
+        reader.skip_nodeid()
+        if reader.read_responseheader() != 0:
+            raise IOError("OpenSecureChannel failed")
+        reader.read("I")
+        reader.read("I")
+        self.token = reader.read("I")
+
+    def _send(self, kind, body):
+        self.sock.sendall(kind + struct.pack("<I", 8 + len(body)) + body)
+
+    def _next_header(self, type_id):
+        self.sequence += 1
+        self.request += 1
+        return (struct.pack("<IIII", self.channel, self.token, self.sequence, self.request) +
+                encode_nodeid(type_id) + encode_requestheader(self.request))
+
+    def find_servers(self):
+        body = self._next_header(ID_FINDSERVERSREQUEST)
+        body += encode_string(self.url) + encode_string(None) + encode_string(None)
+        self._send(b"MSGF", body)
+        kind, data = recv_message(self.sock)
+        if kind != b"MSGF":
+            raise IOError("FindServers rejected: %r" % kind)
+        reader = Reader(data, 16)
+        reader.skip_nodeid()
+        result = reader.read_responseheader()
+        return result, reader.read("i")
+
+    def close(self):
+        self._send(b"CLOF", self._next_header(ID_CLOSESECURECHANNELREQUEST))
+        self.sock.close()
+
+
+def count_fds(pid):
+    if not pid:
+        return -1
+    return len(os.listdir("/proc/%d/fd" % pid))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="concurrent discovery client load test")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=4840)
+    parser.add_argument("--clients", type=int, default=5000)
+    parser.add_argument("--pid", type=int, default=0, help="server pid, to report its open file descriptors")
+    args = parser.parse_args()
+
+    url = "opc.tcp://%s:%d" % (args.host, args.port)
+    threading.stack_size(256 * 1024)
+    opened = threading.Barrier(args.clients + 1)
+    served = threading.Barrier(args.clients + 1)
+    results = []
+    errors = []
+
+    def run():
+        client = None
+        try:
+            client = Client(args.host, args.port, url)
+        except Exception as e:
+            errors.append(repr(e))
+        opened.wait()
+        try:
+            if client:
+                results.append(client.find_servers())
+        except Exception as e:
+            errors.append(repr(e))
+            client = None
+        served.wait()
+        if client:
+            client.close()
+
+    start = time.time()
+    threads = [threading.Thread(target=run) for _ in range(args.clients)]
+    for thread in threads:
+        thread.start()
+    opened.wait()
+    connected = time.time()
+    fds_open = count_fds(args.pid)
+    served.wait()
+    done = time.time()
+    for thread in threads:
+        thread.join()
+    time.sleep(1.5)
+    fds_after = count_fds(args.pid)
+
+    print("clients:            %d" % args.clients)
+    print("connect time:       %.2f s" % (connected - start))
+    print("FindServers time:   %.2f s" % (done - connected))
+    print("FindServers ok:     %d %s" % (len(results), sorted(set(results))))
+    print("errors:             %d %s" % (len(errors), sorted(set(errors)) if errors else ""))
+    if args.pid:
+        print("server fds open:    %d" % fds_open)
+        print("server fds after:   %d" % fds_after)
+    return 1 if errors or len(results) != args.clients else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,308 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* Measures the PKI work done for every OpenSecureChannel of the LDS:
+ * open the certificate store, validate the client certificate, close the store.
+ *
+ * usage: pki_bench <workdir> [certificates] [iterations] [threads]
+ *
+ * A trust list of self-signed RSA-2048 certificates is written to <workdir>/trusted
+ * and the store is opened with the flags the LDS uses. The tool also checks that a
+ * certificate added to or removed from the trust list is seen by the next validation.
+ *
+ * This is not an end-to-end OpenSecureChannel latency test: the stack in this tree
+ * only contains the server side, so there is no client to open secured channels with.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+/* openssl includes */
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+/* uastack includes */
+#include <opcua_serverstub.h>
+#include <opcua_core.h>
+#include <opcua_p_pki.h>
+#include <opcua_p_pkifactory.h>
+
+static OpcUa_P_OpenSSL_CertificateStore_Config g_PKIConfig;
+static char             g_szTrustListPath[PATH_MAX];
+static char             g_szCRLPath[PATH_MAX];
+static char             g_szRejectedPath[PATH_MAX];
+static OpcUa_ByteString g_Certificate;
+static int              g_iterationsPerThread = 0;
+static int              g_failures = 0;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static EVP_PKEY* create_key(void)
+{
+    EVP_PKEY_CTX *pCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+    EVP_PKEY *pKey = NULL;
+
+    if (pCtx == NULL) return NULL;
+    if (EVP_PKEY_keygen_init(pCtx) <= 0 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(pCtx, 2048) <= 0 ||
+        EVP_PKEY_keygen(pCtx, &pKey) <= 0)
+    {
+        pKey = NULL;
+    }
+    EVP_PKEY_CTX_free(pCtx);
+    return pKey;
+}
+
+/* Writes a self-signed certificate for the given name as DER file and optionally returns its encoding. */
+static int create_certificate(EVP_PKEY *pKey, int serial, const char *szFile, OpcUa_ByteString *pEncoded)
+{
+    X509 *pCert = X509_new();
+    X509_NAME *pName = NULL;
+    unsigned char *pData = NULL;
+    char szCommonName[64];
+    FILE *pFile = NULL;
+    int len = -1;
+
+    if (pCert == NULL) return -1;
+
+    snprintf(szCommonName, sizeof(szCommonName), "pki_bench %d", serial);
+    X509_set_version(pCert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(pCert), serial);
+    X509_gmtime_adj(X509_getm_notBefore(pCert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(pCert), 3600L * 24 * 365);
+    pName = X509_get_subject_name(pCert);
+    X509_NAME_add_entry_by_txt(pName, "O", MBSTRING_ASC, (const unsigned char*)"OPC Foundation", -1, -1, 0);
+    X509_NAME_add_entry_by_txt(pName, "CN", MBSTRING_ASC, (const unsigned char*)szCommonName, -1, -1, 0);
+    X509_set_issuer_name(pCert, pName);
+    X509_set_pubkey(pCert, pKey);
+
+    if (X509_sign(pCert, pKey, EVP_sha256()) > 0)
+    {
+        len = i2d_X509(pCert, &pData);
+    }
+    X509_free(pCert);
+    if (len <= 0) return -1;
+
+    pFile = fopen(szFile, "wb");
+    if (pFile == NULL || fwrite(pData, 1, len, pFile) != (size_t)len)
+    {
+        if (pFile) fclose(pFile);
+        OPENSSL_free(pData);
+        return -1;
+    }
+    fclose(pFile);
+
+    if (pEncoded)
+    {
+        pEncoded->Data = malloc(len);
+        if (pEncoded->Data == NULL)
+        {
+            OPENSSL_free(pData);
+            return -1;
+        }
+        memcpy(pEncoded->Data, pData, len);
+        pEncoded->Length = len;
+    }
+    OPENSSL_free(pData);
+    return 0;
+}
+
+/* The PKI calls of one OpenSecureChannel. */
+static OpcUa_StatusCode validate_once(OpcUa_ByteString *pCertificate)
+{
+    OpcUa_PKIProvider pkiProvider;
+    OpcUa_Void *pCertificateStore = OpcUa_Null;
+    OpcUa_Int validationCode = 0;
+    OpcUa_StatusCode uStatus;
+
+    uStatus = OpcUa_P_PKIFactory_CreatePKIProvider(&g_PKIConfig, &pkiProvider);
+    if (OpcUa_IsBad(uStatus)) return uStatus;
+
+    uStatus = pkiProvider.OpenCertificateStore(&pkiProvider, &pCertificateStore);
+    if (OpcUa_IsGood(uStatus))
+    {
+        uStatus = pkiProvider.ValidateCertificate(&pkiProvider, pCertificate, pCertificateStore, &validationCode);
+        pkiProvider.CloseCertificateStore(&pkiProvider, &pCertificateStore);
+    }
+
+    OpcUa_P_PKIFactory_DeletePKIProvider(&pkiProvider);
+    return uStatus;
+}
+
+static void* bench_thread(void *pArg)
+{
+    int i;
+    (void)pArg;
+
+    for (i = 0; i < g_iterationsPerThread; i++)
+    {
+        if (OpcUa_IsBad(validate_once(&g_Certificate)))
+        {
+            __atomic_add_fetch(&g_failures, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    OpcUa_Handle hPlatformLayer = OpcUa_Null;
+    OpcUa_ProxyStubConfiguration stackConfig;
+    OpcUa_ByteString lateCertificate = { 0, NULL };
+    OpcUa_StatusCode uStatus;
+    EVP_PKEY *pKey = NULL;
+    pthread_t threads[64];
+    char szFile[PATH_MAX + 32];
+    int numCertificates = argc > 2 ? atoi(argv[2]) : 300;
+    int numIterations = argc > 3 ? atoi(argv[3]) : 200;
+    int numThreads = argc > 4 ? atoi(argv[4]) : 4;
+    int i, ret = EXIT_SUCCESS;
+    double start, elapsed;
+
+    if (argc < 2 || numCertificates < 1 || numIterations < 1 || numThreads < 0 || numThreads > 64)
+    {
+        fprintf(stderr, "usage: %s <workdir> [certificates] [iterations] [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    snprintf(g_szTrustListPath, sizeof(g_szTrustListPath), "%s/trusted", argv[1]);
+    snprintf(g_szCRLPath, sizeof(g_szCRLPath), "%s/crl", argv[1]);
+    snprintf(g_szRejectedPath, sizeof(g_szRejectedPath), "%s/rejected", argv[1]);
+    if ((mkdir(argv[1], 0700) != 0 && errno != EEXIST) ||
+        (mkdir(g_szTrustListPath, 0700) != 0 && errno != EEXIST) ||
+        (mkdir(g_szCRLPath, 0700) != 0 && errno != EEXIST) ||
+        (mkdir(g_szRejectedPath, 0700) != 0 && errno != EEXIST))
+    {
+        fprintf(stderr, "cannot create the directories in %s: %s\n", argv[1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    /* one key for all certificates keeps the setup fast; the store parses each certificate anyway */
+    pKey = create_key();
+    if (pKey == NULL)
+    {
+        fprintf(stderr, "key generation failed\n");
+        return EXIT_FAILURE;
+    }
+    for (i = 1; i <= numCertificates; i++)
+    {
+        snprintf(szFile, sizeof(szFile), "%s/c%d.der", g_szTrustListPath, i);
+        if (create_certificate(pKey, i, szFile, i == (numCertificates + 1) / 2 ? &g_Certificate : NULL) != 0)
+        {
+            fprintf(stderr, "cannot write %s\n", szFile);
+            return EXIT_FAILURE;
+        }
+    }
+    snprintf(szFile, sizeof(szFile), "%s/late.der", argv[1]);
+    if (create_certificate(pKey, numCertificates + 1, szFile, &lateCertificate) != 0)
+    {
+        fprintf(stderr, "cannot write %s\n", szFile);
+        return EXIT_FAILURE;
+    }
+    EVP_PKEY_free(pKey);
+
+    memset(&stackConfig, 0xff, sizeof(stackConfig));
+    stackConfig.bProxyStub_Trace_Enabled = OpcUa_False;
+    stackConfig.uProxyStub_Trace_Level = 0;
+    if (OpcUa_IsBad(OpcUa_P_Initialize(&hPlatformLayer)) ||
+        OpcUa_IsBad(OpcUa_ProxyStub_Initialize(hPlatformLayer, &stackConfig)))
+    {
+        fprintf(stderr, "stack initialization failed\n");
+        return EXIT_FAILURE;
+    }
+
+    /* same configuration as ualds_security_initialize */
+    g_PKIConfig.PkiType = OpcUa_OpenSSL_PKI;
+    g_PKIConfig.CertificateTrustListLocation = g_szTrustListPath;
+    g_PKIConfig.CertificateRevocationListLocation = g_szCRLPath;
+    g_PKIConfig.CertificateUntrustedListLocation = g_szRejectedPath;
+    g_PKIConfig.Flags = OPCUA_P_PKI_OPENSSL_USE_DEFAULT_CERT_CRL_LOOKUP_METHOD;
+
+    uStatus = validate_once(&g_Certificate);
+    if (OpcUa_IsBad(uStatus))
+    {
+        fprintf(stderr, "validation of a trusted certificate failed: 0x%08X\n", uStatus);
+        ret = EXIT_FAILURE;
+        goto cleanup;
+    }
+
+    start = now();
+    for (i = 0; i < numIterations; i++)
+    {
+        if (OpcUa_IsBad(validate_once(&g_Certificate))) g_failures++;
+    }
+    elapsed = now() - start;
+    printf("%d trusted certificates, 1 thread: %.3f ms per open+validate+close\n",
+           numCertificates, elapsed * 1000 / numIterations);
+
+    if (numThreads > 0)
+    {
+        g_iterationsPerThread = (numIterations + numThreads - 1) / numThreads;
+        start = now();
+        for (i = 0; i < numThreads; i++) pthread_create(&threads[i], NULL, bench_thread, NULL);
+        for (i = 0; i < numThreads; i++) pthread_join(threads[i], NULL);
+        elapsed = now() - start;
+        printf("%d trusted certificates, %d threads: %.3f ms per open+validate+close (wall)\n",
+               numCertificates, numThreads, elapsed * 1000 / (g_iterationsPerThread * numThreads));
+    }
+
+    /* trust list changes must be visible to the next validation */
+    snprintf(szFile, sizeof(szFile), "%s/late.der", g_szTrustListPath);
+    unlink(szFile);
+    if (OpcUa_IsGood(validate_once(&lateCertificate))) g_failures++;
+    {
+        FILE *pFile = fopen(szFile, "wb");
+        if (pFile == NULL || fwrite(lateCertificate.Data, 1, lateCertificate.Length, pFile) != (size_t)lateCertificate.Length) g_failures++;
+        if (pFile) fclose(pFile);
+    }
+    if (OpcUa_IsBad(validate_once(&lateCertificate))) g_failures++;
+    unlink(szFile);
+    if (OpcUa_IsGood(validate_once(&lateCertificate))) g_failures++;
+
+    printf("failures: %d\n", g_failures);
+    if (g_failures != 0) ret = EXIT_FAILURE;
+
+cleanup:
+    OpcUa_ProxyStub_Clear();
+    OpcUa_P_Clean(&hPlatformLayer);
+    free(g_Certificate.Data);
+    free(lateCertificate.Data);
+    return ret;
+}
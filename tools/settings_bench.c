@@ -0,0 +1,166 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* Measures the settings key lookup: builds a configuration of about 50k lines
+ * (2500 server sections with 19 keys each) in memory and times reads and
+ * writes of random keys in random sections.
+ *
+ * usage: settings_bench [lookups]
+ *
+ * Every read must return the value written for the key.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/* local includes */
+#include "settings.h"
+
+#define BENCH_NUM_GROUPS 2500
+#define BENCH_NUM_KEYS   19
+
+extern void ualds_settings_clear(void);
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int create_settings(void)
+{
+    char szGroup[64];
+    char szKey[32];
+    char szValue[64];
+    int errors = 0;
+    int i, j;
+
+    for (i = 0; i < BENCH_NUM_GROUPS; i++)
+    {
+        sprintf(szGroup, "urn:host%d:UAServer", i);
+        ualds_settings_begingroup(szGroup);
+        for (j = 0; j < BENCH_NUM_KEYS; j++)
+        {
+            sprintf(szKey, "Key%d", j);
+            sprintf(szValue, "%d.%d", i, j);
+            if (ualds_settings_writestring(szKey, szValue) != 0) errors++;
+        }
+        ualds_settings_addemptyline();
+        ualds_settings_endgroup();
+    }
+
+    return errors;
+}
+
+static int bench_reads(int numLookups)
+{
+    char szGroup[64];
+    char szKey[32];
+    char szValue[256];
+    char szExpected[64];
+    double start, seconds;
+    int errors = 0;
+    int i, j, n;
+
+    start = now();
+    for (n = 0; n < numLookups; n++)
+    {
+        i = rand() % BENCH_NUM_GROUPS;
+        j = rand() % BENCH_NUM_KEYS;
+        sprintf(szGroup, "urn:host%d:UAServer", i);
+        sprintf(szKey, "Key%d", j);
+        sprintf(szExpected, "%d.%d", i, j);
+        ualds_settings_begingroup(szGroup);
+        if (ualds_settings_readstring(szKey, szValue, sizeof(szValue)) != 0 || strcmp(szValue, szExpected) != 0)
+        {
+            fprintf(stderr, "wrong value for [%s] %s\n", szGroup, szKey);
+            errors++;
+        }
+        ualds_settings_endgroup();
+    }
+    seconds = now() - start;
+    printf("settings lookup: %d reads in %.3f s (%.0f reads/s)\n", numLookups, seconds, numLookups / seconds);
+
+    return errors;
+}
+
+static int bench_writes(int numLookups)
+{
+    char szGroup[64];
+    char szKey[32];
+    char szValue[64];
+    double start, seconds;
+    int errors = 0;
+    int i, j, n;
+
+    start = now();
+    for (n = 0; n < numLookups; n++)
+    {
+        i = rand() % BENCH_NUM_GROUPS;
+        j = rand() % BENCH_NUM_KEYS;
+        sprintf(szGroup, "urn:host%d:UAServer", i);
+        sprintf(szKey, "Key%d", j);
+        sprintf(szValue, "%d.%d", i, j);
+        ualds_settings_begingroup(szGroup);
+        if (ualds_settings_writestring(szKey, szValue) != 0) errors++;
+        ualds_settings_endgroup();
+    }
+    seconds = now() - start;
+    printf("settings lookup: %d writes in %.3f s (%.0f writes/s)\n", numLookups, seconds, numLookups / seconds);
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    int numLookups = argc > 1 ? atoi(argv[1]) : 200000;
+    int errors = 0;
+
+    if (numLookups < 1)
+    {
+        fprintf(stderr, "usage: %s [lookups]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    errors += create_settings();
+
+    srand(1);
+    errors += bench_reads(numLookups);
+    errors += bench_writes(numLookups);
+    /* the writes must not have changed any value */
+    errors += bench_reads(numLookups / 10);
+
+    printf("errors: %d\n", errors);
+
+    ualds_settings_clear();
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* Measures the symmetric crypto of secured message chunks: sign+encrypt and
+ * decrypt+verify through the crypto provider, for 64 KB and 1 KB chunks of the
+ * Basic256Sha256 and Aes256_Sha256_RsaPss security policies.
+ *
+ * usage: symcrypto_bench [iterations of 64 KB]
+ *
+ * It also checks the signatures against a one-shot HMAC for more keys than the
+ * HMAC key cache holds, so the cache eviction is covered.
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/* openssl includes */
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+/* uastack includes */
+#include <opcua_serverstub.h>
+#include <opcua_core.h>
+#include <opcua_crypto.h>
+
+#define BENCH_MAX_CHUNK   65536
+#define BENCH_KEY_LENGTH  32
+#define BENCH_NUM_KEYS    200
+
+static const char *g_szPolicies[] =
+{
+    "http://opcfoundation.org/UA/SecurityPolicy#Basic256Sha256",
+    "http://opcfoundation.org/UA/SecurityPolicy#Aes256_Sha256_RsaPss"
+};
+
+static OpcUa_Byte g_plainText[BENCH_MAX_CHUNK];
+static OpcUa_Byte g_cipherText[BENCH_MAX_CHUNK + 64];
+static OpcUa_Byte g_decrypted[BENCH_MAX_CHUNK + 64];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void set_key(OpcUa_Key *pKey, OpcUa_Byte *pData, OpcUa_Int32 length)
+{
+    memset(pKey, 0, sizeof(*pKey));
+    pKey->Type = OpcUa_Crypto_KeyType_Symmetric;
+    pKey->Key.Data = pData;
+    pKey->Key.Length = length;
+}
+
+/* Times sign+encrypt and decrypt+verify of one chunk size; returns the number of errors. */
+static int bench_chunks(OpcUa_CryptoProvider *pProvider, const char *szPolicy, OpcUa_UInt32 size, int iterations)
+{
+    OpcUa_Byte encryptingKey[BENCH_KEY_LENGTH], signingKey[BENCH_KEY_LENGTH], iv[16], signature[64];
+    OpcUa_Key encryptionKey, signatureKey;
+    OpcUa_ByteString mac;
+    OpcUa_UInt32 cipherLength = 0, plainLength = 0;
+    double start, signEncrypt, decryptVerify;
+    int i, errors = 0;
+
+    for (i = 0; i < BENCH_KEY_LENGTH; i++)
+    {
+        encryptingKey[i] = (OpcUa_Byte)(i * 7 + 1);
+        signingKey[i] = (OpcUa_Byte)(i * 13 + 5);
+    }
+    for (i = 0; i < 16; i++) iv[i] = (OpcUa_Byte)i;
+    set_key(&encryptionKey, encryptingKey, BENCH_KEY_LENGTH);
+    set_key(&signatureKey, signingKey, BENCH_KEY_LENGTH);
+    mac.Data = signature;
+
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+        mac.Length = 32;
+        cipherLength = sizeof(g_cipherText);
+        if (OpcUa_IsBad(OpcUa_Crypto_SymmetricSign(pProvider, g_plainText, size, &signatureKey, &mac)) ||
+            OpcUa_IsBad(OpcUa_Crypto_SymmetricEncrypt(pProvider, g_plainText, size, &encryptionKey, iv, g_cipherText, &cipherLength)))
+        {
+            errors++;
+        }
+    }
+    signEncrypt = now() - start;
+
+    start = now();
+    for (i = 0; i < iterations; i++)
+    {
+        mac.Length = 32;
+        plainLength = sizeof(g_decrypted);
+        if (OpcUa_IsBad(OpcUa_Crypto_SymmetricDecrypt(pProvider, g_cipherText, cipherLength, &encryptionKey, iv, g_decrypted, &plainLength)) ||
+            OpcUa_IsBad(OpcUa_Crypto_SymmetricVerify(pProvider, g_decrypted, size, &signatureKey, &mac)))
+        {
+            errors++;
+        }
+    }
+    decryptVerify = now() - start;
+
+    if (plainLength < size || memcmp(g_decrypted, g_plainText, size) != 0) errors++;
+
+    printf("%-22s %6u bytes: sign+encrypt %8.2f us, decrypt+verify %8.2f us\n",
+           strrchr(szPolicy, '#') + 1, size, signEncrypt * 1e6 / iterations, decryptVerify * 1e6 / iterations);
+    return errors;
+}
+
+/* Compares the signatures of many different keys with a one-shot HMAC; returns the number of mismatches. */
+static int check_signatures(OpcUa_CryptoProvider *pProvider)
+{
+    OpcUa_Byte key[BENCH_KEY_LENGTH], signature[32], reference[32], data[100];
+    OpcUa_ByteString mac;
+    OpcUa_Key signatureKey;
+    unsigned int referenceLength = 0;
+    int round, k, errors = 0;
+
+    for (round = 0; round < 3; round++)
+    {
+        for (k = 0; k < BENCH_NUM_KEYS; k++)
+        {
+            memset(key, k, sizeof(key));
+            key[0] = (OpcUa_Byte)round;
+            memset(data, round + k, sizeof(data));
+            set_key(&signatureKey, key, (k % 3) ? BENCH_KEY_LENGTH : 20);
+            mac.Data = signature;
+            mac.Length = sizeof(signature);
+
+            if (OpcUa_IsBad(OpcUa_Crypto_SymmetricSign(pProvider, data, sizeof(data), &signatureKey, &mac)))
+            {
+                errors++;
+                continue;
+            }
+            HMAC(EVP_sha256(), key, signatureKey.Key.Length, data, sizeof(data), reference, &referenceLength);
+            if (mac.Length != (OpcUa_Int32)referenceLength || memcmp(signature, reference, referenceLength) != 0)
+            {
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    OpcUa_Handle hPlatformLayer = OpcUa_Null;
+    OpcUa_ProxyStubConfiguration stackConfig;
+    OpcUa_CryptoProvider provider;
+    int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+    int errors = 0;
+    size_t i;
+
+    if (iterations < 1)
+    {
+        fprintf(stderr, "usage: %s [iterations of 64 KB]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&stackConfig, 0xff, sizeof(stackConfig));
+    stackConfig.bProxyStub_Trace_Enabled = OpcUa_False;
+    stackConfig.uProxyStub_Trace_Level = 0;
+    if (OpcUa_IsBad(OpcUa_P_Initialize(&hPlatformLayer)) ||
+        OpcUa_IsBad(OpcUa_ProxyStub_Initialize(hPlatformLayer, &stackConfig)))
+    {
+        fprintf(stderr, "stack initialization failed\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < sizeof(g_plainText); i++) g_plainText[i] = (OpcUa_Byte)(i * 31);
+
+    for (i = 0; i < sizeof(g_szPolicies) / sizeof(g_szPolicies[0]); i++)
+    {
+        memset(&provider, 0, sizeof(provider));
+        if (OpcUa_IsBad(OpcUa_CryptoProvider_Create((OpcUa_StringA)g_szPolicies[i], &provider)))
+        {
+            fprintf(stderr, "no crypto provider for %s\n", g_szPolicies[i]);
+            errors++;
+            continue;
+        }
+        errors += bench_chunks(&provider, g_szPolicies[i], BENCH_MAX_CHUNK, iterations);
+        errors += bench_chunks(&provider, g_szPolicies[i], 1024, iterations * 50);
+        errors += check_signatures(&provider);
+        OpcUa_CryptoProvider_Delete(&provider);
+    }
+
+    printf("errors: %d\n", errors);
+
+    OpcUa_ProxyStub_Clear();
+    OpcUa_P_Clean(&hPlatformLayer);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+/* ========================================================================
+* Copyright (c) 2005-2026 The OPC Foundation, Inc. All rights reserved.
+*
+* OPC Foundation MIT License 1.00
+*
+* Permission is hereby granted, free of charge, to any person
+* obtaining a copy of this software and associated documentation
+* files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use,
+* copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following
+* conditions:
+*
+* The above copyright notice and this permission notice shall be
+* included in all copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+* OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+* HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*
+* The complete license agreement can be found here:
+* http://opcfoundation.org/License/MIT/1.00/
+* ======================================================================*/
+
+/* Compares isTLD, a binary search over the sorted TLD list, with the former
+ * linear scan over all TLDs: every known TLD in upper and lower case and a few
+ * other domains must give the same result, then both are timed.
+ *
+ * usage: tld_bench [lookups per sample]
+ */
+
+/* system includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+/* local includes */
+#include "utils.h"
+/* local platform includes */
+#include <platform.h>
+
+#define BENCH_MAX_TLDS       2000
+#define BENCH_MAX_TLD_LENGTH 100
+
+/* defined in tlds-alpha-by-domain.h, split in place by loadKnownTLD */
+extern char tld_str[];
+
+/* the former TLD table: every name with a leading dot, compared one by one */
+typedef struct _TLDTable
+{
+    char (*tlds)[BENCH_MAX_TLD_LENGTH];
+    int nrTlds;
+} TLDTable;
+
+static const char *g_szSamples[] =
+{
+    ".com", ".COM", ".org", ".zw", ".local", ".de", ".xn--p1ai",
+    ".lan", ".", "", "com", ".co.uk", ".comm"
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int loadLinearTLD(TLDTable *pTable, const char *szList)
+{
+    char *szCopy = strdup(szList);
+    char *pch;
+
+    pTable->tlds = malloc(BENCH_MAX_TLDS * sizeof(*pTable->tlds));
+    pTable->nrTlds = 0;
+    if (szCopy == NULL || pTable->tlds == NULL)
+    {
+        free(szCopy);
+        return -1;
+    }
+
+    pch = strtok(szCopy, " \n");
+    while (pch != NULL)
+    {
+        if (pTable->nrTlds == BENCH_MAX_TLDS || strlen(pch) + 2 > BENCH_MAX_TLD_LENGTH)
+        {
+            free(szCopy);
+            return -1;
+        }
+        strcpy(pTable->tlds[pTable->nrTlds], ".");
+        strcat(pTable->tlds[pTable->nrTlds], pch);
+        pTable->nrTlds++;
+        pch = strtok(NULL, " \n");
+    }
+
+    free(szCopy);
+    return 0;
+}
+
+static int isLinearTLD(const TLDTable *pTable, const char *domain)
+{
+    int i = 0;
+    for (i = 0; i < pTable->nrTlds; ++i)
+    {
+        if (ualds_platform_strcpy_insensitive(domain, pTable->tlds[i]) == 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int check_known_tlds(const TLDTable *pTable)
+{
+    char szLower[BENCH_MAX_TLD_LENGTH];
+    int errors = 0;
+    int i, j;
+
+    for (i = 0; i < pTable->nrTlds; i++)
+    {
+        if (isTLD(pTable->tlds[i]) != 0)
+        {
+            fprintf(stderr, "isTLD(\"%s\") does not find a known TLD\n", pTable->tlds[i]);
+            errors++;
+        }
+        for (j = 0; pTable->tlds[i][j] != 0; j++)
+        {
+            szLower[j] = (char)tolower((unsigned char)pTable->tlds[i][j]);
+        }
+        szLower[j] = 0;
+        if (isTLD(szLower) != 0)
+        {
+            fprintf(stderr, "isTLD(\"%s\") does not find a known TLD\n", szLower);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    const int numSamples = sizeof(g_szSamples) / sizeof(g_szSamples[0]);
+    int numLookups = argc > 1 ? atoi(argv[1]) : 20000;
+    TLDTable table;
+    double start, linear, indexed;
+    int errors = 0;
+    int i, n;
+
+    if (numLookups < 1)
+    {
+        fprintf(stderr, "usage: %s [lookups per sample]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* copy the list before loadKnownTLD splits it */
+    if (loadLinearTLD(&table, tld_str) != 0)
+    {
+        fprintf(stderr, "cannot load the TLD list\n");
+        free(table.tlds);
+        return EXIT_FAILURE;
+    }
+    loadKnownTLD();
+
+    errors += check_known_tlds(&table);
+
+    for (i = 0; i < numSamples; i++)
+    {
+        if (isTLD(g_szSamples[i]) != isLinearTLD(&table, g_szSamples[i]))
+        {
+            fprintf(stderr, "isTLD(\"%s\") differs from the linear scan\n", g_szSamples[i]);
+            errors++;
+        }
+    }
+
+    for (i = 0; i < numSamples; i++)
+    {
+        start = now();
+        for (n = 0; n < numLookups; n++)
+        {
+            isLinearTLD(&table, g_szSamples[i]);
+        }
+        linear = now() - start;
+
+        start = now();
+        for (n = 0; n < numLookups; n++)
+        {
+            isTLD(g_szSamples[i]);
+        }
+        indexed = now() - start;
+
+        printf("isTLD(\"%s\"): linear %.0f ns, bsearch %.0f ns\n", g_szSamples[i],
+               linear * 1e9 / numLookups, indexed * 1e9 / numLookups);
+    }
+    printf("known TLDs: %d\n", table.nrTlds);
+    printf("errors: %d\n", errors);
+
+    free(table.tlds);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -38,6 +38,7 @@
 #include <opcua_string.h>
 #include <opcua_pkifactory.h>
 #include <opcua_endpoint.h>
+#include <opcua_timer.h>
 
 /* openssl includes */
 #if OPCUA_SUPPORT_PKI
@@ -53,6 +54,9 @@
 #include "service.h"
 #endif /* _WIN32 */
 #include "settings.h"
+#include "registry.h"
+#include "journal.h"
+#include "rejected.h"
 #ifdef HAVE_HDS
 # include "zeroconf.h"
 # include "findserversonnetwork.h"
@@ -60,11 +64,18 @@
 /* local platform includes */
 #include <platform.h>
 #include <log.h>
+#ifndef _WIN32
+# include <tracering.h>
+#endif
 #if OPCUA_SUPPORT_PKI_WIN32
 # include <certstore.h>
 #endif /* OPCUA_SUPPORT_PKI_WIN32 */
 
-static int g_shutdown = 0;
+static volatile int g_shutdown = 0;
+static UALDS_POLLFD *g_pPollFds = 0;
+static int           g_maxPollFds = 0;
+static UALDS_SOCKET  g_wakeupFd;
+static int           g_bWakeup = 0;
 static OpcUa_P_OpenSSL_CertificateStore_Config g_PKIConfig;
 static OpcUa_PKIProvider                       g_PkiProvider;
 static OpcUa_P_OpenSSL_CertificateStore_Config g_LinuxConfig;
@@ -94,10 +105,20 @@ static char             g_szServerUri[UALDS_CONF_MAX_URI_LENGTH];
 static char             g_szProductUri[UALDS_CONF_MAX_URI_LENGTH];
 static char             g_szApplicationName[UALDS_CONF_MAX_URI_LENGTH];
 static char             g_szHostname[256];
+static OpcUa_Mutex      g_hHostnameMutex = OpcUa_Null;
+static OpcUa_Timer      g_hHostnameTimer = OpcUa_Null;
+static char           **g_pszDiscoveryUrls = 0;
+static int              g_numDiscoveryUrls = 0;
 static int              g_ExpirationMaxAge = 600; /* 10 minutes */
 static int              g_bAllowLocalRegistration = 0;
 static int              g_MaxRejectedCertificates = 5;
 static int              g_MaxAgeRejectedCertificates = 1; /* days */
+static int              g_bBatchedPersistence = 0; /* PersistenceMode: 0=sync, 1=batched */
+static int              g_PersistenceInterval = 5; /* seconds */
+static OpcUa_Timer      g_hPersistenceTimer = OpcUa_Null;
+static OpcUa_Timer      g_hExpirationTimer = OpcUa_Null;
+static int              g_bJournal = 0;
+static int              g_JournalMaxSize = 1024; /* kilobytes */
 #ifdef _WIN32
 static int              g_bWin32StoreCheck = 0;
 #endif /* _WIN32 */
@@ -193,12 +214,46 @@ const char* ualds_serveruri(void)
     return g_szServerUri;
 }
 
+/** Copies the fully qualified host name, which replaces [gethostname] in URIs and URLs.
+ * The name is resolved on startup and refreshed periodically by a timer,
+ * so service handlers don't need to do a DNS lookup on each request.
+ */
+void ualds_hostname(char *szHostname, size_t len)
+{
+    OpcUa_Mutex_Lock(g_hHostnameMutex);
+    strlcpy(szHostname, g_szHostname, len);
+    OpcUa_Mutex_Unlock(g_hHostnameMutex);
+}
+
 /** Returns the lds product uri. */
 const char* ualds_producturi(void)
 {
     return g_szProductUri;
 }
 
+/** Returns the lds discovery urls as configured, before [gethostname] is replaced.
+ * The urls are read once on startup, so they can be used without holding g_mutex.
+ */
+const char* const* ualds_discoveryurls(int *pNumUrls)
+{
+    *pNumUrls = g_numDiscoveryUrls;
+    return (const char* const*)g_pszDiscoveryUrls;
+}
+
+/** Frees the cached lds discovery urls. */
+static void ualds_discoveryurls_clear(void)
+{
+    int i;
+
+    for (i = 0; i < g_numDiscoveryUrls; i++)
+    {
+        free(g_pszDiscoveryUrls[i]);
+    }
+    free(g_pszDiscoveryUrls);
+    g_pszDiscoveryUrls = 0;
+    g_numDiscoveryUrls = 0;
+}
+
 /** Returns the lds application name for the given locale. */
 const char* ualds_applicationname(const char *szLocale)
 {
@@ -213,11 +268,15 @@ OpcUa_StatusCode ualds_findservers(
     OpcUa_Handle          hContext,
     OpcUa_Void          **ppRequest,
     OpcUa_EncodeableType *pRequestType);
+OpcUa_StatusCode ualds_findservers_initialize(void);
+void ualds_findservers_cleanup(void);
 OpcUa_StatusCode ualds_getendpoints(
     OpcUa_Endpoint        hEndpoint,
     OpcUa_Handle          hContext,
     OpcUa_Void          **ppRequest,
     OpcUa_EncodeableType *pRequestType);
+OpcUa_StatusCode ualds_getendpoints_initialize(void);
+void ualds_getendpoints_cleanup(void);
 OpcUa_StatusCode ualds_registerserver(
     OpcUa_Endpoint        hEndpoint,
     OpcUa_Handle          hContext,
@@ -863,6 +922,12 @@ OpcUa_InitializeStatus(OpcUa_Module_Server, "ualds_security_initialize");
     strlcpy(g_szRejectedPath, g_szCertificateStorePath, PATH_MAX);
     strlcat(g_szRejectedPath, "rejected" __ualds_plat_path_sep "certs" __ualds_plat_path_sep, PATH_MAX);
     ualds_platform_mkpath(g_szRejectedPath);
+    ualds_settings_readint("MaxRejectedCertificates", &g_MaxRejectedCertificates);
+    ualds_settings_readint("MaxAgeRejectedCertificates", &g_MaxAgeRejectedCertificates);
+    if (ualds_rejected_open(g_szRejectedPath, g_MaxRejectedCertificates, g_MaxAgeRejectedCertificates) != 0)
+    {
+        ualds_log(UALDS_LOG_WARNING, "Failed to index rejected folder, rejected certificates are not saved.");
+    }
 
     strlcpy(g_szIssuerPath, g_szCertificateStorePath, PATH_MAX);
     strlcat(g_szIssuerPath, "issuer" __ualds_plat_path_sep "certs" __ualds_plat_path_sep, PATH_MAX);
@@ -1085,6 +1150,7 @@ OpcUa_FinishErrorHandling;
 
 static OpcUa_StatusCode ualds_security_uninitialize(void)
 {
+    ualds_rejected_close();
     OpcUa_ByteString_Clear(&g_server_certificate);
     OpcUa_Key_Clear(&g_server_key);
 
@@ -1093,152 +1159,6 @@ static OpcUa_StatusCode ualds_security_uninitialize(void)
     return ualds_delete_security_policies();
 }
 
-/** File filter for scandir. All entries where this functions return non-zero,
- * will be stored in scandir namelist.
- * This function filters for file ending with "*.der".
- */
-static int ualds_certificate_filefilter(const struct ualds_dirent *entry)
-{
-    int len = strlen(entry->d_name);
-    if (len < 4) return 0;
-    return (strcmp(entry->d_name+len-4, ".der") == 0);
-}
-
-/** This function is used by ualds_platform_scandir which does a qsort() call
- * to sort the file entries.
- * We implement a sort filter here to sort all entries by creation date descending (youngest first).
- */
-static int ualds_certificate_filesort(const struct ualds_dirent **a, const struct ualds_dirent **b)
-{
-    char szPathA[PATH_MAX];
-    char szPathB[PATH_MAX];
-    struct ualds_stat statA;
-    struct ualds_stat statB;
-
-    strlcpy(szPathA, g_szRejectedPath, PATH_MAX);
-    strlcat(szPathA, "/", PATH_MAX);
-    strlcat(szPathA, (*a)->d_name, PATH_MAX);
-    strlcpy(szPathB, g_szRejectedPath, PATH_MAX);
-    strlcat(szPathB, "/", PATH_MAX);
-    strlcat(szPathB, (*b)->d_name, PATH_MAX);
-
-    if (ualds_platform_stat(szPathA, &statA) == 0 &&
-        ualds_platform_stat(szPathB, &statB) == 0)
-    {
-        return (statA.st_ctime < statB.st_ctime);
-    }
-
-    return 0;
-}
-
-static OpcUa_Void ualds_cleanup_rejected(void)
-{
-    int ret;
-    struct ualds_dirent **namelist;
-    struct ualds_stat statF;
-    char szPath[PATH_MAX];
-    int i;
-    time_t now = time(0);
-
-    /* get list of all certificate files, orderd by their creation date */
-    ret = ualds_platform_scandir(
-        g_szRejectedPath,
-        &namelist,
-        ualds_certificate_filefilter,
-        ualds_certificate_filesort);
-
-    if (ret != -1)
-    {
-        /* scan loop: find first certificate which should be removed. */
-        for (i=0; i<ret; i++)
-        {
-            ualds_log(UALDS_LOG_DEBUG, "%s", namelist[i]->d_name);
-            strlcpy(szPath, g_szRejectedPath, PATH_MAX);
-            strlcat(szPath, "/", PATH_MAX);
-            strlcat(szPath, namelist[i]->d_name, PATH_MAX);
-
-            /* g_MaxRejectedCertificates-1 because we are actually adding a new one when this function gets called. */
-            if (i >= (g_MaxRejectedCertificates-1))
-            {
-                ualds_log(UALDS_LOG_DEBUG, "Reached maximum number of rejected certificates.");
-                break; /* start delete loop */
-            }
-            else
-            {
-                if (ualds_platform_stat(szPath, &statF) == 0)
-                {
-                    time_t age = now - statF.st_ctime;
-
-                    age /= 86000; /* convert to days */
-                    if (age > g_MaxAgeRejectedCertificates)
-                    {
-                        ualds_log(UALDS_LOG_DEBUG, "Reached maximum age of rejected certificates.");
-                        break; /* start delete loop */
-                    }
-                }
-            }
-            free(namelist[i]);
-        }
-        /* delete loop: remove all certificates from here. */
-        for (; i<ret; i++)
-        {
-            strlcpy(szPath, g_szRejectedPath, PATH_MAX);
-            strlcat(szPath, "/", PATH_MAX);
-            strlcat(szPath, namelist[i]->d_name, PATH_MAX);
-            ualds_log(UALDS_LOG_DEBUG, "Removing certificate %s from rejected folder.", namelist[i]->d_name);
-            ualds_platform_rm(szPath);
-            free(namelist[i]);
-        }
-        free(namelist);
-    }
-}
-
-static OpcUa_Void ualds_save_clientcertificate(OpcUa_ByteString* a_pbsClientCertificate)
-{
-#if OPCUA_SUPPORT_PKI
-    unsigned char hash[20];
-    char szHash[41];
-    int i, j;
-    unsigned char h, l;
-    UALDS_FILE *f;
-    char szPath[PATH_MAX];
-
-    if (a_pbsClientCertificate == OpcUa_Null) return;
-    if (a_pbsClientCertificate->Length <= 0) return;
-    if (a_pbsClientCertificate->Data == OpcUa_Null) return;
-
-    ualds_cleanup_rejected();
-
-    /* compute SHA1 hash from certificate data */
-    SHA1(a_pbsClientCertificate->Data, a_pbsClientCertificate->Length, hash);
-    for (i = 0, j = 0; i < 20; i++)
-    {
-        h = (hash[i] >> 4);
-        l = (hash[i] & 0xf);
-        /* hex string conversion */
-        szHash[j++] = h > 9 ? 'A' + h - 10 : '0' + h;
-        szHash[j++] = l > 9 ? 'A' + l - 10 : '0' + l;
-    }
-    szHash[j++] = 0;
-
-    strlcpy(szPath, g_szRejectedPath, sizeof(szPath));
-    strlcat(szPath, "/", sizeof(szPath));
-    strlcat(szPath, szHash, sizeof(szPath));
-    strlcat(szPath, ".der", sizeof(szPath));
-
-    f = ualds_platform_fopen(szPath, "wb");
-    if (f)
-    {
-        ualds_platform_fwrite(a_pbsClientCertificate->Data, a_pbsClientCertificate->Length, 1, f);
-        ualds_platform_fclose(f);
-    }
-    else
-    {
-        ualds_log(UALDS_LOG_ERR, "Failed to write certificate into rejected folder.");
-    }
-#endif /* OPCUA_SUPPORT_PKI */
-}
-
 static OpcUa_StatusCode ualds_endpoint_callback(
     OpcUa_Endpoint          hEndpoint,
     OpcUa_Void*             pvCallbackData,
@@ -1269,7 +1189,7 @@ static OpcUa_StatusCode ualds_endpoint_callback(
             if (uStatus == OpcUa_BadCertificateUntrusted)
             {
                 /* save untrusted certificate in rejected folder */
-                ualds_save_clientcertificate(pbsClientCertificate);
+                ualds_rejected_add(pbsClientCertificate);
             }
             break;
         }
@@ -1383,6 +1303,9 @@ static OpcUa_StatusCode ualds_delete_endpoints(void)
 
 static void ualds_initialize_proxystubconfig(OpcUa_ProxyStubConfiguration *pConfig)
 {
+    char szValue[10];
+    int  iTimeout = 0;
+
     pConfig->bProxyStub_Trace_Enabled              = OpcUa_True;
     pConfig->uProxyStub_Trace_Level                = g_StackTraceLevel;
     pConfig->iSerializer_MaxAlloc                  = -1;
@@ -1396,13 +1319,47 @@ static void ualds_initialize_proxystubconfig(OpcUa_ProxyStubConfiguration *pConf
     pConfig->iSecureListener_ThreadPool_MaxThreads = -1;
     pConfig->iSecureListener_ThreadPool_MaxJobs    = -1;
     pConfig->bSecureListener_ThreadPool_BlockOnAdd = OpcUa_True;
-    pConfig->uSecureListener_ThreadPool_Timeout    = OPCUA_INFINITE;
+    pConfig->uSecureListener_ThreadPool_Timeout    = UALDS_CONF_THREADPOOL_TIMEOUT;
     pConfig->iTcpListener_DefaultChunkSize         = -1;
+    pConfig->iTcpListener_MaxConnections           = -1;
     pConfig->iTcpConnection_DefaultChunkSize       = -1;
     pConfig->iTcpTransport_MaxMessageLength        = -1;
     pConfig->iTcpTransport_MaxChunkCount           = -1;
     pConfig->bTcpListener_ClientThreadsEnabled     = OpcUa_False;
     pConfig->bTcpStream_ExpectWriteToBlock         = OpcUa_True;
+
+    /* discovery clients connect in bursts, allow more than the stack default if configured */
+    ualds_settings_begingroup("General");
+    ualds_settings_readint("MaxConnections", &pConfig->iTcpListener_MaxConnections);
+    ualds_settings_endgroup();
+#ifdef _WIN32
+    /* the win32 socket manager has a fixed size and would refuse to open the listener, keep one socket for listening */
+    if (pConfig->iTcpListener_MaxConnections >= OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS)
+    {
+        ualds_log(UALDS_LOG_WARNING, "MaxConnections = %d exceeds the socket limit of this build, using %d.",
+                  pConfig->iTcpListener_MaxConnections, OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS - 1);
+        pConfig->iTcpListener_MaxConnections = OPCUA_P_SOCKETMANAGER_NUMBEROFSOCKETS - 1;
+    }
+#endif /* _WIN32 */
+
+    /* run the service handlers on worker threads, so a slow registration does not stall other clients */
+    ualds_settings_begingroup("ThreadPool");
+    if (ualds_settings_readstring("Enabled", szValue, sizeof(szValue)) == 0)
+    {
+        pConfig->bSecureListener_ThreadPool_Enabled = (strcmp(szValue, "yes") == 0) ? OpcUa_True : OpcUa_False;
+    }
+    ualds_settings_readint("MinThreads", &pConfig->iSecureListener_ThreadPool_MinThreads);
+    ualds_settings_readint("MaxThreads", &pConfig->iSecureListener_ThreadPool_MaxThreads);
+    ualds_settings_readint("MaxJobs", &pConfig->iSecureListener_ThreadPool_MaxJobs);
+    if (ualds_settings_readstring("BlockOnAdd", szValue, sizeof(szValue)) == 0)
+    {
+        pConfig->bSecureListener_ThreadPool_BlockOnAdd = (strcmp(szValue, "no") != 0) ? OpcUa_True : OpcUa_False;
+    }
+    if (ualds_settings_readint("Timeout", &iTimeout) == 0 && iTimeout > 0)
+    {
+        pConfig->uSecureListener_ThreadPool_Timeout = (OpcUa_UInt32)iTimeout;
+    }
+    ualds_settings_endgroup();
 }
 
 static OpcUa_Void OPCUA_DLLCALL ualds_stack_trace_hook(OpcUa_CharA* szMessage)
@@ -1410,14 +1367,165 @@ static OpcUa_Void OPCUA_DLLCALL ualds_stack_trace_hook(OpcUa_CharA* szMessage)
     ualds_log(UALDS_LOG_DEBUG, "[uastack] %.*s", strlen(szMessage)-1, szMessage);
 }
 
+/** Timer callback which writes modified settings in batched persistence mode. */
+static OpcUa_StatusCode OPCUA_DLLCALL ualds_persistence_timer(OpcUa_Void*  pvCallbackData,
+                                                              OpcUa_Timer  hTimer,
+                                                              OpcUa_UInt32 msecElapsed)
+{
+    UALDS_UNUSED(pvCallbackData);
+    UALDS_UNUSED(hTimer);
+    UALDS_UNUSED(msecElapsed);
+
+    OpcUa_Mutex_Lock(g_mutex);
+    if (ualds_settings_ismodified())
+    {
+        ualds_settings_snapshot();
+    }
+    OpcUa_Mutex_Unlock(g_mutex);
+
+    return OpcUa_Good;
+}
+
+/** Timer callback which resolves the host name again, e.g. after a DHCP lease changed the domain. */
+static OpcUa_StatusCode OPCUA_DLLCALL ualds_hostname_timer(OpcUa_Void*  pvCallbackData,
+                                                           OpcUa_Timer  hTimer,
+                                                           OpcUa_UInt32 msecElapsed)
+{
+    char szHostname[256];
+
+    UALDS_UNUSED(pvCallbackData);
+    UALDS_UNUSED(hTimer);
+    UALDS_UNUSED(msecElapsed);
+
+    /* resolve without holding the lock, this may block on the resolver */
+    if (ualds_platform_getfqhostname(szHostname, sizeof(szHostname)) != 0) return OpcUa_Good;
+
+    OpcUa_Mutex_Lock(g_hHostnameMutex);
+    if (strcmp(szHostname, g_szHostname) != 0)
+    {
+        ualds_log(UALDS_LOG_NOTICE, "Host name changed from %s to %s.", g_szHostname, szHostname);
+        strlcpy(g_szHostname, szHostname, sizeof(g_szHostname));
+    }
+    OpcUa_Mutex_Unlock(g_hHostnameMutex);
+
+    return OpcUa_Good;
+}
+
+/** Timer callback which removes expired registrations. */
+static OpcUa_StatusCode OPCUA_DLLCALL ualds_expiration_timer(OpcUa_Void*  pvCallbackData,
+                                                             OpcUa_Timer  hTimer,
+                                                             OpcUa_UInt32 msecElapsed)
+{
+    UALDS_UNUSED(pvCallbackData);
+    UALDS_UNUSED(hTimer);
+    UALDS_UNUSED(msecElapsed);
+
+    OpcUa_Mutex_Lock(g_mutex);
+    ualds_expirationcheck();
+    OpcUa_Mutex_Unlock(g_mutex);
+
+    return OpcUa_Good;
+}
+
+/** Makes sure that g_pPollFds can hold \c numFds entries. */
+static int ualds_reserve_pollfds(int numFds)
+{
+    UALDS_POLLFD *pFds;
+
+    if (numFds <= g_maxPollFds) return 0;
+
+    numFds += 16;
+    pFds = realloc(g_pPollFds, numFds * sizeof(UALDS_POLLFD));
+    if (pFds == 0)
+    {
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        return ENOMEM;
+    }
+    g_pPollFds = pFds;
+    g_maxPollFds = numFds;
+
+    return 0;
+}
+
+/** Waits up to \c timeout milliseconds for a shutdown request and for mDNS results.
+ * The sockets of all pending mDNS operations are waited on in a single poll call,
+ * so results are processed as soon as they arrive, and only for sockets which are readable.
+ */
+static void ualds_wait_events(int timeout)
+{
+    int numFds = 0;
+    int numZeroconf = 0;
+    int numFindServers = 0;
+    int i;
+
+    if (ualds_reserve_pollfds(1) != 0)
+    {
+        ualds_platform_sleep(1);
+        return;
+    }
+    if (g_bWakeup)
+    {
+        g_pPollFds[0].fd = g_wakeupFd;
+        g_pPollFds[0].events = POLLIN;
+        g_pPollFds[0].revents = 0;
+        numFds = 1;
+    }
+
+#ifdef HAVE_HDS
+    if (g_bEnableZeroconf)
+    {
+        /* the array is too small if the number of sockets has grown, then collect them again */
+        do
+        {
+            numZeroconf = ualds_zeroconf_getSockets(g_pPollFds + numFds, g_maxPollFds - numFds);
+        } while (numFds + numZeroconf > g_maxPollFds && ualds_reserve_pollfds(numFds + numZeroconf) == 0);
+        if (numZeroconf > g_maxPollFds - numFds) numZeroconf = g_maxPollFds - numFds;
+
+        do
+        {
+            numFindServers = ualds_findserversonnetwork_getSockets(g_pPollFds + numFds + numZeroconf, g_maxPollFds - numFds - numZeroconf);
+        } while (numFds + numZeroconf + numFindServers > g_maxPollFds && ualds_reserve_pollfds(numFds + numZeroconf + numFindServers) == 0);
+        if (numFindServers > g_maxPollFds - numFds - numZeroconf) numFindServers = g_maxPollFds - numFds - numZeroconf;
+    }
+#endif
+
+    if (numFds + numZeroconf + numFindServers == 0)
+    {
+        ualds_platform_sleep(1);
+        return;
+    }
+
+    if (ualds_platform_poll(g_pPollFds, numFds + numZeroconf + numFindServers, timeout) <= 0) return;
+
+    if (g_bWakeup && g_pPollFds[0].revents != 0)
+    {
+        ualds_platform_wakeup_drain();
+    }
+#ifdef HAVE_HDS
+    for (i = numFds; i < numFds + numZeroconf && !g_shutdown; i++)
+    {
+        if (g_pPollFds[i].revents != 0) ualds_zeroconf_processSocket(&g_pPollFds[i]);
+    }
+    for (i = numFds + numZeroconf; i < numFds + numZeroconf + numFindServers && !g_shutdown; i++)
+    {
+        if (g_pPollFds[i].revents != 0) ualds_findserversonnetwork_processSocket(&g_pPollFds[i]);
+    }
+#else
+    UALDS_UNUSED(i);
+#endif
+}
+
 static int ualds_server_startup(void)
 {
     int ret = EXIT_SUCCESS;
     OpcUa_ProxyStubConfiguration stackconfig;
     OpcUa_StatusCode status;
     int numServerNames = 0;
+    int numDiscoveryUrls = 0;
+    int i;
     char szExeFileName[PATH_MAX];
     char szValue[10];
+    char szUrl[UALDS_CONF_MAX_URI_LENGTH];
     OpcUa_Handle pcalltab = OpcUa_Null;
 
 #ifdef HAVE_HDS
@@ -1451,6 +1559,45 @@ static int ualds_server_startup(void)
             g_StackTraceLevel = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
         }
     }
+#ifndef _WIN32
+    /* record stack traces into the binary trace ring, independent of StackTrace */
+    if (ualds_settings_readstring("TraceRing", szValue, sizeof(szValue)) == 0)
+    {
+        OpcUa_UInt32 traceRingLevel = OPCUA_TRACE_OUTPUT_LEVEL_NONE;
+        int traceRingSize = UALDS_CONF_TRACERING_SIZE;
+        char szTraceRingFile[PATH_MAX];
+
+        if (strcmp(szValue, "error") == 0) {
+            traceRingLevel = OPCUA_TRACE_OUTPUT_LEVEL_ERROR;
+        }
+        else if (strcmp(szValue, "warn") == 0) {
+            traceRingLevel = OPCUA_TRACE_OUTPUT_LEVEL_WARNING;
+        }
+        else if (strcmp(szValue, "info") == 0) {
+            traceRingLevel = OPCUA_TRACE_OUTPUT_LEVEL_INFO;
+        }
+        else if (strcmp(szValue, "debug") == 0) {
+            traceRingLevel = OPCUA_TRACE_OUTPUT_LEVEL_DEBUG;
+        }
+        ualds_settings_readint("TraceRingSize", &traceRingSize);
+        if (ualds_settings_readstring("TraceRingFile", szTraceRingFile, sizeof(szTraceRingFile)) != 0)
+        {
+            getDefaultLogFilePath(szTraceRingFile, sizeof(szTraceRingFile));
+            strlcat(szTraceRingFile, ".trace", sizeof(szTraceRingFile));
+        }
+        if (traceRingLevel != OPCUA_TRACE_OUTPUT_LEVEL_NONE && traceRingSize > 0)
+        {
+            if (ualds_tracering_open(traceRingLevel, (unsigned int)traceRingSize, szTraceRingFile) == 0)
+            {
+                ualds_log(UALDS_LOG_INFO, "Recording stack traces into trace ring, dump file is %s.", szTraceRingFile);
+            }
+            else
+            {
+                ualds_log(UALDS_LOG_ERR, "Failed to open trace ring dump file %s.", szTraceRingFile);
+            }
+        }
+    }
+#endif
     ualds_settings_endgroup();
 
     /* setup trace hook of uastack */
@@ -1476,6 +1623,29 @@ static int ualds_server_startup(void)
         OpcUa_P_Clean(&pcalltab);
         return EXIT_FAILURE;
     }
+    status = OpcUa_Mutex_Create(&g_hHostnameMutex);
+    if (OpcUa_IsBad(status))
+    {
+        OpcUa_Mutex_Delete(&g_mutex);
+        OpcUa_P_Clean(&pcalltab);
+        return EXIT_FAILURE;
+    }
+    if (ualds_registry_initialize() != 0)
+    {
+        OpcUa_Mutex_Delete(&g_hHostnameMutex);
+        OpcUa_Mutex_Delete(&g_mutex);
+        OpcUa_P_Clean(&pcalltab);
+        return EXIT_FAILURE;
+    }
+    status = ualds_findservers_initialize();
+    if (OpcUa_IsBad(status))
+    {
+        ualds_registry_cleanup();
+        OpcUa_Mutex_Delete(&g_hHostnameMutex);
+        OpcUa_Mutex_Delete(&g_mutex);
+        OpcUa_P_Clean(&pcalltab);
+        return EXIT_FAILURE;
+    }
 
     /* read settings */
     ualds_settings_begingroup("General");
@@ -1489,6 +1659,30 @@ static int ualds_server_startup(void)
             g_bAllowLocalRegistration = 1;
         }
     }
+    if (ualds_settings_readstring("PersistenceMode", szValue, sizeof(szValue)) == 0)
+    {
+        if (strcmp(szValue, "batched") == 0)
+        {
+            g_bBatchedPersistence = 1;
+        }
+    }
+    ualds_settings_readint("PersistenceInterval", &g_PersistenceInterval);
+    if (g_PersistenceInterval < 1)
+    {
+        g_PersistenceInterval = 1;
+    }
+    if (ualds_settings_readstring("Journal", szValue, sizeof(szValue)) == 0)
+    {
+        if (strcmp(szValue, "yes") == 0)
+        {
+            g_bJournal = 1;
+        }
+    }
+    ualds_settings_readint("JournalMaxSize", &g_JournalMaxSize);
+    if (g_JournalMaxSize < 1)
+    {
+        g_JournalMaxSize = 1;
+    }
     ualds_settings_endgroup();
 
     ualds_settings_begingroup(g_szServerUri);
@@ -1500,12 +1694,47 @@ static int ualds_server_startup(void)
         ualds_settings_readstring("Text", g_szApplicationName, sizeof(g_szApplicationName));
     }
     ualds_settings_endarray();
+    ualds_settings_beginreadarray("DiscoveryUrls", &numDiscoveryUrls);
+    if (numDiscoveryUrls > 0)
+    {
+        g_pszDiscoveryUrls = calloc(numDiscoveryUrls, sizeof(char*));
+        if (g_pszDiscoveryUrls == 0)
+        {
+            ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        }
+        else
+        {
+            for (i = 0; i < numDiscoveryUrls; i++)
+            {
+                ualds_settings_setarrayindex(i);
+                if (ualds_settings_readstring("Url", szUrl, sizeof(szUrl)) == 0)
+                {
+                    g_pszDiscoveryUrls[g_numDiscoveryUrls] = strdup(szUrl);
+                    if (g_pszDiscoveryUrls[g_numDiscoveryUrls]) g_numDiscoveryUrls++;
+                }
+            }
+        }
+    }
+    ualds_settings_endarray();
     if (strlen(szExeFileName) > 0)
     {
         ualds_settings_writestring("SemaphoreFilePath", szExeFileName);
     }
     ualds_settings_endgroup();
 
+    /* load registered servers */
+    ualds_registry_setmaxage(g_ExpirationMaxAge);
+    ualds_registry_load();
+
+    /* apply registration changes which are not yet contained in the settings file */
+    if (g_bJournal)
+    {
+        if (ualds_journal_open(ualds_settings_path(), g_JournalMaxSize * 1024L, ualds_settings_isrestored()) != 0)
+        {
+            ualds_log(UALDS_LOG_WARNING, "Failed to open registration journal, settings are written without journal.");
+        }
+    }
+
     /* Initialize OPC UA Security */
     status = ualds_security_initialize();
     if (OpcUa_IsBad(status))
@@ -1548,6 +1777,8 @@ static int ualds_server_startup(void)
             ualds_delete_endpoints();
             ualds_security_uninitialize();
             ualds_settings_cleanup(0);
+            ualds_findservers_cleanup();
+            OpcUa_Mutex_Delete(&g_hHostnameMutex);
             OpcUa_Mutex_Delete(&g_mutex);
             OpcUa_ProxyStub_Clear();
             OpcUa_P_Clean(&pcalltab);
@@ -1562,6 +1793,8 @@ static int ualds_server_startup(void)
             ualds_delete_endpoints();
             ualds_security_uninitialize();
             ualds_settings_cleanup(0);
+            ualds_findservers_cleanup();
+            OpcUa_Mutex_Delete(&g_hHostnameMutex);
             OpcUa_Mutex_Delete(&g_mutex);
             OpcUa_ProxyStub_Clear();
             OpcUa_P_Clean(&pcalltab);
@@ -1574,17 +1807,22 @@ static int ualds_server_startup(void)
     }
 #endif
 
+    /* Build the GetEndpoints response, the endpoints and the certificate are known now */
+    status = ualds_getendpoints_initialize();
+
     /* Open Endpoints */
-    status = ualds_create_endpoints();
+    if (OpcUa_IsGood(status))
+    {
+        status = ualds_create_endpoints();
+    }
     if (OpcUa_IsBad(status))
     {
         ualds_delete_endpoints();
+        ualds_getendpoints_cleanup();
 
 #ifdef HAVE_HDS
         if (g_bEnableZeroconf)
         {
-            ualds_zeroconf_socketEventCallback(&g_shutdown);
-
             ualds_zeroconf_stop_registration();
 
             /* stop browsing for DNSServices in the background */
@@ -1598,27 +1836,93 @@ static int ualds_server_startup(void)
 
         ualds_security_uninitialize();
         ualds_settings_cleanup(0);
+        ualds_findservers_cleanup();
+        OpcUa_Mutex_Delete(&g_hHostnameMutex);
         OpcUa_Mutex_Delete(&g_mutex);
         OpcUa_ProxyStub_Clear();
         OpcUa_P_Clean(&pcalltab);
         return EXIT_FAILURE;
     }
 
-    ualds_settings_flush();
+    ualds_settings_snapshot();
 
-    while (!g_shutdown)
+    status = OpcUa_Timer_Create(&g_hExpirationTimer,
+                                UALDS_CONF_EXPIRATION_CHECK_INTERVAL,
+                                ualds_expiration_timer,
+                                OpcUa_Null,
+                                OpcUa_Null);
+    if (OpcUa_IsBad(status))
     {
-#ifdef HAVE_HDS
-        if (g_bEnableZeroconf)
+        ualds_log(UALDS_LOG_ERR, "Failed to create expiration check timer, registrations will not expire.");
+        g_hExpirationTimer = OpcUa_Null;
+    }
+
+    status = OpcUa_Timer_Create(&g_hHostnameTimer,
+                                UALDS_CONF_HOSTNAME_REFRESH_INTERVAL,
+                                ualds_hostname_timer,
+                                OpcUa_Null,
+                                OpcUa_Null);
+    if (OpcUa_IsBad(status))
+    {
+        ualds_log(UALDS_LOG_WARNING, "Failed to create host name refresh timer, the host name is only resolved on startup.");
+        g_hHostnameTimer = OpcUa_Null;
+    }
+
+    if (g_bBatchedPersistence)
+    {
+        ualds_log(UALDS_LOG_INFO, "Create settings persistence timer with interval %i", g_PersistenceInterval);
+        status = OpcUa_Timer_Create(&g_hPersistenceTimer,
+                                    g_PersistenceInterval * 1000,
+                                    ualds_persistence_timer,
+                                    OpcUa_Null,
+                                    OpcUa_Null);
+        if (OpcUa_IsBad(status))
         {
-            ualds_zeroconf_socketEventCallback(&g_shutdown);
-            ualds_findserversonnetwork_socketEventCallback(&g_shutdown);
+            ualds_log(UALDS_LOG_WARNING, "Failed to create settings persistence timer, settings are written synchronously.");
+            g_hPersistenceTimer = OpcUa_Null;
         }
-#endif
-        ualds_platform_sleep(1);
+    }
+
+    if (ualds_platform_wakeup_open(&g_wakeupFd) == 0)
+    {
+        g_bWakeup = 1;
+    }
+    else
+    {
+        ualds_log(UALDS_LOG_WARNING, "Failed to create wakeup pipe, shutdown may be delayed.");
+    }
+
+    while (!g_shutdown)
+    {
+        ualds_wait_events(1000);
+    }
+
+    g_bWakeup = 0;
+    ualds_platform_wakeup_close();
+    free(g_pPollFds);
+    g_pPollFds = 0;
+    g_maxPollFds = 0;
+
+    if (g_hExpirationTimer != OpcUa_Null)
+    {
+        OpcUa_Timer_Delete(&g_hExpirationTimer);
+        g_hExpirationTimer = OpcUa_Null;
+    }
+    if (g_hHostnameTimer != OpcUa_Null)
+    {
+        OpcUa_Timer_Delete(&g_hHostnameTimer);
+        g_hHostnameTimer = OpcUa_Null;
+    }
+
+    if (g_hPersistenceTimer != OpcUa_Null)
+    {
+        /* pending changes are written by ualds_settings_cleanup */
+        OpcUa_Timer_Delete(&g_hPersistenceTimer);
+        g_hPersistenceTimer = OpcUa_Null;
     }
 
     ualds_delete_endpoints();
+    ualds_getendpoints_cleanup();
 
 #ifdef HAVE_HDS
     if (g_bEnableZeroconf)
@@ -1637,6 +1941,8 @@ static int ualds_server_startup(void)
 
     ualds_security_uninitialize();
     ualds_settings_cleanup(1);
+    ualds_findservers_cleanup();
+    OpcUa_Mutex_Delete(&g_hHostnameMutex);
     OpcUa_Mutex_Delete(&g_mutex);
     OpcUa_ProxyStub_Clear();
     OpcUa_P_Clean(&pcalltab);
@@ -1677,6 +1983,10 @@ int ualds_server(void)
         }
     }
 
+#ifndef _WIN32
+    ualds_tracering_close();
+#endif
+
     return ret;
 }
 
@@ -1686,6 +1996,7 @@ int ualds_server(void)
 void ualds_shutdown(void)
 {
     g_shutdown = 1;
+    ualds_platform_wakeup_signal();
 }
 
 /** Reloads the configuration.
@@ -1695,139 +2006,76 @@ void ualds_reload(void)
 {
 }
 
-/** Iterates over all registered servers and removes all expired entries. */
+/** Removes all expired registrations.
+ * Only due entries of the registry's expiration heap are visited. Registrations
+ * with a semaphore file are checked on each call, as long as the file exists.
+ * This is called periodically by the expiration timer, the caller must hold g_mutex.
+ */
 void ualds_expirationcheck(void)
 {
-    int numServers = 0;
     int numRemoved = 0;
-    int i, pos;
-    char **szServerUriArray = 0;
-    int  *RemovedServers = 0;
-    time_t now, updatetime;
-    char szSemaphoreFile[PATH_MAX];
+    time_t now = time(0);
+    ualds_registeredserver *pServer;
 
-    /* read list of all registered servers */
-    ualds_settings_begingroup("RegisteredServers");
-    ualds_settings_beginreadarray("Servers", &numServers);
-    if (numServers < 1)
+    while ((pServer = ualds_registry_nextexpiration()) != 0 && pServer->ExpiryTime < now)
     {
-        ualds_settings_endarray();
-        ualds_settings_endgroup();
-        return;
-    }
-    szServerUriArray = malloc(sizeof(char*) * numServers);
-    if (szServerUriArray == 0)
-    {
-        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
-        ualds_settings_endarray();
-        ualds_settings_endgroup();
-        return;
-    }
-    RemovedServers = malloc(sizeof(int) * numServers);
-    if (RemovedServers == 0)
-    {
-        free(szServerUriArray);
-        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
-        ualds_settings_endarray();
-        ualds_settings_endgroup();
-        return;
-    }
-    for (i=0; i<numServers; i++)
-    {
-        szServerUriArray[i] = malloc(UALDS_CONF_MAX_URI_LENGTH);
-        if (szServerUriArray[i])
+        if (pServer->szSemaphoreFilePath != 0 && pServer->szSemaphoreFilePath[0] != 0 &&
+            ualds_platform_fileexists(pServer->szSemaphoreFilePath))
         {
-            ualds_settings_setarrayindex(i);
-            ualds_settings_readstring("ServerUri", szServerUriArray[i], UALDS_CONF_MAX_URI_LENGTH);
+            /* server is still running, check again on the next call */
+            ualds_registry_reschedule(pServer, now);
+            continue;
         }
-    }
-    ualds_settings_endarray();
-    ualds_settings_endgroup();
 
-    /* check each server for expiration */
-    for (i=0; i<numServers; i++)
-    {
-        RemovedServers[i] = 0;
-        if (szServerUriArray[i])
-        {
-            szSemaphoreFile[0] = 0;
-            updatetime = 0;
-            ualds_settings_begingroup(szServerUriArray[i]);
-            if (ualds_settings_readstring("SemaphoreFilePath", szSemaphoreFile, PATH_MAX) == ENOENT)
-            {
-                ualds_settings_endgroup();
-                ualds_settings_removegroup(szServerUriArray[i]);
-#ifdef HAVE_HDS
-                ualds_zeroconf_removeRegistration(szServerUriArray[i]);
-#endif
-                RemovedServers[i] = 1;
-                numRemoved++;
-                continue;
-            }
-            ualds_settings_readtime_t("UpdateTime", &updatetime);
-            ualds_settings_endgroup();
-
-            if (szSemaphoreFile[0] != 0)
-            {
-                if (szSemaphoreFile[0] != '*' &&
-                    !ualds_platform_fileexists(szSemaphoreFile))
-                {
-                    /* file does not exist, remove entry */
-                    ualds_settings_removegroup(szServerUriArray[i]);
 #ifdef HAVE_HDS
-                    ualds_zeroconf_removeRegistration(szServerUriArray[i]);
-#endif
-                    RemovedServers[i] = 1;
-                    numRemoved++;
-                }
-            }
-            else
-            {
-                now = time(0);
-                if ((now - updatetime) > g_ExpirationMaxAge)
-                {
-                    /* entry is expired, remove it */
-                    ualds_settings_removegroup(szServerUriArray[i]);
-#ifdef HAVE_HDS
-                    ualds_zeroconf_removeRegistration(szServerUriArray[i]);
+        char szServerUri[UALDS_CONF_MAX_URI_LENGTH];
+        strlcpy(szServerUri, pServer->szServerUri, sizeof(szServerUri));
+        ualds_registry_remove(szServerUri);
+        ualds_zeroconf_removeRegistration(szServerUri);
+#else
+        ualds_registry_remove(pServer->szServerUri);
 #endif
-                    RemovedServers[i] = 1;
-                    numRemoved++;
-                }
-            }
-        }
+        numRemoved++;
     }
 
     /* write new list of all registered servers */
-    ualds_settings_begingroup("RegisteredServers");
-    ualds_settings_removearray("Servers");
-    ualds_settings_beginwritearray("Servers", numServers-numRemoved);
-    for (i=0, pos=0; i<numServers; i++)
+    if (numRemoved > 0)
     {
-        if (RemovedServers[i] == 0)
-        {
-            ualds_settings_setarrayindex(pos);
-            ualds_settings_writestring("ServerUri", szServerUriArray[i]);
-            pos++;
-        }
+        ualds_registry_writeserverlist();
     }
-    ualds_settings_endarray();
-    ualds_settings_endgroup();
+}
 
-    /* cleanup */
-    for (i=0; i<numServers; i++)
+/** Writes the settings file. If the registration journal is open, it is compacted,
+ * because the settings file then contains all journaled changes.
+ * The caller must hold g_mutex.
+ */
+int ualds_settings_snapshot(void)
+{
+    if (ualds_journal_isopen())
     {
-        if (szServerUriArray[i])
-        {
-            free(szServerUriArray[i]);
-            szServerUriArray[i] = 0;
-        }
+        return ualds_journal_compact();
     }
-    free(szServerUriArray);
-    szServerUriArray = 0;
-    
-    free(RemovedServers);
-    RemovedServers = 0;
+
+    return ualds_settings_flush();
+}
+
+/** Persists modified settings according to the configured PersistenceMode.
+ * If the registration journal is open, the change has already been journaled
+ * and the settings are only written if the journal needs compaction.
+ * Otherwise in sync mode the settings are written immediately, in batched mode
+ * they are written by the persistence timer.
+ * The caller must hold g_mutex.
+ */
+int ualds_settings_commit(void)
+{
+    if (ualds_journal_isopen())
+    {
+        if (!ualds_journal_needscompaction()) return 0;
+        return ualds_journal_compact();
+    }
+    if (g_hPersistenceTimer != OpcUa_Null) return 0;
+
+    return ualds_settings_flush();
 }
 
 int ualds_settings_cleanup(int flush)
@@ -1835,6 +2083,13 @@ int ualds_settings_cleanup(int flush)
     int status = 0;
 
     OpcUa_Mutex_Lock(g_mutex);
+    if (flush != 0 && ualds_journal_isopen())
+    {
+        ualds_journal_compact();
+    }
+    ualds_journal_close();
+    ualds_registry_cleanup();
+    ualds_discoveryurls_clear();
     status = ualds_settings_close(flush);
     OpcUa_Mutex_Unlock(g_mutex);
 
@@ -67,9 +67,14 @@ void ualds_expirationcheck(void);
 
 const ualds_endpoint* ualds_endpoints(OpcUa_UInt32 *pNumEndpoints);
 const char* ualds_serveruri(void);
+void ualds_hostname(char *szHostname, size_t len);
 const char* ualds_producturi(void);
+const char* const* ualds_discoveryurls(int *pNumUrls);
 const char* ualds_applicationname(const char *szLocale);
 
+int ualds_settings_snapshot(void);
+int ualds_settings_commit(void);
+
 // param flush 
 //          != 0 => flush to disk
 //          == 0 => don't flush to disk
@@ -46,9 +46,12 @@
 
 #include "tlds-alpha-by-domain.h"
 
+/** Known Top Level Domains (TLD), sorted for binary search.
+ * The entries point into tld_str, which is split in place by loadKnownTLD.
+ */
 typedef struct _TLDStruct
 {
-    char tlds[2000][100];
+    const char **tlds;
     int nrTlds;
 } TLDStruct;
 
@@ -138,31 +141,58 @@ int is_Host_IP4Address(const char* host)
     return 0;
 }
 
+static int compareTLD(const void *a, const void *b)
+{
+    return ualds_platform_strcpy_insensitive(*(const char* const*)a, *(const char* const*)b);
+}
+
+/** Checks if the domain, including the leading dot, is a known TLD.
+ * @return 0 if the domain is a TLD, 1 otherwise.
+ */
 int isTLD(const char* domain)
 {
-    int i = 0;
-    for (i = 0; i < tld_struct.nrTlds; ++i)
+    if (domain == NULL || domain[0] != '.' || tld_struct.nrTlds == 0)
     {
-        if (ualds_platform_strcpy_insensitive(domain, tld_struct.tlds[i]) == 0)
-        {
-            return 0;
-        }
+        return 1;
+    }
+
+    domain++;
+    if (bsearch(&domain, tld_struct.tlds, tld_struct.nrTlds, sizeof(const char*), compareTLD) != NULL)
+    {
+        return 0;
     }
     return 1;
 }
 
 void loadKnownTLD(void)
 {
-    // load known Top Level Domains (TLD) 
-    tld_struct.nrTlds = 0;
+    char *pch;
+    int maxTlds = 0;
 
-    char * pch;
-    pch = strtok(tld_str, " ");
-    while (pch != NULL)
+    // load known Top Level Domains (TLD) once, tld_str is split in place
+    if (tld_struct.tlds != NULL)
     {
-        strcpy(tld_struct.tlds[tld_struct.nrTlds], ".");
-        strcat(tld_struct.tlds[tld_struct.nrTlds], pch);
-        tld_struct.nrTlds++;
-        pch = strtok(NULL, " ");
+        return;
     }
+
+    for (pch = tld_str; *pch != 0; pch++)
+    {
+        if (*pch == ' ') maxTlds++;
+    }
+    tld_struct.tlds = malloc(sizeof(const char*) * (maxTlds + 1));
+    if (tld_struct.tlds == NULL)
+    {
+        ualds_log(UALDS_LOG_ERR, "malloc failed. Out of Memory.");
+        return;
+    }
+
+    tld_struct.nrTlds = 0;
+    pch = strtok(tld_str, " \n");
+    while (pch != NULL && tld_struct.nrTlds <= maxTlds)
+    {
+        tld_struct.tlds[tld_struct.nrTlds++] = pch;
+        pch = strtok(NULL, " \n");
+    }
+
+    qsort(tld_struct.tlds, tld_struct.nrTlds, sizeof(const char*), compareTLD);
 }
@@ -30,6 +30,7 @@
 /* system includes */
 #include <stdio.h>
 #include <direct.h>
+#include <io.h>
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <errno.h>
@@ -281,6 +282,27 @@ int ualds_platform_rename(const char* from, const char* to)
     return MoveFileA(from, to) ? 0 : -1;
 }
 
+/** Flushes the stream buffers and the file content to disk. */
+int ualds_platform_fsync(UALDS_FILE *fp)
+{
+    if (fflush(fp) != 0) return -1;
+    return _commit(_fileno(fp));
+}
+
+/** Atomically replaces \c szFile with \c szNewFile.
+ * If \c szBackupFile is not NULL the previous version of \c szFile is kept with this name.
+ */
+int ualds_platform_replacefile(const char *szFile, const char *szNewFile, const char *szBackupFile)
+{
+    if (ReplaceFileA(szFile, szNewFile, szBackupFile, REPLACEFILE_IGNORE_MERGE_ERRORS, 0, 0))
+    {
+        return 0;
+    }
+
+    /* ReplaceFile fails if szFile does not exist yet */
+    return MoveFileExA(szNewFile, szFile, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+}
+
 /** Sleep */
 void ualds_platform_sleep(int seconds)
 {
@@ -298,16 +320,27 @@ int ualds_platform_getfqhostname(char *szHostname, int len)
     return ualds_platform_gethostbyname(szHostname, szHostname, len);
 }
 
-/** Get fully qualified name by using gethostbyname. */
+/** Get fully qualified name by using getaddrinfo. */
 int ualds_platform_gethostbyname(const char* host, char* szHostname, int len)
 {
-    struct hostent *pEnt = 0;
+    struct addrinfo hints;
+    struct addrinfo *pResult = 0;
+    int ret;
+
+    UALDS_UNUSED(host);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_flags = AI_CANONNAME;
 
-    pEnt = gethostbyname(szHostname);
-    if (pEnt == 0) return -1;
+    /* getaddrinfo is reentrant, unlike gethostbyname */
+    ret = getaddrinfo(szHostname, NULL, &hints, &pResult);
+    if (ret != 0 || pResult == 0) return -1;
 
-    strncpy(szHostname, pEnt->h_name, len);
-    szHostname[len - 1] = 0;
+    if (pResult->ai_canonname)
+    {
+        strlcpy(szHostname, pResult->ai_canonname, len);
+    }
+    freeaddrinfo(pResult);
 
     return 0;
 }
@@ -622,3 +655,63 @@ int ualds_platform_strcpy_insensitive(const char *s1, const char *s2)
 {
     return stricmp(s1, s2);
 }
+
+static SOCKET g_wakeupSocket = INVALID_SOCKET;
+
+/** Creates the wakeup socket, which allows interrupting ualds_platform_poll.
+ * Windows can't poll pipes, so this is a loopback UDP socket connected to itself.
+ * @param pFd Receives the socket which becomes readable when the wakeup is signalled.
+ */
+int ualds_platform_wakeup_open(UALDS_SOCKET *pFd)
+{
+    struct sockaddr_in addr;
+    int addrlen = sizeof(addr);
+    u_long nonblocking = 1;
+
+    g_wakeupSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (g_wakeupSocket == INVALID_SOCKET) return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(g_wakeupSocket, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(g_wakeupSocket, (struct sockaddr*)&addr, &addrlen) != 0 ||
+        connect(g_wakeupSocket, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ioctlsocket(g_wakeupSocket, FIONBIO, &nonblocking) != 0)
+    {
+        closesocket(g_wakeupSocket);
+        g_wakeupSocket = INVALID_SOCKET;
+        return -1;
+    }
+    *pFd = g_wakeupSocket;
+
+    return 0;
+}
+
+/** Signals the wakeup socket. */
+void ualds_platform_wakeup_signal(void)
+{
+    if (g_wakeupSocket != INVALID_SOCKET)
+    {
+        send(g_wakeupSocket, "", 1, 0);
+    }
+}
+
+/** Resets the wakeup socket after it was signalled. */
+void ualds_platform_wakeup_drain(void)
+{
+    char buf[64];
+
+    if (g_wakeupSocket == INVALID_SOCKET) return;
+    while (recv(g_wakeupSocket, buf, sizeof(buf), 0) > 0);
+}
+
+void ualds_platform_wakeup_close(void)
+{
+    if (g_wakeupSocket != INVALID_SOCKET)
+    {
+        closesocket(g_wakeupSocket);
+        g_wakeupSocket = INVALID_SOCKET;
+    }
+}
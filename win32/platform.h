@@ -32,6 +32,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <winsock2.h>
 #include <windows.h>
 
 /* add some missing C99 defines for MS compiler*/
@@ -170,6 +171,8 @@ size_t ualds_platform_fread(void *ptr, size_t size, size_t nmemb, UALDS_FILE *fp
 size_t ualds_platform_fwrite(const void *ptr, size_t size, size_t nmemb, UALDS_FILE *fp);
 // int ualds_platform_fprintf(UALDS_FILE *fp, const char* fmt, ...);
 #define ualds_platform_fprintf fprintf
+int ualds_platform_fsync(UALDS_FILE *fp);
+int ualds_platform_replacefile(const char *szFile, const char *szNewFile, const char *szBackupFile);
 int ualds_platform_stat(const char *path, struct ualds_stat *buf);
 int ualds_platform_fstat(UALDS_FILE *fp, struct ualds_stat *buf);
 int ualds_platform_scandir(const char *dirp, struct ualds_dirent ***namelist,
@@ -181,6 +184,23 @@ void ualds_platform_getapplicationpath(char *szFilePath, size_t len);
 void ualds_platform_getcwd(char *szFilePath, size_t len);
 void ualds_platform_sleep(int seconds);
 
+/* slim reader/writer locks don't need to be destroyed */
+#define UALDS_RWLOCK SRWLOCK
+#define ualds_platform_rwlock_init(pLock) (InitializeSRWLock(pLock), 0)
+#define ualds_platform_rwlock_destroy(pLock) (void)(pLock)
+#define ualds_platform_rwlock_rdlock AcquireSRWLockShared
+#define ualds_platform_rwlock_rdunlock ReleaseSRWLockShared
+#define ualds_platform_rwlock_wrlock AcquireSRWLockExclusive
+#define ualds_platform_rwlock_wrunlock ReleaseSRWLockExclusive
+
+#define UALDS_SOCKET SOCKET
+#define UALDS_POLLFD WSAPOLLFD
+#define ualds_platform_poll WSAPoll
+int ualds_platform_wakeup_open(UALDS_SOCKET *pFd);
+void ualds_platform_wakeup_signal(void);
+void ualds_platform_wakeup_drain(void);
+void ualds_platform_wakeup_close(void);
+
 int ualds_platform_strcpy_insensitive(const char *s1, const char *s2);
 
 #ifndef HAVE_STRLCPY
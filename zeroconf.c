@@ -109,19 +109,17 @@ static void DNSSD_API ualds_DNSServiceRegisterReply(DNSServiceRef sdRef,
     }
 }
 
-void ualds_zeroconf_socketEventCallback(int* shutdown)
+/** Collects the sockets of all pending mDNS registrations for ualds_platform_poll.
+ * Entries of failed or stopped registrations are removed.
+ * @param pFds Receives up to \c maxFds sockets.
+ * @return The number of sockets, which can be larger than \c maxFds.
+ */
+int ualds_zeroconf_getSockets(UALDS_POLLFD *pFds, int maxFds)
 {
-    fd_set readFDs;
-    struct timeval tv;
-    int fd, status;
+    int numFds = 0;
     ualds_registerContext* context;
     MulticastSocketCallbackStruct* socketCallbackStruct;
 
-    if (*shutdown)
-    {
-        return;
-    }
-
     /* Need to synchronize access to shared fd/sdref between this main thread
       and registration thread - the g_lstServers list is convinient for that. */
     OpcUa_List_Enter(&g_lstServers);
@@ -132,7 +130,7 @@ void ualds_zeroconf_socketEventCallback(int* shutdown)
     while (socketCallbackStruct)
     {
         context = (ualds_registerContext*)socketCallbackStruct->context;
-        if (*shutdown || context == OpcUa_Null || context->sdRef == OpcUa_Null)
+        if (context == OpcUa_Null || context->sdRef == OpcUa_Null || context->sdRef != socketCallbackStruct->sdRef)
         {
             /* previously a registration failed or was stopped - remove socket from poll list */
             OpcUa_Free(socketCallbackStruct);
@@ -141,17 +139,46 @@ void ualds_zeroconf_socketEventCallback(int* shutdown)
             continue;
         }
 
-        fd = DNSServiceRefSockFD(socketCallbackStruct->sdRef);
-        FD_ZERO(&readFDs);
-        FD_SET(fd, &readFDs);
+        if (numFds < maxFds)
+        {
+            pFds[numFds].fd = DNSServiceRefSockFD(socketCallbackStruct->sdRef);
+            pFds[numFds].events = POLLIN;
+            pFds[numFds].revents = 0;
+        }
+        numFds++;
+        socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetNextElement(&g_registerServersSocketList);
+    }
+
+    OpcUa_List_Leave(&g_registerServersSocketList);
+    OpcUa_List_Leave(&g_lstServers);
 
-        tv.tv_sec = 0;
-        tv.tv_usec = 100000;
+    return numFds;
+}
 
-        status = select(fd + 1, &readFDs, NULL, NULL, &tv);
-        if (status > 0)
+/** Processes the mDNS registration result which is pending on the socket \c pFd.
+ * The registration may have been stopped since the socket was collected,
+ * so the socket is looked up again and checked for pending data before
+ * DNSServiceProcessResult is called, which would block otherwise.
+ */
+void ualds_zeroconf_processSocket(const UALDS_POLLFD *pFd)
+{
+    UALDS_POLLFD pollFd = *pFd;
+    ualds_registerContext* context;
+    MulticastSocketCallbackStruct* socketCallbackStruct;
+
+    OpcUa_List_Enter(&g_lstServers);
+    OpcUa_List_Enter(&g_registerServersSocketList);
+    OpcUa_List_ResetCurrent(&g_registerServersSocketList);
+
+    socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetCurrentElement(&g_registerServersSocketList);
+    while (socketCallbackStruct)
+    {
+        context = (ualds_registerContext*)socketCallbackStruct->context;
+        if (context != OpcUa_Null && context->sdRef != OpcUa_Null && context->sdRef == socketCallbackStruct->sdRef &&
+            DNSServiceRefSockFD(socketCallbackStruct->sdRef) == pollFd.fd)
         {
-            if (FD_ISSET(fd, &readFDs))
+            pollFd.revents = 0;
+            if (ualds_platform_poll(&pollFd, 1, 0) > 0)
             {
                 int error = DNSServiceProcessResult(socketCallbackStruct->sdRef);
                 if (error != kDNSServiceErr_NoError)
@@ -159,6 +186,7 @@ void ualds_zeroconf_socketEventCallback(int* shutdown)
                     ualds_log(UALDS_LOG_ERR, "DNSServiceProcessResult: error == %d\n", error);
                 }
             }
+            break;
         }
         socketCallbackStruct = (MulticastSocketCallbackStruct*)OpcUa_List_GetNextElement(&g_registerServersSocketList);
     }
@@ -315,7 +343,6 @@ static OpcUa_StatusCode OPCUA_DLLCALL ualds_zeroconf_registerInternal(OpcUa_Void
     UALDS_UNUSED(msecElapsed);
 
     OpcUa_Mutex_Lock(g_mutex);
-    ualds_expirationcheck();
 
     OpcUa_List_Enter(&g_lstServers);
     OpcUa_List_ResetCurrent(&g_lstServers);
@@ -364,7 +391,7 @@ static OpcUa_StatusCode OPCUA_DLLCALL ualds_zeroconf_registerInternal(OpcUa_Void
         {
             /* replace [gethostname] in own server name */
             char hostname[UALDS_CONF_MAX_URI_LENGTH] = {0};
-            ualds_platform_getfqhostname(hostname, sizeof(hostname));
+            ualds_hostname(hostname, sizeof(hostname));
             replace_string(szMDNSServerName, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", hostname);
             replace_string(szHostName, UALDS_CONF_MAX_URI_LENGTH, "[gethostname]", hostname);
             bOwnRegistration = OpcUa_False;
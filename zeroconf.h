@@ -31,6 +31,7 @@
 #define __ZEROCONF_H__
 
 #include <opcua_proxystub.h>
+#include <platform.h>
 
 OpcUa_StatusCode ualds_zeroconf_start_registration(void);
 void ualds_zeroconf_stop_registration(void);
@@ -38,6 +39,7 @@ void ualds_zeroconf_stop_registration(void);
 void ualds_zeroconf_addRegistration(const char *szServerUri);
 void ualds_zeroconf_removeRegistration(const char *szServerUri);
 
-void ualds_zeroconf_socketEventCallback(int* shutdown);
+int ualds_zeroconf_getSockets(UALDS_POLLFD *pFds, int maxFds);
+void ualds_zeroconf_processSocket(const UALDS_POLLFD *pFd);
 
 #endif /* __ZEROCONF_H__ */